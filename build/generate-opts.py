@@ -318,6 +318,7 @@ opts_structs = OrderedDict([
                     'change.',
         }),
         ('showExpandedEvents', { 'type': 'bool', 'help': 'Set to ``true`` to return an expanded list of change stream events. Available only on MongoDB versions >=6.0'}),
+        ('prefetch', {'type': 'bool', 'help': 'Set to ``true`` to send the next ``getMore`` in a background thread while the application processes the events returned by :symbol:`mongoc_change_stream_next_batch`. The client must not be used by any other operation until the next call to :symbol:`mongoc_change_stream_next_batch`, :symbol:`mongoc_change_stream_next`, or :symbol:`mongoc_change_stream_destroy`.'}),
         comment_option_string_pre_4_4,
     ], fullDocument=None, fullDocumentBeforeChange=None, batchSize=-1, rst_prelude=".. versionchanged:: 2.0.0 ``batchSize`` of 0 is applied to the ``aggregate`` command. 0 was previously ignored.")),
 
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <common-prelude.h>
+
+#ifndef MONGO_C_DRIVER_COMMON_DTOA_PRIVATE_H
+#define MONGO_C_DRIVER_COMMON_DTOA_PRIVATE_H
+
+#include <bson/bson.h>
+
+#define mcommon_dtoa_shortest COMMON_NAME(dtoa_shortest)
+
+BSON_BEGIN_DECLS
+
+// The maximum number of digits written by mcommon_dtoa_shortest.
+#define MCOMMON_DTOA_MAX_DIGITS 17
+
+/**
+ * @brief Find the shortest decimal representation that reads back as a double.
+ * @param value A finite, positive double.
+ * @param digits Receives up to MCOMMON_DTOA_MAX_DIGITS decimal digits, not NUL-terminated. The first digit is not '0'.
+ * @param exponent Receives the power of ten to scale the digits by: value is (digits) * 10^(exponent).
+ * @returns The number of digits written.
+ *
+ * Of the representations with the fewest digits, the one closest to @p value is chosen. Uses the Ryu algorithm by
+ * Ulf Adams, "Ryu: fast float-to-string conversion", PLDI 2018.
+ */
+uint32_t
+mcommon_dtoa_shortest(double value, char digits[MCOMMON_DTOA_MAX_DIGITS], int32_t *exponent);
+
+BSON_END_DECLS
+
+#endif /* MONGO_C_DRIVER_COMMON_DTOA_PRIVATE_H */
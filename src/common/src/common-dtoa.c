@@ -0,0 +1,275 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <common-dtoa-private.h>
+
+#include <string.h>
+
+// The tables hold the most significant bits of 5^i and 5^-i, as pairs of 64-bit halves with the low half first.
+#define POW5_BITCOUNT 125
+#define POW5_INV_BITCOUNT 125
+#include <common-dtoa-tables.generated.h>
+
+#define DOUBLE_MANTISSA_BITS 52
+#define DOUBLE_EXPONENT_BITS 11
+#define DOUBLE_BIAS 1023
+
+// Returns ceil(log2(5^e)), or 1 if e is 0. Exact for 0 <= e <= 3528.
+static int32_t
+pow5bits(int32_t e)
+{
+   BSON_ASSERT(e >= 0 && e <= 3528);
+   return (int32_t)(((uint32_t)e * 1217359u) >> 19) + 1;
+}
+
+// Returns floor(log10(2^e)). Exact for 0 <= e <= 1650.
+static uint32_t
+log10_pow2(int32_t e)
+{
+   BSON_ASSERT(e >= 0 && e <= 1650);
+   return ((uint32_t)e * 78913u) >> 18;
+}
+
+// Returns floor(log10(5^e)). Exact for 0 <= e <= 2620.
+static uint32_t
+log10_pow5(int32_t e)
+{
+   BSON_ASSERT(e >= 0 && e <= 2620);
+   return ((uint32_t)e * 732923u) >> 20;
+}
+
+static uint32_t
+pow5_factor(uint64_t value)
+{
+   uint32_t count = 0;
+   while (value % 5u == 0) {
+      value /= 5u;
+      count++;
+   }
+   return count;
+}
+
+static bool
+multiple_of_power_of_5(uint64_t value, uint32_t p)
+{
+   return pow5_factor(value) >= p;
+}
+
+static bool
+multiple_of_power_of_2(uint64_t value, uint32_t p)
+{
+   BSON_ASSERT(p < 64);
+   return (value & ((UINT64_C(1) << p) - 1u)) == 0;
+}
+
+#if defined(__SIZEOF_INT128__)
+// __extension__ keeps -pedantic from rejecting the non-standard type.
+__extension__ typedef unsigned __int128 dtoa_uint128_t;
+#endif
+
+// Returns the 128-bit product of a and b.
+static void
+umul128(uint64_t a, uint64_t b, uint64_t *lo, uint64_t *hi)
+{
+#if defined(__SIZEOF_INT128__)
+   const dtoa_uint128_t product = (dtoa_uint128_t)a * b;
+   *lo = (uint64_t)product;
+   *hi = (uint64_t)(product >> 64);
+#else
+   const uint64_t a_lo = (uint32_t)a;
+   const uint64_t a_hi = a >> 32;
+   const uint64_t b_lo = (uint32_t)b;
+   const uint64_t b_hi = b >> 32;
+
+   const uint64_t lo_lo = a_lo * b_lo;
+   const uint64_t hi_lo = a_hi * b_lo;
+   const uint64_t lo_hi = a_lo * b_hi;
+   const uint64_t hi_hi = a_hi * b_hi;
+
+   const uint64_t mid = (lo_lo >> 32) + (uint32_t)hi_lo + (uint32_t)lo_hi;
+   *lo = (mid << 32) | (uint32_t)lo_lo;
+   *hi = hi_hi + (hi_lo >> 32) + (lo_hi >> 32) + (mid >> 32);
+#endif
+}
+
+// Returns (m * mul) >> j, where mul is a 128-bit table entry and 64 < j < 128.
+static uint64_t
+mul_shift64(uint64_t m, const uint64_t mul[2], int32_t j)
+{
+   uint64_t b0_lo, b0_hi, b2_lo, b2_hi;
+
+   BSON_ASSERT(j > 64 && j < 128);
+
+   umul128(m, mul[0], &b0_lo, &b0_hi);
+   umul128(m, mul[1], &b2_lo, &b2_hi);
+   BSON_UNUSED(b0_lo);
+
+   // (b0 >> 64) + b2, as a 128-bit sum.
+   const uint64_t sum_lo = b0_hi + b2_lo;
+   const uint64_t sum_hi = b2_hi + (sum_lo < b0_hi);
+
+   const int32_t shift = j - 64;
+   return (sum_hi << (64 - shift)) | (sum_lo >> shift);
+}
+
+uint32_t
+mcommon_dtoa_shortest(double value, char digits[MCOMMON_DTOA_MAX_DIGITS], int32_t *exponent)
+{
+   BSON_ASSERT_PARAM(digits);
+   BSON_ASSERT_PARAM(exponent);
+   BSON_ASSERT(value > 0.0 && value * 0 == 0);
+
+   uint64_t bits;
+   memcpy(&bits, &value, sizeof bits);
+
+   const uint64_t ieee_mantissa = bits & ((UINT64_C(1) << DOUBLE_MANTISSA_BITS) - 1u);
+   const uint32_t ieee_exponent = (uint32_t)(bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1u);
+
+   // value is m2 * 2^e2. Both are offset by two bits, to leave room for the bounds of the rounding interval.
+   int32_t e2;
+   uint64_t m2;
+   if (ieee_exponent == 0) {
+      e2 = 1 - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS - 2;
+      m2 = ieee_mantissa;
+   } else {
+      e2 = (int32_t)ieee_exponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS - 2;
+      m2 = (UINT64_C(1) << DOUBLE_MANTISSA_BITS) | ieee_mantissa;
+   }
+   const bool even = (m2 & 1u) == 0;
+   const bool accept_bounds = even;
+
+   // The value and the bounds of its rounding interval: mv, mp = mv + 2, mm = mv - 1 - mm_shift. The lower bound is
+   // closer at a power of two.
+   const uint64_t mv = 4u * m2;
+   const uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+   // Convert the interval to decimal: vr, vp, vm are mv, mp, mm scaled by 10^-e10.
+   uint64_t vr, vp, vm;
+   int32_t e10;
+   bool vm_is_trailing_zeros = false;
+   bool vr_is_trailing_zeros = false;
+   if (e2 >= 0) {
+      const uint32_t q = log10_pow2(e2) - (e2 > 3);
+      e10 = (int32_t)q;
+      const int32_t k = POW5_INV_BITCOUNT + pow5bits((int32_t)q) - 1;
+      const int32_t i = -e2 + (int32_t)q + k;
+      BSON_ASSERT(q < MCOMMON_DTOA_POW5_INV_TABLE_SIZE);
+      vr = mul_shift64(4u * m2, mcommon_dtoa_pow5_inv_split[q], i);
+      vp = mul_shift64(4u * m2 + 2u, mcommon_dtoa_pow5_inv_split[q], i);
+      vm = mul_shift64(4u * m2 - 1u - mm_shift, mcommon_dtoa_pow5_inv_split[q], i);
+      if (q <= 21) {
+         // Only one of mp, mv, and mm can be a multiple of 5, if any.
+         if (mv % 5u == 0) {
+            vr_is_trailing_zeros = multiple_of_power_of_5(mv, q);
+         } else if (accept_bounds) {
+            vm_is_trailing_zeros = multiple_of_power_of_5(mv - 1u - mm_shift, q);
+         } else {
+            vp -= multiple_of_power_of_5(mv + 2u, q);
+         }
+      }
+   } else {
+      const uint32_t q = log10_pow5(-e2) - (-e2 > 1);
+      e10 = (int32_t)q + e2;
+      const int32_t i = -e2 - (int32_t)q;
+      const int32_t k = pow5bits(i) - POW5_BITCOUNT;
+      const int32_t j = (int32_t)q - k;
+      BSON_ASSERT(i < MCOMMON_DTOA_POW5_TABLE_SIZE);
+      vr = mul_shift64(4u * m2, mcommon_dtoa_pow5_split[i], j);
+      vp = mul_shift64(4u * m2 + 2u, mcommon_dtoa_pow5_split[i], j);
+      vm = mul_shift64(4u * m2 - 1u - mm_shift, mcommon_dtoa_pow5_split[i], j);
+      if (q <= 1) {
+         // mv has at least q trailing zero bits, so vr has at least q trailing decimal zeros.
+         vr_is_trailing_zeros = true;
+         if (accept_bounds) {
+            vm_is_trailing_zeros = mm_shift == 1;
+         } else {
+            vp--;
+         }
+      } else if (q < 63) {
+         vr_is_trailing_zeros = multiple_of_power_of_2(mv, q);
+      }
+   }
+
+   // Remove digits while the interval still holds a shorter representation.
+   int32_t removed = 0;
+   uint8_t last_removed_digit = 0;
+   uint64_t output;
+   if (vm_is_trailing_zeros || vr_is_trailing_zeros) {
+      // Rare: the interval bounds or the value are exact, so ties and inclusive bounds must be handled.
+      while (vp / 10u > vm / 10u) {
+         vm_is_trailing_zeros &= vm % 10u == 0;
+         vr_is_trailing_zeros &= last_removed_digit == 0;
+         last_removed_digit = (uint8_t)(vr % 10u);
+         vr /= 10u;
+         vp /= 10u;
+         vm /= 10u;
+         removed++;
+      }
+      if (vm_is_trailing_zeros) {
+         while (vm % 10u == 0) {
+            vr_is_trailing_zeros &= last_removed_digit == 0;
+            last_removed_digit = (uint8_t)(vr % 10u);
+            vr /= 10u;
+            vp /= 10u;
+            vm /= 10u;
+            removed++;
+         }
+      }
+      if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2u == 0) {
+         // Round ties to even.
+         last_removed_digit = 4;
+      }
+      output = vr + ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros)) || last_removed_digit >= 5);
+   } else {
+      bool round_up = false;
+      if (vp / 100u > vm / 100u) {
+         round_up = vr % 100u >= 50u;
+         vr /= 100u;
+         vp /= 100u;
+         vm /= 100u;
+         removed += 2;
+      }
+      while (vp / 10u > vm / 10u) {
+         round_up = vr % 10u >= 5u;
+         vr /= 10u;
+         vp /= 10u;
+         vm /= 10u;
+         removed++;
+      }
+      output = vr + (vr == vm || round_up);
+   }
+
+   // Rounding up may leave trailing zeros, which a shorter representation of the same value does not need.
+   while (output % 10u == 0) {
+      output /= 10u;
+      removed++;
+   }
+
+   // Write the digits, most significant first.
+   char buf[20];
+   uint32_t len = 0;
+   do {
+      buf[len++] = (char)('0' + output % 10u);
+      output /= 10u;
+   } while (output);
+   BSON_ASSERT(len <= MCOMMON_DTOA_MAX_DIGITS);
+
+   for (uint32_t n = 0; n < len; n++) {
+      digits[n] = buf[len - 1u - n];
+   }
+   *exponent = e10 + removed;
+   return len;
+}
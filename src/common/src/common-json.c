@@ -15,6 +15,7 @@
  */
 
 
+#include <common-dtoa-private.h>
 #include <common-json-private.h>
 #include <common-string-private.h>
 #include <common-utf8-private.h>
@@ -443,6 +444,25 @@ mcommon_json_append_escaped_considers_byte_as_special(uint8_t byte)
    return 0 != (table[byte >> 6] & (1ull << (byte & 0x3f)));
 }
 
+/**
+ * @brief Test whether any of the eight bytes of a word may require special processing in mcommon_json_append_escaped.
+ * @returns true if the word contains a byte in the range 0x00 - 0x1F, '\\', '\"', or 0xC0.
+ */
+static BSON_INLINE bool
+mcommon_json_append_escaped_word_has_special(uint64_t word)
+{
+   const uint64_t ones = 0x0101010101010101ull;
+   const uint64_t high_bits = 0x8080808080808080ull;
+   // Bytes equal to a special byte become zero.
+   const uint64_t quote = word ^ (ones * 0x22u);
+   const uint64_t backslash = word ^ (ones * 0x5Cu);
+   const uint64_t c0 = word ^ (ones * 0xC0u);
+
+   // Each term is nonzero if any byte of its word is less than 0x20, or is zero, respectively.
+   return 0 != (((word - ones * 0x20u) & ~word & high_bits) | ((quote - ones) & ~quote & high_bits) |
+                ((backslash - ones) & ~backslash & high_bits) | ((c0 - ones) & ~c0 & high_bits));
+}
+
 /**
  * @brief Measure the number of consecutive non-special bytes.
  */
@@ -450,8 +470,17 @@ static BSON_INLINE uint32_t
 mcommon_json_append_escaped_count_non_special_bytes(const char *str, uint32_t len)
 {
    uint32_t result = 0;
-   // Good candidate for architecture-specific optimizations.
-   // SSE4 strcspn is nearly what we want, but our table of special bytes would be too large (34 > 16)
+   // Skip eight bytes at a time while none is special, then find the special byte one byte at a time.
+   while (len >= sizeof(uint64_t)) {
+      uint64_t word;
+      memcpy(&word, str, sizeof word);
+      if (mcommon_json_append_escaped_word_has_special(word)) {
+         break;
+      }
+      result += (uint32_t)sizeof(uint64_t);
+      str += sizeof(uint64_t);
+      len -= (uint32_t)sizeof(uint64_t);
+   }
    while (len) {
       if (mcommon_json_append_escaped_considers_byte_as_special((uint8_t)*str)) {
          break;
@@ -582,6 +611,83 @@ mcommon_iso8601_string_append(mcommon_string_append_t *append, int64_t msec_sinc
    }
 }
 
+/**
+ * @brief Append a finite double as the shortest decimal that reads back as the same value.
+ *
+ * The layout is that of printf("%.20g"): scientific notation is used for exponents below -4 or above 19. A trailing
+ * ".0" distinguishes "3.0" from "3". Unlike printf, the output does not depend on the locale.
+ */
+static bool
+mcommon_json_append_double_shortest(mcommon_string_append_t *append, double value)
+{
+   // At most 24 characters in any of the layouts below.
+   char out[32];
+   size_t len = 0;
+   uint64_t bits;
+
+   memcpy(&bits, &value, sizeof bits);
+   if (bits >> 63) {
+      out[len++] = '-';
+      value = -value;
+   }
+
+   if (value == 0) {
+      memcpy(out + len, "0.0", 3);
+      len += 3;
+      return mcommon_string_append_bytes(append, out, (uint32_t)len);
+   }
+
+   char digits[MCOMMON_DTOA_MAX_DIGITS];
+   int32_t exponent;
+   const int32_t n_digits = (int32_t)mcommon_dtoa_shortest(value, digits, &exponent);
+   // The exponent of the first digit in scientific notation.
+   const int32_t sci_exponent = exponent + n_digits - 1;
+
+   if (sci_exponent < -4 || sci_exponent >= 20) {
+      out[len++] = digits[0];
+      if (n_digits > 1) {
+         out[len++] = '.';
+         memcpy(out + len, digits + 1, (size_t)n_digits - 1u);
+         len += (size_t)n_digits - 1u;
+      }
+      out[len++] = 'e';
+      out[len++] = sci_exponent < 0 ? '-' : '+';
+      // At least two exponent digits, as printed by printf.
+      const int32_t abs_exponent = sci_exponent < 0 ? -sci_exponent : sci_exponent;
+      if (abs_exponent >= 100) {
+         out[len++] = (char)('0' + abs_exponent / 100);
+      }
+      out[len++] = (char)('0' + abs_exponent / 10 % 10);
+      out[len++] = (char)('0' + abs_exponent % 10);
+   } else if (sci_exponent >= 0) {
+      const int32_t n_integer_digits = sci_exponent + 1;
+      if (n_digits <= n_integer_digits) {
+         memcpy(out + len, digits, (size_t)n_digits);
+         len += (size_t)n_digits;
+         memset(out + len, '0', (size_t)(n_integer_digits - n_digits));
+         len += (size_t)(n_integer_digits - n_digits);
+         memcpy(out + len, ".0", 2);
+         len += 2;
+      } else {
+         memcpy(out + len, digits, (size_t)n_integer_digits);
+         len += (size_t)n_integer_digits;
+         out[len++] = '.';
+         memcpy(out + len, digits + n_integer_digits, (size_t)(n_digits - n_integer_digits));
+         len += (size_t)(n_digits - n_integer_digits);
+      }
+   } else {
+      out[len++] = '0';
+      out[len++] = '.';
+      memset(out + len, '0', (size_t)(-sci_exponent - 1));
+      len += (size_t)(-sci_exponent - 1);
+      memcpy(out + len, digits, (size_t)n_digits);
+      len += (size_t)n_digits;
+   }
+
+   BSON_ASSERT(len <= sizeof out);
+   return mcommon_string_append_bytes(append, out, (uint32_t)len);
+}
+
 bool
 mcommon_json_append_value_double(mcommon_string_append_t *append, double value, bson_json_mode_t mode)
 {
@@ -603,15 +709,11 @@ mcommon_json_append_value_double(mcommon_string_append_t *append, double value,
       } else {
          mcommon_string_append(append, "-Infinity");
       }
+   } else if (value != value || value * 0 != 0) {
+      /* legacy output of nan and inf is as printed by the platform */
+      mcommon_string_append_printf(append, "%.20g", value);
    } else {
-      const mcommon_string_t *string = mcommon_string_from_append(append);
-      uint32_t start_len = string->len;
-      if (mcommon_string_append_printf(append, "%.20g", value)) {
-         /* ensure trailing ".0" to distinguish "3" from "3.0" */
-         if (strspn(&string->str[start_len], "0123456789-") == string->len - start_len) {
-            mcommon_string_append(append, ".0");
-         }
-      }
+      mcommon_json_append_double_shortest(append, value);
    }
 
    if (!legacy) {
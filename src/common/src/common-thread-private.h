@@ -31,6 +31,7 @@ BSON_BEGIN_DECLS
 
 #define mcommon_thread_create COMMON_NAME(thread_create)
 #define mcommon_thread_join COMMON_NAME(thread_join)
+#define mcommon_thread_n_processors COMMON_NAME(thread_n_processors)
 
 #if defined(BSON_OS_UNIX)
 #include <pthread.h>
@@ -147,6 +148,11 @@ mcommon_thread_join(bson_thread_t thread);
 int
 mcommon_thread_create(bson_thread_t *thread, BSON_THREAD_FUN_TYPE(func), void *arg);
 
+// mcommon_thread_n_processors returns the number of online processors, at
+// least 1.
+uint32_t
+mcommon_thread_n_processors(void);
+
 #if defined(MONGOC_ENABLE_DEBUG_ASSERTIONS) && defined(BSON_OS_UNIX)
 #define mcommon_mutex_is_locked COMMON_NAME(mutex_is_locked)
 bool
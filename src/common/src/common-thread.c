@@ -18,6 +18,10 @@
 
 #include <errno.h>
 
+#if defined(BSON_OS_UNIX)
+#include <unistd.h>
+#endif
+
 #if defined(BSON_OS_UNIX)
 int
 mcommon_thread_create(bson_thread_t *thread, BSON_THREAD_FUN_TYPE(func), void *arg)
@@ -32,6 +36,13 @@ mcommon_thread_join(bson_thread_t thread)
 {
    return pthread_join(thread, NULL);
 }
+uint32_t
+mcommon_thread_n_processors(void)
+{
+   const long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+   return n > 0 ? (uint32_t)BSON_MIN(n, 1024) : 1u;
+}
 
 #if defined(MONGOC_ENABLE_DEBUG_ASSERTIONS) && defined(BSON_OS_UNIX)
 bool
@@ -72,4 +83,12 @@ mcommon_thread_join(bson_thread_t thread)
    }
    return 0;
 }
+uint32_t
+mcommon_thread_n_processors(void)
+{
+   SYSTEM_INFO info;
+
+   GetSystemInfo(&info);
+   return BSON_MAX((uint32_t)info.dwNumberOfProcessors, 1u);
+}
 #endif
@@ -0,0 +1,59 @@
+"""
+This script generates common-dtoa-tables.generated.h, the tables of powers of
+five used by mcommon_dtoa_shortest() in common-dtoa.c.
+
+Run this script with Python 3.12+, and pipe the output into a file.
+
+This script takes no command-line arguments.
+"""
+
+# /// script
+# requires-python = ">=3.12"
+# dependencies = []
+# ///
+
+# The number of bits of each table entry. Must match common-dtoa.c.
+POW5_BITCOUNT = 125
+POW5_INV_BITCOUNT = 125
+
+# 5^i for i < POW5_TABLE_SIZE covers the negative binary exponents of doubles,
+# and 5^-i for i < POW5_INV_TABLE_SIZE covers the positive ones.
+POW5_TABLE_SIZE = 326
+POW5_INV_TABLE_SIZE = 342
+
+
+def split(value: int) -> str:
+    """Format a 128-bit value as a pair of 64-bit halves, low half first"""
+    mask = (1 << 64) - 1
+    return f"{{UINT64_C({value & mask}), UINT64_C({value >> 64})}}"
+
+
+def main() -> None:
+    print("// ! This code is GENERATED! Do not edit it directly!")
+    print("// Generated by dtoa-tables.py.")
+    print("// clang-format off")
+    print()
+    print("#define MCOMMON_DTOA_POW5_TABLE_SIZE", POW5_TABLE_SIZE)
+    print("#define MCOMMON_DTOA_POW5_INV_TABLE_SIZE", POW5_INV_TABLE_SIZE)
+    print()
+    # The POW5_BITCOUNT most significant bits of 5^i.
+    print("static const uint64_t mcommon_dtoa_pow5_split[MCOMMON_DTOA_POW5_TABLE_SIZE][2] = {")
+    for i in range(POW5_TABLE_SIZE):
+        pow5 = 5**i
+        shift = pow5.bit_length() - POW5_BITCOUNT
+        value = pow5 >> shift if shift >= 0 else pow5 << -shift
+        print(f"   {split(value)},")
+    print("};")
+    print()
+    # The POW5_INV_BITCOUNT most significant bits of 1 / 5^i, rounded up.
+    print("static const uint64_t mcommon_dtoa_pow5_inv_split[MCOMMON_DTOA_POW5_INV_TABLE_SIZE][2] = {")
+    for i in range(POW5_INV_TABLE_SIZE):
+        pow5 = 5**i
+        shift = pow5.bit_length() - 1 + POW5_INV_BITCOUNT
+        value = (1 << shift) // pow5 + 1
+        print(f"   {split(value)},")
+    print("};")
+
+
+if __name__ == "__main__":
+    main()
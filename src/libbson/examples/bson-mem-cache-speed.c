@@ -0,0 +1,156 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <bson/bson.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * This is a benchmark of the allocations of a typical operation: building a
+ * command and copying its reply, formatting an error message, allocating an
+ * iovec array and converting a document to JSON. They run on one or more
+ * threads, with the system allocator or with bson_mem_cache_get_vtable().
+ *
+ * ./bson-mem-cache-speed 100000 1 malloc
+ * ./bson-mem-cache-speed 100000 4 cache
+ */
+
+
+#define MAX_THREADS 64
+
+
+typedef struct {
+   uint8_t data[16];
+} iovec_t;
+
+
+static void
+operation(int i)
+{
+   bson_t *cmd;
+   bson_t *reply;
+   bson_t child;
+   iovec_t *iov;
+   char *message;
+   char *json;
+
+   cmd = bson_new();
+   BSON_APPEND_UTF8(cmd, "find", "collection");
+   BSON_APPEND_DOCUMENT_BEGIN(cmd, "filter", &child);
+   BSON_APPEND_INT32(&child, "x", i);
+   BSON_APPEND_UTF8(&child, "name", "a string long enough to spill the document out of its inline buffer");
+   bson_append_document_end(cmd, &child);
+   BSON_APPEND_INT32(cmd, "batchSize", 100);
+   BSON_APPEND_UTF8(cmd, "$db", "db");
+
+   iov = BSON_ARRAY_ALLOC((size_t)(i % 4) + 2u, iovec_t);
+   memset(iov, 0, sizeof *iov);
+
+   reply = bson_copy(cmd);
+   message = bson_strdup_printf("Failed to send \"%s\" command with database \"%s\": %d", "find", "db", i);
+   json = bson_as_relaxed_extended_json(reply, NULL);
+
+   bson_free(json);
+   bson_free(message);
+   bson_destroy(reply);
+   bson_free(iov);
+   bson_destroy(cmd);
+}
+
+
+static void *
+worker(void *data)
+{
+   const int n = *(const int *)data;
+
+   for (int i = 0; i < n; i++) {
+      operation(i);
+   }
+
+   return NULL;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+   pthread_t threads[MAX_THREADS];
+   bson_mem_cache_stats_t stats;
+   int n;
+   int n_threads;
+   int64_t start;
+   int64_t elapsed_us;
+
+   if (argc != 4 || (strcmp(argv[3], "malloc") != 0 && strcmp(argv[3], "cache") != 0)) {
+      fprintf(stderr,
+              "usage: bson-mem-cache-speed NUM_ITERATIONS NUM_THREADS [malloc|cache]\n"
+              "\n"
+              "  malloc = the system allocator\n"
+              "  cache  = bson_mem_cache_get_vtable()\n"
+              "\n");
+      return EXIT_FAILURE;
+   }
+
+   n = atoi(argv[1]);
+   n_threads = atoi(argv[2]);
+
+   if (n_threads < 1 || n_threads > MAX_THREADS) {
+      fprintf(stderr, "NUM_THREADS must be between 1 and %d\n", MAX_THREADS);
+      return EXIT_FAILURE;
+   }
+
+   /* the vtable is set before anything is allocated */
+   if (strcmp(argv[3], "cache") == 0) {
+      bson_mem_set_vtable(bson_mem_cache_get_vtable());
+   }
+
+   start = bson_get_monotonic_time();
+
+   for (int i = 0; i < n_threads; i++) {
+      if (pthread_create(&threads[i], NULL, worker, &n) != 0) {
+         perror("pthread_create");
+         return EXIT_FAILURE;
+      }
+   }
+
+   for (int i = 0; i < n_threads; i++) {
+      pthread_join(threads[i], NULL);
+   }
+
+   elapsed_us = bson_get_monotonic_time() - start;
+   printf("%d operations on %d threads in %.3f seconds", n, n_threads, (double)elapsed_us / 1e6);
+   if (n > 0) {
+      printf(", %.1f ns per operation", (double)elapsed_us * 1e3 / ((double)n * n_threads));
+   }
+   printf("\n");
+
+   if (strcmp(argv[3], "cache") == 0) {
+      bson_mem_cache_get_stats(&stats);
+      printf("small allocs: %" PRId64 ", large allocs: %" PRId64 ", refills: %" PRId64 ", releases: %" PRId64
+             ", reserved: %" PRId64 " bytes\n",
+             stats.small_allocs,
+             stats.large_allocs,
+             stats.refills,
+             stats.releases,
+             stats.bytes_reserved);
+   }
+
+   return 0;
+}
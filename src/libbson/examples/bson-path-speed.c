@@ -0,0 +1,131 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <bson/bson.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * This is a benchmark of finding the same dotted paths in a document with
+ * bson_iter_find_descendant(), with a bson_path_t per path, or with a single
+ * bson_path_set_t.
+ *
+ * ./bson-path-speed 1000000 descendant
+ * ./bson-path-speed 1000000 path
+ * ./bson-path-speed 1000000 path-set
+ */
+
+
+#define N_PATHS 6
+
+
+int
+main(int argc, char *argv[])
+{
+   static const char *const dotkeys[N_PATHS] = {
+      "meta.tenant.id", "meta.tenant.region", "meta.created", "status", "items.2.sku", "owner.address.city"};
+   bson_path_t *paths[N_PATHS];
+   bson_path_set_t *set;
+   bson_iter_t iters[N_PATHS];
+   bool found[N_PATHS];
+   bson_iter_t iter;
+   bson_t *doc;
+   bson_error_t error;
+   size_t n_found = 0;
+   char key[16];
+   int n;
+   int j;
+   int64_t start;
+   int64_t elapsed_us;
+
+   if (argc != 3 ||
+       (strcmp(argv[2], "descendant") != 0 && strcmp(argv[2], "path") != 0 && strcmp(argv[2], "path-set") != 0)) {
+      fprintf(stderr,
+              "usage: bson-path-speed NUM_ITERATIONS [descendant|path|path-set]\n"
+              "\n"
+              "  descendant = bson_iter_find_descendant() for each path\n"
+              "  path       = bson_path_find() for each path\n"
+              "  path-set   = bson_path_set_find() for all paths\n"
+              "\n");
+      return EXIT_FAILURE;
+   }
+
+   n = atoi(argv[1]);
+
+   doc = bson_new_from_json((const uint8_t *)"{\"_id\": 1, \"name\": \"a name\", \"status\": \"active\","
+                                             " \"meta\": {\"version\": 3, \"created\": 1700000000,"
+                                             " \"tenant\": {\"name\": \"tenant\", \"region\": \"eu\", \"id\": 42}},"
+                                             " \"items\": [{\"sku\": \"a\"}, {\"sku\": \"b\"}, {\"sku\": \"c\"}],"
+                                             " \"owner\": {\"name\": \"owner\", \"address\": {\"street\": \"a street\","
+                                             " \"city\": \"a city\"}}}",
+                             -1,
+                             &error);
+   if (!doc) {
+      fprintf(stderr, "%s\n", error.message);
+      return EXIT_FAILURE;
+   }
+
+   /* Pad the document with other fields, before and after those found. */
+   for (j = 0; j < 20; j++) {
+      bson_snprintf(key, sizeof key, "field%d", j);
+      BSON_APPEND_INT32(doc, key, j);
+   }
+
+   for (j = 0; j < N_PATHS; j++) {
+      paths[j] = bson_path_new(dotkeys[j]);
+   }
+   set = bson_path_set_new(dotkeys, N_PATHS);
+
+   start = bson_get_monotonic_time();
+
+   for (int i = 0; i < n; i++) {
+      if (strcmp(argv[2], "descendant") == 0) {
+         for (j = 0; j < N_PATHS; j++) {
+            bson_iter_t descendant;
+
+            if (bson_iter_init(&iter, doc) && bson_iter_find_descendant(&iter, dotkeys[j], &descendant)) {
+               n_found++;
+            }
+         }
+      } else if (strcmp(argv[2], "path") == 0) {
+         for (j = 0; j < N_PATHS; j++) {
+            if (bson_path_find(paths[j], doc, &iter)) {
+               n_found++;
+            }
+         }
+      } else {
+         n_found += bson_path_set_find(set, doc, iters, found);
+      }
+   }
+
+   elapsed_us = bson_get_monotonic_time() - start;
+   printf("found %zu of %d x %d paths in %.3f seconds", n_found, n, N_PATHS, (double)elapsed_us / 1e6);
+   if (n > 0) {
+      printf(", %.1f ns per document", (double)elapsed_us * 1e3 / n);
+   }
+   printf("\n");
+
+   for (j = 0; j < N_PATHS; j++) {
+      bson_path_destroy(paths[j]);
+   }
+   bson_path_set_destroy(set);
+   bson_destroy(doc);
+
+   return 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <bson/bson.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * This is a benchmark of bson_utf8_validate() over ASCII text, or text mixing
+ * ASCII with two, three and four byte sequences.
+ *
+ * ./bson-utf8-speed 100000 ascii
+ * ./bson-utf8-speed 100000 mixed
+ */
+
+
+int
+main(int argc, char *argv[])
+{
+   static const char *const mixed_words[] = {"plain ", "caf\xc3\xa9 ", "\xe2\x82\xac 10 ", "\xf0\x9f\x98\x80 "};
+   const size_t len = 64 * 1024;
+   char *str;
+   size_t i;
+   int n;
+   int j;
+   int64_t start;
+   int64_t elapsed_us;
+
+   if (argc != 3 || (strcmp(argv[2], "ascii") != 0 && strcmp(argv[2], "mixed") != 0)) {
+      fprintf(stderr,
+              "usage: bson-utf8-speed NUM_ITERATIONS [ascii|mixed]\n"
+              "\n"
+              "  ascii = validate ASCII text\n"
+              "  mixed = validate ASCII mixed with multi-byte sequences\n"
+              "\n");
+      return EXIT_FAILURE;
+   }
+
+   n = atoi(argv[1]);
+   str = bson_malloc(len);
+
+   /* Fill the string with whole words, padded with spaces. */
+   i = 0;
+   for (j = 0;; j++) {
+      const char *word = strcmp(argv[2], "ascii") == 0 ? "plain " : mixed_words[j % 4];
+      const size_t word_len = strlen(word);
+
+      if (len - i < word_len) {
+         break;
+      }
+      memcpy(str + i, word, word_len);
+      i += word_len;
+   }
+   memset(str + i, ' ', len - i);
+
+   start = bson_get_monotonic_time();
+
+   for (j = 0; j < n; j++) {
+      if (!bson_utf8_validate(str, len, false)) {
+         fprintf(stderr, "invalid UTF-8\n");
+         bson_free(str);
+         return EXIT_FAILURE;
+      }
+   }
+
+   elapsed_us = bson_get_monotonic_time() - start;
+   printf("validated %d x %zu bytes in %.3f seconds", n, len, (double)elapsed_us / 1e6);
+   if (elapsed_us > 0) {
+      printf(", %.1f MB/s", (double)n * (double)len / (double)elapsed_us);
+   }
+   printf("\n");
+
+   bson_free(str);
+
+   return 0;
+}
@@ -0,0 +1,252 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <bson/bson-arena.h>
+#include <bson/macros.h>
+#include <bson/memory.h>
+
+#include <stdint.h>
+#include <string.h>
+
+
+/* Each allocation is preceded by its size, so that bson_arena_realloc() can
+ * copy it, and is aligned for any BSON value. */
+#define BSON_ARENA_ALIGN 8u
+#define BSON_ARENA_HEADER_SIZE 8u
+
+#define BSON_ARENA_MIN_BLOCK_SIZE 4096u
+#define BSON_ARENA_MAX_BLOCK_SIZE (1u << 20)
+
+
+typedef struct _bson_arena_block_t {
+   struct _bson_arena_block_t *next;
+} bson_arena_block_t;
+
+typedef struct {
+   uint8_t *pos;                /* the next free byte */
+   uint8_t *end;                /* the end of the current block */
+   uint8_t *last;               /* the most recent allocation */
+   bson_arena_block_t *blocks;  /* allocated blocks, the most recent first */
+   size_t next_block_size;
+} bson_arena_impl_t;
+
+BSON_STATIC_ASSERT2(arena_impl_t, sizeof(bson_arena_impl_t) <= sizeof(bson_arena_t));
+BSON_STATIC_ASSERT2(arena_header, sizeof(size_t) <= BSON_ARENA_HEADER_SIZE);
+
+
+static BSON_INLINE size_t
+_bson_arena_align_size(size_t size)
+{
+   return (size + (BSON_ARENA_ALIGN - 1u)) & ~(size_t)(BSON_ARENA_ALIGN - 1u);
+}
+
+
+static BSON_INLINE uint8_t *
+_bson_arena_align_ptr(uint8_t *ptr)
+{
+   return (uint8_t *)(((uintptr_t)ptr + (BSON_ARENA_ALIGN - 1u)) & ~(uintptr_t)(BSON_ARENA_ALIGN - 1u));
+}
+
+
+static BSON_INLINE size_t
+_bson_arena_size(const void *mem)
+{
+   size_t size;
+
+   memcpy(&size, (const uint8_t *)mem - BSON_ARENA_HEADER_SIZE, sizeof size);
+   return size;
+}
+
+
+static void *
+_bson_arena_alloc(bson_arena_impl_t *impl, size_t num_bytes)
+{
+   size_t needed;
+   uint8_t *mem;
+
+   BSON_ASSERT(num_bytes <= SIZE_MAX / 2u);
+   needed = BSON_ARENA_HEADER_SIZE + _bson_arena_align_size(num_bytes);
+
+   if (!impl->pos || (size_t)(impl->end - impl->pos) < needed) {
+      /* the rest of the current block is left unused */
+      size_t block_size = impl->next_block_size;
+      bson_arena_block_t *block;
+
+      if (block_size < sizeof *block + BSON_ARENA_ALIGN + needed) {
+         block_size = sizeof *block + BSON_ARENA_ALIGN + needed;
+      }
+
+      block = bson_malloc(block_size);
+      block->next = impl->blocks;
+      impl->blocks = block;
+      impl->pos = _bson_arena_align_ptr((uint8_t *)(block + 1));
+      impl->end = (uint8_t *)block + block_size;
+
+      if (impl->next_block_size < BSON_ARENA_MAX_BLOCK_SIZE) {
+         impl->next_block_size *= 2u;
+      }
+   }
+
+   mem = impl->pos + BSON_ARENA_HEADER_SIZE;
+   memcpy(impl->pos, &num_bytes, sizeof num_bytes);
+   impl->pos += needed;
+   impl->last = mem;
+
+   return mem;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_arena_init --
+ *
+ *       Initialize @arena, drawing memory from the @buffer_len bytes of
+ *       @buffer first. @buffer may be NULL, and must outlive @arena.
+ *
+ * Returns:
+ *       None.
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+bson_arena_init(bson_arena_t *arena, /* IN */
+                void *buffer,        /* IN */
+                size_t buffer_len)   /* IN */
+{
+   bson_arena_impl_t *const impl = (bson_arena_impl_t *)arena;
+
+   BSON_ASSERT_PARAM(arena);
+   BSON_ASSERT(buffer || buffer_len == 0);
+
+   impl->pos = NULL;
+   impl->end = NULL;
+   impl->last = NULL;
+   impl->blocks = NULL;
+   impl->next_block_size = BSON_ARENA_MIN_BLOCK_SIZE;
+
+   if (buffer) {
+      impl->pos = _bson_arena_align_ptr(buffer);
+      impl->end = (uint8_t *)buffer + buffer_len;
+
+      if (impl->pos > impl->end) {
+         impl->pos = impl->end;
+      }
+   }
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_arena_destroy --
+ *
+ *       Release all memory allocated from @arena. Documents and buffers
+ *       allocated from @arena must not be used afterwards.
+ *
+ * Returns:
+ *       None.
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+bson_arena_destroy(bson_arena_t *arena) /* IN */
+{
+   bson_arena_impl_t *impl = (bson_arena_impl_t *)arena;
+
+   if (!arena) {
+      return;
+   }
+
+   while (impl->blocks) {
+      bson_arena_block_t *const next = impl->blocks->next;
+
+      bson_free(impl->blocks);
+      impl->blocks = next;
+   }
+
+   impl->pos = NULL;
+   impl->end = NULL;
+   impl->last = NULL;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_arena_realloc --
+ *
+ *       A bson_realloc_func allocating from the bson_arena_t @arena, for
+ *       bson_writer_new() or bson_new_from_buffer(). @mem is NULL or was
+ *       returned by bson_arena_realloc() with the same @arena.
+ *
+ *       The most recent allocation grows in place if the current block has
+ *       room, any other is copied. Memory is not freed until @arena is
+ *       destroyed.
+ *
+ * Returns:
+ *       The reallocated memory, or NULL if @num_bytes is 0.
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void *
+bson_arena_realloc(void *mem,        /* IN */
+                   size_t num_bytes, /* IN */
+                   void *arena)      /* IN */
+{
+   bson_arena_impl_t *const impl = arena;
+   size_t size;
+   void *copy;
+
+   BSON_ASSERT_PARAM(arena);
+
+   if (num_bytes == 0) {
+      return NULL;
+   }
+
+   if (!mem) {
+      return _bson_arena_alloc(impl, num_bytes);
+   }
+
+   size = _bson_arena_size(mem);
+
+   if (num_bytes <= size) {
+      return mem;
+   }
+
+   if (mem == impl->last && (size_t)(impl->end - (uint8_t *)mem) >= _bson_arena_align_size(num_bytes)) {
+      memcpy((uint8_t *)mem - BSON_ARENA_HEADER_SIZE, &num_bytes, sizeof num_bytes);
+      impl->pos = (uint8_t *)mem + _bson_arena_align_size(num_bytes);
+      return mem;
+   }
+
+   copy = _bson_arena_alloc(impl, num_bytes);
+   memcpy(copy, mem, size);
+
+   return copy;
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <bson/bson-prelude.h>
+
+
+#ifndef BSON_ARENA_H
+#define BSON_ARENA_H
+
+
+#include <bson/macros.h>
+
+#include <stddef.h>
+
+
+BSON_BEGIN_DECLS
+
+
+/**
+ * bson_arena_t:
+ *
+ * A bump allocator for short-lived documents. Memory is drawn from a buffer
+ * provided by the caller, then from blocks allocated as needed, and is all
+ * released at once by bson_arena_destroy(). The growth of the most recent
+ * allocation is done in place.
+ *
+ * Documents initialized with bson_init_arena(), or writers created with
+ * bson_arena_realloc() as their realloc function, allocate from the arena.
+ * An arena is not thread safe.
+ */
+BSON_ALIGNED_BEGIN(BSON_ALIGN_OF_PTR) typedef struct _bson_arena_t {
+   void *padding[6]; /* Padding for stack allocation. */
+} bson_arena_t BSON_ALIGNED_END(BSON_ALIGN_OF_PTR);
+
+
+BSON_EXPORT(void)
+bson_arena_init(bson_arena_t *arena, void *buffer, size_t buffer_len);
+
+BSON_EXPORT(void)
+bson_arena_destroy(bson_arena_t *arena);
+
+BSON_EXPORT(void *)
+bson_arena_realloc(void *mem, size_t num_bytes, void *arena);
+
+
+BSON_END_DECLS
+
+
+#endif /* BSON_ARENA_H */
@@ -0,0 +1,546 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <bson/bson-index.h>
+#include <bson/bson.h>
+#include <bson/memory.h>
+
+#include <string.h>
+
+
+/*
+ * The index has one table per document: the indexed document, then each
+ * embedded document or array in breadth-first order. A table owns a range of
+ * entries, one per element in document order, and an open-addressed hash
+ * table of slots over them. The keys are copied, so that a document with the
+ * same keys in the same order can reuse the index without hashing again.
+ */
+
+typedef struct {
+   uint32_t key;     /* offset of the key in keys */
+   uint32_t key_len;
+   uint32_t hash;
+   uint32_t offset;  /* of the element in its document */
+   uint32_t child;   /* the table of an embedded document or array, or 0 */
+   bson_type_t type;
+} bson_index_entry_t;
+
+typedef struct {
+   uint32_t offset;  /* of the document in the indexed document */
+   uint32_t length;
+   uint32_t entries; /* the first entry */
+   uint32_t n_entries;
+   uint32_t slots;   /* the first slot */
+   uint32_t mask;    /* the number of slots minus one */
+} bson_index_table_t;
+
+struct _bson_index_t {
+   const uint8_t *data;
+   uint32_t length;
+
+   bson_index_table_t *tables;
+   size_t n_tables;
+   size_t tables_alloc;
+
+   bson_index_entry_t *entries;
+   size_t n_entries;
+   size_t entries_alloc;
+
+   uint32_t *slots; /* an entry number plus one, or 0 if the slot is empty */
+   size_t n_slots;
+   size_t slots_alloc;
+
+   char *keys;
+   size_t keys_len;
+   size_t keys_alloc;
+};
+
+
+static void
+_bson_index_reserve(void **ptr, size_t *alloc, size_t needed, size_t size)
+{
+   if (needed > *alloc) {
+      size_t n = *alloc ? *alloc : 16u;
+
+      while (n < needed) {
+         n *= 2u;
+      }
+
+      *ptr = bson_realloc(*ptr, n * size);
+      *alloc = n;
+   }
+}
+
+
+/* FNV-1a */
+static BSON_INLINE uint32_t
+_bson_index_hash(const char *key, uint32_t key_len)
+{
+   uint32_t hash = 2166136261u;
+
+   for (uint32_t i = 0; i < key_len; i++) {
+      hash ^= (uint8_t)key[i];
+      hash *= 16777619u;
+   }
+
+   return hash;
+}
+
+
+/* The bytes of the embedded document or array observed by @iter. */
+static void
+_bson_index_iter_child(const bson_iter_t *iter, const uint8_t **data, uint32_t *length)
+{
+   if (BSON_ITER_HOLDS_ARRAY(iter)) {
+      bson_iter_array(iter, length, data);
+   } else {
+      bson_iter_document(iter, length, data);
+   }
+}
+
+
+static uint32_t
+_bson_index_add_table(bson_index_t *index, const uint8_t *data, uint32_t length)
+{
+   bson_index_table_t *table;
+
+   _bson_index_reserve((void **)&index->tables, &index->tables_alloc, index->n_tables + 1u, sizeof *index->tables);
+
+   table = &index->tables[index->n_tables];
+   table->offset = (uint32_t)(data - index->data);
+   table->length = length;
+   table->entries = 0;
+   table->n_entries = 0;
+   table->slots = 0;
+   table->mask = 0;
+
+   return (uint32_t)index->n_tables++;
+}
+
+
+static void
+_bson_index_fill_slots(bson_index_t *index, bson_index_table_t *table)
+{
+   uint32_t n_slots = 2u;
+
+   while (n_slots < table->n_entries * 2u) {
+      n_slots *= 2u;
+   }
+
+   _bson_index_reserve((void **)&index->slots, &index->slots_alloc, index->n_slots + n_slots, sizeof *index->slots);
+   memset(index->slots + index->n_slots, 0, n_slots * sizeof *index->slots);
+
+   table->slots = (uint32_t)index->n_slots;
+   table->mask = n_slots - 1u;
+   index->n_slots += n_slots;
+
+   for (uint32_t i = table->entries; i < table->entries + table->n_entries; i++) {
+      const bson_index_entry_t *entry = &index->entries[i];
+      uint32_t *const slots = index->slots + table->slots;
+      uint32_t s = entry->hash & table->mask;
+
+      for (; slots[s]; s = (s + 1u) & table->mask) {
+         const bson_index_entry_t *other = &index->entries[slots[s] - 1u];
+
+         /* like bson_iter_find(), a repeated key finds the first element */
+         if (other->hash == entry->hash && other->key_len == entry->key_len &&
+             memcmp(index->keys + other->key, index->keys + entry->key, entry->key_len) == 0) {
+            break;
+         }
+      }
+
+      if (!slots[s]) {
+         slots[s] = i + 1u;
+      }
+   }
+}
+
+
+/* Index the elements of a table, adding a table for each embedded document
+ * or array to be indexed later. */
+static bool
+_bson_index_build_table(bson_index_t *index, uint32_t t)
+{
+   bson_iter_t iter;
+
+   if (!bson_iter_init_from_data(&iter, index->data + index->tables[t].offset, index->tables[t].length)) {
+      return false;
+   }
+
+   index->tables[t].entries = (uint32_t)index->n_entries;
+
+   while (bson_iter_next(&iter)) {
+      const uint32_t key_len = bson_iter_key_len(&iter);
+      bson_index_entry_t *entry;
+
+      _bson_index_reserve(
+         (void **)&index->entries, &index->entries_alloc, index->n_entries + 1u, sizeof *index->entries);
+      _bson_index_reserve((void **)&index->keys, &index->keys_alloc, index->keys_len + key_len + 1u, 1u);
+
+      entry = &index->entries[index->n_entries++];
+      entry->key = (uint32_t)index->keys_len;
+      entry->key_len = key_len;
+      entry->offset = iter.off;
+      entry->type = bson_iter_type(&iter);
+      entry->child = 0;
+
+      memcpy(index->keys + index->keys_len, bson_iter_key(&iter), key_len + 1u);
+      index->keys_len += key_len + 1u;
+      entry->hash = _bson_index_hash(index->keys + entry->key, key_len);
+
+      if (entry->type == BSON_TYPE_DOCUMENT || entry->type == BSON_TYPE_ARRAY) {
+         const uint8_t *data;
+         uint32_t length;
+
+         _bson_index_iter_child(&iter, &data, &length);
+         entry->child = _bson_index_add_table(index, data, length);
+      }
+   }
+
+   if (iter.err_off) {
+      return false;
+   }
+
+   index->tables[t].n_entries = (uint32_t)index->n_entries - index->tables[t].entries;
+   _bson_index_fill_slots(index, &index->tables[t]);
+
+   return true;
+}
+
+
+static bool
+_bson_index_build(bson_index_t *index, const bson_t *bson)
+{
+   index->data = bson_get_data(bson);
+   index->length = bson->len;
+   index->n_tables = 0;
+   index->n_entries = 0;
+   index->n_slots = 0;
+   index->keys_len = 0;
+
+   _bson_index_add_table(index, index->data, index->length);
+
+   for (uint32_t t = 0; t < index->n_tables; t++) {
+      if (!_bson_index_build_table(index, t)) {
+         /* not rebound by bson_index_reinit() */
+         index->n_tables = 0;
+         return false;
+      }
+   }
+
+   return true;
+}
+
+
+/* Rebind the index to a document with the same keys in the same order, and
+ * the same embedded documents and arrays. Returns false if the layout differs,
+ * which may leave the index half updated. */
+static bool
+_bson_index_rebind(bson_index_t *index, const bson_t *bson)
+{
+   index->data = bson_get_data(bson);
+   index->length = bson->len;
+   index->tables[0].length = index->length;
+
+   for (size_t t = 0; t < index->n_tables; t++) {
+      const bson_index_table_t *table = &index->tables[t];
+      const bson_index_entry_t *end = index->entries + table->entries + table->n_entries;
+      bson_index_entry_t *entry = index->entries + table->entries;
+      bson_iter_t iter;
+
+      if (!bson_iter_init_from_data(&iter, index->data + table->offset, table->length)) {
+         return false;
+      }
+
+      while (bson_iter_next(&iter)) {
+         const bson_type_t type = bson_iter_type(&iter);
+         const bool is_parent = type == BSON_TYPE_DOCUMENT || type == BSON_TYPE_ARRAY;
+
+         if (entry == end || entry->key_len != bson_iter_key_len(&iter) ||
+             memcmp(index->keys + entry->key, bson_iter_key(&iter), entry->key_len) != 0 ||
+             is_parent != (entry->child != 0)) {
+            return false;
+         }
+
+         entry->offset = iter.off;
+         entry->type = type;
+
+         if (is_parent) {
+            const uint8_t *data;
+            uint32_t length;
+
+            _bson_index_iter_child(&iter, &data, &length);
+            index->tables[entry->child].offset = (uint32_t)(data - index->data);
+            index->tables[entry->child].length = length;
+         }
+
+         entry++;
+      }
+
+      if (iter.err_off || entry != end) {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+
+static const bson_index_entry_t *
+_bson_index_lookup(const bson_index_t *index, const bson_index_table_t *table, const char *key, uint32_t key_len)
+{
+   const uint32_t hash = _bson_index_hash(key, key_len);
+   const uint32_t *const slots = index->slots + table->slots;
+
+   for (uint32_t s = hash & table->mask; slots[s]; s = (s + 1u) & table->mask) {
+      const bson_index_entry_t *entry = &index->entries[slots[s] - 1u];
+
+      if (entry->hash == hash && entry->key_len == key_len && memcmp(index->keys + entry->key, key, key_len) == 0) {
+         return entry;
+      }
+   }
+
+   return NULL;
+}
+
+
+static bool
+_bson_index_iter_init(const bson_index_t *index,
+                      const bson_index_table_t *table,
+                      const bson_index_entry_t *entry,
+                      bson_iter_t *iter)
+{
+   return bson_iter_init_from_data_at_offset(
+      iter, index->data + table->offset, table->length, entry->offset, entry->key_len);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_index_new --
+ *
+ *       Index the keys of @bson and of its embedded documents and arrays,
+ *       in a single pass over @bson. @bson must not be modified or freed
+ *       while the index is used.
+ *
+ * Returns:
+ *       A newly allocated bson_index_t that should be freed with
+ *       bson_index_destroy(), or NULL if @bson is corrupt.
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bson_index_t *
+bson_index_new(const bson_t *bson) /* IN */
+{
+   bson_index_t *index;
+
+   BSON_ASSERT_PARAM(bson);
+
+   index = bson_malloc0(sizeof *index);
+
+   if (!_bson_index_build(index, bson)) {
+      bson_index_destroy(index);
+      return NULL;
+   }
+
+   return index;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_index_reinit --
+ *
+ *       Index @bson instead of the document indexed by @index, reusing the
+ *       memory of @index. If @bson has the same keys in the same order as
+ *       the previous document, including those of embedded documents and
+ *       arrays, only the offsets of the elements are updated.
+ *
+ * Returns:
+ *       true if successful, false if @bson is corrupt. @index must not be
+ *       used after a failure, other than to destroy it or reinit it.
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+bson_index_reinit(bson_index_t *index, /* IN */
+                  const bson_t *bson)  /* IN */
+{
+   BSON_ASSERT_PARAM(index);
+   BSON_ASSERT_PARAM(bson);
+
+   if (index->n_tables > 0 && _bson_index_rebind(index, bson)) {
+      return true;
+   }
+
+   return _bson_index_build(index, bson);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_index_destroy --
+ *
+ *       Free an index created with bson_index_new().
+ *
+ * Returns:
+ *       None.
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+bson_index_destroy(bson_index_t *index) /* IN */
+{
+   if (!index) {
+      return;
+   }
+
+   bson_free(index->tables);
+   bson_free(index->entries);
+   bson_free(index->slots);
+   bson_free(index->keys);
+   bson_free(index);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_index_find --
+ *
+ *       Initialize @iter on the first field of the indexed document whose
+ *       key is @key, like bson_iter_init_find().
+ *
+ * Returns:
+ *       true if the field was found and @iter is observing that field.
+ *
+ * Side effects:
+ *       @iter is initialized.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+bson_index_find(const bson_index_t *index, /* IN */
+                const char *key,           /* IN */
+                bson_iter_t *iter)         /* OUT */
+{
+   return bson_index_find_w_len(index, key, -1, iter);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_index_find_w_len --
+ *
+ *       Like bson_index_find(). @keylen indicates the length of @key, or
+ *       -1 to determine the length with strlen().
+ *
+ * Returns:
+ *       true if the field was found and @iter is observing that field.
+ *
+ * Side effects:
+ *       @iter is initialized.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+bson_index_find_w_len(const bson_index_t *index, /* IN */
+                      const char *key,           /* IN */
+                      int keylen,                /* IN */
+                      bson_iter_t *iter)         /* OUT */
+{
+   const bson_index_entry_t *entry;
+
+   BSON_ASSERT_PARAM(index);
+   BSON_ASSERT_PARAM(key);
+   BSON_ASSERT_PARAM(iter);
+
+   if (keylen < 0) {
+      keylen = (int)strlen(key);
+   }
+
+   entry = _bson_index_lookup(index, &index->tables[0], key, (uint32_t)keylen);
+
+   return entry && _bson_index_iter_init(index, &index->tables[0], entry, iter);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_index_find_descendant --
+ *
+ *       Initialize @descendant on a field of the indexed document using the
+ *       "parent.child.key" notation, like bson_iter_find_descendant(). Each
+ *       part of @dotkey is found with one lookup.
+ *
+ * Returns:
+ *       true if the descendant was found and @descendant was initialized.
+ *
+ * Side effects:
+ *       @descendant may be initialized.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+bson_index_find_descendant(const bson_index_t *index, /* IN */
+                           const char *dotkey,        /* IN */
+                           bson_iter_t *descendant)   /* OUT */
+{
+   const bson_index_table_t *table;
+   const bson_index_entry_t *entry;
+   const char *dot;
+
+   BSON_ASSERT_PARAM(index);
+   BSON_ASSERT_PARAM(dotkey);
+   BSON_ASSERT_PARAM(descendant);
+
+   table = &index->tables[0];
+
+   while ((dot = strchr(dotkey, '.'))) {
+      entry = _bson_index_lookup(index, table, dotkey, (uint32_t)(dot - dotkey));
+
+      if (!entry || !entry->child) {
+         return false;
+      }
+
+      table = &index->tables[entry->child];
+      dotkey = dot + 1;
+   }
+
+   entry = _bson_index_lookup(index, table, dotkey, (uint32_t)strlen(dotkey));
+
+   return entry && _bson_index_iter_init(index, table, entry, descendant);
+}
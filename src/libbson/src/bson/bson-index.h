@@ -0,0 +1,63 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <bson/bson-prelude.h>
+
+
+#ifndef BSON_INDEX_H
+#define BSON_INDEX_H
+
+
+#include <bson/bson-iter.h>
+#include <bson/bson-types.h>
+#include <bson/macros.h>
+
+
+BSON_BEGIN_DECLS
+
+
+/*
+ * A read-only index of the keys of a document and of its embedded documents
+ * and arrays, to position a bson_iter_t on a field without scanning the keys
+ * before it. The indexed document must not be modified or freed while the
+ * index is used.
+ */
+typedef struct _bson_index_t bson_index_t;
+
+
+BSON_EXPORT(bson_index_t *)
+bson_index_new(const bson_t *bson);
+
+BSON_EXPORT(bool)
+bson_index_reinit(bson_index_t *index, const bson_t *bson);
+
+BSON_EXPORT(void)
+bson_index_destroy(bson_index_t *index);
+
+BSON_EXPORT(bool)
+bson_index_find(const bson_index_t *index, const char *key, bson_iter_t *iter);
+
+BSON_EXPORT(bool)
+bson_index_find_w_len(const bson_index_t *index, const char *key, int keylen, bson_iter_t *iter);
+
+BSON_EXPORT(bool)
+bson_index_find_descendant(const bson_index_t *index, const char *dotkey, bson_iter_t *descendant);
+
+
+BSON_END_DECLS
+
+
+#endif /* BSON_INDEX_H */
@@ -27,5 +27,12 @@ struct _bson_json_opts_t {
    bool is_outermost_array;
 };
 
+/* Reads the JSON object @data into the empty document @bson in one pass.
+ * Returns false, leaving @bson with unspecified contents, if @data is not a
+ * plain JSON object: keys beginning with "$", invalid JSON and other uncommon
+ * input must be read with bson_json_reader_t. */
+bool
+_bson_json_parse_fast(const uint8_t *data, size_t len, bson_t *bson);
+
 
 #endif /* BSON_JSON_PRIVATE_H */
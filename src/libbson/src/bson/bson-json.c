@@ -20,7 +20,10 @@
 #include <bson/bson-error-private.h>
 #include <bson/bson-iso8601-private.h>
 #include <bson/bson-json-private.h>
+#include <bson/bson-mapped-file-private.h>
+#include <common-atomic-private.h>
 #include <common-b64-private.h>
+#include <common-thread-private.h>
 
 #include <bson/bson.h>
 #include <bson/config.h>
@@ -34,6 +37,7 @@
 #include <sys/types.h>
 
 #include <errno.h>
+#include <float.h>
 #include <math.h>
 
 #ifdef _WIN32
@@ -2243,12 +2247,622 @@ bson_json_data_reader_ingest(bson_json_reader_t *reader, /* IN */
 }
 
 
+/*
+ * A single-pass reader for the common case: a plain JSON object already in
+ * memory. It writes BSON directly into the output document and gives up on
+ * anything the jsonsl-based reader treats specially (keys beginning with "$",
+ * "\u0000" escapes, deep nesting, out of range numbers, invalid JSON), so that
+ * reader stays the authority on Extended JSON and on error messages.
+ */
+
+typedef struct {
+   uint32_t start; /* offset of the document's length prefix */
+   uint32_t index; /* number of elements so far, for array keys */
+   bool is_array;
+} bson_json_fast_frame_t;
+
+typedef struct {
+   bson_t *bson;
+   uint8_t *out;
+   size_t out_len;
+   size_t out_cap;
+   const uint8_t *p;
+   const uint8_t *end;
+} bson_json_fast_t;
+
+
+static bool
+_bson_json_fast_grow(bson_json_fast_t *fast, size_t n)
+{
+   size_t cap;
+
+   if (n > BSON_MAX_SIZE - fast->out_len) {
+      return false;
+   }
+
+   cap = BSON_MIN(BSON_MAX(fast->out_cap * 2u, fast->out_len + n), BSON_MAX_SIZE);
+
+   /* bson_reserve_buffer keeps the bytes written so far */
+   fast->out = bson_reserve_buffer(fast->bson, (uint32_t)cap);
+   fast->out_cap = cap;
+
+   return fast->out != NULL;
+}
+
+
+static BSON_INLINE bool
+_bson_json_fast_reserve(bson_json_fast_t *fast, size_t n)
+{
+   return BSON_LIKELY(fast->out_cap - fast->out_len >= n) || _bson_json_fast_grow(fast, n);
+}
+
+
+static BSON_INLINE void
+_bson_json_fast_skip_ws(bson_json_fast_t *fast)
+{
+   while (fast->p < fast->end && (*fast->p == ' ' || *fast->p == '\n' || *fast->p == '\r' || *fast->p == '\t')) {
+      fast->p++;
+   }
+}
+
+
+static BSON_INLINE void
+_bson_json_fast_patch_length(bson_json_fast_t *fast, size_t offset, size_t len)
+{
+   const uint32_t len_le = BSON_UINT32_TO_LE((uint32_t)len);
+
+   memcpy(fast->out + offset, &len_le, sizeof len_le);
+}
+
+
+/* True if any byte of @w is below 0x20, a quote or a backslash. */
+static BSON_INLINE bool
+_bson_json_fast_word_has_special(uint64_t w)
+{
+   const uint64_t ones = UINT64_C(0x0101010101010101);
+   const uint64_t highs = UINT64_C(0x8080808080808080);
+   const uint64_t quote = w ^ (ones * '"');
+   const uint64_t backslash = w ^ (ones * '\\');
+
+   return (((w - ones * 0x20) & ~w) | ((quote - ones) & ~quote) | ((backslash - ones) & ~backslash)) & highs;
+}
+
+
+static BSON_INLINE int32_t
+_bson_json_fast_hex4(const uint8_t *p)
+{
+   int32_t value = 0;
+
+   for (int i = 0; i < 4; i++) {
+      const uint8_t c = p[i];
+
+      value <<= 4;
+      if (c >= '0' && c <= '9') {
+         value |= c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+         value |= c - 'a' + 10;
+      } else if (c >= 'A' && c <= 'F') {
+         value |= c - 'A' + 10;
+      } else {
+         return -1;
+      }
+   }
+
+   return value;
+}
+
+
+/* Unescape the string starting after the opening quote into the output, and
+ * move past the closing quote. Does not write a terminating NUL. */
+static bool
+_bson_json_fast_read_string(bson_json_fast_t *fast)
+{
+   const uint8_t *p = fast->p;
+   const uint8_t *const end = fast->end;
+   const size_t start = fast->out_len;
+   uint64_t seen = 0; /* OR of all raw bytes, to skip validation of ASCII */
+
+   for (;;) {
+      const uint8_t *const run = p;
+      size_t run_len;
+
+      while (end - p >= 8) {
+         uint64_t w;
+
+         memcpy(&w, p, sizeof w);
+         if (_bson_json_fast_word_has_special(w)) {
+            break;
+         }
+         seen |= w;
+         p += 8;
+      }
+
+      while (p < end && *p >= 0x20 && *p != '"' && *p != '\\') {
+         seen |= *p;
+         p++;
+      }
+
+      run_len = (size_t)(p - run);
+      if (!_bson_json_fast_reserve(fast, run_len + 4u)) {
+         return false;
+      }
+      memcpy(fast->out + fast->out_len, run, run_len);
+      fast->out_len += run_len;
+
+      if (p == end || *p < 0x20) {
+         return false;
+      }
+
+      if (*p == '"') {
+         break;
+      }
+
+      /* a backslash escape */
+      if (end - p < 2) {
+         return false;
+      }
+
+      switch (p[1]) {
+      case '"':
+      case '\\':
+      case '/':
+         fast->out[fast->out_len++] = p[1];
+         break;
+      case 'b':
+         fast->out[fast->out_len++] = '\b';
+         break;
+      case 'f':
+         fast->out[fast->out_len++] = '\f';
+         break;
+      case 'n':
+         fast->out[fast->out_len++] = '\n';
+         break;
+      case 'r':
+         fast->out[fast->out_len++] = '\r';
+         break;
+      case 't':
+         fast->out[fast->out_len++] = '\t';
+         break;
+      case 'u': {
+         int32_t cp;
+
+         if (end - p < 6 || (cp = _bson_json_fast_hex4(p + 2)) <= 0) {
+            return false;
+         }
+
+         if (cp >= 0xD800 && cp <= 0xDFFF) {
+            int32_t low;
+
+            /* a high surrogate followed by a low surrogate */
+            if (cp >= 0xDC00 || end - p < 12 || p[6] != '\\' || p[7] != 'u' ||
+                (low = _bson_json_fast_hex4(p + 8)) < 0xDC00 || low > 0xDFFF) {
+               return false;
+            }
+
+            cp = 0x10000 + ((cp & 0x3FF) << 10) + (low & 0x3FF);
+            p += 6;
+         }
+
+         if (cp < 0x80) {
+            fast->out[fast->out_len++] = (uint8_t)cp;
+         } else if (cp < 0x800) {
+            fast->out[fast->out_len++] = (uint8_t)(0xC0 | (cp >> 6));
+            fast->out[fast->out_len++] = (uint8_t)(0x80 | (cp & 0x3F));
+         } else if (cp < 0x10000) {
+            fast->out[fast->out_len++] = (uint8_t)(0xE0 | (cp >> 12));
+            fast->out[fast->out_len++] = (uint8_t)(0x80 | ((cp >> 6) & 0x3F));
+            fast->out[fast->out_len++] = (uint8_t)(0x80 | (cp & 0x3F));
+         } else {
+            fast->out[fast->out_len++] = (uint8_t)(0xF0 | (cp >> 18));
+            fast->out[fast->out_len++] = (uint8_t)(0x80 | ((cp >> 12) & 0x3F));
+            fast->out[fast->out_len++] = (uint8_t)(0x80 | ((cp >> 6) & 0x3F));
+            fast->out[fast->out_len++] = (uint8_t)(0x80 | (cp & 0x3F));
+         }
+
+         p += 4;
+         break;
+      }
+      default:
+         return false;
+      }
+
+      p += 2;
+   }
+
+   /* escapes only produce valid UTF-8, raw bytes must be checked */
+   if ((seen & UINT64_C(0x8080808080808080)) &&
+       !bson_utf8_validate((const char *)fast->out + start, fast->out_len - start, false)) {
+      return false;
+   }
+
+   fast->p = p + 1;
+
+   return true;
+}
+
+
+/* Read a number, append its value and return its type, or 0 to give up. */
+static bson_type_t
+_bson_json_fast_read_number(bson_json_fast_t *fast)
+{
+   static const double powers_of_ten[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                          1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+   const uint8_t *const start = fast->p;
+   const uint8_t *const end = fast->end;
+   const uint8_t *p = start;
+   bool negative = false;
+   uint64_t mantissa = 0;
+   int32_t n_digits = 0;
+   int32_t n_fraction_digits = 0;
+   int32_t exponent = 0;
+   bool is_double = false;
+
+   /* the grammar of RFC 8259, anything else is left to jsonsl */
+   if (*p == '-') {
+      negative = true;
+      p++;
+   }
+
+   if (p == end || *p < '0' || *p > '9') {
+      return (bson_type_t)0;
+   }
+
+   if (*p == '0') {
+      p++;
+   } else {
+      for (; p < end && *p >= '0' && *p <= '9'; p++, n_digits++) {
+         mantissa = mantissa * 10u + (uint64_t)(*p - '0');
+         if (n_digits == 19) {
+            return (bson_type_t)0;
+         }
+      }
+   }
+
+   if (p < end && *p == '.') {
+      is_double = true;
+      p++;
+      if (p == end || *p < '0' || *p > '9') {
+         return (bson_type_t)0;
+      }
+      for (; p < end && *p >= '0' && *p <= '9'; p++, n_digits++, n_fraction_digits++) {
+         mantissa = mantissa * 10u + (uint64_t)(*p - '0');
+         if (n_digits == 19) {
+            return (bson_type_t)0;
+         }
+      }
+   }
+
+   if (p < end && (*p == 'e' || *p == 'E')) {
+      bool negative_exponent = false;
+
+      is_double = true;
+      p++;
+      if (p < end && (*p == '+' || *p == '-')) {
+         negative_exponent = *p == '-';
+         p++;
+      }
+      if (p == end || *p < '0' || *p > '9') {
+         return (bson_type_t)0;
+      }
+      for (; p < end && *p >= '0' && *p <= '9'; p++) {
+         if (exponent < 100000) {
+            exponent = exponent * 10 + (*p - '0');
+         }
+      }
+      if (negative_exponent) {
+         exponent = -exponent;
+      }
+   }
+
+   fast->p = p;
+
+   if (!is_double) {
+      uint32_t v32;
+      uint64_t v64;
+
+      /* the same types as _bson_json_read_integer */
+      if (mantissa <= INT32_MAX || (negative && mantissa <= (uint64_t)INT32_MAX + 1)) {
+         if (!_bson_json_fast_reserve(fast, sizeof v32)) {
+            return (bson_type_t)0;
+         }
+         v32 = BSON_UINT32_TO_LE((uint32_t)(negative ? 0u - mantissa : mantissa));
+         memcpy(fast->out + fast->out_len, &v32, sizeof v32);
+         fast->out_len += sizeof v32;
+         return BSON_TYPE_INT32;
+      }
+
+      if (mantissa > (uint64_t)INT64_MAX + (negative ? 1u : 0u) || !_bson_json_fast_reserve(fast, sizeof v64)) {
+         return (bson_type_t)0;
+      }
+      v64 = BSON_UINT64_TO_LE(negative ? 0u - mantissa : mantissa);
+      memcpy(fast->out + fast->out_len, &v64, sizeof v64);
+      fast->out_len += sizeof v64;
+      return BSON_TYPE_INT64;
+   } else {
+      double d;
+
+      exponent -= n_fraction_digits;
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+      if (mantissa <= (UINT64_C(1) << 53) && exponent >= -22 && exponent <= 22) {
+         /* both operands are exact, so one correctly rounded operation gives
+          * the same result as strtod (Clinger's fast path) */
+         d = (double)mantissa;
+         d = exponent < 0 ? d / powers_of_ten[-exponent] : d * powers_of_ten[exponent];
+         if (negative) {
+            d = -d;
+         }
+      } else
+#endif
+      {
+         char text[64];
+         const size_t len = (size_t)(p - start);
+
+         if (len >= sizeof text) {
+            return (bson_type_t)0;
+         }
+
+         memcpy(text, start, len);
+         text[len] = '\0';
+         errno = 0;
+         d = strtod(text, NULL);
+         if ((d == HUGE_VAL || d == -HUGE_VAL) && errno == ERANGE) {
+            return (bson_type_t)0;
+         }
+      }
+
+      BSON_UNUSED(powers_of_ten);
+
+      if (!_bson_json_fast_reserve(fast, sizeof d)) {
+         return (bson_type_t)0;
+      }
+      d = BSON_DOUBLE_TO_LE(d);
+      memcpy(fast->out + fast->out_len, &d, sizeof d);
+      fast->out_len += sizeof d;
+      return BSON_TYPE_DOUBLE;
+   }
+}
+
+
+bool
+_bson_json_parse_fast(const uint8_t *data, size_t len, bson_t *bson)
+{
+   bson_json_fast_frame_t stack[STACK_MAX];
+   bson_json_fast_frame_t *frame;
+   int32_t n = 0;
+   bson_json_fast_t fast;
+   size_t type_pos = 0;
+
+   BSON_ASSERT_PARAM(data);
+   BSON_ASSERT_PARAM(bson);
+
+   fast.bson = bson;
+   fast.out = NULL;
+   fast.out_len = 0;
+   fast.out_cap = 0;
+   fast.p = data;
+   fast.end = data + len;
+
+   _bson_json_fast_skip_ws(&fast);
+
+   if (fast.p == fast.end || *fast.p != '{') {
+      return false;
+   }
+
+   /* the output is usually no larger than the input */
+   if (!_bson_json_fast_reserve(&fast, BSON_MAX(BSON_MIN(len, BSON_MAX_SIZE), 16u))) {
+      return false;
+   }
+
+   /* the root document's length prefix */
+   fast.p++;
+   frame = &stack[0];
+   frame->start = 0;
+   frame->index = 0;
+   frame->is_array = false;
+   fast.out_len = 4;
+
+object_first:
+   _bson_json_fast_skip_ws(&fast);
+   if (fast.p < fast.end && *fast.p == '}') {
+      fast.p++;
+      goto close;
+   }
+
+key:
+   if (fast.p == fast.end || *fast.p != '"' || !_bson_json_fast_reserve(&fast, 1)) {
+      return false;
+   }
+
+   fast.p++;
+   type_pos = fast.out_len++;
+   if (!_bson_json_fast_read_string(&fast)) {
+      return false;
+   }
+
+   /* may be Extended JSON */
+   if (fast.out_len > type_pos + 1u && fast.out[type_pos + 1u] == '$') {
+      return false;
+   }
+
+   /* the reservation for the string left room for the NUL */
+   fast.out[fast.out_len++] = '\0';
+
+   _bson_json_fast_skip_ws(&fast);
+   if (fast.p == fast.end || *fast.p != ':') {
+      return false;
+   }
+   fast.p++;
+   goto value;
+
+array_first:
+   _bson_json_fast_skip_ws(&fast);
+   if (fast.p < fast.end && *fast.p == ']') {
+      fast.p++;
+      goto close;
+   }
+
+array_element: {
+   const char *key;
+   char buf[16];
+   size_t key_len;
+
+   if (!_bson_json_fast_reserve(&fast, 1u + sizeof buf)) {
+      return false;
+   }
+
+   type_pos = fast.out_len++;
+   key_len = bson_uint32_to_string(frame->index++, &key, buf, sizeof buf);
+   memcpy(fast.out + fast.out_len, key, key_len + 1u);
+   fast.out_len += key_len + 1u;
+}
+
+value:
+   _bson_json_fast_skip_ws(&fast);
+   if (fast.p == fast.end) {
+      return false;
+   }
+
+   switch (*fast.p) {
+   case '{':
+   case '[':
+      if (n + 1 == STACK_MAX || !_bson_json_fast_reserve(&fast, 4)) {
+         return false;
+      }
+      frame = &stack[++n];
+      frame->start = (uint32_t)fast.out_len;
+      frame->index = 0;
+      frame->is_array = *fast.p == '[';
+      fast.out[type_pos] = frame->is_array ? BSON_TYPE_ARRAY : BSON_TYPE_DOCUMENT;
+      fast.out_len += 4;
+      fast.p++;
+      if (frame->is_array) {
+         goto array_first;
+      }
+      goto object_first;
+   case '"': {
+      size_t len_pos;
+
+      if (!_bson_json_fast_reserve(&fast, 4)) {
+         return false;
+      }
+      fast.out[type_pos] = BSON_TYPE_UTF8;
+      len_pos = fast.out_len;
+      fast.out_len += 4;
+      fast.p++;
+      if (!_bson_json_fast_read_string(&fast)) {
+         return false;
+      }
+      fast.out[fast.out_len++] = '\0';
+      _bson_json_fast_patch_length(&fast, len_pos, fast.out_len - len_pos - 4u);
+      break;
+   }
+   case 't':
+   case 'f':
+      if (!_bson_json_fast_reserve(&fast, 1)) {
+         return false;
+      }
+      fast.out[type_pos] = BSON_TYPE_BOOL;
+      if (fast.end - fast.p >= 4 && memcmp(fast.p, "true", 4) == 0) {
+         fast.out[fast.out_len++] = 1;
+         fast.p += 4;
+      } else if (fast.end - fast.p >= 5 && memcmp(fast.p, "false", 5) == 0) {
+         fast.out[fast.out_len++] = 0;
+         fast.p += 5;
+      } else {
+         return false;
+      }
+      break;
+   case 'n':
+      if (fast.end - fast.p < 4 || memcmp(fast.p, "null", 4) != 0) {
+         return false;
+      }
+      fast.out[type_pos] = BSON_TYPE_NULL;
+      fast.p += 4;
+      break;
+   default: {
+      const bson_type_t type = _bson_json_fast_read_number(&fast);
+
+      if (!type) {
+         return false;
+      }
+      fast.out[type_pos] = (uint8_t)type;
+   }
+   }
+
+after_value:
+   _bson_json_fast_skip_ws(&fast);
+   if (fast.p == fast.end) {
+      return false;
+   }
+
+   if (*fast.p == ',') {
+      fast.p++;
+      if (frame->is_array) {
+         goto array_element;
+      }
+      _bson_json_fast_skip_ws(&fast);
+      goto key;
+   }
+
+   if (*fast.p != (frame->is_array ? ']' : '}')) {
+      return false;
+   }
+   fast.p++;
+
+close:
+   if (!_bson_json_fast_reserve(&fast, 1)) {
+      return false;
+   }
+   fast.out[fast.out_len++] = '\0';
+   _bson_json_fast_patch_length(&fast, frame->start, fast.out_len - frame->start);
+
+   if (n > 0) {
+      frame = &stack[--n];
+      goto after_value;
+   }
+
+   _bson_json_fast_skip_ws(&fast);
+   if (fast.p != fast.end) {
+      return false;
+   }
+
+   /* trim the reservation to the document's length */
+   return bson_reserve_buffer(bson, (uint32_t)fast.out_len) != NULL;
+}
+
+
+/* Reads the single JSON document @data into the empty document @bson, returns
+ * like bson_json_reader_read. */
+static int
+_bson_json_read_one(const uint8_t *data, size_t len, bson_t *bson, bson_error_t *error)
+{
+   bson_json_reader_t *reader;
+   int r;
+
+   if (_bson_json_parse_fast(data, len, bson)) {
+      // Like bson_json_reader_read, clear the error on success.
+      if (error) {
+         memset(error, 0, sizeof *error);
+      }
+      return 1;
+   }
+
+   bson_reinit(bson);
+   reader = bson_json_data_reader_new(false, BSON_JSON_DEFAULT_BUF_SIZE);
+   bson_json_data_reader_ingest(reader, data, len);
+   r = bson_json_reader_read(reader, bson, error);
+   bson_json_reader_destroy(reader);
+
+   return r;
+}
+
+
 bson_t *
 bson_new_from_json(const uint8_t *data, /* IN */
                    ssize_t len,         /* IN */
                    bson_error_t *error) /* OUT */
 {
-   bson_json_reader_t *reader;
    bson_t *bson;
    int r;
 
@@ -2259,10 +2873,7 @@ bson_new_from_json(const uint8_t *data, /* IN */
    }
 
    bson = bson_new();
-   reader = bson_json_data_reader_new(false, BSON_JSON_DEFAULT_BUF_SIZE);
-   bson_json_data_reader_ingest(reader, data, len);
-   r = bson_json_reader_read(reader, bson, error);
-   bson_json_reader_destroy(reader);
+   r = _bson_json_read_one(data, (size_t)len, bson, error);
 
    if (r == 0) {
       bson_set_error(error, BSON_ERROR_JSON, BSON_JSON_ERROR_READ_INVALID_PARAM, "Empty JSON string");
@@ -2283,7 +2894,6 @@ bson_init_from_json(bson_t *bson,        /* OUT */
                     ssize_t len,         /* IN */
                     bson_error_t *error) /* OUT */
 {
-   bson_json_reader_t *reader;
    int r;
 
    BSON_ASSERT(bson);
@@ -2294,11 +2904,7 @@ bson_init_from_json(bson_t *bson,        /* OUT */
    }
 
    bson_init(bson);
-
-   reader = bson_json_data_reader_new(false, BSON_JSON_DEFAULT_BUF_SIZE);
-   bson_json_data_reader_ingest(reader, (const uint8_t *)data, len);
-   r = bson_json_reader_read(reader, bson, error);
-   bson_json_reader_destroy(reader);
+   r = _bson_json_read_one((const uint8_t *)data, (size_t)len, bson, error);
 
    if (r == 0) {
       bson_set_error(error, BSON_ERROR_JSON, BSON_JSON_ERROR_READ_INVALID_PARAM, "Empty JSON string");
@@ -2396,3 +3002,378 @@ bson_json_reader_new_from_file(const char *path,    /* IN */
 
    return bson_json_reader_new_from_fd(fd, true);
 }
+
+
+/*
+ * Newline-delimited JSON, one document per line, read by several threads.
+ * JSON strings cannot contain a raw newline, so the input is split at
+ * newlines into chunks of about BSON_JSON_NDJSON_CHUNK_SIZE bytes, and each
+ * chunk is parsed by one thread.
+ *
+ * In order, the calling thread starts a round of one chunk per thread, each
+ * parsed into a bson_writer_t buffer, and passes the documents of the previous
+ * round to the callback while the round runs. Unordered, the threads claim
+ * chunks one after another and call the callback themselves.
+ */
+
+#define BSON_JSON_NDJSON_CHUNK_SIZE (1 << 20)
+
+typedef struct {
+   const uint8_t *data;
+   size_t len;
+   bool ordered;
+   bson_json_ndjson_cb cb;
+   void *ctx;
+
+   int stop; /* atomic */
+
+   bson_mutex_t mutex;
+   size_t next;       /* offset of the next chunk, unordered */
+   bool has_error;    /* the error of the earliest line that failed */
+   size_t error_line; /* offset of that line */
+   bson_error_t error;
+} bson_json_ndjson_t;
+
+typedef struct {
+   bson_json_ndjson_t *ndjson;
+   bson_thread_t thread;
+   bool started;
+
+   /* reading in order: one chunk, its documents and its error */
+   const uint8_t *begin;
+   const uint8_t *end;
+   uint8_t *buf;
+   size_t buflen;
+   bson_writer_t *writer;
+   bool has_error;
+   size_t error_line;
+   bson_error_t error;
+} bson_json_ndjson_job_t;
+
+
+/* Returns the end of the chunk that begins at @begin, just after a newline. */
+static const uint8_t *
+_bson_json_ndjson_chunk_end(const bson_json_ndjson_t *ndjson, const uint8_t *begin)
+{
+   const uint8_t *const end = ndjson->data + ndjson->len;
+   const uint8_t *newline;
+
+   if ((size_t)(end - begin) <= BSON_JSON_NDJSON_CHUNK_SIZE) {
+      return end;
+   }
+
+   newline = memchr(begin + BSON_JSON_NDJSON_CHUNK_SIZE, '\n', (size_t)(end - begin) - BSON_JSON_NDJSON_CHUNK_SIZE);
+
+   return newline ? newline + 1 : end;
+}
+
+
+static void
+_bson_json_ndjson_set_error(bson_json_ndjson_t *ndjson, size_t line, const bson_error_t *error)
+{
+   bson_mutex_lock(&ndjson->mutex);
+   if (!ndjson->has_error || line < ndjson->error_line) {
+      ndjson->has_error = true;
+      ndjson->error_line = line;
+      ndjson->error = *error;
+   }
+   bson_mutex_unlock(&ndjson->mutex);
+}
+
+
+/* Parse the lines of [begin, end), skipping blank lines. Reading in order, the
+ * documents are written to @job and its error is recorded there, otherwise
+ * each document is passed to the callback. */
+static void
+_bson_json_ndjson_parse(bson_json_ndjson_t *ndjson,
+                        bson_json_ndjson_job_t *job,
+                        const uint8_t *begin,
+                        const uint8_t *end)
+{
+   bson_t unordered_doc = BSON_INITIALIZER;
+   const uint8_t *line = begin;
+
+   while (line < end && !mcommon_atomic_int_fetch(&ndjson->stop, mcommon_memory_order_relaxed)) {
+      const uint8_t *const newline = memchr(line, '\n', (size_t)(end - line));
+      const uint8_t *const line_end = newline ? newline : end;
+      const uint8_t *p = line;
+      bson_error_t error;
+      bson_t *doc;
+      int r;
+
+      while (p < line_end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+         p++;
+      }
+
+      if (p < line_end) {
+         if (ndjson->ordered) {
+            bson_writer_begin(job->writer, &doc);
+         } else {
+            bson_reinit(&unordered_doc);
+            doc = &unordered_doc;
+         }
+
+         r = _bson_json_read_one(line, (size_t)(line_end - line), doc, &error);
+
+         if (r != 1) {
+            if (r == 0) {
+               bson_set_error(&error, BSON_ERROR_JSON, BSON_JSON_ERROR_READ_CORRUPT_JS, "%s", "Incomplete JSON");
+            }
+
+            if (ndjson->ordered) {
+               bson_writer_rollback(job->writer);
+               job->has_error = true;
+               job->error_line = (size_t)(line - ndjson->data);
+               job->error = error;
+            } else {
+               _bson_json_ndjson_set_error(ndjson, (size_t)(line - ndjson->data), &error);
+               mcommon_atomic_int_exchange(&ndjson->stop, 1, mcommon_memory_order_relaxed);
+            }
+
+            break;
+         }
+
+         if (ndjson->ordered) {
+            bson_writer_end(job->writer);
+         } else if (!ndjson->cb(ndjson->ctx, doc)) {
+            mcommon_atomic_int_exchange(&ndjson->stop, 1, mcommon_memory_order_relaxed);
+            break;
+         }
+      }
+
+      line = line_end + 1;
+   }
+
+   bson_destroy(&unordered_doc);
+}
+
+
+static BSON_THREAD_FUN(_bson_json_ndjson_ordered_worker, arg)
+{
+   bson_json_ndjson_job_t *const job = arg;
+
+   _bson_json_ndjson_parse(job->ndjson, job, job->begin, job->end);
+
+   BSON_THREAD_RETURN;
+}
+
+
+static BSON_THREAD_FUN(_bson_json_ndjson_unordered_worker, arg)
+{
+   bson_json_ndjson_job_t *const job = arg;
+   bson_json_ndjson_t *const ndjson = job->ndjson;
+
+   for (;;) {
+      const uint8_t *begin;
+      const uint8_t *end;
+
+      bson_mutex_lock(&ndjson->mutex);
+      begin = ndjson->data + ndjson->next;
+      end = _bson_json_ndjson_chunk_end(ndjson, begin);
+      ndjson->next = (size_t)(end - ndjson->data);
+      bson_mutex_unlock(&ndjson->mutex);
+
+      if (begin == end || mcommon_atomic_int_fetch(&ndjson->stop, mcommon_memory_order_relaxed)) {
+         break;
+      }
+
+      _bson_json_ndjson_parse(ndjson, NULL, begin, end);
+   }
+
+   BSON_THREAD_RETURN;
+}
+
+
+/* Pass the documents of a finished job to the callback in order. Returns false
+ * if reading must stop. */
+static bool
+_bson_json_ndjson_emit(bson_json_ndjson_t *ndjson, bson_json_ndjson_job_t *job)
+{
+   const size_t len = bson_writer_get_length(job->writer);
+   size_t offset = 0;
+
+   while (offset < len) {
+      uint32_t doc_len;
+      bson_t doc;
+
+      memcpy(&doc_len, job->buf + offset, sizeof doc_len);
+      doc_len = BSON_UINT32_FROM_LE(doc_len);
+      BSON_ASSERT(bson_init_static(&doc, job->buf + offset, doc_len));
+
+      if (!ndjson->cb(ndjson->ctx, &doc)) {
+         return false;
+      }
+
+      offset += doc_len;
+   }
+
+   if (job->has_error) {
+      _bson_json_ndjson_set_error(ndjson, job->error_line, &job->error);
+      return false;
+   }
+
+   return true;
+}
+
+
+static void
+_bson_json_ndjson_read_ordered(bson_json_ndjson_t *ndjson, uint32_t n_threads)
+{
+   bson_json_ndjson_job_t *const jobs = bson_malloc0(2u * n_threads * sizeof *jobs);
+   bson_json_ndjson_job_t *round = jobs;
+   bson_json_ndjson_job_t *previous = NULL;
+   const uint8_t *next = ndjson->data;
+   const uint8_t *const end = ndjson->data + ndjson->len;
+
+   for (uint32_t i = 0; i < 2u * n_threads; i++) {
+      jobs[i].ndjson = ndjson;
+      jobs[i].writer = bson_writer_new(&jobs[i].buf, &jobs[i].buflen, 0, bson_realloc_ctx, NULL);
+   }
+
+   while (next < end || previous) {
+      /* start a round of one chunk per thread */
+      for (uint32_t i = 0; i < n_threads; i++) {
+         bson_json_ndjson_job_t *const job = &round[i];
+
+         bson_writer_destroy(job->writer);
+         job->writer = bson_writer_new(&job->buf, &job->buflen, 0, bson_realloc_ctx, NULL);
+         job->has_error = false;
+         job->begin = next;
+         job->end = next = _bson_json_ndjson_chunk_end(ndjson, next);
+         job->started = false;
+
+         if (job->begin < job->end && !mcommon_atomic_int_fetch(&ndjson->stop, mcommon_memory_order_relaxed)) {
+            job->started = mcommon_thread_create(&job->thread, _bson_json_ndjson_ordered_worker, job) == 0;
+            if (!job->started) {
+               /* parse it in this thread instead */
+               _bson_json_ndjson_parse(ndjson, job, job->begin, job->end);
+            }
+         }
+      }
+
+      /* meanwhile, hand over the previous round */
+      for (uint32_t i = 0; previous && i < n_threads; i++) {
+         if (!mcommon_atomic_int_fetch(&ndjson->stop, mcommon_memory_order_relaxed) &&
+             !_bson_json_ndjson_emit(ndjson, &previous[i])) {
+            mcommon_atomic_int_exchange(&ndjson->stop, 1, mcommon_memory_order_relaxed);
+         }
+      }
+
+      for (uint32_t i = 0; i < n_threads; i++) {
+         if (round[i].started) {
+            mcommon_thread_join(round[i].thread);
+         }
+      }
+
+      if (round[0].begin == round[0].end) {
+         /* the round was empty, nothing left to hand over */
+         previous = NULL;
+      } else {
+         previous = round;
+         round = round == jobs ? jobs + n_threads : jobs;
+      }
+
+      if (mcommon_atomic_int_fetch(&ndjson->stop, mcommon_memory_order_relaxed)) {
+         break;
+      }
+   }
+
+   for (uint32_t i = 0; i < 2u * n_threads; i++) {
+      bson_writer_destroy(jobs[i].writer);
+      bson_free(jobs[i].buf);
+   }
+   bson_free(jobs);
+}
+
+
+static void
+_bson_json_ndjson_read_unordered(bson_json_ndjson_t *ndjson, uint32_t n_threads)
+{
+   bson_json_ndjson_job_t *const jobs = bson_malloc0(n_threads * sizeof *jobs);
+
+   /* the calling thread is one of the readers */
+   for (uint32_t i = 1; i < n_threads; i++) {
+      jobs[i].ndjson = ndjson;
+      jobs[i].started = mcommon_thread_create(&jobs[i].thread, _bson_json_ndjson_unordered_worker, &jobs[i]) == 0;
+   }
+
+   jobs[0].ndjson = ndjson;
+   _bson_json_ndjson_unordered_worker(&jobs[0]);
+
+   for (uint32_t i = 1; i < n_threads; i++) {
+      if (jobs[i].started) {
+         mcommon_thread_join(jobs[i].thread);
+      }
+   }
+
+   bson_free(jobs);
+}
+
+
+bool
+bson_json_read_ndjson(const uint8_t *data,
+                      size_t len,
+                      uint32_t n_threads,
+                      bool ordered,
+                      bson_json_ndjson_cb cb,
+                      void *ctx,
+                      bson_error_t *error)
+{
+   bson_json_ndjson_t ndjson = {0};
+
+   BSON_ASSERT(data || len == 0);
+   BSON_ASSERT_PARAM(cb);
+
+   if (n_threads == 0) {
+      n_threads = mcommon_thread_n_processors();
+   }
+
+   ndjson.data = data;
+   ndjson.len = len;
+   ndjson.ordered = ordered;
+   ndjson.cb = cb;
+   ndjson.ctx = ctx;
+   bson_mutex_init(&ndjson.mutex);
+
+   if (ordered) {
+      _bson_json_ndjson_read_ordered(&ndjson, n_threads);
+   } else {
+      _bson_json_ndjson_read_unordered(&ndjson, n_threads);
+   }
+
+   bson_mutex_destroy(&ndjson.mutex);
+
+   if (ndjson.has_error) {
+      /* lines are numbered from 1 */
+      size_t line = 1;
+
+      for (const uint8_t *p = data; (p = memchr(p, '\n', ndjson.error_line - (size_t)(p - data))); p++) {
+         line++;
+      }
+
+      bson_set_error(error, ndjson.error.domain, ndjson.error.code, "line %zu: %s", line, ndjson.error.message);
+      return false;
+   }
+
+   return true;
+}
+
+
+bool
+bson_json_read_ndjson_file(
+   const char *path, uint32_t n_threads, bool ordered, bson_json_ndjson_cb cb, void *ctx, bson_error_t *error)
+{
+   bson_mapped_file_t file;
+   bool ret;
+
+   BSON_ASSERT_PARAM(path);
+
+   if (!_bson_mapped_file_open(&file, path, error)) {
+      return false;
+   }
+
+   ret = bson_json_read_ndjson(file.data, file.len, n_threads, ordered, cb, ctx, error);
+   _bson_mapped_file_close(&file);
+
+   return ret;
+}
@@ -84,6 +84,20 @@ bson_json_data_reader_new(bool allow_multiple, size_t size);
 BSON_EXPORT(void)
 bson_json_data_reader_ingest(bson_json_reader_t *reader, const uint8_t *data, size_t len);
 
+typedef bool(BSON_CALL *bson_json_ndjson_cb)(void *ctx, const bson_t *doc);
+
+BSON_EXPORT(bool)
+bson_json_read_ndjson(const uint8_t *data,
+                      size_t len,
+                      uint32_t n_threads,
+                      bool ordered,
+                      bson_json_ndjson_cb cb,
+                      void *ctx,
+                      bson_error_t *error);
+BSON_EXPORT(bool)
+bson_json_read_ndjson_file(
+   const char *path, uint32_t n_threads, bool ordered, bson_json_ndjson_cb cb, void *ctx, bson_error_t *error);
+
 
 BSON_END_DECLS
 
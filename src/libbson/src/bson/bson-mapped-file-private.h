@@ -0,0 +1,52 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <bson/bson-prelude.h>
+
+
+#ifndef BSON_MAPPED_FILE_PRIVATE_H
+#define BSON_MAPPED_FILE_PRIVATE_H
+
+
+#include <bson/bson-types.h>
+#include <bson/macros.h>
+
+
+BSON_BEGIN_DECLS
+
+
+/* The contents of a file, memory-mapped read-only where possible and
+ * otherwise read into memory. */
+typedef struct {
+   const uint8_t *data;
+   size_t len;
+   bool is_mapped;
+} bson_mapped_file_t;
+
+
+/* Maps the file at @path, hinting the system that it is read sequentially.
+ * Returns false and sets @error if it cannot be opened or read. */
+bool
+_bson_mapped_file_open(bson_mapped_file_t *file, const char *path, bson_error_t *error);
+
+void
+_bson_mapped_file_close(bson_mapped_file_t *file);
+
+
+BSON_END_DECLS
+
+
+#endif /* BSON_MAPPED_FILE_PRIVATE_H */
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <bson/bson-mapped-file-private.h>
+
+#include <bson/bson.h>
+
+#include <mlib/cmp.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <errno.h>
+
+#ifdef BSON_OS_WIN32
+#include <io.h>
+#include <share.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+static void
+_bson_mapped_file_set_error(bson_error_t *error, int errnum)
+{
+   char errmsg_buf[BSON_ERROR_BUFFER_SIZE];
+   char *errmsg;
+
+   errmsg = bson_strerror_r(errnum, errmsg_buf, sizeof errmsg_buf);
+   bson_set_error(error, BSON_ERROR_READER, BSON_ERROR_READER_BADFD, "%s", errmsg);
+}
+
+
+/* Read all of @fd into memory, for files that cannot be mapped. */
+static bool
+_bson_mapped_file_read(bson_mapped_file_t *file, int fd, bson_error_t *error)
+{
+   uint8_t *buf = NULL;
+   size_t len = 0;
+   size_t cap = 0;
+
+   for (;;) {
+      ssize_t r;
+
+      if (cap - len < 4096u) {
+         cap = BSON_MAX(cap * 2u, 65536u);
+         buf = bson_realloc(buf, cap);
+      }
+
+#ifdef BSON_OS_WIN32
+      r = _read(fd, buf + len, (unsigned int)BSON_MIN(cap - len, (size_t)INT_MAX));
+#else
+      r = read(fd, buf + len, cap - len);
+#endif
+
+      if (r == 0) {
+         break;
+      }
+
+      if (r < 0) {
+         if (errno == EINTR || errno == EAGAIN) {
+            continue;
+         }
+
+         _bson_mapped_file_set_error(error, errno);
+         bson_free(buf);
+         return false;
+      }
+
+      len += (size_t)r;
+   }
+
+   file->data = buf;
+   file->len = len;
+   file->is_mapped = false;
+
+   return true;
+}
+
+
+bool
+_bson_mapped_file_open(bson_mapped_file_t *file, const char *path, bson_error_t *error)
+{
+   int fd = -1;
+   bool ret;
+
+   BSON_ASSERT_PARAM(file);
+   BSON_ASSERT_PARAM(path);
+
+   file->data = NULL;
+   file->len = 0;
+   file->is_mapped = false;
+
+#ifdef BSON_OS_WIN32
+   _sopen_s(&fd, path, (_O_RDONLY | _O_BINARY), _SH_DENYNO, _S_IREAD);
+#else
+   fd = open(path, O_RDONLY);
+#endif
+
+   if (fd == -1) {
+      _bson_mapped_file_set_error(error, errno);
+      return false;
+   }
+
+#ifndef BSON_OS_WIN32
+   {
+      struct stat st;
+
+      if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && mlib_in_range(size_t, st.st_size)) {
+         void *const data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+         if (data != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+            (void)madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+            file->data = data;
+            file->len = (size_t)st.st_size;
+            file->is_mapped = true;
+            close(fd);
+            return true;
+         }
+      }
+   }
+#endif
+
+   ret = _bson_mapped_file_read(file, fd, error);
+
+#ifdef BSON_OS_WIN32
+   _close(fd);
+#else
+   close(fd);
+#endif
+
+   return ret;
+}
+
+
+void
+_bson_mapped_file_close(bson_mapped_file_t *file)
+{
+   if (!file) {
+      return;
+   }
+
+#ifndef BSON_OS_WIN32
+   if (file->is_mapped) {
+      munmap((void *)file->data, file->len);
+   } else
+#endif
+   {
+      bson_free((void *)file->data);
+   }
+
+   file->data = NULL;
+   file->len = 0;
+   file->is_mapped = false;
+}
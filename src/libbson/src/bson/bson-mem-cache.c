@@ -0,0 +1,638 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <bson/bson-mem-cache.h>
+
+#include <common-atomic-private.h>
+#include <common-thread-private.h>
+
+#include <bson/compat.h>
+#include <bson/macros.h>
+
+#include <mlib/config.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+ * Allocations of up to BSON_MEM_CACHE_MAX_SMALL bytes are rounded up to one
+ * of the size classes below and served from a free list in the calling
+ * thread's cache. A thread cache refills from, and releases to, a central
+ * depot per size class in batches, so the depot's mutex is taken once per
+ * batch. The depot carves objects from spans obtained from the system
+ * allocator, which are never returned.
+ *
+ * Larger allocations go to the system allocator. Every allocation is
+ * preceded by a header recording its size class, so free() and realloc()
+ * need no lookup.
+ */
+#define BSON_MEM_CACHE_HEADER_SIZE 16u
+#define BSON_MEM_CACHE_MAX_SMALL 2048u
+#define BSON_MEM_CACHE_N_CLASSES 24u
+#define BSON_MEM_CACHE_LARGE UINT32_MAX
+#define BSON_MEM_CACHE_SPAN_SIZE (64u * 1024u)
+#define BSON_MEM_CACHE_BATCH_BYTES (32u * 1024u)
+
+
+typedef struct {
+   size_t size;         /* the size requested */
+   uint32_t size_class; /* or BSON_MEM_CACHE_LARGE */
+   uint32_t offset;     /* from the system allocation, for large ones */
+} bson_mem_cache_header_t;
+
+BSON_STATIC_ASSERT2(mem_cache_header, sizeof(bson_mem_cache_header_t) <= BSON_MEM_CACHE_HEADER_SIZE);
+
+
+/* A free object is linked through its first bytes, in place of its header. */
+typedef struct _bson_mem_cache_free_t {
+   struct _bson_mem_cache_free_t *next;
+} bson_mem_cache_free_t;
+
+typedef struct {
+   bson_mem_cache_free_t *head;
+   uint32_t count;
+} bson_mem_cache_list_t;
+
+typedef struct _bson_mem_cache_span_t {
+   struct _bson_mem_cache_span_t *next;
+} bson_mem_cache_span_t;
+
+typedef struct {
+   bson_mutex_t mutex;
+   bson_mem_cache_list_t list;
+   bson_mem_cache_span_t *spans;
+} bson_mem_cache_depot_t;
+
+typedef struct {
+   bson_mem_cache_list_t lists[BSON_MEM_CACHE_N_CLASSES];
+
+   /* counts not yet added to the totals */
+   int64_t small_allocs;
+   int64_t small_frees;
+   int64_t large_allocs;
+   int64_t large_frees;
+} bson_mem_cache_thread_t;
+
+
+static const uint32_t gClassSizes[BSON_MEM_CACHE_N_CLASSES] = {
+   16, 32, 48, 64, 80, 96, 112, 128,        /* steps of 16 bytes */
+   160, 192, 224, 256, 320, 384, 448, 512,  /* then four per power of two */
+   640, 768, 896, 1024, 1280, 1536, 1792, 2048};
+
+static bson_mem_cache_depot_t gDepots[BSON_MEM_CACHE_N_CLASSES];
+static bson_once_t gOnce = BSON_ONCE_INIT;
+
+static mlib_thread_local bson_mem_cache_thread_t *gThreadCache;
+
+#if defined(BSON_OS_UNIX)
+static pthread_key_t gThreadCacheKey;
+#else
+static DWORD gThreadCacheKey;
+#endif
+
+static bson_mem_cache_stats_t gStats;
+
+
+static void
+_bson_mem_cache_thread_destroy(void *cache);
+
+#if defined(BSON_OS_WIN32)
+static VOID WINAPI
+_bson_mem_cache_fls_callback(PVOID cache)
+{
+   if (cache) {
+      _bson_mem_cache_thread_destroy(cache);
+   }
+}
+#endif
+
+
+static BSON_ONCE_FUN(_bson_mem_cache_init)
+{
+   for (uint32_t i = 0; i < BSON_MEM_CACHE_N_CLASSES; i++) {
+      bson_mutex_init(&gDepots[i].mutex);
+   }
+
+#if defined(BSON_OS_UNIX)
+   BSON_ASSERT(pthread_key_create(&gThreadCacheKey, _bson_mem_cache_thread_destroy) == 0);
+#else
+   gThreadCacheKey = FlsAlloc(_bson_mem_cache_fls_callback);
+   BSON_ASSERT(gThreadCacheKey != FLS_OUT_OF_INDEXES);
+#endif
+
+   BSON_ONCE_RETURN;
+}
+
+
+/* The size class of an allocation of 1 to BSON_MEM_CACHE_MAX_SMALL bytes:
+ * steps of 16 bytes up to 128, then four steps per power of two. */
+static BSON_INLINE uint32_t
+_bson_mem_cache_size_class(size_t num_bytes)
+{
+   uint32_t lg = 7u;
+
+   if (num_bytes <= 128u) {
+      return num_bytes ? (uint32_t)((num_bytes - 1u) / 16u) : 0u;
+   }
+
+   while ((num_bytes - 1u) >> (lg + 1u)) {
+      lg++;
+   }
+
+   return 8u + (lg - 7u) * 4u + (uint32_t)((num_bytes - 1u) >> (lg - 2u)) - 4u;
+}
+
+
+static BSON_INLINE size_t
+_bson_mem_cache_object_size(uint32_t size_class)
+{
+   return BSON_MEM_CACHE_HEADER_SIZE + gClassSizes[size_class];
+}
+
+
+/* The number of objects moved between a thread cache and the depot at once.
+ * A thread cache holds at most twice as many. */
+static BSON_INLINE uint32_t
+_bson_mem_cache_batch(uint32_t size_class)
+{
+   const size_t batch = BSON_MEM_CACHE_BATCH_BYTES / _bson_mem_cache_object_size(size_class);
+
+   return batch < 4u ? 4u : batch > 64u ? 64u : (uint32_t)batch;
+}
+
+
+static void
+_bson_mem_cache_add_stat(int64_t *stat, int64_t n)
+{
+   if (n) {
+      mcommon_atomic_int64_fetch_add(stat, n, mcommon_memory_order_relaxed);
+   }
+}
+
+
+static void
+_bson_mem_cache_publish(bson_mem_cache_thread_t *cache)
+{
+   _bson_mem_cache_add_stat(&gStats.small_allocs, cache->small_allocs);
+   _bson_mem_cache_add_stat(&gStats.small_frees, cache->small_frees);
+   _bson_mem_cache_add_stat(&gStats.large_allocs, cache->large_allocs);
+   _bson_mem_cache_add_stat(&gStats.large_frees, cache->large_frees);
+
+   cache->small_allocs = 0;
+   cache->small_frees = 0;
+   cache->large_allocs = 0;
+   cache->large_frees = 0;
+}
+
+
+/* Split a new span into objects of @size_class. Requires the depot mutex. */
+static bool
+_bson_mem_cache_carve_span(bson_mem_cache_depot_t *depot, uint32_t size_class)
+{
+   const size_t object_size = _bson_mem_cache_object_size(size_class);
+   bson_mem_cache_span_t *span;
+   uint8_t *pos;
+   uint8_t *end;
+
+   if (!(span = malloc(BSON_MEM_CACHE_SPAN_SIZE))) {
+      return false;
+   }
+
+   span->next = depot->spans;
+   depot->spans = span;
+
+   /* objects are aligned to 16 bytes, like their headers */
+   pos = (uint8_t *)(((uintptr_t)(span + 1) + 15u) & ~(uintptr_t)15u);
+   end = (uint8_t *)span + BSON_MEM_CACHE_SPAN_SIZE;
+
+   while ((size_t)(end - pos) >= object_size) {
+      bson_mem_cache_free_t *const object = (bson_mem_cache_free_t *)pos;
+
+      object->next = depot->list.head;
+      depot->list.head = object;
+      depot->list.count++;
+      pos += object_size;
+   }
+
+   _bson_mem_cache_add_stat(&gStats.bytes_reserved, BSON_MEM_CACHE_SPAN_SIZE);
+
+   return true;
+}
+
+
+static bool
+_bson_mem_cache_refill(bson_mem_cache_thread_t *cache, uint32_t size_class)
+{
+   bson_mem_cache_depot_t *const depot = &gDepots[size_class];
+   bson_mem_cache_list_t *const list = &cache->lists[size_class];
+   uint32_t batch = _bson_mem_cache_batch(size_class);
+
+   bson_mutex_lock(&depot->mutex);
+
+   if (depot->list.count < batch) {
+      _bson_mem_cache_carve_span(depot, size_class);
+   }
+
+   if (batch > depot->list.count) {
+      batch = depot->list.count;
+   }
+
+   for (uint32_t i = 0; i < batch; i++) {
+      bson_mem_cache_free_t *const object = depot->list.head;
+
+      depot->list.head = object->next;
+      object->next = list->head;
+      list->head = object;
+   }
+
+   depot->list.count -= batch;
+   list->count += batch;
+
+   bson_mutex_unlock(&depot->mutex);
+
+   _bson_mem_cache_add_stat(&gStats.refills, 1);
+   _bson_mem_cache_publish(cache);
+
+   return batch > 0;
+}
+
+
+/* Move the first @n objects of @list to the depot of @size_class. */
+static void
+_bson_mem_cache_release(bson_mem_cache_list_t *list, uint32_t size_class, uint32_t n)
+{
+   bson_mem_cache_depot_t *const depot = &gDepots[size_class];
+   bson_mem_cache_free_t *const head = list->head;
+   bson_mem_cache_free_t *tail = head;
+
+   BSON_ASSERT(n > 0 && n <= list->count);
+
+   for (uint32_t i = 1; i < n; i++) {
+      tail = tail->next;
+   }
+
+   list->head = tail->next;
+   list->count -= n;
+
+   bson_mutex_lock(&depot->mutex);
+   tail->next = depot->list.head;
+   depot->list.head = head;
+   depot->list.count += n;
+   bson_mutex_unlock(&depot->mutex);
+
+   _bson_mem_cache_add_stat(&gStats.releases, 1);
+}
+
+
+static void
+_bson_mem_cache_flush(bson_mem_cache_thread_t *cache)
+{
+   for (uint32_t i = 0; i < BSON_MEM_CACHE_N_CLASSES; i++) {
+      if (cache->lists[i].count) {
+         _bson_mem_cache_release(&cache->lists[i], i, cache->lists[i].count);
+      }
+   }
+
+   _bson_mem_cache_publish(cache);
+}
+
+
+static void
+_bson_mem_cache_thread_destroy(void *cache)
+{
+   _bson_mem_cache_flush(cache);
+
+   if (gThreadCache == cache) {
+      gThreadCache = NULL;
+   }
+
+   free(cache);
+   _bson_mem_cache_add_stat(&gStats.thread_caches, -1);
+}
+
+
+static bson_mem_cache_thread_t *
+_bson_mem_cache_thread(void)
+{
+   bson_mem_cache_thread_t *cache = gThreadCache;
+
+   if (BSON_LIKELY(cache)) {
+      return cache;
+   }
+
+   bson_once(&gOnce, _bson_mem_cache_init);
+
+   if (!(cache = calloc(1, sizeof *cache))) {
+      return NULL;
+   }
+
+   /* the cache is flushed to the depot when the thread exits */
+#if defined(BSON_OS_UNIX)
+   BSON_ASSERT(pthread_setspecific(gThreadCacheKey, cache) == 0);
+#else
+   BSON_ASSERT(FlsSetValue(gThreadCacheKey, cache));
+#endif
+
+   gThreadCache = cache;
+   _bson_mem_cache_add_stat(&gStats.thread_caches, 1);
+
+   return cache;
+}
+
+
+/* Allocate @num_bytes from the system allocator, aligned to @alignment if it
+ * is larger than BSON_MEM_CACHE_HEADER_SIZE. */
+static void *
+_bson_mem_cache_large_alloc(bson_mem_cache_thread_t *cache, size_t alignment, size_t num_bytes)
+{
+   bson_mem_cache_header_t *header;
+   uint8_t *raw;
+   uint8_t *mem;
+   size_t extra = BSON_MEM_CACHE_HEADER_SIZE;
+
+   if (alignment > BSON_MEM_CACHE_HEADER_SIZE) {
+      if (alignment > UINT32_MAX / 2u) {
+         return NULL;
+      }
+      extra += alignment;
+   }
+
+   if (num_bytes > SIZE_MAX - extra || !(raw = malloc(num_bytes + extra))) {
+      return NULL;
+   }
+
+   mem = raw + BSON_MEM_CACHE_HEADER_SIZE;
+   if (alignment > BSON_MEM_CACHE_HEADER_SIZE) {
+      mem = (uint8_t *)(((uintptr_t)mem + (alignment - 1u)) & ~(uintptr_t)(alignment - 1u));
+   }
+
+   header = (bson_mem_cache_header_t *)(mem - BSON_MEM_CACHE_HEADER_SIZE);
+   header->size = num_bytes;
+   header->size_class = BSON_MEM_CACHE_LARGE;
+   header->offset = (uint32_t)((uint8_t *)header - raw);
+
+   if (cache) {
+      cache->large_allocs++;
+   } else {
+      _bson_mem_cache_add_stat(&gStats.large_allocs, 1);
+   }
+
+   return mem;
+}
+
+
+static void *
+_bson_mem_cache_malloc(size_t num_bytes)
+{
+   bson_mem_cache_thread_t *const cache = _bson_mem_cache_thread();
+   bson_mem_cache_header_t *header;
+   bson_mem_cache_list_t *list;
+   uint32_t size_class;
+
+   if (num_bytes > BSON_MEM_CACHE_MAX_SMALL || BSON_UNLIKELY(!cache)) {
+      return _bson_mem_cache_large_alloc(cache, 0, num_bytes);
+   }
+
+   size_class = _bson_mem_cache_size_class(num_bytes);
+   list = &cache->lists[size_class];
+
+   if (BSON_UNLIKELY(!list->head) && !_bson_mem_cache_refill(cache, size_class)) {
+      return NULL;
+   }
+
+   header = (bson_mem_cache_header_t *)list->head;
+   list->head = list->head->next;
+   list->count--;
+   cache->small_allocs++;
+
+   header->size = num_bytes;
+   header->size_class = size_class;
+   header->offset = 0;
+
+   return (uint8_t *)header + BSON_MEM_CACHE_HEADER_SIZE;
+}
+
+
+static void
+_bson_mem_cache_free(void *mem)
+{
+   bson_mem_cache_thread_t *cache;
+   bson_mem_cache_header_t *header;
+   bson_mem_cache_free_t *object;
+   uint32_t size_class;
+
+   if (!mem) {
+      return;
+   }
+
+   header = (bson_mem_cache_header_t *)((uint8_t *)mem - BSON_MEM_CACHE_HEADER_SIZE);
+   size_class = header->size_class;
+   cache = _bson_mem_cache_thread();
+
+   if (size_class == BSON_MEM_CACHE_LARGE) {
+      free((uint8_t *)header - header->offset);
+
+      if (cache) {
+         cache->large_frees++;
+      } else {
+         _bson_mem_cache_add_stat(&gStats.large_frees, 1);
+      }
+      return;
+   }
+
+   object = (bson_mem_cache_free_t *)header;
+
+   if (BSON_UNLIKELY(!cache)) {
+      bson_mem_cache_list_t list = {object, 1};
+
+      object->next = NULL;
+      _bson_mem_cache_release(&list, size_class, 1);
+      _bson_mem_cache_add_stat(&gStats.small_frees, 1);
+      return;
+   }
+
+   object->next = cache->lists[size_class].head;
+   cache->lists[size_class].head = object;
+   cache->small_frees++;
+
+   if (BSON_UNLIKELY(++cache->lists[size_class].count > 2u * _bson_mem_cache_batch(size_class))) {
+      _bson_mem_cache_release(&cache->lists[size_class], size_class, _bson_mem_cache_batch(size_class));
+      _bson_mem_cache_publish(cache);
+   }
+}
+
+
+static void *
+_bson_mem_cache_calloc(size_t n_members, size_t num_bytes)
+{
+   void *mem;
+
+   if (n_members && num_bytes > SIZE_MAX / n_members) {
+      return NULL;
+   }
+
+   if ((mem = _bson_mem_cache_malloc(n_members * num_bytes))) {
+      memset(mem, 0, n_members * num_bytes);
+   }
+
+   return mem;
+}
+
+
+static void *
+_bson_mem_cache_realloc(void *mem, size_t num_bytes)
+{
+   bson_mem_cache_header_t *header;
+   void *copy;
+
+   if (!mem) {
+      return _bson_mem_cache_malloc(num_bytes);
+   }
+
+   header = (bson_mem_cache_header_t *)((uint8_t *)mem - BSON_MEM_CACHE_HEADER_SIZE);
+
+   if (header->size_class != BSON_MEM_CACHE_LARGE) {
+      if (num_bytes && num_bytes <= gClassSizes[header->size_class]) {
+         header->size = num_bytes;
+         return mem;
+      }
+   } else if (header->offset == 0 && num_bytes > BSON_MEM_CACHE_MAX_SMALL) {
+      /* a large allocation stays with the system allocator */
+      if (num_bytes > SIZE_MAX - BSON_MEM_CACHE_HEADER_SIZE ||
+          !(header = realloc(header, num_bytes + BSON_MEM_CACHE_HEADER_SIZE))) {
+         return NULL;
+      }
+
+      header->size = num_bytes;
+      return (uint8_t *)header + BSON_MEM_CACHE_HEADER_SIZE;
+   }
+
+   if (!(copy = _bson_mem_cache_malloc(num_bytes))) {
+      return NULL;
+   }
+
+   memcpy(copy, mem, BSON_MIN(header->size, num_bytes));
+   _bson_mem_cache_free(mem);
+
+   return copy;
+}
+
+
+static void *
+_bson_mem_cache_aligned_alloc(size_t alignment, size_t num_bytes)
+{
+   if (alignment <= BSON_MEM_CACHE_HEADER_SIZE) {
+      return _bson_mem_cache_malloc(num_bytes);
+   }
+
+   return _bson_mem_cache_large_alloc(_bson_mem_cache_thread(), alignment, num_bytes);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_mem_cache_get_vtable --
+ *
+ *       Get the vtable of a size class allocator with thread caches, for
+ *       bson_mem_set_vtable(). It must be set before any memory is
+ *       allocated with bson_malloc().
+ *
+ * Returns:
+ *       A vtable valid for the lifetime of the process.
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+const bson_mem_vtable_t *
+bson_mem_cache_get_vtable(void)
+{
+   static const bson_mem_vtable_t vtable = {.malloc = _bson_mem_cache_malloc,
+                                            .calloc = _bson_mem_cache_calloc,
+                                            .realloc = _bson_mem_cache_realloc,
+                                            .free = _bson_mem_cache_free,
+                                            .aligned_alloc = _bson_mem_cache_aligned_alloc,
+                                            .padding = {0}};
+
+   return &vtable;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_mem_cache_get_stats --
+ *
+ *       Get the counters of the allocator. Counts of threads that have not
+ *       refilled, released or flushed their cache since are not included.
+ *
+ * Returns:
+ *       None.
+ *
+ * Side effects:
+ *       @stats is set.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+bson_mem_cache_get_stats(bson_mem_cache_stats_t *stats) /* OUT */
+{
+   BSON_ASSERT_PARAM(stats);
+
+   memset(stats, 0, sizeof *stats);
+
+   stats->small_allocs = mcommon_atomic_int64_fetch(&gStats.small_allocs, mcommon_memory_order_relaxed);
+   stats->small_frees = mcommon_atomic_int64_fetch(&gStats.small_frees, mcommon_memory_order_relaxed);
+   stats->large_allocs = mcommon_atomic_int64_fetch(&gStats.large_allocs, mcommon_memory_order_relaxed);
+   stats->large_frees = mcommon_atomic_int64_fetch(&gStats.large_frees, mcommon_memory_order_relaxed);
+   stats->refills = mcommon_atomic_int64_fetch(&gStats.refills, mcommon_memory_order_relaxed);
+   stats->releases = mcommon_atomic_int64_fetch(&gStats.releases, mcommon_memory_order_relaxed);
+   stats->bytes_reserved = mcommon_atomic_int64_fetch(&gStats.bytes_reserved, mcommon_memory_order_relaxed);
+   stats->thread_caches = mcommon_atomic_int64_fetch(&gStats.thread_caches, mcommon_memory_order_relaxed);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_mem_cache_thread_flush --
+ *
+ *       Return the objects cached by the calling thread to the depot, and
+ *       add its counts to the totals of bson_mem_cache_get_stats(). This is
+ *       done when the thread exits.
+ *
+ * Returns:
+ *       None.
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+bson_mem_cache_thread_flush(void)
+{
+   if (gThreadCache) {
+      _bson_mem_cache_flush(gThreadCache);
+   }
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <bson/bson-prelude.h>
+
+
+#ifndef BSON_MEM_CACHE_H
+#define BSON_MEM_CACHE_H
+
+
+#include <bson/macros.h>
+#include <bson/memory.h>
+
+#include <stdint.h>
+
+
+BSON_BEGIN_DECLS
+
+
+/**
+ * bson_mem_cache_stats_t:
+ *
+ * Counters of the allocator returned by bson_mem_cache_get_vtable(). Each
+ * thread counts its own operations, and adds them to these totals when it
+ * refills or releases a batch of objects, calls bson_mem_cache_thread_flush(),
+ * or exits.
+ */
+typedef struct _bson_mem_cache_stats_t {
+   int64_t small_allocs;   /* allocations served from a size class */
+   int64_t small_frees;    /* frees of size class objects */
+   int64_t large_allocs;   /* allocations forwarded to the system allocator */
+   int64_t large_frees;    /* frees forwarded to the system allocator */
+   int64_t refills;        /* batches moved from the depot to a thread cache */
+   int64_t releases;       /* batches moved from a thread cache to the depot */
+   int64_t bytes_reserved; /* memory held for size classes, never released */
+   int64_t thread_caches;  /* threads currently holding a cache */
+   int64_t padding[8];
+} bson_mem_cache_stats_t;
+
+
+BSON_EXPORT(const bson_mem_vtable_t *)
+bson_mem_cache_get_vtable(void);
+
+BSON_EXPORT(void)
+bson_mem_cache_get_stats(bson_mem_cache_stats_t *stats);
+
+BSON_EXPORT(void)
+bson_mem_cache_thread_flush(void);
+
+
+BSON_END_DECLS
+
+
+#endif /* BSON_MEM_CACHE_H */
@@ -0,0 +1,452 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <bson/bson-path.h>
+#include <bson/bson.h>
+#include <bson/memory.h>
+
+#include <string.h>
+
+
+typedef struct {
+   uint32_t key; /* offset of the key in dotkey */
+   uint32_t key_len;
+} bson_path_segment_t;
+
+struct _bson_path_t {
+   char *dotkey;
+   bson_path_segment_t *segments;
+   uint32_t n_segments;
+};
+
+/*
+ * The paths of a set are merged into a tree of segments, so that a key
+ * shared by several paths is compared once. Node 0 is the document itself.
+ */
+typedef struct {
+   uint32_t key; /* offset of the key in keys */
+   uint32_t key_len;
+   uint32_t first_child;  /* or 0 */
+   uint32_t next_sibling; /* or 0 */
+   uint32_t n_children;
+   size_t first_path; /* the first path ending at this node, or SIZE_MAX */
+} bson_path_node_t;
+
+struct _bson_path_set_t {
+   char *keys;
+   bson_path_node_t *nodes;
+   uint32_t n_nodes;
+   size_t *next_path; /* the next path ending at the same node, or SIZE_MAX */
+   size_t n_paths;
+};
+
+
+/* Whether @iter is observing the field named by @key. */
+static BSON_INLINE bool
+_bson_path_key_equal(const bson_iter_t *iter, const char *key, uint32_t key_len)
+{
+   return bson_iter_key_len(iter) == key_len && memcmp(bson_iter_key(iter), key, key_len) == 0;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_path_new --
+ *
+ *       Split the dot-notation key @dotkey into its parts, to find the
+ *       same field in many documents with bson_path_find().
+ *
+ * Returns:
+ *       A newly allocated bson_path_t that should be freed with
+ *       bson_path_destroy().
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bson_path_t *
+bson_path_new(const char *dotkey) /* IN */
+{
+   bson_path_t *path;
+   uint32_t start = 0;
+   size_t len;
+
+   BSON_ASSERT_PARAM(dotkey);
+
+   len = strlen(dotkey);
+   BSON_ASSERT(len < UINT32_MAX);
+
+   path = bson_malloc0(sizeof *path);
+   path->dotkey = bson_strndup(dotkey, len);
+   path->n_segments = 1;
+
+   for (size_t i = 0; i < len; i++) {
+      path->n_segments += dotkey[i] == '.';
+   }
+
+   path->segments = bson_malloc(path->n_segments * sizeof *path->segments);
+
+   for (uint32_t i = 0, s = 0; i <= (uint32_t)len; i++) {
+      if (i == (uint32_t)len || dotkey[i] == '.') {
+         path->segments[s].key = start;
+         path->segments[s].key_len = i - start;
+         s++;
+         start = i + 1u;
+      }
+   }
+
+   return path;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_path_destroy --
+ *
+ *       Free a path created with bson_path_new().
+ *
+ * Returns:
+ *       None.
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+bson_path_destroy(bson_path_t *path) /* IN */
+{
+   if (!path) {
+      return;
+   }
+
+   bson_free(path->dotkey);
+   bson_free(path->segments);
+   bson_free(path);
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_path_find --
+ *
+ *       Initialize @iter on the field of @bson named by @path, like
+ *       bson_iter_find_descendant(). Array elements are named by their
+ *       index, like "a.0.b".
+ *
+ * Returns:
+ *       true if the field was found and @iter is observing that field.
+ *
+ * Side effects:
+ *       @iter may be initialized.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+bson_path_find(const bson_path_t *path, /* IN */
+               const bson_t *bson,      /* IN */
+               bson_iter_t *iter)       /* OUT */
+{
+   BSON_ASSERT_PARAM(path);
+   BSON_ASSERT_PARAM(bson);
+   BSON_ASSERT_PARAM(iter);
+
+   if (!bson_iter_init(iter, bson)) {
+      return false;
+   }
+
+   for (uint32_t s = 0; s < path->n_segments; s++) {
+      const char *key = path->dotkey + path->segments[s].key;
+      const uint32_t key_len = path->segments[s].key_len;
+      bool is_found = false;
+
+      if (s > 0) {
+         bson_iter_t child;
+
+         if (!bson_iter_recurse(iter, &child)) {
+            return false;
+         }
+
+         *iter = child;
+      }
+
+      /* like bson_iter_find_descendant(), the first field with the key is
+       * used even if it is not a document */
+      while (!is_found && bson_iter_next(iter)) {
+         is_found = _bson_path_key_equal(iter, key, key_len);
+      }
+
+      if (!is_found) {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+
+static uint32_t
+_bson_path_set_add_child(bson_path_set_t *set, uint32_t parent, uint32_t key, uint32_t key_len)
+{
+   bson_path_node_t *node = &set->nodes[parent];
+   uint32_t *link = &node->first_child;
+
+   while (*link) {
+      const bson_path_node_t *child = &set->nodes[*link];
+
+      if (child->key_len == key_len && memcmp(set->keys + child->key, set->keys + key, key_len) == 0) {
+         return *link;
+      }
+
+      link = &set->nodes[*link].next_sibling;
+   }
+
+   *link = set->n_nodes;
+   node->n_children++;
+
+   node = &set->nodes[set->n_nodes];
+   node->key = key;
+   node->key_len = key_len;
+   node->first_child = 0;
+   node->next_sibling = 0;
+   node->n_children = 0;
+   node->first_path = SIZE_MAX;
+
+   return set->n_nodes++;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_path_set_new --
+ *
+ *       Split the @n_dotkeys dot-notation keys of @dotkeys into their parts,
+ *       to find them together in many documents with bson_path_set_find().
+ *
+ * Returns:
+ *       A newly allocated bson_path_set_t that should be freed with
+ *       bson_path_set_destroy().
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bson_path_set_t *
+bson_path_set_new(const char *const *dotkeys, /* IN */
+                  size_t n_dotkeys)           /* IN */
+{
+   bson_path_set_t *set;
+   size_t keys_len = 0;
+   size_t max_nodes = 1;
+
+   BSON_ASSERT(dotkeys || n_dotkeys == 0);
+
+   for (size_t p = 0; p < n_dotkeys; p++) {
+      const size_t len = strlen(dotkeys[p]);
+
+      keys_len += len + 1u;
+
+      /* one node per part at most */
+      max_nodes += 1u;
+      for (size_t i = 0; i < len; i++) {
+         max_nodes += dotkeys[p][i] == '.';
+      }
+   }
+
+   BSON_ASSERT(keys_len < UINT32_MAX && max_nodes < UINT32_MAX);
+
+   set = bson_malloc0(sizeof *set);
+   set->keys = bson_malloc(keys_len + 1u);
+   set->nodes = bson_malloc0(max_nodes * sizeof *set->nodes);
+   set->n_nodes = 1;
+   set->nodes[0].first_path = SIZE_MAX;
+   set->next_path = bson_malloc((n_dotkeys ? n_dotkeys : 1u) * sizeof *set->next_path);
+   set->n_paths = n_dotkeys;
+
+   keys_len = 0;
+
+   for (size_t p = 0; p < n_dotkeys; p++) {
+      const uint32_t len = (uint32_t)strlen(dotkeys[p]);
+      const uint32_t base = (uint32_t)keys_len;
+      uint32_t node = 0;
+      uint32_t start = 0;
+
+      memcpy(set->keys + base, dotkeys[p], len + 1u);
+      keys_len += len + 1u;
+
+      for (uint32_t i = 0; i <= len; i++) {
+         if (i == len || dotkeys[p][i] == '.') {
+            node = _bson_path_set_add_child(set, node, base + start, i - start);
+            start = i + 1u;
+         }
+      }
+
+      set->next_path[p] = set->nodes[node].first_path;
+      set->nodes[node].first_path = p;
+   }
+
+   return set;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_path_set_destroy --
+ *
+ *       Free a set of paths created with bson_path_set_new().
+ *
+ * Returns:
+ *       None.
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+bson_path_set_destroy(bson_path_set_t *set) /* IN */
+{
+   if (!set) {
+      return;
+   }
+
+   bson_free(set->keys);
+   bson_free(set->nodes);
+   bson_free(set->next_path);
+   bson_free(set);
+}
+
+
+/* Find the children of @parent in the document or array of @iter, stopping
+ * once each has been found. Returns the number of paths found. */
+static size_t
+_bson_path_set_walk(const bson_path_set_t *set,
+                    const bson_path_node_t *parent,
+                    bson_iter_t *iter,
+                    bool *matched,
+                    bson_iter_t *iters,
+                    bool *found)
+{
+   uint32_t n_remaining = parent->n_children;
+   size_t n_found = 0;
+
+   while (n_remaining > 0 && bson_iter_next(iter)) {
+      uint32_t c;
+
+      for (c = parent->first_child; c; c = set->nodes[c].next_sibling) {
+         if (!matched[c] && _bson_path_key_equal(iter, set->keys + set->nodes[c].key, set->nodes[c].key_len)) {
+            break;
+         }
+      }
+
+      if (!c) {
+         continue;
+      }
+
+      /* like bson_iter_find_descendant(), only the first field with the key
+       * is used */
+      matched[c] = true;
+      n_remaining--;
+
+      for (size_t p = set->nodes[c].first_path; p != SIZE_MAX; p = set->next_path[p]) {
+         iters[p] = *iter;
+         found[p] = true;
+         n_found++;
+      }
+
+      if (set->nodes[c].first_child) {
+         bson_iter_t child;
+
+         if (bson_iter_recurse(iter, &child)) {
+            n_found += _bson_path_set_walk(set, &set->nodes[c], &child, matched, iters, found);
+         }
+      }
+   }
+
+   return n_found;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_path_set_find --
+ *
+ *       Find each path of @set in @bson, in a single pass over the fields
+ *       of @bson. For the i-th path, found[i] is set to whether it was
+ *       found, and if so iters[i] is initialized on the field, like
+ *       bson_iter_find_descendant().
+ *
+ *       @iters and @found must have room for one element per path.
+ *
+ * Returns:
+ *       The number of paths found.
+ *
+ * Side effects:
+ *       @iters and @found are initialized.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+size_t
+bson_path_set_find(const bson_path_set_t *set, /* IN */
+                   const bson_t *bson,         /* IN */
+                   bson_iter_t *iters,         /* OUT */
+                   bool *found)                /* OUT */
+{
+   bool matched_local[64];
+   bool *matched;
+   bson_iter_t iter;
+   size_t n_found = 0;
+
+   BSON_ASSERT_PARAM(set);
+   BSON_ASSERT_PARAM(bson);
+   BSON_ASSERT(iters || set->n_paths == 0);
+   BSON_ASSERT(found || set->n_paths == 0);
+
+   for (size_t p = 0; p < set->n_paths; p++) {
+      found[p] = false;
+   }
+
+   if (set->n_nodes <= sizeof matched_local / sizeof matched_local[0]) {
+      matched = matched_local;
+      memset(matched, 0, set->n_nodes * sizeof *matched);
+   } else {
+      matched = bson_malloc0(set->n_nodes * sizeof *matched);
+   }
+
+   if (bson_iter_init(&iter, bson)) {
+      n_found = _bson_path_set_walk(set, &set->nodes[0], &iter, matched, iters, found);
+   }
+
+   if (matched != matched_local) {
+      bson_free(matched);
+   }
+
+   return n_found;
+}
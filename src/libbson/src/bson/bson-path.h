@@ -0,0 +1,66 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <bson/bson-prelude.h>
+
+
+#ifndef BSON_PATH_H
+#define BSON_PATH_H
+
+
+#include <bson/bson-iter.h>
+#include <bson/bson-types.h>
+#include <bson/macros.h>
+
+
+BSON_BEGIN_DECLS
+
+
+/*
+ * A dot-notation path like "a.b.c", split once to find the same field in many
+ * documents, like bson_iter_find_descendant().
+ */
+typedef struct _bson_path_t bson_path_t;
+
+/*
+ * Several paths, found together in a single pass over a document.
+ */
+typedef struct _bson_path_set_t bson_path_set_t;
+
+
+BSON_EXPORT(bson_path_t *)
+bson_path_new(const char *dotkey);
+
+BSON_EXPORT(void)
+bson_path_destroy(bson_path_t *path);
+
+BSON_EXPORT(bool)
+bson_path_find(const bson_path_t *path, const bson_t *bson, bson_iter_t *iter);
+
+BSON_EXPORT(bson_path_set_t *)
+bson_path_set_new(const char *const *dotkeys, size_t n_dotkeys);
+
+BSON_EXPORT(void)
+bson_path_set_destroy(bson_path_set_t *set);
+
+BSON_EXPORT(size_t)
+bson_path_set_find(const bson_path_set_t *set, const bson_t *bson, bson_iter_t *iters, bool *found);
+
+
+BSON_END_DECLS
+
+
+#endif /* BSON_PATH_H */
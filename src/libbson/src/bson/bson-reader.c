@@ -14,7 +14,10 @@
  * limitations under the License.
  */
 
+#include <bson/bson-mapped-file-private.h>
 #include <bson/bson.h>
+#include <common-atomic-private.h>
+#include <common-thread-private.h>
 
 #include <mlib/intencode.h>
 
@@ -69,6 +72,7 @@ typedef struct {
    size_t length;
    size_t offset;
    bson_t inline_bson;
+   bson_mapped_file_t file; /* owned by readers from bson_reader_new_from_mapped_file */
 } bson_reader_data_t;
 
 
@@ -616,7 +620,8 @@ _bson_reader_data_tell(bson_reader_data_t *reader) /* IN */
  * bson_reader_destroy --
  *
  *       Release a bson_reader_t created with bson_reader_new_from_data(),
- *       bson_reader_new_from_fd(), or bson_reader_new_from_handle().
+ *       bson_reader_new_from_fd(), bson_reader_new_from_mapped_file(), or
+ *       bson_reader_new_from_handle().
  *
  * Returns:
  *       None.
@@ -647,6 +652,7 @@ bson_reader_destroy(bson_reader_t *reader) /* IN */
       bson_free(handle->data);
    } break;
    case BSON_READER_DATA:
+      _bson_mapped_file_close(&((bson_reader_data_t *)reader)->file);
       break;
    default:
       fprintf(stderr, "No such reader type: %02x\n", reader->type);
@@ -792,6 +798,50 @@ bson_reader_new_from_file(const char *path,    /* IN */
 }
 
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_reader_new_from_mapped_file --
+ *
+ *       Like bson_reader_new_from_file(), but the file is memory-mapped
+ *       and the documents returned by bson_reader_read() point into the
+ *       mapping instead of being copied into a buffer.
+ *
+ * Returns:
+ *       A new bson_reader_t if successful, otherwise NULL and
+ *       @error is set. Free the non-NULL result with
+ *       bson_reader_destroy().
+ *
+ * Side effects:
+ *       @error may be set.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bson_reader_t *
+bson_reader_new_from_mapped_file(const char *path,    /* IN */
+                                 bson_error_t *error) /* OUT */
+{
+   bson_reader_data_t *real;
+   bson_mapped_file_t file;
+
+   BSON_ASSERT(path);
+
+   if (!_bson_mapped_file_open(&file, path, error)) {
+      return NULL;
+   }
+
+   real = BSON_ALIGNED_ALLOC0(bson_reader_data_t);
+   real->type = BSON_READER_DATA;
+   real->data = file.data;
+   real->length = file.len;
+   real->offset = 0;
+   real->file = file;
+
+   return (bson_reader_t *)real;
+}
+
+
 /*
  *--------------------------------------------------------------------------
  *
@@ -815,3 +865,240 @@ bson_reader_reset(bson_reader_t *reader)
 
    real->offset = 0;
 }
+
+
+/*
+ * Reading a sequence of BSON documents on several threads. The threads claim
+ * ranges of about BSON_READER_PARALLEL_CHUNK_SIZE bytes one after another; the
+ * thread claiming a range finds its end by walking the length prefixes, so
+ * that scan is spread over the threads and overlaps with reading. Ranges are
+ * small enough to still be in cache when they are read.
+ */
+
+#define BSON_READER_PARALLEL_CHUNK_SIZE (1 << 18)
+
+typedef struct {
+   const uint8_t *data;
+   size_t length;
+   bson_reader_parallel_cb cb;
+   void *ctx;
+
+   int stop; /* atomic */
+
+   bson_mutex_t mutex;
+   size_t next;           /* offset of the next range */
+   bool is_corrupt;       /* a document at corrupt_offset is invalid */
+   size_t corrupt_offset; /* the earliest one */
+} bson_reader_parallel_t;
+
+typedef struct {
+   bson_reader_parallel_t *parallel;
+   bson_thread_t thread;
+   bool started;
+} bson_reader_parallel_worker_t;
+
+
+/* No range is claimed after a corrupt document is found, the ranges claimed
+ * before it are still read. */
+static void
+_bson_reader_parallel_set_corrupt(bson_reader_parallel_t *parallel, size_t offset)
+{
+   bson_mutex_lock(&parallel->mutex);
+   if (!parallel->is_corrupt || offset < parallel->corrupt_offset) {
+      parallel->is_corrupt = true;
+      parallel->corrupt_offset = offset;
+   }
+   parallel->next = parallel->length;
+   bson_mutex_unlock(&parallel->mutex);
+}
+
+
+/* Claim the next range of whole documents, returns false if there is none. */
+static bool
+_bson_reader_parallel_claim(bson_reader_parallel_t *parallel, size_t *begin, size_t *end)
+{
+   size_t offset;
+   bool is_corrupt = false;
+
+   bson_mutex_lock(&parallel->mutex);
+
+   *begin = offset = parallel->next;
+
+   while (offset < parallel->length && offset - *begin < BSON_READER_PARALLEL_CHUNK_SIZE) {
+      int32_t blen;
+
+      if (parallel->length - offset < 5u || (blen = mlib_read_i32le(parallel->data + offset)) < 5 ||
+          (size_t)blen > parallel->length - offset) {
+         is_corrupt = true;
+         break;
+      }
+
+      offset += (size_t)blen;
+   }
+
+   *end = offset;
+   parallel->next = offset;
+
+   bson_mutex_unlock(&parallel->mutex);
+
+   if (is_corrupt) {
+      _bson_reader_parallel_set_corrupt(parallel, offset);
+   }
+
+   return *begin < *end;
+}
+
+
+static BSON_THREAD_FUN(_bson_reader_parallel_worker, arg)
+{
+   bson_reader_parallel_worker_t *const worker = arg;
+   bson_reader_parallel_t *const parallel = worker->parallel;
+   size_t begin;
+   size_t end;
+
+   while (!mcommon_atomic_int_fetch(&parallel->stop, mcommon_memory_order_relaxed) &&
+          _bson_reader_parallel_claim(parallel, &begin, &end)) {
+      for (size_t offset = begin; offset < end;) {
+         const uint32_t blen = (uint32_t)mlib_read_i32le(parallel->data + offset);
+         bson_t doc;
+
+         if (!bson_init_static(&doc, parallel->data + offset, blen)) {
+            _bson_reader_parallel_set_corrupt(parallel, offset);
+            break;
+         }
+
+         if (!parallel->cb(parallel->ctx, &doc)) {
+            mcommon_atomic_int_exchange(&parallel->stop, 1, mcommon_memory_order_relaxed);
+            break;
+         }
+
+         if (mcommon_atomic_int_fetch(&parallel->stop, mcommon_memory_order_relaxed)) {
+            break;
+         }
+
+         offset += blen;
+      }
+   }
+
+   BSON_THREAD_RETURN;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_reader_read_parallel --
+ *
+ *       Pass each document of the sequence of BSON documents in @data to
+ *       @cb, using @n_threads threads (0 for one per processor) including
+ *       the calling thread. @cb may be called from several threads at once
+ *       and in any order. Reading stops when @cb returns false.
+ *
+ * Returns:
+ *       true if every document was read or @cb stopped reading, otherwise
+ *       false and @error is set.
+ *
+ * Side effects:
+ *       @error may be set.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+bson_reader_read_parallel(const uint8_t *data,        /* IN */
+                          size_t length,              /* IN */
+                          uint32_t n_threads,         /* IN */
+                          bson_reader_parallel_cb cb, /* IN */
+                          void *ctx,                  /* IN */
+                          bson_error_t *error)        /* OUT */
+{
+   bson_reader_parallel_t parallel = {0};
+   bson_reader_parallel_worker_t *workers;
+
+   BSON_ASSERT(data || length == 0);
+   BSON_ASSERT_PARAM(cb);
+
+   if (n_threads == 0) {
+      n_threads = mcommon_thread_n_processors();
+   }
+
+   parallel.data = data;
+   parallel.length = length;
+   parallel.cb = cb;
+   parallel.ctx = ctx;
+   bson_mutex_init(&parallel.mutex);
+
+   workers = bson_malloc0(n_threads * sizeof *workers);
+
+   for (uint32_t i = 0; i < n_threads; i++) {
+      workers[i].parallel = &parallel;
+   }
+
+   /* the calling thread is one of the readers */
+   for (uint32_t i = 1; i < n_threads; i++) {
+      workers[i].started = mcommon_thread_create(&workers[i].thread, _bson_reader_parallel_worker, &workers[i]) == 0;
+   }
+
+   _bson_reader_parallel_worker(&workers[0]);
+
+   for (uint32_t i = 1; i < n_threads; i++) {
+      if (workers[i].started) {
+         mcommon_thread_join(workers[i].thread);
+      }
+   }
+
+   bson_free(workers);
+   bson_mutex_destroy(&parallel.mutex);
+
+   if (parallel.is_corrupt) {
+      bson_set_error(error,
+                     BSON_ERROR_READER,
+                     BSON_ERROR_READER_CORRUPT,
+                     "corrupt BSON document at offset %zu",
+                     parallel.corrupt_offset);
+      return false;
+   }
+
+   return true;
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_reader_read_file_parallel --
+ *
+ *       Like bson_reader_read_parallel(), for the memory-mapped file at
+ *       @path.
+ *
+ * Returns:
+ *       true if every document was read or @cb stopped reading, otherwise
+ *       false and @error is set.
+ *
+ * Side effects:
+ *       @error may be set.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+bool
+bson_reader_read_file_parallel(const char *path,           /* IN */
+                               uint32_t n_threads,         /* IN */
+                               bson_reader_parallel_cb cb, /* IN */
+                               void *ctx,                  /* IN */
+                               bson_error_t *error)        /* OUT */
+{
+   bson_mapped_file_t file;
+   bool ret;
+
+   BSON_ASSERT(path);
+
+   if (!_bson_mapped_file_open(&file, path, error)) {
+      return false;
+   }
+
+   ret = bson_reader_read_parallel(file.data, file.len, n_threads, cb, ctx, error);
+   _bson_mapped_file_close(&file);
+
+   return ret;
+}
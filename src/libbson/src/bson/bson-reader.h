@@ -30,6 +30,7 @@ BSON_BEGIN_DECLS
 
 
 #define BSON_ERROR_READER_BADFD 1
+#define BSON_ERROR_READER_CORRUPT 2
 
 
 /*
@@ -87,6 +88,31 @@ typedef ssize_t(BSON_CALL *bson_reader_read_func_t)(void *handle,  /* IN */
 typedef void(BSON_CALL *bson_reader_destroy_func_t)(void *handle); /* IN */
 
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * bson_reader_parallel_cb --
+ *
+ *       Callback of bson_reader_read_parallel(), called with each document.
+ *       It may be called from several threads at once.
+ *
+ * Parameters:
+ *       @ctx: the context provided to bson_reader_read_parallel().
+ *       @doc: a document, valid until the callback returns.
+ *
+ * Returns:
+ *       false to stop reading.
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+typedef bool(BSON_CALL *bson_reader_parallel_cb)(void *ctx,          /* IN */
+                                                 const bson_t *doc); /* IN */
+
+
 BSON_EXPORT(bson_reader_t *)
 bson_reader_new_from_handle(void *handle, bson_reader_read_func_t rf, bson_reader_destroy_func_t df);
 BSON_EXPORT(bson_reader_t *)
@@ -94,6 +120,8 @@ bson_reader_new_from_fd(int fd, bool close_on_destroy);
 BSON_EXPORT(bson_reader_t *)
 bson_reader_new_from_file(const char *path, bson_error_t *error);
 BSON_EXPORT(bson_reader_t *)
+bson_reader_new_from_mapped_file(const char *path, bson_error_t *error);
+BSON_EXPORT(bson_reader_t *)
 bson_reader_new_from_data(const uint8_t *data, size_t length);
 BSON_EXPORT(void)
 bson_reader_destroy(bson_reader_t *reader);
@@ -107,6 +135,12 @@ BSON_EXPORT(off_t)
 bson_reader_tell(bson_reader_t *reader);
 BSON_EXPORT(void)
 bson_reader_reset(bson_reader_t *reader);
+BSON_EXPORT(bool)
+bson_reader_read_parallel(
+   const uint8_t *data, size_t length, uint32_t n_threads, bson_reader_parallel_cb cb, void *ctx, bson_error_t *error);
+BSON_EXPORT(bool)
+bson_reader_read_file_parallel(
+   const char *path, uint32_t n_threads, bson_reader_parallel_cb cb, void *ctx, bson_error_t *error);
 
 BSON_END_DECLS
 
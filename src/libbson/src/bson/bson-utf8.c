@@ -29,6 +29,55 @@
 #include <string.h>
 
 
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _bson_utf8_ascii_prefix_len --
+ *
+ *       Finds how many bytes at the start of @utf8 are ASCII, and not NULL
+ *       unless @allow_null. Checks eight bytes at a time, so the result is a
+ *       multiple of eight and the remaining bytes must be checked one
+ *       sequence at a time.
+ *
+ * Returns:
+ *       The length of the ASCII prefix found.
+ *
+ * Side effects:
+ *       None.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+static BSON_INLINE size_t
+_bson_utf8_ascii_prefix_len(const char *utf8, /* IN */
+                            size_t utf8_len,  /* IN */
+                            bool allow_null)  /* IN */
+{
+   const uint64_t high_bits = UINT64_C(0x8080808080808080);
+   const uint64_t low_bits = UINT64_C(0x0101010101010101);
+   size_t i;
+
+   for (i = 0; utf8_len - i >= sizeof(uint64_t); i += sizeof(uint64_t)) {
+      uint64_t word;
+      memcpy(&word, &utf8[i], sizeof(word));
+
+      /* Bytes with the high bit set start or continue multi-byte sequences. */
+      uint64_t special = word & high_bits;
+
+      if (!allow_null) {
+         /* Sets the high bit of a byte if any byte of the word is zero. */
+         special |= (word - low_bits) & ~word & high_bits;
+      }
+
+      if (special) {
+         break;
+      }
+   }
+
+   return i;
+}
+
+
 /*
  *--------------------------------------------------------------------------
  *
@@ -76,6 +125,11 @@ bson_utf8_validate(const char *utf8, /* IN */
    BSON_ASSERT(utf8);
 
    for (i = 0; i < utf8_len; i += seq_length) {
+      i += _bson_utf8_ascii_prefix_len(&utf8[i], utf8_len - i, allow_null);
+      if (i == utf8_len) {
+         break;
+      }
+
       mcommon_utf8_get_sequence(&utf8[i], &seq_length, &first_mask);
 
       /*
@@ -109,19 +163,11 @@ bson_utf8_validate(const char *utf8, /* IN */
       }
 
       /*
-       * Check for NULL bytes afterwards.
-       *
-       * Hint: if you want to optimize this function, starting here to do
-       * this in the same pass as the data above would probably be a good
-       * idea. You would add a branch into the inner loop, but save possibly
-       * on cache-line bouncing on larger strings. Just a thought.
+       * Check for NULL bytes. The bytes of multi-byte sequences were checked
+       * to be non-zero above, so only single-byte sequences can be NULL.
        */
-      if (!allow_null) {
-         for (j = 0; j < seq_length; j++) {
-            if (((i + j) > utf8_len) || !utf8[i + j]) {
-               return false;
-            }
-         }
+      if (!allow_null && !utf8[i]) {
+         return false;
       }
 
       /*
@@ -202,7 +202,8 @@ bson_writer_begin(bson_writer_t *writer, /* IN */
       *writer->buf = writer->realloc_func(*writer->buf, *writer->buflen, writer->realloc_func_ctx);
    }
 
-   memset((*writer->buf) + writer->offset + 1, 0, 5);
+   /* an empty document: the length 5 in 4 bytes, then the terminator */
+   memset((*writer->buf) + writer->offset + 1, 0, 4);
    (*writer->buf)[writer->offset] = 5;
 
    *bson = &writer->b;
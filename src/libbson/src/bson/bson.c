@@ -1870,6 +1870,32 @@ bson_init(bson_t *bson)
 }
 
 
+void
+bson_init_arena(bson_t *bson, bson_arena_t *arena)
+{
+   bson_impl_alloc_t *impl = (bson_impl_alloc_t *)bson;
+
+   BSON_ASSERT_PARAM(bson);
+   BSON_ASSERT_PARAM(arena);
+
+   /* the same capacity as inline data */
+   impl->flags = BSON_FLAG_NO_FREE_OBJECT | BSON_FLAG_NO_FREE_DATA | BSON_FLAG_NO_HEAP_DATA;
+   impl->len = 5;
+   impl->parent = NULL;
+   impl->depth = 0;
+   impl->indirect_buffer = NULL;
+   impl->indirect_buflen = NULL;
+   impl->offset = 0;
+   impl->own_buflen = _bson_round_up_alloc_size(BSON_INLINE_DATA_SIZE);
+   impl->own_buffer = bson_arena_realloc(NULL, impl->own_buflen, arena);
+   impl->realloc = bson_arena_realloc;
+   impl->realloc_func_ctx = arena;
+
+   mlib_write_u32le(impl->own_buffer, 5u);
+   impl->own_buffer[4] = '\0';
+}
+
+
 void
 bson_reinit(bson_t *bson)
 {
@@ -2299,6 +2325,13 @@ bson_destroy_with_steal(bson_t *bson, bool steal, uint32_t *length)
    } else {
       bson_impl_alloc_t *const alloc = (bson_impl_alloc_t *)bson;
       ret = alloc->indirect_buffer ? *alloc->indirect_buffer : alloc->own_buffer;
+      if (bson->flags & BSON_FLAG_NO_HEAP_DATA) {
+         /* the caller frees the stolen buffer with bson_free() */
+         uint8_t *const data = ret;
+
+         ret = bson_malloc(bson->len);
+         memcpy(ret, data + alloc->offset, bson->len);
+      }
       if (alloc->indirect_buffer) {
          *alloc->indirect_buffer = NULL;
       }
@@ -20,14 +20,18 @@
 
 #define BSON_INSIDE
 
+#include <bson/bson-arena.h>             // IWYU pragma: export
 #include <bson/bson-bcon.h>              // IWYU pragma: export
 #include <bson/bson-clock.h>             // IWYU pragma: export
 #include <bson/bson-context.h>           // IWYU pragma: export
 #include <bson/bson-decimal128.h>        // IWYU pragma: export
+#include <bson/bson-index.h>             // IWYU pragma: export
 #include <bson/bson-iter.h>              // IWYU pragma: export
 #include <bson/bson-json.h>              // IWYU pragma: export
 #include <bson/bson-keys.h>              // IWYU pragma: export
+#include <bson/bson-mem-cache.h>         // IWYU pragma: export
 #include <bson/bson-oid.h>               // IWYU pragma: export
+#include <bson/bson-path.h>              // IWYU pragma: export
 #include <bson/bson-reader.h>            // IWYU pragma: export
 #include <bson/bson-string.h>            // IWYU pragma: export
 #include <bson/bson-types.h>             // IWYU pragma: export
@@ -205,6 +209,20 @@ BSON_EXPORT(void)
 bson_init(bson_t *b);
 
 
+/**
+ * bson_init_arena:
+ * @b: A pointer to a bson_t.
+ * @arena: A bson_arena_t.
+ *
+ * Initializes a bson_t whose buffer, and the growth of that buffer, are
+ * allocated from @arena. This avoids heap allocations for short-lived
+ * documents. bson_destroy() releases nothing, @b must not be used after
+ * @arena is destroyed.
+ */
+BSON_EXPORT(void)
+bson_init_arena(bson_t *b, bson_arena_t *arena);
+
+
 /**
  * bson_reinit:
  * @b: (inout): A bson_t.
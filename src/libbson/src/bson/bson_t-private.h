@@ -40,6 +40,7 @@ typedef enum {
    BSON_FLAG_CHILD = (1 << 3),
    BSON_FLAG_IN_CHILD = (1 << 4),
    BSON_FLAG_NO_FREE_DATA = (1 << 5), // Set if `bson_destroy` should not free BSON data.
+   BSON_FLAG_NO_HEAP_DATA = (1 << 6), // Set if BSON data was not allocated by `bson_malloc`, e.g. from an arena.
 } bson_flags_t;
 
 
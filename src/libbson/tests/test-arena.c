@@ -0,0 +1,195 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <bson/bson.h>
+
+#include <TestSuite.h>
+#include <test-conveniences.h>
+
+
+static void
+test_arena_realloc(void)
+{
+   uint8_t buffer[256];
+   bson_arena_t arena;
+   uint8_t *a;
+   uint8_t *b;
+   uint8_t *c;
+
+   bson_arena_init(&arena, buffer, sizeof buffer);
+
+   a = bson_arena_realloc(NULL, 10, &arena);
+   BSON_ASSERT(a >= buffer && a < buffer + sizeof buffer);
+   ASSERT_CMPUINT64((uint64_t)((uintptr_t)a % 8u), ==, 0u);
+   memset(a, 'a', 10);
+
+   /* the most recent allocation grows in place */
+   BSON_ASSERT(bson_arena_realloc(a, 64, &arena) == a);
+   memset(a + 10, 'a', 54);
+
+   b = bson_arena_realloc(NULL, 16, &arena);
+   BSON_ASSERT(b > a);
+   memset(b, 'b', 16);
+
+   /* any other is copied */
+   c = bson_arena_realloc(a, 100, &arena);
+   BSON_ASSERT(c != a);
+   for (int i = 0; i < 64; i++) {
+      ASSERT_CMPINT(c[i], ==, 'a');
+   }
+
+   /* a shrink keeps the allocation */
+   BSON_ASSERT(bson_arena_realloc(c, 50, &arena) == c);
+
+   /* beyond the buffer, blocks are allocated */
+   for (int i = 0; i < 100; i++) {
+      uint8_t *mem = bson_arena_realloc(NULL, 1000, &arena);
+
+      BSON_ASSERT(mem < buffer || mem >= buffer + sizeof buffer);
+      memset(mem, 'x', 1000);
+   }
+
+   for (int i = 0; i < 16; i++) {
+      ASSERT_CMPINT(b[i], ==, 'b');
+   }
+
+   BSON_ASSERT(!bson_arena_realloc(b, 0, &arena));
+
+   bson_arena_destroy(&arena);
+
+   /* without a buffer */
+   bson_arena_init(&arena, NULL, 0);
+   a = bson_arena_realloc(NULL, 1u << 20, &arena);
+   memset(a, 'a', 1u << 20);
+   BSON_ASSERT(bson_arena_realloc(a, 2u << 20, &arena) != a);
+   bson_arena_destroy(&arena);
+   bson_arena_destroy(NULL);
+}
+
+
+static void
+test_arena_bson(void)
+{
+   uint8_t buffer[512];
+   bson_arena_t arena;
+   bson_t docs[3];
+   bson_t child;
+   bson_t *expected;
+   uint8_t *stolen;
+   uint32_t len;
+
+   bson_arena_init(&arena, buffer, sizeof buffer);
+
+   for (int i = 0; i < 3; i++) {
+      bson_init_arena(&docs[i], &arena);
+      BSON_ASSERT(bson_empty(&docs[i]));
+   }
+
+   /* documents grow in turn, beyond the buffer */
+   for (int i = 0; i < 100; i++) {
+      for (int d = 0; d < 3; d++) {
+         BSON_ASSERT(BSON_APPEND_INT32(&docs[d], "key", i));
+      }
+   }
+
+   BSON_ASSERT(BSON_APPEND_DOCUMENT_BEGIN(&docs[0], "child", &child));
+   BSON_ASSERT(BSON_APPEND_UTF8(&child, "s", "a string long enough to grow the parent document"));
+   BSON_ASSERT(bson_append_document_end(&docs[0], &child));
+
+   ASSERT_CMPUINT32(bson_count_keys(&docs[0]), ==, 101u);
+   ASSERT_CMPUINT32(bson_count_keys(&docs[2]), ==, 100u);
+   BSON_ASSERT(bson_validate(&docs[0], BSON_VALIDATE_NONE, NULL));
+
+   /* a reinit document stays in the arena */
+   bson_reinit(&docs[1]);
+   BSON_ASSERT(BSON_APPEND_BOOL(&docs[1], "b", true));
+   assert_match_bson(&docs[1], tmp_bson("{'b': true}"), false);
+
+   /* a stolen buffer is copied out of the arena */
+   expected = bson_copy(&docs[2]);
+   stolen = bson_destroy_with_steal(&docs[2], true, &len);
+   BSON_ASSERT(stolen);
+   ASSERT_CMPUINT32(len, ==, expected->len);
+   BSON_ASSERT(memcmp(stolen, bson_get_data(expected), len) == 0);
+   bson_free(stolen);
+   bson_destroy(expected);
+
+   /* and so is one moved with bson_steal() */
+   {
+      bson_t moved;
+
+      expected = bson_copy(&docs[0]);
+      BSON_ASSERT(bson_steal(&moved, &docs[0]));
+      stolen = bson_destroy_with_steal(&moved, true, &len);
+      ASSERT_CMPUINT32(len, ==, expected->len);
+      BSON_ASSERT(memcmp(stolen, bson_get_data(expected), len) == 0);
+      bson_free(stolen);
+      bson_destroy(expected);
+   }
+
+   bson_destroy(&docs[1]);
+   bson_arena_destroy(&arena);
+}
+
+
+static void
+test_arena_writer(void)
+{
+   bson_arena_t arena;
+   bson_writer_t *writer;
+   uint8_t *buf = NULL;
+   size_t buflen = 0;
+   bson_reader_t *reader;
+   const bson_t *doc;
+   bson_t *b;
+   int n = 0;
+
+   bson_arena_init(&arena, NULL, 0);
+
+   writer = bson_writer_new(&buf, &buflen, 0, bson_arena_realloc, &arena);
+
+   for (int i = 0; i < 1000; i++) {
+      BSON_ASSERT(bson_writer_begin(writer, &b));
+      BSON_ASSERT(BSON_APPEND_INT32(b, "i", i));
+      bson_writer_end(writer);
+   }
+
+   reader = bson_reader_new_from_data(buf, bson_writer_get_length(writer));
+
+   while ((doc = bson_reader_read(reader, NULL))) {
+      bson_iter_t iter;
+
+      BSON_ASSERT(bson_iter_init_find(&iter, doc, "i"));
+      ASSERT_CMPINT32(bson_iter_int32(&iter), ==, n);
+      n++;
+   }
+
+   ASSERT_CMPINT(n, ==, 1000);
+
+   bson_reader_destroy(reader);
+   bson_writer_destroy(writer);
+   bson_arena_destroy(&arena);
+}
+
+
+void
+test_arena_install(TestSuite *suite)
+{
+   TestSuite_Add(suite, "/bson/arena/realloc", test_arena_realloc);
+   TestSuite_Add(suite, "/bson/arena/bson", test_arena_bson);
+   TestSuite_Add(suite, "/bson/arena/writer", test_arena_writer);
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <bson/bson.h>
+
+#include <TestSuite.h>
+#include <test-conveniences.h>
+
+
+/* Check that the index finds the same element as a linear search. */
+static void
+_assert_same_as_iter(const bson_index_t *index, const bson_t *bson, const char *dotkey)
+{
+   bson_iter_t iter;
+   bson_iter_t expected;
+   bson_iter_t found;
+   bool has_expected;
+
+   BSON_ASSERT(bson_iter_init(&iter, bson));
+   has_expected = bson_iter_find_descendant(&iter, dotkey, &expected);
+
+   if (!has_expected) {
+      BSON_ASSERT(!bson_index_find_descendant(index, dotkey, &found));
+      return;
+   }
+
+   BSON_ASSERT(bson_index_find_descendant(index, dotkey, &found));
+   ASSERT_CMPSTR(bson_iter_key(&expected), bson_iter_key(&found));
+   ASSERT_CMPUINT32(bson_iter_offset(&expected), ==, bson_iter_offset(&found));
+   BSON_ASSERT(bson_iter_type(&expected) == bson_iter_type(&found));
+   BSON_ASSERT(bson_iter_value(&expected)->value_type == bson_iter_value(&found)->value_type);
+}
+
+
+static void
+test_index_find(void)
+{
+   bson_t bson = BSON_INITIALIZER;
+   bson_index_t *index;
+   bson_iter_t iter;
+   char key[16];
+
+   for (int i = 0; i < 200; i++) {
+      bson_snprintf(key, sizeof key, "field%d", i);
+      BSON_ASSERT(bson_append_int32(&bson, key, -1, i));
+   }
+
+   BSON_ASSERT(bson_append_utf8(&bson, "field7", -1, "repeated", -1));
+
+   index = bson_index_new(&bson);
+   BSON_ASSERT(index);
+
+   for (int i = 199; i >= 0; i--) {
+      bson_snprintf(key, sizeof key, "field%d", i);
+      BSON_ASSERT(bson_index_find(index, key, &iter));
+      ASSERT_CMPSTR(key, bson_iter_key(&iter));
+      ASSERT_CMPINT32(bson_iter_int32(&iter), ==, i);
+
+      /* the iterator continues from the field it was positioned on */
+      if (i < 199) {
+         BSON_ASSERT(bson_iter_next(&iter));
+         ASSERT_CMPINT32(bson_iter_int32(&iter), ==, i + 1);
+      }
+   }
+
+   /* a repeated key finds the first field, like bson_iter_find() */
+   BSON_ASSERT(bson_index_find(index, "field7", &iter));
+   BSON_ASSERT(BSON_ITER_HOLDS_INT32(&iter));
+
+   BSON_ASSERT(bson_index_find_w_len(index, "field12345", 7, &iter));
+   ASSERT_CMPSTR("field12", bson_iter_key(&iter));
+
+   BSON_ASSERT(!bson_index_find(index, "field200", &iter));
+   BSON_ASSERT(!bson_index_find(index, "field", &iter));
+   BSON_ASSERT(!bson_index_find(index, "", &iter));
+
+   bson_index_destroy(index);
+   bson_destroy(&bson);
+}
+
+
+static void
+test_index_find_descendant(void)
+{
+   const char *dotkeys[] = {"a",     "a.b",   "a.b.c", "a.b.c.d", "a.x", "arr", "arr.0", "arr.1.y", "arr.2",
+                            "arr.3", "s",     "s.t",   "e",       "e.f", "",    ".",   "a.",    "a..b"};
+   bson_t *bson;
+   bson_index_t *index;
+
+   bson = tmp_bson(BSON_STR({
+      "a" : {"b" : {"c" : 1, "z" : "zzz"}, "x" : [ 1, 2 ]},
+      "arr" : [ 10, {"y" : "why"}, [ 3, 4 ] ],
+      "s" : "string",
+      "e" : {}
+   }));
+
+   index = bson_index_new(bson);
+   BSON_ASSERT(index);
+
+   for (size_t i = 0; i < sizeof dotkeys / sizeof dotkeys[0]; i++) {
+      _assert_same_as_iter(index, bson, dotkeys[i]);
+   }
+
+   bson_index_destroy(index);
+}
+
+
+static void
+test_index_reinit(void)
+{
+   const char *dotkeys[] = {"name", "n", "sub", "sub.list", "sub.list.0", "sub.list.1", "sub.k", "other"};
+   bson_t *docs[5];
+   bson_index_t *index;
+   bson_iter_t iter;
+
+   /* the same layout with values of other lengths, then other layouts */
+   docs[0] = tmp_bson(BSON_STR({"name" : "a", "n" : 1, "sub" : {"list" : [ "x" ], "k" : true}}));
+   docs[1] = tmp_bson(BSON_STR({"name" : "a longer name", "n" : 2.5, "sub" : {"list" : [ "yyy" ], "k" : null}}));
+   docs[2] = tmp_bson(BSON_STR({"name" : "b", "n" : 3, "sub" : {"list" : [ "x", "z" ], "k" : false}}));
+   docs[3] = tmp_bson(BSON_STR({"name" : "c", "n" : 4, "sub" : 5}));
+   docs[4] = tmp_bson(BSON_STR({"other" : 1}));
+
+   index = bson_index_new(docs[0]);
+   BSON_ASSERT(index);
+
+   for (size_t d = 0; d < sizeof docs / sizeof docs[0]; d++) {
+      BSON_ASSERT(bson_index_reinit(index, docs[d]));
+
+      for (size_t i = 0; i < sizeof dotkeys / sizeof dotkeys[0]; i++) {
+         _assert_same_as_iter(index, docs[d], dotkeys[i]);
+      }
+   }
+
+   BSON_ASSERT(bson_index_reinit(index, docs[1]));
+   BSON_ASSERT(bson_index_find_descendant(index, "sub.list.0", &iter));
+   ASSERT_CMPSTR("yyy", bson_iter_utf8(&iter, NULL));
+
+   bson_index_destroy(index);
+}
+
+
+static void
+test_index_corrupt(void)
+{
+   bson_t *doc = tmp_bson(BSON_STR({"a" : {"b" : 1}}));
+   uint8_t data[64];
+   bson_index_t *index;
+   bson_t corrupt;
+
+   ASSERT_CMPSIZE_T((size_t)doc->len, <=, sizeof data);
+   memcpy(data, bson_get_data(doc), doc->len);
+
+   /* the embedded document is longer than its parent */
+   data[7] = 0x7f;
+   BSON_ASSERT(bson_init_static(&corrupt, data, doc->len));
+
+   BSON_ASSERT(!bson_index_new(&corrupt));
+
+   index = bson_index_new(doc);
+   BSON_ASSERT(index);
+   BSON_ASSERT(!bson_index_reinit(index, &corrupt));
+   BSON_ASSERT(bson_index_reinit(index, doc));
+   _assert_same_as_iter(index, doc, "a.b");
+   bson_index_destroy(index);
+
+   index = bson_index_new(tmp_bson("{}"));
+   BSON_ASSERT(index);
+   _assert_same_as_iter(index, tmp_bson("{}"), "a");
+   bson_index_destroy(index);
+}
+
+
+void
+test_index_install(TestSuite *suite)
+{
+   TestSuite_Add(suite, "/bson/index/find", test_index_find);
+   TestSuite_Add(suite, "/bson/index/find_descendant", test_index_find_descendant);
+   TestSuite_Add(suite, "/bson/index/reinit", test_index_reinit);
+   TestSuite_Add(suite, "/bson/index/corrupt", test_index_corrupt);
+}
@@ -7,6 +7,7 @@
 #include <bson/bson-json-private.h>
 #include <common-json-private.h>
 #include <common-string-private.h>
+#include <common-thread-private.h>
 
 #include <bson/bson.h>
 
@@ -333,7 +334,6 @@ test_bson_as_json_double(void)
    size_t len;
    bson_t *b;
    char *str;
-   char *expected;
 
    b = bson_new();
    BSON_ASSERT(bson_append_double(b, "foo", -1, 123.5));
@@ -343,22 +343,69 @@ test_bson_as_json_double(void)
    BSON_ASSERT(bson_append_double(b, "huge", -1, 1e99));
    str = bson_as_legacy_extended_json(b, &len);
 
-   expected = bson_strdup_printf("{"
-                                 " \"foo\" : 123.5,"
-                                 " \"bar\" : 3.0,"
-                                 " \"baz\" : -1.0,"
-                                 " \"quux\" : 0.03125,"
-                                 " \"huge\" : %.20g }",
-                                 1e99);
-
-   ASSERT_CMPSTR(str, expected);
+   ASSERT_CMPSTR(str,
+                 "{"
+                 " \"foo\" : 123.5,"
+                 " \"bar\" : 3.0,"
+                 " \"baz\" : -1.0,"
+                 " \"quux\" : 0.03125,"
+                 " \"huge\" : 1e+99 }");
 
-   bson_free(expected);
    bson_free(str);
    bson_destroy(b);
 }
 
 
+/* Doubles are printed with the fewest digits that read back as the same
+ * value, in the layout of printf("%.20g"). */
+static void
+test_bson_as_json_double_shortest(void)
+{
+   static const struct {
+      double value;
+      const char *json;
+   } tests[] = {
+      {0.1, "0.1"},
+      {-0.0, "-0.0"},
+      {1.0 / 3.0, "0.3333333333333333"},
+      {0.0001, "0.0001"},
+      {0.00001, "1e-05"},
+      {1e19, "10000000000000000000.0"},
+      {1.5e20, "1.5e+20"},
+      {1.2345678921232e18, "1234567892123200000.0"},
+      {9007199254740993.0, "9007199254740992.0"},
+      {1.7976931348623157e308, "1.7976931348623157e+308"},
+      {2.2250738585072014e-308, "2.2250738585072014e-308"},
+      {5e-324, "5e-324"},
+   };
+
+   for (size_t i = 0; i < sizeof tests / sizeof tests[0]; i++) {
+      bson_t *const b = BCON_NEW("d", BCON_DOUBLE(tests[i].value));
+      char *const str = bson_as_legacy_extended_json(b, NULL);
+      char *const expected = bson_strdup_printf("{ \"d\" : %s }", tests[i].json);
+      char *const canonical = bson_as_canonical_extended_json(b, NULL);
+      char *const expected_canonical = bson_strdup_printf("{ \"d\" : { \"$numberDouble\" : \"%s\" } }", tests[i].json);
+      bson_t *parsed;
+      bson_error_t error;
+
+      ASSERT_CMPSTR(str, expected);
+      ASSERT_CMPSTR(canonical, expected_canonical);
+
+      /* The output reads back as the same value. */
+      parsed = bson_new_from_json((const uint8_t *)canonical, -1, &error);
+      ASSERT_OR_PRINT(parsed, error);
+      BSON_ASSERT(bson_equal(parsed, b));
+
+      bson_destroy(parsed);
+      bson_free(expected_canonical);
+      bson_free(canonical);
+      bson_free(expected);
+      bson_free(str);
+      bson_destroy(b);
+   }
+}
+
+
 static void
 test_bson_as_json_double_nonfinite(void)
 {
@@ -2278,6 +2325,248 @@ test_bson_json_extra_chars(void)
    }
 }
 
+/* bson_new_from_json reads plain JSON without jsonsl, check it agrees with the
+ * jsonsl-based bson_json_reader_t, including on input it must hand over. */
+static void
+test_bson_json_read_fast_path(void)
+{
+   static const struct {
+      const char *json;
+      bool is_plain; /* read without jsonsl */
+   } tests[] = {
+      {"{}", true},
+      {" \t\r\n{ } \n", true},
+      {"{\"a\": 1, \"b\": -2147483648, \"c\": 2147483648, \"d\": -9223372036854775808}", true},
+      {"{\"a\": 9223372036854775807, \"b\": -0, \"c\": 0}", true},
+      {"{\"a\": 1.5, \"b\": -0.0, \"c\": 1e10, \"d\": 1E-5, \"e\": 2.5e+3, \"f\": 0.1}", true},
+      {"{\"a\": 1.7976931348623157e308, \"b\": 5e-324, \"c\": 123456789012345678e-30}", true},
+      {"{\"a\": true, \"b\": false, \"c\": null}", true},
+      {"{\"a\": [], \"b\": [1, [2, {}], {\"c\": [\"d\"]}], \"e\": {\"f\": {}}}", true},
+      {"{\"a\": \"\", \"b\": \"0123456789abcdef0123456789\", \"c\": \"\\\"\\\\\\/\\b\\f\\n\\r\\t\"}", true},
+      {"{\"\\u00e9\\u4e2d\\ud83d\\ude00\": \"\\u0041\\u00E9\\u4E2D\\uD83D\\uDE00 caf\xc3\xa9 \xe4\xb8\xad\"}", true},
+      {"{\"a\": 1, \"a\": 2}", true},
+      {"{\"$a\": 1}", false},
+      {"{\"a\": {\"$oid\": \"0123456789abcdef01234567\"}}", false},
+      {"{\"a\": {\"\\u0024numberLong\": \"1\"}}", false},
+      {"{\"a\": \"\\u0000\"}", false},
+      {"{\"a\": 1e400}", false},
+      {"{\"a\": 9223372036854775808}", false},
+      {"{\"a\": 0.12345678901234567890123}", false},
+      {"{\"a\": \"\xff\"}", false},
+      {"{\"a\": \"\\ud83d\"}", false},
+      {"{\"a\": \"\\ude00\"}", false},
+      {"{\"a\": \"\t\"}", false},
+      {"{\"a\": 01}", false},
+      {"{\"a\": .5}", false},
+      {"{\"a\": 1.}", false},
+      {"{\"a\": tru}", false},
+      {"{\"a\": 1,}", false},
+      {"{\"a\" 1}", false},
+      {"{\"a\": [1 2]}", false},
+      {"{\"a\": [}", false},
+      {"{\"a\": 1]", false},
+      {"{\"a\": 1", false},
+      {"{\"a\": 1} x", false},
+      {"{\"a\": 1}{}", false},
+      {"[1]", false},
+      {"", false},
+   };
+
+   for (size_t i = 0; i < sizeof tests / sizeof tests[0]; i++) {
+      const char *const json = tests[i].json;
+      const size_t len = strlen(json);
+      bson_t *b;
+      bson_t expected = BSON_INITIALIZER;
+      bson_t plain = BSON_INITIALIZER;
+      bson_json_reader_t *reader;
+      bson_error_t error;
+      bson_error_t expected_error;
+      int r;
+
+      ASSERT_CMPINT((int)_bson_json_parse_fast((const uint8_t *)json, len, &plain), ==, (int)tests[i].is_plain);
+
+      reader = bson_json_data_reader_new(false, 0);
+      bson_json_data_reader_ingest(reader, (const uint8_t *)json, len);
+      r = bson_json_reader_read(reader, &expected, &expected_error);
+      bson_json_reader_destroy(reader);
+
+      /* like the reader, a successful read clears the error */
+      memset(&error, 0xff, sizeof error);
+      b = bson_new_from_json((const uint8_t *)json, (ssize_t)len, &error);
+
+      if (r == 1) {
+         ASSERT_OR_PRINT(b, error);
+         BSON_ASSERT(error.domain == 0 && error.code == 0);
+         bson_eq_bson(b, &expected);
+      } else {
+         BSON_ASSERT(!b);
+         if (r == -1) {
+            ASSERT_CMPSTR(error.message, expected_error.message);
+         }
+      }
+
+      if (tests[i].is_plain) {
+         bson_eq_bson(&plain, &expected);
+      }
+
+      bson_destroy(b);
+      bson_destroy(&plain);
+      bson_destroy(&expected);
+   }
+}
+
+typedef struct {
+   bson_mutex_t mutex;
+   int64_t n_docs;
+   int64_t sum;
+   int64_t next; /* the expected value of "i", reading in order */
+   int64_t stop_after;
+} ndjson_test_ctx_t;
+
+
+static bool
+ndjson_test_cb(void *ctx_, const bson_t *doc)
+{
+   ndjson_test_ctx_t *const ctx = ctx_;
+   bson_iter_t iter;
+   int64_t i;
+   bool ret;
+
+   BSON_ASSERT(bson_iter_init_find(&iter, doc, "i"));
+   i = bson_iter_as_int64(&iter);
+
+   bson_mutex_lock(&ctx->mutex);
+   if (ctx->next >= 0) {
+      ASSERT_CMPINT64(i, ==, ctx->next);
+      ctx->next++;
+   }
+   ctx->n_docs++;
+   ctx->sum += i;
+   ret = ctx->n_docs != ctx->stop_after;
+   bson_mutex_unlock(&ctx->mutex);
+
+   return ret;
+}
+
+
+static void
+test_bson_json_read_ndjson(void)
+{
+   const int64_t n = 100000;
+   mcommon_string_append_t json;
+   ndjson_test_ctx_t ctx;
+   bson_error_t error;
+
+   /* about 3.5 MB: several chunks, with blank lines, CRLF and Extended JSON */
+   mcommon_string_new_as_append(&json);
+   for (int64_t i = 0; i < n; i++) {
+      if (i % 3 == 0) {
+         mcommon_string_append_printf(&json, "{\"i\": %" PRId64 ", \"s\": \"line\\n\"}\n", i);
+      } else if (i % 3 == 1) {
+         mcommon_string_append_printf(&json, "  {\"i\": {\"$numberLong\": \"%" PRId64 "\"}}\r\n\n", i);
+      } else {
+         mcommon_string_append_printf(&json, "{\"a\": [1, 2, 3], \"i\": %" PRId64 "}\n", i);
+      }
+   }
+
+   for (int ordered = 0; ordered <= 1; ordered++) {
+      for (uint32_t n_threads = 0; n_threads <= 4; n_threads += 2) {
+         memset(&ctx, 0, sizeof ctx);
+         bson_mutex_init(&ctx.mutex);
+         ctx.next = ordered ? 0 : -1;
+
+         ASSERT_OR_PRINT(bson_json_read_ndjson((const uint8_t *)mcommon_str_from_append(&json),
+                                               mcommon_strlen_from_append(&json),
+                                               n_threads,
+                                               ordered,
+                                               ndjson_test_cb,
+                                               &ctx,
+                                               &error),
+                         error);
+         ASSERT_CMPINT64(ctx.n_docs, ==, n);
+         ASSERT_CMPINT64(ctx.sum, ==, n * (n - 1) / 2);
+
+         /* stop early */
+         ctx.n_docs = ctx.sum = 0;
+         ctx.next = ordered ? 0 : -1;
+         ctx.stop_after = 1000;
+         ASSERT_OR_PRINT(bson_json_read_ndjson((const uint8_t *)mcommon_str_from_append(&json),
+                                               mcommon_strlen_from_append(&json),
+                                               n_threads,
+                                               ordered,
+                                               ndjson_test_cb,
+                                               &ctx,
+                                               &error),
+                         error);
+         if (ordered) {
+            ASSERT_CMPINT64(ctx.n_docs, ==, 1000);
+         } else {
+            ASSERT_CMPINT64(ctx.n_docs, >=, 1000);
+         }
+
+         bson_mutex_destroy(&ctx.mutex);
+      }
+   }
+
+   /* documents before a bad line are read in order, the error has its line */
+   mcommon_string_append(&json, "{\"i\": 1\n{\"i\": 2}\n");
+   for (int ordered = 0; ordered <= 1; ordered++) {
+      memset(&ctx, 0, sizeof ctx);
+      bson_mutex_init(&ctx.mutex);
+      ctx.next = ordered ? 0 : -1;
+
+      BSON_ASSERT(!bson_json_read_ndjson((const uint8_t *)mcommon_str_from_append(&json),
+                                         mcommon_strlen_from_append(&json),
+                                         4,
+                                         ordered,
+                                         ndjson_test_cb,
+                                         &ctx,
+                                         &error));
+      ASSERT_ERROR_CONTAINS(error, BSON_ERROR_JSON, BSON_JSON_ERROR_READ_CORRUPT_JS, "line 133334: ");
+      if (ordered) {
+         ASSERT_CMPINT64(ctx.n_docs, ==, n);
+      }
+
+      bson_mutex_destroy(&ctx.mutex);
+   }
+
+   mcommon_string_from_append_destroy(&json);
+
+   /* empty input */
+   memset(&ctx, 0, sizeof ctx);
+   bson_mutex_init(&ctx.mutex);
+   ASSERT_OR_PRINT(bson_json_read_ndjson((const uint8_t *)"", 0, 2, true, ndjson_test_cb, &ctx, &error), error);
+   ASSERT_OR_PRINT(bson_json_read_ndjson((const uint8_t *)" \n\n", 3, 2, false, ndjson_test_cb, &ctx, &error), error);
+   ASSERT_CMPINT64(ctx.n_docs, ==, 0);
+   bson_mutex_destroy(&ctx.mutex);
+}
+
+
+static bool
+ndjson_count_cb(void *ctx, const bson_t *doc)
+{
+   BSON_ASSERT(!bson_empty(doc));
+   (*(int *)ctx)++;
+   return true;
+}
+
+
+static void
+test_bson_json_read_ndjson_file(void)
+{
+   bson_error_t error;
+   int n_docs = 0;
+
+   ASSERT_OR_PRINT(
+      bson_json_read_ndjson_file(BSON_JSON_DIR "/test.json", 2, true, ndjson_count_cb, &n_docs, &error), error);
+   ASSERT_CMPINT(n_docs, ==, 2);
+
+   BSON_ASSERT(
+      !bson_json_read_ndjson_file(BSON_JSON_DIR "/does-not-exist.json", 2, true, ndjson_count_cb, NULL, &error));
+   ASSERT_CMPUINT32(error.domain, ==, BSON_ERROR_READER);
+   ASSERT_CMPUINT32(error.code, ==, BSON_ERROR_READER_BADFD);
+}
+
 static void
 test_bson_json_date_check(const char *json, int64_t value)
 {
@@ -3799,6 +4088,7 @@ test_json_install(TestSuite *suite)
    TestSuite_Add(suite, "/bson/as_json/int32", test_bson_as_json_int32);
    TestSuite_Add(suite, "/bson/as_json/int64", test_bson_as_json_int64);
    TestSuite_Add(suite, "/bson/as_json/double", test_bson_as_json_double);
+   TestSuite_Add(suite, "/bson/as_json/double_shortest", test_bson_as_json_double_shortest);
    TestSuite_Add(suite, "/bson/as_json/double/nonfinite", test_bson_as_json_double_nonfinite);
    TestSuite_Add(suite, "/bson/as_json/code", test_bson_as_json_code);
    TestSuite_Add(suite, "/bson/as_json/date_time", test_bson_as_json_date_time);
@@ -3868,6 +4158,9 @@ test_json_install(TestSuite *suite)
    TestSuite_Add(suite, "/bson/json/read/null_in_str", test_bson_json_null_in_str);
    TestSuite_Add(suite, "/bson/json/read/merge_multiple", test_bson_json_merge_multiple);
    TestSuite_Add(suite, "/bson/json/read/extra_chars", test_bson_json_extra_chars);
+   TestSuite_Add(suite, "/bson/json/read/fast_path", test_bson_json_read_fast_path);
+   TestSuite_Add(suite, "/bson/json/read/ndjson", test_bson_json_read_ndjson);
+   TestSuite_Add(suite, "/bson/json/read/ndjson/file", test_bson_json_read_ndjson_file);
    TestSuite_Add(suite, "/bson/as_json/multi_object", test_bson_as_json_multi_object);
    TestSuite_Add(suite, "/bson/as_json_with_opts/double", test_bson_as_json_with_opts_double);
    TestSuite_Add(suite, "/bson/as_json_with_opts/utf8", test_bson_as_json_with_opts_utf8);
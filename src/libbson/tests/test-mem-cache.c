@@ -0,0 +1,182 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <bson/bson.h>
+
+#include <common-thread-private.h>
+
+#include <TestSuite.h>
+
+
+#define N_THREADS 4
+#define N_OBJECTS 1000
+
+
+/* The tests call the vtable directly: the test suite already allocated with
+ * the default one, so it cannot be set with bson_mem_set_vtable(). */
+
+static void
+_assert_filled(const uint8_t *mem, size_t len, uint8_t value)
+{
+   for (size_t i = 0; i < len; i++) {
+      ASSERT_CMPUINT(mem[i], ==, value);
+   }
+}
+
+
+static void
+test_mem_cache_alloc(void)
+{
+   const bson_mem_vtable_t *vtable = bson_mem_cache_get_vtable();
+   const size_t sizes[] = {1, 15, 16, 17, 100, 128, 129, 1000, 2048, 2049, 100000};
+   uint8_t *mem;
+
+   for (size_t i = 0; i < sizeof sizes / sizeof sizes[0]; i++) {
+      const size_t size = sizes[i];
+
+      mem = vtable->malloc(size);
+      BSON_ASSERT(mem);
+      ASSERT_CMPUINT64((uint64_t)((uintptr_t)mem % 16u), ==, 0u);
+      memset(mem, 'a', size);
+
+      /* grows across size classes, and into a large allocation */
+      mem = vtable->realloc(mem, size + 3000);
+      _assert_filled(mem, size, 'a');
+      memset(mem, 'b', size + 3000);
+
+      /* shrinks back */
+      mem = vtable->realloc(mem, size);
+      _assert_filled(mem, size, 'b');
+      vtable->free(mem);
+
+      mem = vtable->calloc(size, 3);
+      _assert_filled(mem, size * 3, 0);
+      vtable->free(mem);
+   }
+
+   for (size_t alignment = 8; alignment <= 4096; alignment *= 2) {
+      mem = vtable->aligned_alloc(alignment, 100);
+      ASSERT_CMPUINT64((uint64_t)((uintptr_t)mem % alignment), ==, 0u);
+      memset(mem, 'c', 100);
+      mem = vtable->realloc(mem, 5000);
+      _assert_filled(mem, 100, 'c');
+      vtable->free(mem);
+   }
+
+   BSON_ASSERT(!vtable->calloc(SIZE_MAX / 2u, 4));
+   vtable->free(NULL);
+}
+
+
+static void
+test_mem_cache_stats(void)
+{
+   const bson_mem_vtable_t *vtable = bson_mem_cache_get_vtable();
+   bson_mem_cache_stats_t before;
+   bson_mem_cache_stats_t after;
+   void *objects[N_OBJECTS];
+
+   bson_mem_cache_thread_flush();
+   bson_mem_cache_get_stats(&before);
+
+   for (int i = 0; i < N_OBJECTS; i++) {
+      objects[i] = vtable->malloc(24);
+   }
+
+   for (int i = 0; i < N_OBJECTS; i++) {
+      vtable->free(objects[i]);
+   }
+
+   for (int i = 0; i < 3; i++) {
+      vtable->free(vtable->malloc(10000));
+   }
+
+   bson_mem_cache_thread_flush();
+   bson_mem_cache_get_stats(&after);
+
+   ASSERT_CMPINT64(after.small_allocs - before.small_allocs, ==, N_OBJECTS);
+   ASSERT_CMPINT64(after.small_frees - before.small_frees, ==, N_OBJECTS);
+   ASSERT_CMPINT64(after.large_allocs - before.large_allocs, ==, 3);
+   ASSERT_CMPINT64(after.large_frees - before.large_frees, ==, 3);
+   ASSERT_CMPINT64(after.refills, >, before.refills);
+   ASSERT_CMPINT64(after.releases, >, before.releases);
+   ASSERT_CMPINT64(after.bytes_reserved, >, 0);
+   ASSERT_CMPINT64(after.thread_caches, >=, 1);
+}
+
+
+static BSON_THREAD_FUN(_alloc_worker, data)
+{
+   const bson_mem_vtable_t *vtable = bson_mem_cache_get_vtable();
+   uint8_t **objects = data;
+
+   for (int i = 0; i < N_OBJECTS; i++) {
+      const size_t size = (size_t)(i % 290) * 7u + 1u;
+
+      /* allocate twice, free once, to move objects through the depot */
+      vtable->free(vtable->malloc(size));
+      objects[i] = vtable->malloc(size);
+      memset(objects[i], i % 256, size);
+   }
+
+   BSON_THREAD_RETURN;
+}
+
+
+static void
+test_mem_cache_threads(void)
+{
+   const bson_mem_vtable_t *vtable = bson_mem_cache_get_vtable();
+   uint8_t *objects[N_THREADS][N_OBJECTS];
+   bson_thread_t threads[N_THREADS];
+   bson_mem_cache_stats_t before;
+   bson_mem_cache_stats_t after;
+
+   /* this thread has a cache from the tests above, or gets one now */
+   vtable->free(vtable->malloc(1));
+   bson_mem_cache_get_stats(&before);
+
+   for (int i = 0; i < N_THREADS; i++) {
+      ASSERT_CMPINT(mcommon_thread_create(&threads[i], _alloc_worker, objects[i]), ==, 0);
+   }
+
+   for (int i = 0; i < N_THREADS; i++) {
+      ASSERT_CMPINT(mcommon_thread_join(threads[i]), ==, 0);
+   }
+
+   /* the caches of exited threads were returned */
+   bson_mem_cache_get_stats(&after);
+   ASSERT_CMPINT64(after.thread_caches, ==, before.thread_caches);
+   ASSERT_CMPINT64(after.small_allocs - before.small_allocs, ==, 2 * N_THREADS * N_OBJECTS);
+
+   /* objects are freed by another thread than the one that allocated them */
+   for (int i = 0; i < N_THREADS; i++) {
+      for (int j = 0; j < N_OBJECTS; j++) {
+         _assert_filled(objects[i][j], (size_t)(j % 290) * 7u + 1u, (uint8_t)(j % 256));
+         vtable->free(objects[i][j]);
+      }
+   }
+}
+
+
+void
+test_mem_cache_install(TestSuite *suite)
+{
+   TestSuite_Add(suite, "/bson/mem_cache/alloc", test_mem_cache_alloc);
+   TestSuite_Add(suite, "/bson/mem_cache/stats", test_mem_cache_stats);
+   TestSuite_Add(suite, "/bson/mem_cache/threads", test_mem_cache_threads);
+}
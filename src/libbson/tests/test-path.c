@@ -0,0 +1,179 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <bson/bson.h>
+
+#include <TestSuite.h>
+#include <test-conveniences.h>
+
+
+static const char *const test_dotkeys[] = {
+   "a", "a.b", "a.b.c", "a.b.c.d", "a.x", "a.x.1", "arr", "arr.0", "arr.1.y", "arr.2.1", "arr.3", "s",
+   "s.t", "e", "e.f", "dup", "dup.k", "", ".", "a.", "a..b", "a.b",   "missing", "missing.a"};
+
+#define N_TEST_DOTKEYS (sizeof test_dotkeys / sizeof test_dotkeys[0])
+
+
+static bson_t *
+_test_path_doc(void)
+{
+   return tmp_bson(BSON_STR({
+      "a" : {"b" : {"c" : 1, "z" : "zzz"}, "x" : [ 1, 2 ]},
+      "arr" : [ 10, {"y" : "why"}, [ 3, 4 ] ],
+      "s" : "string",
+      "e" : {},
+      "dup" : 1,
+      "dup" : {"k" : 2},
+      "" : {"" : 3}
+   }));
+}
+
+
+/* Check that @found and @iter match bson_iter_find_descendant(). */
+static void
+_assert_same_as_descendant(const bson_t *bson, const char *dotkey, bool found, const bson_iter_t *iter)
+{
+   bson_iter_t root;
+   bson_iter_t expected;
+
+   BSON_ASSERT(bson_iter_init(&root, bson));
+
+   if (!bson_iter_find_descendant(&root, dotkey, &expected)) {
+      BSON_ASSERT(!found);
+      return;
+   }
+
+   BSON_ASSERT(found);
+   ASSERT_CMPSTR(bson_iter_key(&expected), bson_iter_key(iter));
+   BSON_ASSERT(bson_iter_value(&expected)->value_type == bson_iter_value((bson_iter_t *)iter)->value_type);
+   ASSERT_CMPUINT32(bson_iter_offset(&expected), ==, bson_iter_offset((bson_iter_t *)iter));
+}
+
+
+static void
+test_path_find(void)
+{
+   bson_t *bson = _test_path_doc();
+   bson_iter_t iter;
+
+   for (size_t i = 0; i < N_TEST_DOTKEYS; i++) {
+      bson_path_t *path = bson_path_new(test_dotkeys[i]);
+
+      _assert_same_as_descendant(bson, test_dotkeys[i], bson_path_find(path, bson, &iter), &iter);
+
+      /* a compiled path is reused */
+      _assert_same_as_descendant(bson, test_dotkeys[i], bson_path_find(path, bson, &iter), &iter);
+
+      bson_path_destroy(path);
+   }
+
+   {
+      bson_path_t *path = bson_path_new("arr.1.y");
+
+      BSON_ASSERT(bson_path_find(path, bson, &iter));
+      ASSERT_CMPSTR("why", bson_iter_utf8(&iter, NULL));
+      BSON_ASSERT(!bson_path_find(path, tmp_bson("{'arr': [1, 2]}"), &iter));
+      bson_path_destroy(path);
+   }
+}
+
+
+static void
+test_path_set_find(void)
+{
+   bson_t *bson = _test_path_doc();
+   bson_iter_t iters[N_TEST_DOTKEYS];
+   bool found[N_TEST_DOTKEYS];
+   bson_path_set_t *set;
+   size_t n_found;
+   size_t n_expected = 0;
+
+   set = bson_path_set_new(test_dotkeys, N_TEST_DOTKEYS);
+
+   for (int round = 0; round < 2; round++) {
+      n_found = bson_path_set_find(set, bson, iters, found);
+      n_expected = 0;
+
+      for (size_t i = 0; i < N_TEST_DOTKEYS; i++) {
+         _assert_same_as_descendant(bson, test_dotkeys[i], found[i], &iters[i]);
+         n_expected += found[i];
+      }
+
+      ASSERT_CMPSIZE_T(n_found, ==, n_expected);
+   }
+
+   /* "a.b" is listed twice */
+   BSON_ASSERT(found[1] && found[21]);
+   ASSERT_CMPUINT32(bson_iter_offset(&iters[1]), ==, bson_iter_offset(&iters[21]));
+
+   /* the first "dup" is not a document, like bson_iter_find_descendant() */
+   BSON_ASSERT(found[15]);
+   BSON_ASSERT(!found[16]);
+
+   ASSERT_CMPSIZE_T(bson_path_set_find(set, tmp_bson("{}"), iters, found), ==, 0);
+
+   bson_path_set_destroy(set);
+
+   set = bson_path_set_new(NULL, 0);
+   ASSERT_CMPSIZE_T(bson_path_set_find(set, bson, NULL, NULL), ==, 0);
+   bson_path_set_destroy(set);
+}
+
+
+static void
+test_path_set_find_many(void)
+{
+   bson_t bson = BSON_INITIALIZER;
+   char *dotkeys[100];
+   bson_iter_t iters[100];
+   bool found[100];
+   bson_path_set_t *set;
+
+   /* more paths than the set finds without allocating */
+   for (int i = 0; i < 100; i++) {
+      bson_t child;
+      char key[16];
+
+      bson_snprintf(key, sizeof key, "k%d", i);
+      BSON_ASSERT(BSON_APPEND_DOCUMENT_BEGIN(&bson, key, &child));
+      BSON_ASSERT(BSON_APPEND_INT32(&child, "v", i));
+      BSON_ASSERT(bson_append_document_end(&bson, &child));
+
+      dotkeys[i] = bson_strdup_printf("k%d.v", 99 - i);
+   }
+
+   set = bson_path_set_new((const char *const *)dotkeys, 100);
+   ASSERT_CMPSIZE_T(bson_path_set_find(set, &bson, iters, found), ==, 100);
+
+   for (int i = 0; i < 100; i++) {
+      BSON_ASSERT(found[i]);
+      ASSERT_CMPINT32(bson_iter_int32(&iters[i]), ==, 99 - i);
+      bson_free(dotkeys[i]);
+   }
+
+   bson_path_set_destroy(set);
+   bson_destroy(&bson);
+}
+
+
+void
+test_path_install(TestSuite *suite)
+{
+   TestSuite_Add(suite, "/bson/path/find", test_path_find);
+   TestSuite_Add(suite, "/bson/path/set_find", test_path_set_find);
+   TestSuite_Add(suite, "/bson/path/set_find_many", test_path_set_find_many);
+}
@@ -16,6 +16,7 @@
 
 
 #include <bson/bson.h>
+#include <common-thread-private.h>
 
 #include <TestSuite.h>
 
@@ -300,6 +301,162 @@ test_reader_reset(void)
 }
 
 
+static void
+test_reader_from_mapped_file(void)
+{
+   bson_reader_t *reader;
+   const bson_t *b;
+   bson_error_t error;
+   bool eof;
+
+   reader = bson_reader_new_from_mapped_file(BSON_BINARY_DIR "/stream.bson", &error);
+   ASSERT_OR_PRINT(reader, error);
+
+   for (int pass = 0; pass < 2; pass++) {
+      for (int i = 0; i < 1000; i++) {
+         ASSERT_CMPINT(5 * i, ==, (int)bson_reader_tell(reader));
+         b = bson_reader_read(reader, &eof);
+         BSON_ASSERT(b);
+         ASSERT_CMPUINT32(b->len, ==, 5);
+         BSON_ASSERT(!eof);
+      }
+
+      BSON_ASSERT(!bson_reader_read(reader, &eof));
+      BSON_ASSERT(eof);
+      bson_reader_reset(reader);
+   }
+
+   bson_reader_destroy(reader);
+
+   reader = bson_reader_new_from_mapped_file(BSON_BINARY_DIR "/stream_corrupt.bson", &error);
+   ASSERT_OR_PRINT(reader, error);
+
+   for (int i = 0; i < 1000; i++) {
+      BSON_ASSERT(bson_reader_read(reader, &eof));
+   }
+
+   BSON_ASSERT(!bson_reader_read(reader, &eof));
+   BSON_ASSERT(!eof);
+   bson_reader_destroy(reader);
+
+   BSON_ASSERT(!bson_reader_new_from_mapped_file(BSON_BINARY_DIR "/does-not-exist.bson", &error));
+   ASSERT_CMPUINT32(error.domain, ==, BSON_ERROR_READER);
+   ASSERT_CMPUINT32(error.code, ==, BSON_ERROR_READER_BADFD);
+}
+
+
+typedef struct {
+   bson_mutex_t mutex;
+   int64_t n_docs;
+   int64_t sum;
+   int64_t stop_after;
+} reader_parallel_ctx_t;
+
+
+static bool
+reader_parallel_cb(void *ctx_, const bson_t *doc)
+{
+   reader_parallel_ctx_t *const ctx = ctx_;
+   bson_iter_t iter;
+   int64_t i = 0;
+   bool ret;
+
+   if (bson_iter_init_find(&iter, doc, "i")) {
+      i = bson_iter_int64(&iter);
+   }
+
+   bson_mutex_lock(&ctx->mutex);
+   ctx->n_docs++;
+   ctx->sum += i;
+   ret = ctx->n_docs != ctx->stop_after;
+   bson_mutex_unlock(&ctx->mutex);
+
+   return ret;
+}
+
+
+static void
+test_reader_read_parallel(void)
+{
+   /* about 9 MB, several ranges */
+   const int64_t n = 500000;
+   uint8_t *buf = NULL;
+   size_t buflen = 0;
+   size_t len;
+   bson_writer_t *writer;
+   reader_parallel_ctx_t ctx;
+   bson_error_t error;
+   bson_t *doc;
+
+   writer = bson_writer_new(&buf, &buflen, 0, bson_realloc_ctx, NULL);
+   for (int64_t i = 0; i < n; i++) {
+      BSON_ASSERT(bson_writer_begin(writer, &doc));
+      BSON_ASSERT(BSON_APPEND_INT64(doc, "i", i));
+      bson_writer_end(writer);
+   }
+   len = bson_writer_get_length(writer);
+   bson_writer_destroy(writer);
+
+   for (uint32_t n_threads = 0; n_threads <= 4; n_threads += 2) {
+      memset(&ctx, 0, sizeof ctx);
+      bson_mutex_init(&ctx.mutex);
+
+      ASSERT_OR_PRINT(bson_reader_read_parallel(buf, len, n_threads, reader_parallel_cb, &ctx, &error), error);
+      ASSERT_CMPINT64(ctx.n_docs, ==, n);
+      ASSERT_CMPINT64(ctx.sum, ==, n * (n - 1) / 2);
+
+      /* stop early */
+      ctx.n_docs = 0;
+      ctx.stop_after = 1000;
+      ASSERT_OR_PRINT(bson_reader_read_parallel(buf, len, n_threads, reader_parallel_cb, &ctx, &error), error);
+      ASSERT_CMPINT64(ctx.n_docs, >=, 1000);
+      ASSERT_CMPINT64(ctx.n_docs, <, n);
+
+      bson_mutex_destroy(&ctx.mutex);
+   }
+
+   /* a length prefix past the end */
+   memset(&ctx, 0, sizeof ctx);
+   bson_mutex_init(&ctx.mutex);
+   buf[len - 14u] = 0xff;
+   BSON_ASSERT(!bson_reader_read_parallel(buf, len, 4, reader_parallel_cb, &ctx, &error));
+   ASSERT_ERROR_CONTAINS(error, BSON_ERROR_READER, BSON_ERROR_READER_CORRUPT, "corrupt BSON document at offset");
+   ASSERT_CMPINT64(ctx.n_docs, <, n);
+
+   /* empty input */
+   ctx.n_docs = 0;
+   ASSERT_OR_PRINT(bson_reader_read_parallel(buf, 0, 4, reader_parallel_cb, &ctx, &error), error);
+   ASSERT_CMPINT64(ctx.n_docs, ==, 0);
+   bson_mutex_destroy(&ctx.mutex);
+
+   bson_free(buf);
+}
+
+
+static void
+test_reader_read_file_parallel(void)
+{
+   reader_parallel_ctx_t ctx;
+   bson_error_t error;
+
+   memset(&ctx, 0, sizeof ctx);
+   bson_mutex_init(&ctx.mutex);
+
+   ASSERT_OR_PRINT(
+      bson_reader_read_file_parallel(BSON_BINARY_DIR "/stream.bson", 2, reader_parallel_cb, &ctx, &error), error);
+   ASSERT_CMPINT64(ctx.n_docs, ==, 1000);
+
+   ctx.n_docs = 0;
+   BSON_ASSERT(
+      !bson_reader_read_file_parallel(BSON_BINARY_DIR "/stream_corrupt.bson", 2, reader_parallel_cb, &ctx, &error));
+   ASSERT_ERROR_CONTAINS(
+      error, BSON_ERROR_READER, BSON_ERROR_READER_CORRUPT, "corrupt BSON document at offset 5000");
+   ASSERT_CMPINT64(ctx.n_docs, ==, 1000);
+
+   bson_mutex_destroy(&ctx.mutex);
+}
+
+
 void
 test_reader_install(TestSuite *suite)
 {
@@ -314,4 +471,7 @@ test_reader_install(TestSuite *suite)
    TestSuite_Add(suite, "/bson/reader/new_from_handle_corrupt", test_reader_from_handle_corrupt);
    TestSuite_Add(suite, "/bson/reader/grow_buffer", test_reader_grow_buffer);
    TestSuite_Add(suite, "/bson/reader/reset", test_reader_reset);
+   TestSuite_Add(suite, "/bson/reader/new_from_mapped_file", test_reader_from_mapped_file);
+   TestSuite_Add(suite, "/bson/reader/read_parallel", test_reader_read_parallel);
+   TestSuite_Add(suite, "/bson/reader/read_file_parallel", test_reader_read_file_parallel);
 }
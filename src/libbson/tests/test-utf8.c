@@ -56,6 +56,35 @@ test_bson_utf8_validate(void)
 }
 
 
+/* Test strings longer than the eight bytes checked at once for ASCII, with
+ * special bytes at every offset. */
+static void
+test_bson_utf8_validate_long(void)
+{
+   char str[41];
+
+   for (size_t i = 0; i < sizeof str; i++) {
+      memset(str, 'a', sizeof str);
+      BSON_ASSERT(bson_utf8_validate(str, sizeof str, false));
+
+      str[i] = '\0';
+      BSON_ASSERT(!bson_utf8_validate(str, sizeof str, false));
+      BSON_ASSERT(bson_utf8_validate(str, sizeof str, true));
+
+      str[i] = (char)0x80;
+      BSON_ASSERT(!bson_utf8_validate(str, sizeof str, true));
+
+      /* A complete two-byte sequence, or one cut off at the end. */
+      str[i] = (char)0xc3;
+      if (i + 1 < sizeof str) {
+         str[i + 1] = (char)0xa9;
+         BSON_ASSERT(bson_utf8_validate(str, sizeof str, false));
+      } else {
+         BSON_ASSERT(!bson_utf8_validate(str, sizeof str, true));
+      }
+   }
+}
+
 static void
 test_bson_utf8_escape_for_json(void)
 {
@@ -142,6 +171,46 @@ test_bson_utf8_escape_for_json(void)
 }
 
 
+/* Test strings longer than the eight bytes checked at once for escapes, with
+ * a special byte at every offset. */
+static void
+test_bson_utf8_escape_for_json_long(void)
+{
+   static const struct {
+      const char *in;
+      const char *out;
+   } specials[] = {
+      {"\"", "\\\""},
+      {"\\", "\\\\"},
+      {"\n", "\\n"},
+      {"\x1f", "\\u001f"},
+      {"\xc0\x80", "\\u0000"},
+      {" ", " "},
+      {"\x7f", "\x7f"},
+      {"\xc3\xa9", "\xc3\xa9"},
+   };
+   char in[41];
+   char out[64];
+
+   for (size_t s = 0; s < sizeof specials / sizeof specials[0]; s++) {
+      const size_t in_len = strlen(specials[s].in);
+      const size_t out_len = strlen(specials[s].out);
+
+      for (size_t i = 0; i + in_len <= sizeof in; i++) {
+         memset(in, 'a', sizeof in);
+         memcpy(in + i, specials[s].in, in_len);
+
+         memset(out, 'a', sizeof in - in_len + out_len);
+         memcpy(out + i, specials[s].out, out_len);
+         out[sizeof in - in_len + out_len] = '\0';
+
+         char *const str = bson_utf8_escape_for_json(in, (ssize_t)sizeof in);
+         ASSERT_CMPSTR(str, out);
+         bson_free(str);
+      }
+   }
+}
+
 static void
 test_bson_utf8_invalid(void)
 {
@@ -308,9 +377,11 @@ void
 test_utf8_install(TestSuite *suite)
 {
    TestSuite_Add(suite, "/bson/utf8/validate", test_bson_utf8_validate);
+   TestSuite_Add(suite, "/bson/utf8/validate_long", test_bson_utf8_validate_long);
    TestSuite_Add(suite, "/bson/utf8/invalid", test_bson_utf8_invalid);
    TestSuite_Add(suite, "/bson/utf8/nil", test_bson_utf8_nil);
    TestSuite_Add(suite, "/bson/utf8/escape_for_json", test_bson_utf8_escape_for_json);
+   TestSuite_Add(suite, "/bson/utf8/escape_for_json_long", test_bson_utf8_escape_for_json_long);
    TestSuite_Add(suite, "/bson/utf8/get_char_next_char", test_bson_utf8_get_char);
    TestSuite_Add(suite, "/bson/utf8/from_unichar", test_bson_utf8_from_unichar);
    TestSuite_Add(suite, "/bson/utf8/non_shortest", test_bson_utf8_non_shortest);
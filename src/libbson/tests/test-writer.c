@@ -178,6 +178,35 @@ test_bson_writer_null_realloc_2(void)
    bson_free(buf);
 }
 
+/* Documents that exactly fill the buffer write nothing past its end. */
+static void
+test_bson_writer_exact_fit(void)
+{
+   uint8_t *buf = bson_malloc(16);
+   size_t buflen = 10;
+   bson_writer_t *writer;
+   bson_t *b;
+
+   memset(buf, 0xAA, 16);
+
+   writer = bson_writer_new(&buf, &buflen, 0, NULL, NULL);
+   for (int i = 0; i < 2; i++) {
+      BSON_ASSERT(bson_writer_begin(writer, &b));
+      bson_writer_end(writer);
+   }
+
+   BSON_ASSERT(!bson_writer_begin(writer, &b));
+   ASSERT_CMPSIZE_T(bson_writer_get_length(writer), ==, 10u);
+   bson_writer_destroy(writer);
+
+   for (int i = 10; i < 16; i++) {
+      ASSERT_CMPUINT(buf[i], ==, 0xAA);
+   }
+
+   bson_free(buf);
+}
+
+
 void
 test_writer_install(TestSuite *suite)
 {
@@ -186,4 +215,5 @@ test_writer_install(TestSuite *suite)
    TestSuite_Add(suite, "/bson/writer/empty_sequence", test_bson_writer_empty_sequence);
    TestSuite_Add(suite, "/bson/writer/null_realloc", test_bson_writer_null_realloc);
    TestSuite_Add(suite, "/bson/writer/null_realloc_2", test_bson_writer_null_realloc_2);
+   TestSuite_Add(suite, "/bson/writer/exact_fit", test_bson_writer_exact_fit);
 }
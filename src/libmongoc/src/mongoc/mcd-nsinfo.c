@@ -119,6 +119,36 @@ mcd_nsinfo_find(const mcd_nsinfo_t *self, const char *ns)
    return found->index;
 }
 
+const char *
+mcd_nsinfo_intern(mcd_nsinfo_t *self, const char *ns, bson_error_t *error)
+{
+   BSON_ASSERT_PARAM(self);
+   BSON_ASSERT_PARAM(ns);
+   BSON_OPTIONAL_PARAM(error);
+
+   ns_to_index_t *found;
+
+   mlib_diagnostic_push();
+   mlib_disable_constant_conditional_expression_warnings();
+   HASH_FIND_STR(self->n2i, ns, found);
+   mlib_diagnostic_pop();
+
+   if (found == NULL) {
+      if (mcd_nsinfo_append(self, ns, error) < 0) {
+         return NULL;
+      }
+
+      mlib_diagnostic_push();
+      mlib_disable_constant_conditional_expression_warnings();
+      HASH_FIND_STR(self->n2i, ns, found);
+      mlib_diagnostic_pop();
+
+      BSON_ASSERT(found);
+   }
+
+   return found->ns;
+}
+
 uint32_t
 mcd_nsinfo_get_bson_size(const char *ns)
 {
@@ -40,6 +40,11 @@ mcd_nsinfo_append(mcd_nsinfo_t *self, const char *ns, bson_error_t *error);
 int32_t
 mcd_nsinfo_find(const mcd_nsinfo_t *self, const char *ns);
 
+// `mcd_nsinfo_intern` returns the copy of `ns` stored in `self`, appending `ns` if it is not yet present.
+// The returned string is valid until `self` is destroyed. Returns NULL on error.
+const char *
+mcd_nsinfo_intern(mcd_nsinfo_t *self, const char *ns, bson_error_t *error);
+
 // `mcd_nsinfo_get_bson_size` returns the size of the BSON document { "ns": "<ns>" }
 // Useful for checking whether a namespace can be added without exceeding a size limit.
 uint32_t
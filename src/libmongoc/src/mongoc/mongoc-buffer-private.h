@@ -66,6 +66,9 @@ _mongoc_buffer_destroy(mongoc_buffer_t *buffer);
 void
 _mongoc_buffer_clear(mongoc_buffer_t *buffer, bool zero);
 
+void
+_mongoc_buffer_shrink(mongoc_buffer_t *buffer, size_t datalen);
+
 
 BSON_END_DECLS
 
@@ -127,6 +127,32 @@ _mongoc_buffer_clear(mongoc_buffer_t *buffer, bool zero)
 }
 
 
+/**
+ * _mongoc_buffer_shrink:
+ * @buffer: A mongoc_buffer_t.
+ * @datalen: The new capacity of @buffer.
+ *
+ * Releases memory held by @buffer by reducing its capacity to @datalen. The
+ * contents of @buffer are discarded. Does nothing if the capacity of @buffer is
+ * already @datalen or less.
+ */
+void
+_mongoc_buffer_shrink(mongoc_buffer_t *buffer, size_t datalen)
+{
+   BSON_ASSERT_PARAM(buffer);
+   BSON_ASSERT(datalen);
+
+   buffer->len = 0;
+
+   if (buffer->datalen <= datalen) {
+      return;
+   }
+
+   buffer->data = (uint8_t *)buffer->realloc_func(buffer->data, datalen, buffer->realloc_data);
+   buffer->datalen = datalen;
+}
+
+
 bool
 _mongoc_buffer_append(mongoc_buffer_t *buffer, const uint8_t *data, size_t data_size)
 {
@@ -0,0 +1,539 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mongoc/mongoc-bulk-inserter.h>
+
+#include <common-thread-private.h>
+#include <mongoc/mongoc-array-private.h>
+#include <mongoc/mongoc-error-private.h>
+#include <mongoc/mongoc-thread-private.h>
+
+#include <mongoc/mongoc-bulkwrite.h>
+#include <mongoc/mongoc-error.h>
+
+#include <bson/bson.h>
+
+#include <mlib/intencode.h>
+
+#include <stdlib.h>
+
+#define MONGOC_BULK_INSERTER_DEFAULT_MAX_DOCUMENTS 1000
+#define MONGOC_BULK_INSERTER_DEFAULT_MAX_BYTES (16 * 1024 * 1024)
+#define MONGOC_BULK_INSERTER_DEFAULT_FLUSH_INTERVAL_MS 1000
+
+typedef struct {
+   // `data` holds the documents back to back.
+   mongoc_array_t data;
+   // `doc_ctxs` holds the `doc_ctx` passed with each document.
+   mongoc_array_t doc_ctxs;
+} docs_t;
+
+struct _mongoc_bulk_inserter_t {
+   mongoc_client_pool_t *pool;
+   char *ns;
+   int64_t max_documents;
+   int64_t max_bytes;
+   int64_t flush_interval_ms;
+   int64_t max_buffered_bytes;
+   mongoc_bulk_inserter_result_cb_t cb;
+   void *cb_ctx;
+
+   bson_mutex_t mutex;
+   // Broadcast when documents are added, a flush is requested, a batch is reported, or the inserter shuts down.
+   mongoc_cond_t cond;
+   bson_thread_t thread;
+   docs_t pending;
+   // Monotonic time the oldest pending document was added.
+   int64_t pending_since;
+   // `buffered_bytes` counts pending documents and documents being written. Bounded by `max_buffered_bytes`.
+   int64_t buffered_bytes;
+   // Running counts of documents added, taken by the background thread, and reported to the callback.
+   uint64_t n_added;
+   uint64_t n_taken;
+   uint64_t n_reported;
+   // Documents added before `flush_target` are written without waiting for a threshold.
+   uint64_t flush_target;
+   bool shutdown;
+};
+
+
+static void
+_docs_init(docs_t *docs)
+{
+   _mongoc_array_init(&docs->data, sizeof(uint8_t));
+   _mongoc_array_init(&docs->doc_ctxs, sizeof(void *));
+}
+
+
+static void
+_docs_destroy(docs_t *docs)
+{
+   _mongoc_array_destroy(&docs->data);
+   _mongoc_array_destroy(&docs->doc_ctxs);
+}
+
+
+static bool
+_parse_opts(mongoc_bulk_inserter_t *inserter, const bson_t *opts, bson_error_t *error)
+{
+   bson_iter_t iter;
+
+   if (!opts) {
+      return true;
+   }
+
+   BSON_ASSERT(bson_iter_init(&iter, opts));
+   while (bson_iter_next(&iter)) {
+      const char *const key = bson_iter_key(&iter);
+      int64_t *dst;
+
+      if (0 == strcmp(key, "maxDocuments")) {
+         dst = &inserter->max_documents;
+      } else if (0 == strcmp(key, "maxBytes")) {
+         dst = &inserter->max_bytes;
+      } else if (0 == strcmp(key, "flushIntervalMS")) {
+         dst = &inserter->flush_interval_ms;
+      } else if (0 == strcmp(key, "maxBufferedBytes")) {
+         dst = &inserter->max_buffered_bytes;
+      } else {
+         _mongoc_set_error(
+            error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Invalid bulk inserter option: \"%s\"", key);
+         return false;
+      }
+
+      if (!BSON_ITER_HOLDS_NUMBER(&iter) || bson_iter_as_int64(&iter) <= 0) {
+         _mongoc_set_error(error,
+                           MONGOC_ERROR_COMMAND,
+                           MONGOC_ERROR_COMMAND_INVALID_ARG,
+                           "Bulk inserter option \"%s\" must be a positive number",
+                           key);
+         return false;
+      }
+
+      // Durations are converted to microseconds.
+      if (dst == &inserter->flush_interval_ms && bson_iter_as_int64(&iter) > INT64_MAX / 1000) {
+         _mongoc_set_error(error,
+                           MONGOC_ERROR_COMMAND,
+                           MONGOC_ERROR_COMMAND_INVALID_ARG,
+                           "Bulk inserter option \"%s\" must be at most %" PRId64,
+                           key,
+                           INT64_MAX / 1000);
+         return false;
+      }
+
+      *dst = bson_iter_as_int64(&iter);
+   }
+
+   return true;
+}
+
+
+// `_report` calls the result callback for each document of a written batch, in the order the documents were added.
+static void
+_report(mongoc_bulk_inserter_t *inserter,
+        const docs_t *batch,
+        const size_t *model_to_doc,
+        size_t n_models,
+        const mongoc_bulkwritereturn_t *bwr,
+        const bson_error_t *doc_errors)
+{
+   const size_t n_docs = batch->doc_ctxs.len;
+   // `outcomes[i]` is NULL if document `i` was inserted, or the error to report.
+   const bson_error_t **outcomes = bson_malloc0(n_docs * sizeof(*outcomes));
+   bson_error_t *write_errors = bson_malloc0(n_models * sizeof(*write_errors));
+   bson_error_t top_level_error = {0};
+   bson_error_t write_concern_error = {0};
+   bson_iter_t iter;
+   bson_iter_t error_iter;
+
+   // Documents rejected before the write have an error already.
+   for (size_t i = 0; i < n_docs; i++) {
+      if (doc_errors[i].code != 0) {
+         outcomes[i] = &doc_errors[i];
+      }
+   }
+
+   // Without verbose results, a model without a write error is only known to be inserted if there was no top-level
+   // error. Results are verbose, so inserted models are listed.
+   bool *inserted = bson_malloc0(n_models * sizeof(*inserted) + 1u);
+   if (bwr->res && bson_iter_init(&iter, mongoc_bulkwriteresult_insertresults(bwr->res))) {
+      while (bson_iter_next(&iter)) {
+         const size_t idx = (size_t)strtoull(bson_iter_key(&iter), NULL, 10);
+         if (idx < n_models) {
+            inserted[idx] = true;
+         }
+      }
+   }
+
+   if (bwr->exc) {
+      mongoc_bulkwriteexception_error(bwr->exc, &top_level_error);
+
+      if (bson_iter_init(&iter, mongoc_bulkwriteexception_writeerrors(bwr->exc))) {
+         while (bson_iter_next(&iter)) {
+            const size_t idx = (size_t)strtoull(bson_iter_key(&iter), NULL, 10);
+            uint32_t code = 0;
+            const char *message = "";
+
+            if (idx >= n_models || !BSON_ITER_HOLDS_DOCUMENT(&iter) || !bson_iter_recurse(&iter, &error_iter)) {
+               continue;
+            }
+            while (bson_iter_next(&error_iter)) {
+               if (0 == strcmp(bson_iter_key(&error_iter), "code") && BSON_ITER_HOLDS_NUMBER(&error_iter)) {
+                  code = (uint32_t)bson_iter_as_int64(&error_iter);
+               } else if (0 == strcmp(bson_iter_key(&error_iter), "message") && BSON_ITER_HOLDS_UTF8(&error_iter)) {
+                  message = bson_iter_utf8(&error_iter, NULL);
+               }
+            }
+
+            _mongoc_set_error(&write_errors[idx], MONGOC_ERROR_SERVER, code, "%s", message);
+            outcomes[model_to_doc[idx]] = &write_errors[idx];
+         }
+      }
+
+      // A write concern error applies to all documents of the batch that were written.
+      if (bson_iter_init(&iter, mongoc_bulkwriteexception_writeconcernerrors(bwr->exc)) && bson_iter_next(&iter) &&
+          BSON_ITER_HOLDS_DOCUMENT(&iter) && bson_iter_recurse(&iter, &error_iter)) {
+         uint32_t code = 0;
+         const char *message = "";
+
+         while (bson_iter_next(&error_iter)) {
+            if (0 == strcmp(bson_iter_key(&error_iter), "code") && BSON_ITER_HOLDS_NUMBER(&error_iter)) {
+               code = (uint32_t)bson_iter_as_int64(&error_iter);
+            } else if (0 == strcmp(bson_iter_key(&error_iter), "message") && BSON_ITER_HOLDS_UTF8(&error_iter)) {
+               message = bson_iter_utf8(&error_iter, NULL);
+            }
+         }
+
+         _mongoc_set_error(&write_concern_error, MONGOC_ERROR_WRITE_CONCERN, code, "%s", message);
+      }
+   }
+
+   for (size_t m = 0; m < n_models; m++) {
+      const size_t i = model_to_doc[m];
+
+      if (outcomes[i]) {
+         continue;
+      }
+
+      if (!inserted[m] && top_level_error.code != 0) {
+         outcomes[i] = &top_level_error;
+      } else if (write_concern_error.code != 0) {
+         outcomes[i] = &write_concern_error;
+      }
+   }
+
+   // The callback may be replaced by another thread: read it and its context together.
+   bson_mutex_lock(&inserter->mutex);
+   const mongoc_bulk_inserter_result_cb_t cb = inserter->cb;
+   void *const cb_ctx = inserter->cb_ctx;
+   bson_mutex_unlock(&inserter->mutex);
+
+   if (cb) {
+      for (size_t i = 0; i < n_docs; i++) {
+         cb(_mongoc_array_index(&batch->doc_ctxs, void *, i), outcomes[i], cb_ctx);
+      }
+   }
+
+   bson_free(inserted);
+   bson_free(write_errors);
+   bson_free(outcomes);
+}
+
+
+// `_write` inserts a batch of documents with one unordered bulk write. The bulk write splits the documents into as many
+// `bulkWrite` commands as the server size limits require.
+static void
+_write(mongoc_bulk_inserter_t *inserter, const docs_t *batch)
+{
+   const size_t n_docs = batch->doc_ctxs.len;
+   bson_error_t *doc_errors = bson_malloc0(n_docs * sizeof(*doc_errors));
+   size_t *model_to_doc = bson_malloc0(n_docs * sizeof(*model_to_doc) + 1u);
+   size_t n_models = 0;
+   mongoc_bulkwritereturn_t bwr = {0};
+
+   mongoc_client_t *const client = mongoc_client_pool_pop(inserter->pool);
+   mongoc_bulkwrite_t *const bw = mongoc_client_bulkwrite_new(client);
+   mongoc_bulkwriteopts_t *const opts = mongoc_bulkwriteopts_new();
+
+   // Insert results identify which documents were inserted if the bulk write fails part way.
+   mongoc_bulkwriteopts_set_ordered(opts, false);
+   mongoc_bulkwriteopts_set_verboseresults(opts, true);
+
+   {
+      size_t offset = 0;
+
+      for (size_t i = 0; i < n_docs; i++) {
+         const uint8_t *const data = (const uint8_t *)batch->data.data + offset;
+         const uint32_t len = mlib_read_u32le(data);
+         bson_t doc;
+
+         offset += len;
+
+         BSON_ASSERT(bson_init_static(&doc, data, len));
+         if (mongoc_bulkwrite_append_insertone(bw, inserter->ns, &doc, NULL, &doc_errors[i])) {
+            model_to_doc[n_models++] = i;
+         }
+      }
+   }
+
+   if (n_models > 0) {
+      bwr = mongoc_bulkwrite_execute(bw, opts);
+   }
+
+   _report(inserter, batch, model_to_doc, n_models, &bwr, doc_errors);
+
+   mongoc_bulkwriteresult_destroy(bwr.res);
+   mongoc_bulkwriteexception_destroy(bwr.exc);
+   mongoc_bulkwriteopts_destroy(opts);
+   mongoc_bulkwrite_destroy(bw);
+   mongoc_client_pool_push(inserter->pool, client);
+   bson_free(model_to_doc);
+   bson_free(doc_errors);
+}
+
+
+// `_must_write` returns true if the pending documents reached a threshold. Requires the mutex.
+static bool
+_must_write(const mongoc_bulk_inserter_t *inserter)
+{
+   const docs_t *const pending = &inserter->pending;
+
+   if (pending->doc_ctxs.len == 0) {
+      return false;
+   }
+
+   return inserter->shutdown || inserter->flush_target > inserter->n_taken ||
+          (int64_t)pending->doc_ctxs.len >= inserter->max_documents ||
+          (int64_t)pending->data.len >= inserter->max_bytes ||
+          bson_get_monotonic_time() - inserter->pending_since >= inserter->flush_interval_ms * 1000;
+}
+
+
+static BSON_THREAD_FUN(_background_thread, inserter_void)
+{
+   mongoc_bulk_inserter_t *const inserter = (mongoc_bulk_inserter_t *)inserter_void;
+   docs_t batch;
+
+   _docs_init(&batch);
+
+   bson_mutex_lock(&inserter->mutex);
+   while (true) {
+      if (!_must_write(inserter)) {
+         if (inserter->shutdown) {
+            break;
+         }
+
+         if (inserter->pending.doc_ctxs.len == 0) {
+            mongoc_cond_wait(&inserter->cond, &inserter->mutex);
+         } else {
+            // Wait until the oldest pending document is due.
+            const int64_t due = inserter->pending_since + inserter->flush_interval_ms * 1000;
+            const int64_t timeout_ms = (due - bson_get_monotonic_time()) / 1000 + 1;
+            mongoc_cond_timedwait(&inserter->cond, &inserter->mutex, timeout_ms);
+         }
+         continue;
+      }
+
+      // Take all pending documents. Documents added while the batch is written start the next batch.
+      {
+         const docs_t tmp = inserter->pending;
+         inserter->pending = batch;
+         batch = tmp;
+      }
+      inserter->n_taken += batch.doc_ctxs.len;
+      inserter->pending_since = bson_get_monotonic_time();
+      bson_mutex_unlock(&inserter->mutex);
+
+      _write(inserter, &batch);
+
+      bson_mutex_lock(&inserter->mutex);
+      inserter->n_reported += batch.doc_ctxs.len;
+      inserter->buffered_bytes -= (int64_t)batch.data.len;
+      _mongoc_array_clear(&batch.data);
+      _mongoc_array_clear(&batch.doc_ctxs);
+      // Wake threads blocked on backpressure or waiting for a flush.
+      mongoc_cond_broadcast(&inserter->cond);
+   }
+   bson_mutex_unlock(&inserter->mutex);
+
+   _docs_destroy(&batch);
+
+   BSON_THREAD_RETURN;
+}
+
+
+mongoc_bulk_inserter_t *
+mongoc_bulk_inserter_new(mongoc_client_pool_t *pool, const char *ns, const bson_t *opts, bson_error_t *error)
+{
+   BSON_ASSERT_PARAM(pool);
+   BSON_ASSERT_PARAM(ns);
+   BSON_OPTIONAL_PARAM(opts);
+
+   mongoc_bulk_inserter_t *inserter = bson_malloc0(sizeof(*inserter));
+
+   inserter->pool = pool;
+   inserter->ns = bson_strdup(ns);
+   inserter->max_documents = MONGOC_BULK_INSERTER_DEFAULT_MAX_DOCUMENTS;
+   inserter->max_bytes = MONGOC_BULK_INSERTER_DEFAULT_MAX_BYTES;
+   inserter->flush_interval_ms = MONGOC_BULK_INSERTER_DEFAULT_FLUSH_INTERVAL_MS;
+   bson_mutex_init(&inserter->mutex);
+   mongoc_cond_init(&inserter->cond);
+   _docs_init(&inserter->pending);
+
+   if (!strchr(ns, '.')) {
+      _mongoc_set_error(error,
+                        MONGOC_ERROR_COMMAND,
+                        MONGOC_ERROR_COMMAND_INVALID_ARG,
+                        "Invalid namespace \"%s\": expected \"<database>.<collection>\"",
+                        ns);
+      goto fail;
+   }
+
+   if (!_parse_opts(inserter, opts, error)) {
+      goto fail;
+   }
+
+   if (inserter->max_buffered_bytes == 0) {
+      inserter->max_buffered_bytes = 4 * inserter->max_bytes;
+   }
+
+   {
+      const int ret = mcommon_thread_create(&inserter->thread, _background_thread, inserter);
+      if (ret != 0) {
+         char errmsg_buf[BSON_ERROR_BUFFER_SIZE];
+         char *errmsg = bson_strerror_r(ret, errmsg_buf, sizeof errmsg_buf);
+         _mongoc_set_error(error,
+                           MONGOC_ERROR_CLIENT,
+                           MONGOC_ERROR_CLIENT_NOT_READY,
+                           "Failed to start bulk inserter thread. Error: %s",
+                           errmsg);
+         goto fail;
+      }
+   }
+
+   return inserter;
+
+fail:
+   _docs_destroy(&inserter->pending);
+   mongoc_cond_destroy(&inserter->cond);
+   bson_mutex_destroy(&inserter->mutex);
+   bson_free(inserter->ns);
+   bson_free(inserter);
+   return NULL;
+}
+
+
+void
+mongoc_bulk_inserter_set_result_cb(mongoc_bulk_inserter_t *inserter, mongoc_bulk_inserter_result_cb_t cb, void *cb_ctx)
+{
+   BSON_ASSERT_PARAM(inserter);
+
+   bson_mutex_lock(&inserter->mutex);
+   inserter->cb = cb;
+   inserter->cb_ctx = cb_ctx;
+   bson_mutex_unlock(&inserter->mutex);
+}
+
+
+bool
+mongoc_bulk_inserter_insert(mongoc_bulk_inserter_t *inserter, const bson_t *doc, void *doc_ctx, bson_error_t *error)
+{
+   BSON_ASSERT_PARAM(inserter);
+   BSON_ASSERT_PARAM(doc);
+
+   if ((int64_t)doc->len > inserter->max_buffered_bytes) {
+      _mongoc_set_error(error,
+                        MONGOC_ERROR_COMMAND,
+                        MONGOC_ERROR_COMMAND_INVALID_ARG,
+                        "Document of %" PRIu32 " bytes exceeds maxBufferedBytes of %" PRId64,
+                        doc->len,
+                        inserter->max_buffered_bytes);
+      return false;
+   }
+
+   bson_mutex_lock(&inserter->mutex);
+
+   // Block until the background thread frees room for the document.
+   while (!inserter->shutdown && inserter->buffered_bytes + (int64_t)doc->len > inserter->max_buffered_bytes) {
+      mongoc_cond_wait(&inserter->cond, &inserter->mutex);
+   }
+
+   if (inserter->shutdown) {
+      bson_mutex_unlock(&inserter->mutex);
+      _mongoc_set_error(
+         error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Bulk inserter is being destroyed");
+      return false;
+   }
+
+   if (inserter->pending.doc_ctxs.len == 0) {
+      inserter->pending_since = bson_get_monotonic_time();
+   }
+   _mongoc_array_append_vals(&inserter->pending.data, bson_get_data(doc), doc->len);
+   _mongoc_array_append_val(&inserter->pending.doc_ctxs, doc_ctx);
+   inserter->buffered_bytes += (int64_t)doc->len;
+   inserter->n_added++;
+
+   if (_must_write(inserter)) {
+      mongoc_cond_broadcast(&inserter->cond);
+   }
+
+   bson_mutex_unlock(&inserter->mutex);
+
+   return true;
+}
+
+
+void
+mongoc_bulk_inserter_flush(mongoc_bulk_inserter_t *inserter)
+{
+   BSON_ASSERT_PARAM(inserter);
+
+   bson_mutex_lock(&inserter->mutex);
+
+   const uint64_t target = inserter->n_added;
+
+   inserter->flush_target = BSON_MAX(inserter->flush_target, target);
+   mongoc_cond_broadcast(&inserter->cond);
+
+   while (inserter->n_reported < target) {
+      mongoc_cond_wait(&inserter->cond, &inserter->mutex);
+   }
+
+   bson_mutex_unlock(&inserter->mutex);
+}
+
+
+void
+mongoc_bulk_inserter_destroy(mongoc_bulk_inserter_t *inserter)
+{
+   if (!inserter) {
+      return;
+   }
+
+   // The background thread writes the remaining documents before exiting.
+   bson_mutex_lock(&inserter->mutex);
+   inserter->shutdown = true;
+   mongoc_cond_broadcast(&inserter->cond);
+   bson_mutex_unlock(&inserter->mutex);
+
+   mcommon_thread_join(inserter->thread);
+
+   _docs_destroy(&inserter->pending);
+   mongoc_cond_destroy(&inserter->cond);
+   bson_mutex_destroy(&inserter->mutex);
+   bson_free(inserter->ns);
+   bson_free(inserter);
+}
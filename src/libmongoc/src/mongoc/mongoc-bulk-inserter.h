@@ -0,0 +1,55 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mongoc/mongoc-prelude.h>
+
+#ifndef MONGOC_BULK_INSERTER_H
+#define MONGOC_BULK_INSERTER_H
+
+#include <mongoc/mongoc-client-pool.h>
+#include <mongoc/mongoc-macros.h>
+
+#include <bson/bson.h>
+
+BSON_BEGIN_DECLS
+
+typedef struct _mongoc_bulk_inserter_t mongoc_bulk_inserter_t;
+
+// `mongoc_bulk_inserter_result_cb_t` is called once per inserted document from the background thread. `error` is NULL
+// if the document was inserted.
+typedef void (*mongoc_bulk_inserter_result_cb_t)(void *doc_ctx, const bson_error_t *error, void *cb_ctx);
+
+MONGOC_EXPORT(mongoc_bulk_inserter_t *)
+mongoc_bulk_inserter_new(mongoc_client_pool_t *pool, const char *ns, const bson_t *opts, bson_error_t *error)
+   BSON_GNUC_WARN_UNUSED_RESULT;
+
+MONGOC_EXPORT(void)
+mongoc_bulk_inserter_set_result_cb(mongoc_bulk_inserter_t *inserter,
+                                   mongoc_bulk_inserter_result_cb_t cb,
+                                   void *cb_ctx);
+
+MONGOC_EXPORT(bool)
+mongoc_bulk_inserter_insert(mongoc_bulk_inserter_t *inserter, const bson_t *doc, void *doc_ctx, bson_error_t *error);
+
+MONGOC_EXPORT(void)
+mongoc_bulk_inserter_flush(mongoc_bulk_inserter_t *inserter);
+
+MONGOC_EXPORT(void)
+mongoc_bulk_inserter_destroy(mongoc_bulk_inserter_t *inserter);
+
+BSON_END_DECLS
+
+#endif /* MONGOC_BULK_INSERTER_H */
@@ -45,6 +45,10 @@ struct _mongoc_bulk_operation_t {
    mongoc_write_result_t result;
    bool executed;
    int64_t operation_id;
+   /* Set by mongoc_bulk_operation_set_group_by_shard. */
+   bool group_by_shard;
+   /* Set by mongoc_bulk_operation_set_parallel_pool, not owned. */
+   struct _mongoc_client_pool_t *parallel_pool;
 };
 
 
@@ -17,15 +17,21 @@
 
 #include <mongoc/mongoc-bulk-operation.h>
 
+#include <common-thread-private.h>
 #include <mongoc/mongoc-bulk-operation-private.h>
+#include <mongoc/mongoc-client-pool-private.h>
 #include <mongoc/mongoc-client-private.h>
 #include <mongoc/mongoc-error-private.h>
 #include <mongoc/mongoc-opts-private.h>
+#include <mongoc/mongoc-server-description-private.h>
+#include <mongoc/mongoc-shard-routing-private.h>
 #include <mongoc/mongoc-trace-private.h>
 #include <mongoc/mongoc-util-private.h>
 #include <mongoc/mongoc-write-command-private.h>
 #include <mongoc/mongoc-write-concern-private.h>
 
+#include <mlib/intencode.h>
+
 
 /*
  * This is the implementation of both write commands and bulk write commands.
@@ -691,6 +697,259 @@ mongoc_bulk_operation_replace_one(mongoc_bulk_operation_t *bulk,
    EXIT;
 }
 
+/* Returns the shard owning an insert document, or the documents matched by an
+ * update or delete statement, or -1. */
+static int32_t
+_mongoc_bulk_operation_find_shard(const mongoc_shard_routing_table_t *table, int type, const bson_t *statement)
+{
+   bson_iter_t iter;
+   uint32_t len;
+   const uint8_t *data;
+   bson_t filter;
+
+   if (type == MONGOC_WRITE_COMMAND_INSERT) {
+      return _mongoc_shard_routing_table_find_document(table, statement);
+   }
+
+   if (!bson_iter_init_find(&iter, statement, "q") || !BSON_ITER_HOLDS_DOCUMENT(&iter)) {
+      return -1;
+   }
+
+   bson_iter_document(&iter, &len, &data);
+   BSON_ASSERT(bson_init_static(&filter, data, len));
+
+   return _mongoc_shard_routing_table_find_filter(table, &filter);
+}
+
+
+/* Splits each write command of an unordered bulk write into a command per
+ * owning shard, so each batch mongos receives is routed to one shard.
+ * Statements whose shard is not known are kept together in a last command. */
+static void
+_mongoc_bulk_operation_group_by_shard(mongoc_bulk_operation_t *bulk)
+{
+   mongoc_client_t *const client = bulk->client;
+   mongoc_array_t commands;
+   uint32_t offset = 0;
+
+   mongoc_server_description_t *const sd = mongoc_client_select_server(client, true /* for_writes */, NULL, NULL);
+   const bool is_mongos = sd && sd->type == MONGOC_SERVER_MONGOS;
+   mongoc_server_description_destroy(sd);
+
+   if (!is_mongos) {
+      return;
+   }
+
+   if (!client->shard_routing) {
+      client->shard_routing = _mongoc_shard_routing_new();
+   }
+
+   const mongoc_shard_routing_table_t *const table =
+      _mongoc_shard_routing_get(client->shard_routing, client, bulk->database, bulk->collection);
+   if (!table) {
+      return;
+   }
+
+   const uint32_t n_groups = _mongoc_shard_routing_table_n_shards(table) + 1u;
+   mongoc_write_command_t *const groups = bson_malloc(n_groups * sizeof *groups);
+
+   mongoc_array_aligned_init(&commands, mongoc_write_command_t);
+
+   for (size_t i = 0u; i < bulk->commands.len; i++) {
+      mongoc_write_command_t *const command = &_mongoc_array_index(&bulk->commands, mongoc_write_command_t, i);
+      uint32_t pos = 0;
+      uint32_t index = offset;
+
+      for (uint32_t g = 0; g < n_groups; g++) {
+         _mongoc_write_command_init_empty_copy(&groups[g], command);
+      }
+
+      while (pos < command->payload.len) {
+         bson_t statement;
+         const uint32_t len = (uint32_t)mlib_read_i32le(command->payload.data + pos);
+
+         BSON_ASSERT(bson_init_static(&statement, command->payload.data + pos, len));
+
+         const int32_t shard = _mongoc_bulk_operation_find_shard(table, command->type, &statement);
+         _mongoc_write_command_append_raw(&groups[shard < 0 ? n_groups - 1u : (uint32_t)shard], &statement, index++);
+         pos += len;
+      }
+
+      for (uint32_t g = 0; g < n_groups; g++) {
+         if (groups[g].n_documents) {
+            _mongoc_array_append_val(&commands, groups[g]);
+         } else {
+            _mongoc_write_command_destroy(&groups[g]);
+         }
+      }
+
+      offset += command->n_documents;
+      _mongoc_write_command_destroy(command);
+   }
+
+   _mongoc_array_destroy(&bulk->commands);
+   bulk->commands = commands;
+   bson_free(groups);
+}
+
+
+/* The commands of one type in a bulk operation executed in parallel. */
+typedef struct {
+   mongoc_bulk_operation_t *bulk;
+   int type;
+   mongoc_client_t *client;
+   mongoc_write_concern_t *write_concern;
+   /* Indexed like bulk->commands. */
+   const uint32_t *offsets;
+   mongoc_write_result_t *results;
+   uint32_t server_id;
+   bson_thread_t thread;
+   bool started;
+} _mongoc_bulk_group_t;
+
+
+/* Executes the group's commands in order with the group's client. Each
+ * command has its own result, so groups do not share any state. */
+static void
+_mongoc_bulk_group_execute(_mongoc_bulk_group_t *group)
+{
+   mongoc_bulk_operation_t *const bulk = group->bulk;
+
+   for (size_t i = 0u; i < bulk->commands.len; i++) {
+      mongoc_write_command_t *const command = &_mongoc_array_index(&bulk->commands, mongoc_write_command_t, i);
+      mongoc_write_result_t *const result = &group->results[i];
+
+      if (command->type != group->type) {
+         continue;
+      }
+
+      const mongoc_ss_log_context_t ss_log_context = {.operation = _mongoc_write_command_get_name(command),
+                                                      .has_operation_id = true,
+                                                      .operation_id = command->operation_id};
+      mongoc_server_stream_t *const server_stream = mongoc_cluster_stream_for_writes(
+         &group->client->cluster, &ss_log_context, NULL, NULL, NULL, &result->error);
+
+      if (!server_stream) {
+         result->failed = true;
+         result->must_stop = true;
+         return;
+      }
+
+      _mongoc_write_command_execute(command,
+                                    group->client,
+                                    server_stream,
+                                    bulk->database,
+                                    bulk->collection,
+                                    group->write_concern,
+                                    command->indexes.len ? 0u : group->offsets[i],
+                                    NULL /* cs */,
+                                    result);
+
+      if (!group->server_id) {
+         group->server_id = server_stream->sd->id;
+      }
+
+      mongoc_server_stream_cleanup(server_stream);
+
+      if (result->must_stop) {
+         return;
+      }
+   }
+}
+
+
+static BSON_THREAD_FUN(_mongoc_bulk_group_thread, arg)
+{
+   _mongoc_bulk_group_execute((_mongoc_bulk_group_t *)arg);
+
+   BSON_THREAD_RETURN;
+}
+
+
+static bool
+_mongoc_bulk_operation_can_execute_parallel(const mongoc_bulk_operation_t *bulk)
+{
+   // An explicit session or server belongs to the bulk operation's client.
+   return bulk->parallel_pool && !bulk->flags.ordered && !bulk->session && !bulk->server_id &&
+          _mongoc_client_pool_get_topology(bulk->parallel_pool) == bulk->client->topology;
+}
+
+
+/* Executes the inserts, updates, and deletes of an unordered bulk operation
+ * concurrently: the first type on the bulk operation's client, the others on
+ * clients from the parallel pool, or afterward on the bulk operation's client
+ * if the pool has none available. Results are appended in command order, as
+ * if the commands were executed sequentially. */
+static void
+_mongoc_bulk_operation_execute_parallel(mongoc_bulk_operation_t *bulk)
+{
+   _mongoc_bulk_group_t groups[3];
+   size_t n_groups = 0u;
+   uint32_t offset = 0;
+   uint32_t *const offsets = bson_malloc(bulk->commands.len * sizeof *offsets);
+   mongoc_write_result_t *const results = bson_malloc(bulk->commands.len * sizeof *results);
+
+   for (size_t i = 0u; i < bulk->commands.len; i++) {
+      const mongoc_write_command_t *const command = &_mongoc_array_index(&bulk->commands, mongoc_write_command_t, i);
+      size_t g = 0u;
+
+      offsets[i] = offset;
+      offset += command->n_documents;
+      _mongoc_write_result_init(&results[i]);
+
+      while (g < n_groups && groups[g].type != command->type) {
+         g++;
+      }
+
+      if (g == n_groups) {
+         BSON_ASSERT(n_groups < sizeof groups / sizeof groups[0]);
+         groups[n_groups++] = (_mongoc_bulk_group_t){
+            .bulk = bulk, .type = command->type, .offsets = offsets, .results = results};
+      }
+   }
+
+   for (size_t g = 1u; g < n_groups; g++) {
+      groups[g].client = mongoc_client_pool_try_pop(bulk->parallel_pool);
+      if (!groups[g].client) {
+         break;
+      }
+
+      // Write concerns are not thread safe: mongoc_write_concern_t caches its BSON.
+      groups[g].write_concern = mongoc_write_concern_copy(bulk->write_concern);
+      groups[g].started = 0 == mcommon_thread_create(&groups[g].thread, _mongoc_bulk_group_thread, &groups[g]);
+      if (!groups[g].started) {
+         mongoc_write_concern_destroy(groups[g].write_concern);
+         mongoc_client_pool_push(bulk->parallel_pool, groups[g].client);
+         break;
+      }
+   }
+
+   for (size_t g = 0u; g < n_groups; g++) {
+      if (groups[g].started) {
+         mcommon_thread_join(groups[g].thread);
+         mongoc_write_concern_destroy(groups[g].write_concern);
+         mongoc_client_pool_push(bulk->parallel_pool, groups[g].client);
+      } else {
+         groups[g].client = bulk->client;
+         groups[g].write_concern = bulk->write_concern;
+         _mongoc_bulk_group_execute(&groups[g]);
+      }
+   }
+
+   for (size_t i = 0u; i < bulk->commands.len; i++) {
+      _mongoc_write_result_append(&bulk->result, &results[i]);
+      _mongoc_write_result_destroy(&results[i]);
+   }
+
+   for (size_t g = 0u; g < n_groups && !bulk->server_id; g++) {
+      bulk->server_id = groups[g].server_id;
+   }
+
+   bson_free(results);
+   bson_free(offsets);
+}
+
+
 uint32_t
 mongoc_bulk_operation_execute(mongoc_bulk_operation_t *bulk, /* IN */
                               bson_t *reply,                 /* OUT */
@@ -754,6 +1013,15 @@ mongoc_bulk_operation_execute(mongoc_bulk_operation_t *bulk, /* IN */
       GOTO(err);
    }
 
+   if (bulk->group_by_shard && !bulk->flags.ordered) {
+      _mongoc_bulk_operation_group_by_shard(bulk);
+   }
+
+   if (_mongoc_bulk_operation_can_execute_parallel(bulk)) {
+      _mongoc_bulk_operation_execute_parallel(bulk);
+      GOTO(cleanup);
+   }
+
    for (size_t i = 0u; i < bulk->commands.len; i++) {
       command = &_mongoc_array_index(&bulk->commands, mongoc_write_command_t, i);
 
@@ -778,7 +1046,7 @@ mongoc_bulk_operation_execute(mongoc_bulk_operation_t *bulk, /* IN */
                                     bulk->database,
                                     bulk->collection,
                                     bulk->write_concern,
-                                    offset,
+                                    command->indexes.len ? 0u : offset,
                                     bulk->session,
                                     &bulk->result);
 
@@ -961,6 +1229,22 @@ mongoc_bulk_operation_set_let(mongoc_bulk_operation_t *bulk, const bson_t *let)
    bson_copy_to(let, &bulk->let);
 }
 
+void
+mongoc_bulk_operation_set_group_by_shard(mongoc_bulk_operation_t *bulk, bool group_by_shard)
+{
+   BSON_ASSERT_PARAM(bulk);
+
+   bulk->group_by_shard = group_by_shard;
+}
+
+void
+mongoc_bulk_operation_set_parallel_pool(mongoc_bulk_operation_t *bulk, mongoc_client_pool_t *pool)
+{
+   BSON_ASSERT_PARAM(bulk);
+
+   bulk->parallel_pool = pool;
+}
+
 bool
 mongoc_bulk_operation_get_bypass_document_validation(const mongoc_bulk_operation_t *bulk)
 {
@@ -33,6 +33,7 @@ BSON_BEGIN_DECLS
 
 /* forward decl */
 struct _mongoc_client_session_t;
+struct _mongoc_client_pool_t;
 
 typedef struct _mongoc_bulk_operation_t mongoc_bulk_operation_t;
 typedef struct _mongoc_bulk_write_flags_t mongoc_bulk_write_flags_t;
@@ -119,6 +120,12 @@ mongoc_bulk_operation_set_comment(mongoc_bulk_operation_t *bulk, const bson_valu
 MONGOC_EXPORT(void)
 mongoc_bulk_operation_set_let(mongoc_bulk_operation_t *bulk, const bson_t *let);
 
+MONGOC_EXPORT(void)
+mongoc_bulk_operation_set_group_by_shard(mongoc_bulk_operation_t *bulk, bool group_by_shard);
+
+MONGOC_EXPORT(void)
+mongoc_bulk_operation_set_parallel_pool(mongoc_bulk_operation_t *bulk, struct _mongoc_client_pool_t *pool);
+
 
 /*
  * The following functions are really only useful by language bindings and
@@ -44,6 +44,7 @@ struct _mongoc_bulkwriteopts_t {
    bson_value_t comment;
    bson_t *extra;
    uint32_t serverid;
+   uint32_t maxinflightbatches;
 };
 
 // `set_bson_opt` sets `*dst` by copying `src`. If `src` is NULL, `dst` is cleared.
@@ -128,6 +129,12 @@ mongoc_bulkwriteopts_set_serverid(mongoc_bulkwriteopts_t *self, uint32_t serveri
    self->serverid = serverid;
 }
 void
+mongoc_bulkwriteopts_set_maxinflightbatches(mongoc_bulkwriteopts_t *self, uint32_t maxinflightbatches)
+{
+   BSON_ASSERT_PARAM(self);
+   self->maxinflightbatches = maxinflightbatches;
+}
+void
 mongoc_bulkwriteopts_destroy(mongoc_bulkwriteopts_t *self)
 {
    if (!self) {
@@ -149,7 +156,8 @@ typedef struct {
       size_t op_len;      // Length of insert op.
       uint32_t id_offset; // Offset in the insert op to the "_id" field.
    } id_loc;
-   char *ns;
+   // `ns` is owned by `mongoc_bulkwrite_t::namespaces`.
+   const char *ns;
 } modeldata_t;
 
 struct _mongoc_bulkwrite_t {
@@ -170,6 +178,8 @@ struct _mongoc_bulkwrite_t {
    size_t n_ops;
    // `arrayof_modeldata` is an array of `modeldata_t` sized to the number of models. It stores per-model data.
    mongoc_array_t arrayof_modeldata;
+   // `namespaces` stores each distinct namespace of the models once.
+   mcd_nsinfo_t *namespaces;
    // `max_insert_len` tracks the maximum length of any document to-be inserted.
    uint32_t max_insert_len;
    // `has_multi_write` is true if there are any multi-document update or delete operations. Multi-document
@@ -198,6 +208,7 @@ mongoc_bulkwrite_new(void)
    mongoc_optional_init(&bw->is_acknowledged);
    _mongoc_buffer_init(&bw->ops, NULL, 0, NULL, NULL);
    _mongoc_array_init(&bw->arrayof_modeldata, sizeof(modeldata_t));
+   bw->namespaces = mcd_nsinfo_new();
    return bw;
 }
 
@@ -207,11 +218,8 @@ mongoc_bulkwrite_destroy(mongoc_bulkwrite_t *self)
    if (!self) {
       return;
    }
-   for (size_t i = 0; i < self->arrayof_modeldata.len; i++) {
-      modeldata_t md = _mongoc_array_index(&self->arrayof_modeldata, modeldata_t, i);
-      bson_free(md.ns);
-   }
    _mongoc_array_destroy(&self->arrayof_modeldata);
+   mcd_nsinfo_destroy(self->namespaces);
    _mongoc_buffer_destroy(&self->ops);
    bson_free(self);
 }
@@ -243,6 +251,24 @@ mongoc_bulkwrite_insertoneopts_destroy(mongoc_bulkwrite_insertoneopts_t *self)
    } else                                                                                                              \
       (void)0
 
+// Begins an op written directly into `ops` rather than built in a separate document and then copied.
+static bson_writer_t *
+_ops_writer_begin(mongoc_bulkwrite_t *self, bson_t **op)
+{
+   bson_writer_t *writer = bson_writer_new(
+      &self->ops.data, &self->ops.datalen, self->ops.len, self->ops.realloc_func, self->ops.realloc_data);
+   BSON_ASSERT(bson_writer_begin(writer, op));
+   return writer;
+}
+
+static void
+_ops_writer_end(mongoc_bulkwrite_t *self, bson_writer_t *writer)
+{
+   bson_writer_end(writer);
+   self->ops.len = bson_writer_get_length(writer);
+   bson_writer_destroy(writer);
+}
+
 bool
 mongoc_bulkwrite_append_insertone(mongoc_bulkwrite_t *self,
                                   const char *ns,
@@ -259,52 +285,75 @@ mongoc_bulkwrite_append_insertone(mongoc_bulkwrite_t *self,
 
    ERROR_IF_EXECUTED;
 
-   bson_t op = BSON_INITIALIZER;
-   BSON_ASSERT(BSON_APPEND_INT32(&op, "insert", -1)); // Append -1 as a placeholder. Will be overwritten later.
-
-   // `persisted_id_offset` is the byte offset the `_id` in `op`.
-   uint32_t persisted_id_offset = 0;
-   {
-      // Refer: bsonspec.org for BSON format.
-      persisted_id_offset += 4;                                 // Document length.
-      persisted_id_offset += 1;                                 // BSON type for int32.
-      persisted_id_offset += (uint32_t)strlen("insert") + 1u;   // Key + 1 for NULL byte.
-      persisted_id_offset += 4;                                 // int32 value.
-      persisted_id_offset += 1;                                 // BSON type for document.
-      persisted_id_offset += (uint32_t)strlen("document") + 1u; // Key + 1 for NULL byte.
+   const char *interned_ns = mcd_nsinfo_intern(self->namespaces, ns, error);
+   if (!interned_ns) {
+      return false;
    }
 
-   // If `document` does not contain `_id`, add one in the beginning.
+   // Write the op { "insert": -1, "document": <document> } directly into `ops`. -1 is a placeholder for the namespace
+   // index and is overwritten later. If `document` does not contain `_id`, one is written at the beginning of the
+   // persisted document. Refer: bsonspec.org for BSON format.
+   uint8_t header[4 + (1 + sizeof("insert") + 4) + (1 + sizeof("document")) + 4 + (1 + sizeof("_id") + 12)];
+   size_t header_len = 0;
+
    bson_iter_t existing_id_iter;
-   if (!bson_iter_init_find(&existing_id_iter, document, "_id")) {
-      bson_t tmp = BSON_INITIALIZER;
-      bson_oid_t oid;
-      bson_oid_init(&oid, NULL);
-      BSON_ASSERT(BSON_APPEND_OID(&tmp, "_id", &oid));
-      BSON_ASSERT(bson_concat(&tmp, document));
-      BSON_ASSERT(BSON_APPEND_DOCUMENT(&op, "document", &tmp));
-      self->max_insert_len = BSON_MAX(self->max_insert_len, tmp.len);
-      bson_destroy(&tmp);
-      persisted_id_offset += 4; // Document length.
-   } else {
-      BSON_ASSERT(BSON_APPEND_DOCUMENT(&op, "document", document));
-      self->max_insert_len = BSON_MAX(self->max_insert_len, document->len);
+   const bool has_id = bson_iter_init_find(&existing_id_iter, document, "_id");
+   const uint32_t generated_id_len = (uint32_t)(1u + sizeof("_id") + 12u); // BSON type, key, ObjectId.
+   BSON_ASSERT(has_id || document->len <= UINT32_MAX - generated_id_len);
+   const uint32_t doc_len = has_id ? document->len : document->len + generated_id_len;
+   BSON_ASSERT(doc_len <= INT32_MAX - (uint32_t)sizeof(header) - 1u);
+   const uint32_t op_len =
+      4u + (1u + (uint32_t)sizeof("insert") + 4u) + (1u + (uint32_t)sizeof("document")) + doc_len + 1u;
+
+   mlib_write_i32le(header, (int32_t)op_len); // Document length.
+   header_len += 4;
+   header[header_len++] = BSON_TYPE_INT32;
+   memcpy(header + header_len, "insert", sizeof("insert")); // Key + NULL byte.
+   header_len += sizeof("insert");
+   mlib_write_i32le(header + header_len, -1);
+   header_len += 4;
+   header[header_len++] = BSON_TYPE_DOCUMENT;
+   memcpy(header + header_len, "document", sizeof("document"));
+   header_len += sizeof("document");
+
+   // `persisted_id_offset` is the byte offset the `_id` in the op.
+   uint32_t persisted_id_offset = (uint32_t)header_len;
+   const uint8_t *doc_data = bson_get_data(document);
+
+   if (has_id) {
       // `existing_id_offset` is offset of `_id` in the input `document`.
       const uint32_t existing_id_offset = bson_iter_offset(&existing_id_iter);
       BSON_ASSERT(persisted_id_offset <= UINT32_MAX - existing_id_offset);
       persisted_id_offset += existing_id_offset;
+   } else {
+      bson_oid_t oid;
+      bson_oid_init(&oid, NULL);
+      mlib_write_i32le(header + header_len, (int32_t)doc_len); // Document length.
+      header_len += 4;
+      persisted_id_offset += 4;
+      header[header_len++] = BSON_TYPE_OID;
+      memcpy(header + header_len, "_id", sizeof("_id"));
+      header_len += sizeof("_id");
+      memcpy(header + header_len, oid.bytes, 12);
+      header_len += 12;
+      // The length prefix of `document` is replaced by the one written above.
+      doc_data += 4;
    }
 
    size_t op_start = self->ops.len; // Save location of `op` to retrieve `_id` later.
-   BSON_ASSERT(mlib_in_range(size_t, op.len));
-   BSON_ASSERT(_mongoc_buffer_append(&self->ops, bson_get_data(&op), (size_t)op.len));
+   BSON_ASSERT(_mongoc_buffer_append(&self->ops, header, header_len));
+   // Copy the elements of `document` including its trailing NULL byte.
+   const size_t doc_data_len = (size_t)(bson_get_data(document) + document->len - doc_data);
+   BSON_ASSERT(_mongoc_buffer_append(&self->ops, doc_data, doc_data_len));
+   BSON_ASSERT(_mongoc_buffer_append(&self->ops, (const uint8_t *)"", 1)); // Trailing NULL byte of the op.
+   BSON_ASSERT(self->ops.len - op_start == op_len);
+   self->max_insert_len = BSON_MAX(self->max_insert_len, doc_len);
 
    self->n_ops++;
    modeldata_t md = {.op = MODEL_OP_INSERT,
-                     .id_loc = {.op_start = op_start, .op_len = (size_t)op.len, .id_offset = persisted_id_offset},
-                     .ns = bson_strdup(ns)};
+                     .id_loc = {.op_start = op_start, .op_len = (size_t)op_len, .id_offset = persisted_id_offset},
+                     .ns = interned_ns};
    _mongoc_array_append_val(&self->arrayof_modeldata, md);
-   bson_destroy(&op);
    return true;
 }
 
@@ -419,6 +468,11 @@ mongoc_bulkwrite_append_updateone(mongoc_bulkwrite_t *self,
 
    ERROR_IF_EXECUTED;
 
+   const char *interned_ns = mcd_nsinfo_intern(self->namespaces, ns, error);
+   if (!interned_ns) {
+      return false;
+   }
+
    mongoc_bulkwrite_updateoneopts_t defaults = {0};
    if (!opts) {
       opts = &defaults;
@@ -429,37 +483,37 @@ mongoc_bulkwrite_append_updateone(mongoc_bulkwrite_t *self,
       return false;
    }
 
-   bson_t op = BSON_INITIALIZER;
-   BSON_ASSERT(BSON_APPEND_INT32(&op, "update", -1)); // Append -1 as a placeholder. Will be overwritten later.
-   BSON_ASSERT(BSON_APPEND_DOCUMENT(&op, "filter", filter));
+   bson_t *op;
+   bson_writer_t *writer = _ops_writer_begin(self, &op);
+   BSON_ASSERT(BSON_APPEND_INT32(op, "update", -1)); // Append -1 as a placeholder. Will be overwritten later.
+   BSON_ASSERT(BSON_APPEND_DOCUMENT(op, "filter", filter));
    if (is_pipeline) {
-      BSON_ASSERT(BSON_APPEND_ARRAY(&op, "updateMods", update));
+      BSON_ASSERT(BSON_APPEND_ARRAY(op, "updateMods", update));
    } else {
-      BSON_ASSERT(BSON_APPEND_DOCUMENT(&op, "updateMods", update));
+      BSON_ASSERT(BSON_APPEND_DOCUMENT(op, "updateMods", update));
    }
-   BSON_ASSERT(BSON_APPEND_BOOL(&op, "multi", false));
+   BSON_ASSERT(BSON_APPEND_BOOL(op, "multi", false));
    if (opts->arrayfilters) {
-      BSON_ASSERT(BSON_APPEND_ARRAY(&op, "arrayFilters", opts->arrayfilters));
+      BSON_ASSERT(BSON_APPEND_ARRAY(op, "arrayFilters", opts->arrayfilters));
    }
    if (opts->collation) {
-      BSON_ASSERT(BSON_APPEND_DOCUMENT(&op, "collation", opts->collation));
+      BSON_ASSERT(BSON_APPEND_DOCUMENT(op, "collation", opts->collation));
    }
    if (opts->hint.value_type != BSON_TYPE_EOD) {
-      BSON_ASSERT(BSON_APPEND_VALUE(&op, "hint", &opts->hint));
+      BSON_ASSERT(BSON_APPEND_VALUE(op, "hint", &opts->hint));
    }
    if (mongoc_optional_is_set(&opts->upsert)) {
-      BSON_ASSERT(BSON_APPEND_BOOL(&op, "upsert", mongoc_optional_value(&opts->upsert)));
+      BSON_ASSERT(BSON_APPEND_BOOL(op, "upsert", mongoc_optional_value(&opts->upsert)));
    }
    if (opts->sort) {
-      BSON_ASSERT(BSON_APPEND_DOCUMENT(&op, "sort", opts->sort));
+      BSON_ASSERT(BSON_APPEND_DOCUMENT(op, "sort", opts->sort));
    }
 
-   BSON_ASSERT(_mongoc_buffer_append(&self->ops, bson_get_data(&op), op.len));
+   _ops_writer_end(self, writer);
 
    self->n_ops++;
-   modeldata_t md = {.op = MODEL_OP_UPDATE, .ns = bson_strdup(ns)};
+   modeldata_t md = {.op = MODEL_OP_UPDATE, .ns = interned_ns};
    _mongoc_array_append_val(&self->arrayof_modeldata, md);
-   bson_destroy(&op);
    return true;
 }
 
@@ -559,6 +613,11 @@ mongoc_bulkwrite_append_replaceone(mongoc_bulkwrite_t *self,
 
    ERROR_IF_EXECUTED;
 
+   const char *interned_ns = mcd_nsinfo_intern(self->namespaces, ns, error);
+   if (!interned_ns) {
+      return false;
+   }
+
    mongoc_bulkwrite_replaceoneopts_t defaults = {0};
    if (!opts) {
       opts = &defaults;
@@ -568,31 +627,31 @@ mongoc_bulkwrite_append_replaceone(mongoc_bulkwrite_t *self,
       return false;
    }
 
-   bson_t op = BSON_INITIALIZER;
-   BSON_ASSERT(BSON_APPEND_INT32(&op, "update", -1)); // Append -1 as a placeholder. Will be overwritten later.
-   BSON_ASSERT(BSON_APPEND_DOCUMENT(&op, "filter", filter));
-   BSON_ASSERT(BSON_APPEND_DOCUMENT(&op, "updateMods", replacement));
-   BSON_ASSERT(BSON_APPEND_BOOL(&op, "multi", false));
+   bson_t *op;
+   bson_writer_t *writer = _ops_writer_begin(self, &op);
+   BSON_ASSERT(BSON_APPEND_INT32(op, "update", -1)); // Append -1 as a placeholder. Will be overwritten later.
+   BSON_ASSERT(BSON_APPEND_DOCUMENT(op, "filter", filter));
+   BSON_ASSERT(BSON_APPEND_DOCUMENT(op, "updateMods", replacement));
+   BSON_ASSERT(BSON_APPEND_BOOL(op, "multi", false));
    if (opts->collation) {
-      BSON_ASSERT(BSON_APPEND_DOCUMENT(&op, "collation", opts->collation));
+      BSON_ASSERT(BSON_APPEND_DOCUMENT(op, "collation", opts->collation));
    }
    if (opts->hint.value_type != BSON_TYPE_EOD) {
-      BSON_ASSERT(BSON_APPEND_VALUE(&op, "hint", &opts->hint));
+      BSON_ASSERT(BSON_APPEND_VALUE(op, "hint", &opts->hint));
    }
    if (mongoc_optional_is_set(&opts->upsert)) {
-      BSON_ASSERT(BSON_APPEND_BOOL(&op, "upsert", mongoc_optional_value(&opts->upsert)));
+      BSON_ASSERT(BSON_APPEND_BOOL(op, "upsert", mongoc_optional_value(&opts->upsert)));
    }
    if (opts->sort) {
-      BSON_ASSERT(BSON_APPEND_DOCUMENT(&op, "sort", opts->sort));
+      BSON_ASSERT(BSON_APPEND_DOCUMENT(op, "sort", opts->sort));
    }
 
-   BSON_ASSERT(_mongoc_buffer_append(&self->ops, bson_get_data(&op), op.len));
+   _ops_writer_end(self, writer);
 
    self->n_ops++;
    self->max_insert_len = BSON_MAX(self->max_insert_len, replacement->len);
-   modeldata_t md = {.op = MODEL_OP_UPDATE, .ns = bson_strdup(ns)};
+   modeldata_t md = {.op = MODEL_OP_UPDATE, .ns = interned_ns};
    _mongoc_array_append_val(&self->arrayof_modeldata, md);
-   bson_destroy(&op);
    return true;
 }
 
@@ -666,6 +725,11 @@ mongoc_bulkwrite_append_updatemany(mongoc_bulkwrite_t *self,
 
    ERROR_IF_EXECUTED;
 
+   const char *interned_ns = mcd_nsinfo_intern(self->namespaces, ns, error);
+   if (!interned_ns) {
+      return false;
+   }
+
    mongoc_bulkwrite_updatemanyopts_t defaults = {0};
    if (!opts) {
       opts = &defaults;
@@ -676,35 +740,35 @@ mongoc_bulkwrite_append_updatemany(mongoc_bulkwrite_t *self,
       return false;
    }
 
-   bson_t op = BSON_INITIALIZER;
-   BSON_ASSERT(BSON_APPEND_INT32(&op, "update", -1)); // Append -1 as a placeholder. Will be overwritten later.
-   BSON_ASSERT(BSON_APPEND_DOCUMENT(&op, "filter", filter));
+   bson_t *op;
+   bson_writer_t *writer = _ops_writer_begin(self, &op);
+   BSON_ASSERT(BSON_APPEND_INT32(op, "update", -1)); // Append -1 as a placeholder. Will be overwritten later.
+   BSON_ASSERT(BSON_APPEND_DOCUMENT(op, "filter", filter));
    if (is_pipeline) {
-      BSON_ASSERT(BSON_APPEND_ARRAY(&op, "updateMods", update));
+      BSON_ASSERT(BSON_APPEND_ARRAY(op, "updateMods", update));
    } else {
-      BSON_ASSERT(BSON_APPEND_DOCUMENT(&op, "updateMods", update));
+      BSON_ASSERT(BSON_APPEND_DOCUMENT(op, "updateMods", update));
    }
-   BSON_ASSERT(BSON_APPEND_BOOL(&op, "multi", true));
+   BSON_ASSERT(BSON_APPEND_BOOL(op, "multi", true));
    if (opts->arrayfilters) {
-      BSON_ASSERT(BSON_APPEND_ARRAY(&op, "arrayFilters", opts->arrayfilters));
+      BSON_ASSERT(BSON_APPEND_ARRAY(op, "arrayFilters", opts->arrayfilters));
    }
    if (opts->collation) {
-      BSON_ASSERT(BSON_APPEND_DOCUMENT(&op, "collation", opts->collation));
+      BSON_ASSERT(BSON_APPEND_DOCUMENT(op, "collation", opts->collation));
    }
    if (opts->hint.value_type != BSON_TYPE_EOD) {
-      BSON_ASSERT(BSON_APPEND_VALUE(&op, "hint", &opts->hint));
+      BSON_ASSERT(BSON_APPEND_VALUE(op, "hint", &opts->hint));
    }
    if (mongoc_optional_is_set(&opts->upsert)) {
-      BSON_ASSERT(BSON_APPEND_BOOL(&op, "upsert", mongoc_optional_value(&opts->upsert)));
+      BSON_ASSERT(BSON_APPEND_BOOL(op, "upsert", mongoc_optional_value(&opts->upsert)));
    }
 
-   BSON_ASSERT(_mongoc_buffer_append(&self->ops, bson_get_data(&op), op.len));
+   _ops_writer_end(self, writer);
 
    self->has_multi_write = true;
    self->n_ops++;
-   modeldata_t md = {.op = MODEL_OP_UPDATE, .ns = bson_strdup(ns)};
+   modeldata_t md = {.op = MODEL_OP_UPDATE, .ns = interned_ns};
    _mongoc_array_append_val(&self->arrayof_modeldata, md);
-   bson_destroy(&op);
    return true;
 }
 
@@ -759,28 +823,33 @@ mongoc_bulkwrite_append_deleteone(mongoc_bulkwrite_t *self,
 
    ERROR_IF_EXECUTED;
 
+   const char *interned_ns = mcd_nsinfo_intern(self->namespaces, ns, error);
+   if (!interned_ns) {
+      return false;
+   }
+
    mongoc_bulkwrite_deleteoneopts_t defaults = {0};
    if (!opts) {
       opts = &defaults;
    }
 
-   bson_t op = BSON_INITIALIZER;
-   BSON_ASSERT(BSON_APPEND_INT32(&op, "delete", -1)); // Append -1 as a placeholder. Will be overwritten later.
-   BSON_ASSERT(BSON_APPEND_DOCUMENT(&op, "filter", filter));
-   BSON_ASSERT(BSON_APPEND_BOOL(&op, "multi", false));
+   bson_t *op;
+   bson_writer_t *writer = _ops_writer_begin(self, &op);
+   BSON_ASSERT(BSON_APPEND_INT32(op, "delete", -1)); // Append -1 as a placeholder. Will be overwritten later.
+   BSON_ASSERT(BSON_APPEND_DOCUMENT(op, "filter", filter));
+   BSON_ASSERT(BSON_APPEND_BOOL(op, "multi", false));
    if (opts->collation) {
-      BSON_ASSERT(BSON_APPEND_DOCUMENT(&op, "collation", opts->collation));
+      BSON_ASSERT(BSON_APPEND_DOCUMENT(op, "collation", opts->collation));
    }
    if (opts->hint.value_type != BSON_TYPE_EOD) {
-      BSON_ASSERT(BSON_APPEND_VALUE(&op, "hint", &opts->hint));
+      BSON_ASSERT(BSON_APPEND_VALUE(op, "hint", &opts->hint));
    }
 
-   BSON_ASSERT(_mongoc_buffer_append(&self->ops, bson_get_data(&op), op.len));
+   _ops_writer_end(self, writer);
 
    self->n_ops++;
-   modeldata_t md = {.op = MODEL_OP_DELETE, .ns = bson_strdup(ns)};
+   modeldata_t md = {.op = MODEL_OP_DELETE, .ns = interned_ns};
    _mongoc_array_append_val(&self->arrayof_modeldata, md);
-   bson_destroy(&op);
    return true;
 }
 
@@ -833,29 +902,34 @@ mongoc_bulkwrite_append_deletemany(mongoc_bulkwrite_t *self,
 
    ERROR_IF_EXECUTED;
 
+   const char *interned_ns = mcd_nsinfo_intern(self->namespaces, ns, error);
+   if (!interned_ns) {
+      return false;
+   }
+
    mongoc_bulkwrite_deletemanyopts_t defaults = {0};
    if (!opts) {
       opts = &defaults;
    }
 
-   bson_t op = BSON_INITIALIZER;
-   BSON_ASSERT(BSON_APPEND_INT32(&op, "delete", -1)); // Append -1 as a placeholder. Will be overwritten later.
-   BSON_ASSERT(BSON_APPEND_DOCUMENT(&op, "filter", filter));
-   BSON_ASSERT(BSON_APPEND_BOOL(&op, "multi", true));
+   bson_t *op;
+   bson_writer_t *writer = _ops_writer_begin(self, &op);
+   BSON_ASSERT(BSON_APPEND_INT32(op, "delete", -1)); // Append -1 as a placeholder. Will be overwritten later.
+   BSON_ASSERT(BSON_APPEND_DOCUMENT(op, "filter", filter));
+   BSON_ASSERT(BSON_APPEND_BOOL(op, "multi", true));
    if (opts->collation) {
-      BSON_ASSERT(BSON_APPEND_DOCUMENT(&op, "collation", opts->collation));
+      BSON_ASSERT(BSON_APPEND_DOCUMENT(op, "collation", opts->collation));
    }
    if (opts->hint.value_type != BSON_TYPE_EOD) {
-      BSON_ASSERT(BSON_APPEND_VALUE(&op, "hint", &opts->hint));
+      BSON_ASSERT(BSON_APPEND_VALUE(op, "hint", &opts->hint));
    }
 
-   BSON_ASSERT(_mongoc_buffer_append(&self->ops, bson_get_data(&op), op.len));
+   _ops_writer_end(self, writer);
 
    self->has_multi_write = true;
    self->n_ops++;
-   modeldata_t md = {.op = MODEL_OP_DELETE, .ns = bson_strdup(ns)};
+   modeldata_t md = {.op = MODEL_OP_DELETE, .ns = interned_ns};
    _mongoc_array_append_val(&self->arrayof_modeldata, md);
-   bson_destroy(&op);
    return true;
 }
 
@@ -1114,6 +1188,7 @@ _bulkwriteexception_set_error_reply(mongoc_bulkwriteexception_t *self, const bso
    BSON_ASSERT_PARAM(self);
    BSON_ASSERT_PARAM(error_reply);
 
+   bson_destroy(&self->error_reply);
    bson_copy_to(error_reply, &self->error_reply);
    self->has_any_error = true;
 }
@@ -1526,6 +1601,308 @@ mongoc_bulkwrite_set_session(mongoc_bulkwrite_t *self, mongoc_client_session_t *
    self->session = session;
 }
 
+// `bulkwrite_batch_t` is a range of write models sent in one `bulkWrite` command.
+typedef struct {
+   // `ops_doc_offset` is an offset into the `ops` document sequence. Counts the number of documents sent before.
+   size_t ops_doc_offset;
+   // `ops_doc_len` is the number of documents from `ops` to send in this batch.
+   size_t ops_doc_len;
+   // `ops_byte_offset` is an offset into the `ops` document sequence. Counts the number of bytes sent before.
+   size_t ops_byte_offset;
+   // `ops_byte_len` is the number of bytes from `ops` to send in this batch.
+   size_t ops_byte_len;
+   // `nsinfo` tracks the `nsInfo` entries to include in this batch.
+   mcd_nsinfo_t *nsinfo;
+   // `pipelined` is only used when batches are pipelined.
+   mongoc_cluster_pipelined_t pipelined;
+   bool sent;
+   bool ok;
+   bson_t reply;
+   bson_error_t error;
+} bulkwrite_batch_t;
+
+// `_bulkwrite_max_in_flight` returns the number of batches that may be sent before reading replies.
+static size_t
+_bulkwrite_max_in_flight(const mongoc_bulkwrite_t *self,
+                         const mongoc_bulkwriteopts_t *opts,
+                         bool is_ordered,
+                         const mongoc_cmd_parts_t *parts)
+{
+   // Pipelined batches are never retried. A retryable write is sent one batch at a time, so that a retry uses the
+   // session's latest `txnNumber`: the server rejects an older one once a later batch was executed.
+   if (opts->maxinflightbatches <= 1 || is_ordered || !mongoc_optional_value(&self->is_acknowledged) ||
+       parts->is_retryable_write || _mongoc_cse_is_enabled(self->client) ||
+       _mongoc_client_session_in_txn(parts->assembled.session)) {
+      return 1;
+   }
+
+   return BSON_MIN((size_t)opts->maxinflightbatches, self->n_ops);
+}
+
+// The server does not read the next command while a reply is not read. Replies of pipelined batches must fit in the
+// socket buffers, or sending a later batch blocks forever. `BULKWRITE_PIPELINED_REPLY_BUDGET` bounds the expected size
+// of the replies of the batches in flight.
+#define BULKWRITE_PIPELINED_REPLY_BUDGET (64u * 1024u)
+
+// `BULKWRITE_WRITE_ERROR_SIZE` is the size of a write error in a reply, excluding what its message quotes of the
+// operation (e.g. the key of a duplicate key error).
+#define BULKWRITE_WRITE_ERROR_SIZE 256u
+
+// `_bulkwrite_expected_reply_size` bounds the size of the reply to `batch`: a fixed envelope, plus a write error for
+// each operation, plus a result for each operation when verbose results are requested. Write errors are reported
+// whether or not results are verbose, e.g. when every insert of an unordered batch is a duplicate key.
+static size_t
+_bulkwrite_expected_reply_size(const bulkwrite_batch_t *batch, bool verboseresults)
+{
+   // A write error may quote the operation twice: in its message and in a field such as `keyValue`.
+   return 1024u + batch->ops_doc_len * (BULKWRITE_WRITE_ERROR_SIZE + (verboseresults ? 128u : 0u)) +
+          2u * batch->ops_byte_len;
+}
+
+// `_bulkwrite_ready_batch` reads as many documents from `ops` into `batch` as the server size limits permit.
+static bool
+_bulkwrite_ready_batch(mongoc_bulkwrite_t *self,
+                       bulkwrite_batch_t *batch,
+                       int32_t maxWriteBatchSize,
+                       int32_t maxMessageSizeBytes,
+                       size_t opmsg_overhead,
+                       bson_error_t *error)
+{
+   while (true) {
+      if (batch->ops_byte_offset + batch->ops_byte_len >= self->ops.len) {
+         // All remaining ops are readied.
+         break;
+      }
+
+      if (mlib_cmp(batch->ops_doc_len, >=, maxWriteBatchSize)) {
+         // Maximum number of operations are readied.
+         break;
+      }
+
+      uint8_t *const doc_data = self->ops.data + batch->ops_byte_offset + batch->ops_byte_len;
+
+      // Read length of next document.
+      const uint32_t doc_len = mlib_read_u32le(doc_data);
+
+      // Check if adding this operation requires adding an `nsInfo` entry.
+      // `models_idx` is the index of the model that produced this result.
+      size_t models_idx = batch->ops_doc_len + batch->ops_doc_offset;
+      modeldata_t *md = &_mongoc_array_index(&self->arrayof_modeldata, modeldata_t, models_idx);
+      uint32_t nsinfo_bson_size = 0;
+      int32_t ns_index = mcd_nsinfo_find(batch->nsinfo, md->ns);
+      if (ns_index == -1) {
+         // Need to append `nsInfo` entry. Append after checking that both the document and the `nsInfo` entry fit.
+         nsinfo_bson_size = mcd_nsinfo_get_bson_size(md->ns);
+      }
+
+      if (mlib_cmp(opmsg_overhead + batch->ops_byte_len + doc_len + nsinfo_bson_size, >, maxMessageSizeBytes)) {
+         if (batch->ops_byte_len == 0) {
+            // Could not even fit one document within an OP_MSG.
+            _mongoc_set_error(error,
+                              MONGOC_ERROR_COMMAND,
+                              MONGOC_ERROR_COMMAND_INVALID_ARG,
+                              "unable to send document at index %zu. Sending "
+                              "would exceed maxMessageSizeBytes=%" PRId32,
+                              batch->ops_doc_len,
+                              maxMessageSizeBytes);
+            return false;
+         }
+         break;
+      }
+
+      // Check if a new `nsInfo` entry is needed.
+      if (ns_index == -1) {
+         ns_index = mcd_nsinfo_append(batch->nsinfo, md->ns, error);
+         if (ns_index == -1) {
+            return false;
+         }
+      }
+
+      // Overwrite the placeholder to the index of the `nsInfo` entry.
+      {
+         bson_iter_t nsinfo_iter;
+         bson_t doc;
+         BSON_ASSERT(bson_init_static(&doc, doc_data, doc_len));
+         // Find the index.
+         BSON_ASSERT(bson_iter_init(&nsinfo_iter, &doc));
+         BSON_ASSERT(bson_iter_next(&nsinfo_iter));
+         bson_iter_overwrite_int32(&nsinfo_iter, ns_index);
+      }
+
+      // Include document.
+      {
+         batch->ops_byte_len += doc_len;
+         batch->ops_doc_len += 1;
+      }
+   }
+
+   return true;
+}
+
+// `_bulkwrite_set_payloads` points the document sequences of `cmd` at the `nsInfo` and `ops` of `batch`.
+static void
+_bulkwrite_set_payloads(mongoc_cmd_t *cmd, const mongoc_bulkwrite_t *self, const bulkwrite_batch_t *batch)
+{
+   cmd->payloads_count = 2;
+
+   // Create the `nsInfo` payload.
+   {
+      mongoc_cmd_payload_t *payload = &cmd->payloads[0];
+      const mongoc_buffer_t *nsinfo_docseq = mcd_nsinfo_as_document_sequence(batch->nsinfo);
+      payload->documents = nsinfo_docseq->data;
+      BSON_ASSERT(mlib_in_range(int32_t, nsinfo_docseq->len));
+      payload->size = (int32_t)nsinfo_docseq->len;
+      payload->identifier = "nsInfo";
+   }
+
+   // Create the `ops` payload.
+   {
+      mongoc_cmd_payload_t *payload = &cmd->payloads[1];
+      payload->identifier = "ops";
+      payload->documents = self->ops.data + batch->ops_byte_offset;
+      BSON_ASSERT(mlib_in_range(int32_t, batch->ops_byte_len));
+      payload->size = (int32_t)batch->ops_byte_len;
+   }
+}
+
+// `_bulkwrite_ensure_stream` selects a new stream if `*ss` was invalidated (e.g. due to processing an error).
+// `reply` is a required out-param. `*reply` is always initialized upon return.
+static bool
+_bulkwrite_ensure_stream(
+   mongoc_bulkwrite_t *self, mongoc_server_stream_t **ss, mongoc_cmd_t *cmd, bson_t *reply, bson_error_t *error)
+{
+   if (mongoc_cluster_stream_valid(&self->client->cluster, cmd->server_stream)) {
+      bson_init(reply);
+      return true;
+   }
+
+   const mongoc_ss_log_context_t ss_log_context = {
+      .operation = "bulkWrite", .has_operation_id = true, .operation_id = self->operation_id};
+
+   // Select a server and create a stream again.
+   mongoc_server_stream_cleanup(*ss);
+   *ss = mongoc_cluster_stream_for_writes(&self->client->cluster,
+                                          &ss_log_context,
+                                          NULL /* session */,
+                                          NULL /* deprioritized servers */,
+                                          reply,
+                                          error);
+
+   if (!*ss) {
+      return false;
+   }
+
+   bson_init(reply);
+   cmd->server_stream = *ss;
+   return true;
+}
+
+// `_bulkwrite_run_pipelined` sends every batch before reading any reply. Batches are not retried: only writes that are
+// not retryable are pipelined.
+static void
+_bulkwrite_run_pipelined(mongoc_bulkwrite_t *self, mongoc_cmd_t *cmd, bulkwrite_batch_t *batches, size_t n_batches)
+{
+   mongoc_cluster_t *const cluster = &self->client->cluster;
+
+   for (size_t i = 0; i < n_batches; i++) {
+      bulkwrite_batch_t *batch = &batches[i];
+
+      _bulkwrite_set_payloads(cmd, self, batch);
+      bson_destroy(&batch->reply);
+      batch->sent = mongoc_cluster_send_pipelined(cluster, cmd, &batch->pipelined, &batch->reply, &batch->error);
+      if (!batch->sent) {
+         break;
+      }
+   }
+
+   // Replies arrive in the order the batches were sent.
+   for (size_t i = 0; i < n_batches && batches[i].sent; i++) {
+      bulkwrite_batch_t *batch = &batches[i];
+
+      bson_destroy(&batch->reply);
+      batch->ok = mongoc_cluster_recv_pipelined(cluster, cmd, &batch->pipelined, &batch->reply, &batch->error);
+   }
+}
+
+// `_bulkwrite_apply_batch_reply` adds the results of one `bulkWrite` reply to the result and/or exception. Iterates the
+// reply cursor if results do not fit in the first batch. `cmd_reply` is stolen.
+static bool
+_bulkwrite_apply_batch_reply(mongoc_bulkwrite_t *self,
+                             mongoc_bulkwritereturn_t *ret,
+                             const mongoc_cmd_t *cmd,
+                             size_t ops_doc_offset,
+                             bson_t *cmd_reply)
+{
+   bson_error_t error;
+   bool ok = false;
+   mongoc_cursor_t *reply_cursor = NULL;
+
+   // Parse top-level fields.
+   if (!_bulkwritereturn_apply_reply(ret, cmd_reply)) {
+      goto done;
+   }
+
+   // Construct reply cursor and read individual results.
+   {
+      bson_t cursor_opts = BSON_INITIALIZER;
+      {
+         uint32_t serverid = cmd->server_stream->sd->id;
+         BSON_ASSERT(mlib_in_range(int32_t, serverid));
+         int32_t serverid_i32 = (int32_t)serverid;
+         BSON_ASSERT(BSON_APPEND_INT32(&cursor_opts, "serverId", serverid_i32));
+         // Use same session if one was applied.
+         if (cmd->session && !mongoc_client_session_append(cmd->session, &cursor_opts, &error)) {
+            _bulkwriteexception_set_error(ret->exc, &error);
+            _bulkwriteexception_set_error_reply(ret->exc, cmd_reply);
+            bson_destroy(&cursor_opts);
+            goto done;
+         }
+      }
+
+      // Construct the reply cursor.
+      reply_cursor = mongoc_cursor_new_from_command_reply_with_opts(self->client, cmd_reply, &cursor_opts);
+      bson_destroy(&cursor_opts);
+      // `cmd_reply` is stolen. Clear it.
+      bson_init(cmd_reply);
+
+      // Ensure constructing cursor did not error.
+      {
+         const bson_t *error_document;
+         if (mongoc_cursor_error_document(reply_cursor, &error, &error_document)) {
+            _bulkwriteexception_set_error(ret->exc, &error);
+            if (error_document) {
+               _bulkwriteexception_set_error_reply(ret->exc, error_document);
+            }
+            goto done;
+         }
+      }
+
+      // Iterate over cursor results.
+      const bson_t *result;
+      while (mongoc_cursor_next(reply_cursor, &result)) {
+         if (!_bulkwritereturn_apply_result(ret, result, ops_doc_offset, &self->arrayof_modeldata, &self->ops)) {
+            goto done;
+         }
+      }
+      // Ensure iterating cursor did not error.
+      {
+         const bson_t *error_document;
+         if (mongoc_cursor_error_document(reply_cursor, &error, &error_document)) {
+            _bulkwriteexception_set_error(ret->exc, &error);
+            if (error_document) {
+               _bulkwriteexception_set_error_reply(ret->exc, error_document);
+            }
+            goto done;
+         }
+      }
+   }
+
+   ok = true;
+done:
+   mongoc_cursor_destroy(reply_cursor);
+   return ok;
+}
+
 mongoc_bulkwritereturn_t
 mongoc_bulkwrite_execute(mongoc_bulkwrite_t *self, const mongoc_bulkwriteopts_t *opts)
 {
@@ -1540,6 +1917,7 @@ mongoc_bulkwrite_execute(mongoc_bulkwrite_t *self, const mongoc_bulkwriteopts_t
    bson_t cmd = BSON_INITIALIZER;
    mongoc_cmd_parts_t parts = {{0}};
    mongoc_bulkwriteopts_t defaults = {{0}};
+   bulkwrite_batch_t *batches = NULL;
 
    if (!opts) {
       opts = &defaults;
@@ -1716,236 +2094,112 @@ mongoc_bulkwrite_execute(mongoc_bulkwrite_t *self, const mongoc_bulkwriteopts_t
    }
 
    // Send one or more `bulkWrite` commands. Split input payload if necessary to satisfy server size limits.
-   while (true) {
-      bool has_write_errors = false;
-      bool batch_ok = false;
-      bson_t cmd_reply = BSON_INITIALIZER;
-      mongoc_cursor_t *reply_cursor = NULL;
-      // `ops_byte_len` is the number of bytes from `ops` to send in this batch.
-      size_t ops_byte_len = 0;
-      // `ops_doc_len` is the number of documents from `ops` to send in this batch.
-      size_t ops_doc_len = 0;
-
-      if (ops_byte_offset == self->ops.len) {
-         // All write models were sent.
-         break;
-      }
-
-      // Track the nsInfo entries to include in this batch.
-      mcd_nsinfo_t *nsinfo = mcd_nsinfo_new();
+   const size_t max_in_flight = _bulkwrite_max_in_flight(self, opts, is_ordered, &parts);
+   batches = bson_malloc0(max_in_flight * sizeof(*batches));
 
-      // Read as many documents from payload as possible.
-      while (true) {
-         if (ops_byte_offset + ops_byte_len >= self->ops.len) {
-            // All remaining ops are readied.
-            break;
-         }
-
-         if (mlib_cmp(ops_doc_len, >=, maxWriteBatchSize)) {
-            // Maximum number of operations are readied.
+   while (ops_byte_offset < self->ops.len) {
+      bool has_write_errors = false;
+      bool window_ok = true;
+      bool ready_ok = true;
+      size_t n_batches = 0;
+      size_t reply_size = 0;
+
+      // Ready one batch, or up to `max_in_flight` batches to pipeline.
+      while (n_batches < max_in_flight && ops_byte_offset < self->ops.len) {
+         bulkwrite_batch_t *batch = &batches[n_batches];
+
+         *batch = (bulkwrite_batch_t){
+            .ops_doc_offset = ops_doc_offset,
+            .ops_byte_offset = ops_byte_offset,
+            .nsinfo = mcd_nsinfo_new(),
+         };
+         bson_init(&batch->reply);
+
+         if (!_bulkwrite_ready_batch(self, batch, maxWriteBatchSize, maxMessageSizeBytes, opmsg_overhead, &error)) {
+            _bulkwriteexception_set_error(ret.exc, &error);
+            mcd_nsinfo_destroy(batch->nsinfo);
+            bson_destroy(&batch->reply);
+            // Still send the batches readied so far, as is done when sending one batch at a time.
+            ready_ok = false;
             break;
          }
 
-         // Read length of next document.
-         const uint32_t doc_len = mlib_read_u32le(self->ops.data + ops_byte_offset + ops_byte_len);
-
-         // Check if adding this operation requires adding an `nsInfo` entry.
-         // `models_idx` is the index of the model that produced this result.
-         size_t models_idx = ops_doc_len + ops_doc_offset;
-         modeldata_t *md = &_mongoc_array_index(&self->arrayof_modeldata, modeldata_t, models_idx);
-         uint32_t nsinfo_bson_size = 0;
-         int32_t ns_index = mcd_nsinfo_find(nsinfo, md->ns);
-         if (ns_index == -1) {
-            // Need to append `nsInfo` entry. Append after checking that both the document and the `nsInfo` entry fit.
-            nsinfo_bson_size = mcd_nsinfo_get_bson_size(md->ns);
-         }
-
-         if (mlib_cmp(opmsg_overhead + ops_byte_len + doc_len + nsinfo_bson_size, >, maxMessageSizeBytes)) {
-            if (ops_byte_len == 0) {
-               // Could not even fit one document within an OP_MSG.
-               _mongoc_set_error(&error,
-                                 MONGOC_ERROR_COMMAND,
-                                 MONGOC_ERROR_COMMAND_INVALID_ARG,
-                                 "unable to send document at index %zu. Sending "
-                                 "would exceed maxMessageSizeBytes=%" PRId32,
-                                 ops_doc_len,
-                                 maxMessageSizeBytes);
-               _bulkwriteexception_set_error(ret.exc, &error);
-               goto batch_fail;
-            }
+         reply_size += _bulkwrite_expected_reply_size(batch, verboseresults);
+         if (n_batches > 0 && reply_size > BULKWRITE_PIPELINED_REPLY_BUDGET) {
+            // Leave the batch to the next window. It is readied again then.
+            mcd_nsinfo_destroy(batch->nsinfo);
+            bson_destroy(&batch->reply);
             break;
          }
 
-         // Check if a new `nsInfo` entry is needed.
-         if (ns_index == -1) {
-            ns_index = mcd_nsinfo_append(nsinfo, md->ns, &error);
-            if (ns_index == -1) {
-               _bulkwriteexception_set_error(ret.exc, &error);
-               goto batch_fail;
-            }
-         }
-
-         // Overwrite the placeholder to the index of the `nsInfo` entry.
-         {
-            bson_iter_t nsinfo_iter;
-            bson_t doc;
-            BSON_ASSERT(bson_init_static(&doc, self->ops.data + ops_byte_offset + ops_byte_len, doc_len));
-            // Find the index.
-            BSON_ASSERT(bson_iter_init(&nsinfo_iter, &doc));
-            BSON_ASSERT(bson_iter_next(&nsinfo_iter));
-            bson_iter_overwrite_int32(&nsinfo_iter, ns_index);
-         }
-
-         // Include document.
-         {
-            ops_byte_len += doc_len;
-            ops_doc_len += 1;
-         }
+         ops_doc_offset += batch->ops_doc_len;
+         ops_byte_offset += batch->ops_byte_len;
+         n_batches++;
       }
 
-      // Send batch.
-      {
-         parts.assembled.payloads_count = 2;
-
-         // Create the `nsInfo` payload.
-         {
-            mongoc_cmd_payload_t *payload = &parts.assembled.payloads[0];
-            const mongoc_buffer_t *nsinfo_docseq = mcd_nsinfo_as_document_sequence(nsinfo);
-            payload->documents = nsinfo_docseq->data;
-            BSON_ASSERT(mlib_in_range(int32_t, nsinfo_docseq->len));
-            payload->size = (int32_t)nsinfo_docseq->len;
-            payload->identifier = "nsInfo";
-         }
-
-         // Create the `ops` payload.
-         {
-            mongoc_cmd_payload_t *payload = &parts.assembled.payloads[1];
-            payload->identifier = "ops";
-            payload->documents = self->ops.data + ops_byte_offset;
-            BSON_ASSERT(mlib_in_range(int32_t, ops_byte_len));
-            payload->size = (int32_t)ops_byte_len;
-         }
-
+      if (n_batches > 0) {
          // Check if stream is valid. A previous call to `mongoc_cluster_run_retryable_write` may have invalidated
          // stream (e.g. due to processing an error). If invalid, select a new stream before processing more batches.
-         if (!mongoc_cluster_stream_valid(&self->client->cluster, parts.assembled.server_stream)) {
-            bson_t reply;
-            // Select a server and create a stream again.
-            mongoc_server_stream_cleanup(ss);
-            ss = mongoc_cluster_stream_for_writes(&self->client->cluster,
-                                                  &ss_log_context,
-                                                  NULL /* session */,
-                                                  NULL /* deprioritized servers */,
-                                                  &reply,
-                                                  &error);
-
-            if (ss) {
-               parts.assembled.server_stream = ss;
-            } else {
-               _bulkwriteexception_set_error(ret.exc, &error);
-               _bulkwriteexception_set_error_reply(ret.exc, &reply);
-               bson_destroy(&reply);
-               goto batch_fail;
-            }
-         }
-
-         // Send command.
-         {
+         bson_t reply;
+         if (!_bulkwrite_ensure_stream(self, &ss, &parts.assembled, &reply, &error)) {
+            _bulkwriteexception_set_error(ret.exc, &error);
+            _bulkwriteexception_set_error_reply(ret.exc, &reply);
+            window_ok = false;
+         } else if (n_batches == 1) {
+            bulkwrite_batch_t *batch = &batches[0];
             mongoc_server_stream_t *new_ss = NULL;
-            bool ok = mongoc_cluster_run_retryable_write(
-               &self->client->cluster, &parts.assembled, parts.is_retryable_write, &new_ss, &cmd_reply, &error);
+
+            _bulkwrite_set_payloads(&parts.assembled, self, batch);
+            bson_destroy(&batch->reply);
+            batch->ok = mongoc_cluster_run_retryable_write(&self->client->cluster,
+                                                           &parts.assembled,
+                                                           parts.is_retryable_write,
+                                                           &new_ss,
+                                                           &batch->reply,
+                                                           &batch->error);
             if (new_ss) {
                // A retry occurred. Save the newly created stream to use for subsequent commands.
                mongoc_server_stream_cleanup(ss);
                ss = new_ss;
                parts.assembled.server_stream = ss;
             }
+         } else {
+            _bulkwrite_run_pipelined(self, &parts.assembled, batches, n_batches);
+         }
+         bson_destroy(&reply);
+      }
 
-            // Check for a command ('ok': 0) error.
-            if (!ok) {
-               if (error.code != 0) {
+      // Add to result and/or exception in model order. Replies of batches after a failed batch are still applied: the
+      // batches were already executed by the server.
+      for (size_t i = 0; i < n_batches; i++) {
+         bulkwrite_batch_t *batch = &batches[i];
+
+         // Check for a command ('ok': 0) error.
+         if (!batch->ok) {
+            if (window_ok) {
+               if (batch->error.code != 0) {
                   // The original error was a command ('ok': 0) error.
-                  _bulkwriteexception_set_error(ret.exc, &error);
+                  _bulkwriteexception_set_error(ret.exc, &batch->error);
                }
-               _bulkwriteexception_set_error_reply(ret.exc, &cmd_reply);
-               goto batch_fail;
+               _bulkwriteexception_set_error_reply(ret.exc, &batch->reply);
             }
+            window_ok = false;
+            continue;
          }
 
-         // Add to result and/or exception.
-         if (mongoc_optional_value(&self->is_acknowledged)) {
-            // Parse top-level fields.
-            if (!_bulkwritereturn_apply_reply(&ret, &cmd_reply)) {
-               goto batch_fail;
-            }
-
-            // Construct reply cursor and read individual results.
-            {
-               bson_t cursor_opts = BSON_INITIALIZER;
-               {
-                  uint32_t serverid = parts.assembled.server_stream->sd->id;
-                  BSON_ASSERT(mlib_in_range(int32_t, serverid));
-                  int32_t serverid_i32 = (int32_t)serverid;
-                  BSON_ASSERT(BSON_APPEND_INT32(&cursor_opts, "serverId", serverid_i32));
-                  // Use same session if one was applied.
-                  if (parts.assembled.session &&
-                      !mongoc_client_session_append(parts.assembled.session, &cursor_opts, &error)) {
-                     _bulkwriteexception_set_error(ret.exc, &error);
-                     _bulkwriteexception_set_error_reply(ret.exc, &cmd_reply);
-                     goto batch_fail;
-                  }
-               }
-
-               // Construct the reply cursor.
-               reply_cursor = mongoc_cursor_new_from_command_reply_with_opts(self->client, &cmd_reply, &cursor_opts);
-               bson_destroy(&cursor_opts);
-               // `cmd_reply` is stolen. Clear it.
-               bson_init(&cmd_reply);
-
-               // Ensure constructing cursor did not error.
-               {
-                  const bson_t *error_document;
-                  if (mongoc_cursor_error_document(reply_cursor, &error, &error_document)) {
-                     _bulkwriteexception_set_error(ret.exc, &error);
-                     if (error_document) {
-                        _bulkwriteexception_set_error_reply(ret.exc, error_document);
-                     }
-                     goto batch_fail;
-                  }
-               }
-
-               // Iterate over cursor results.
-               const bson_t *result;
-               while (mongoc_cursor_next(reply_cursor, &result)) {
-                  if (!_bulkwritereturn_apply_result(
-                         &ret, result, ops_doc_offset, &self->arrayof_modeldata, &self->ops)) {
-                     goto batch_fail;
-                  }
-               }
-               has_write_errors = !bson_empty(&ret.exc->write_errors);
-               // Ensure iterating cursor did not error.
-               {
-                  const bson_t *error_document;
-                  if (mongoc_cursor_error_document(reply_cursor, &error, &error_document)) {
-                     _bulkwriteexception_set_error(ret.exc, &error);
-                     if (error_document) {
-                        _bulkwriteexception_set_error_reply(ret.exc, error_document);
-                     }
-                     goto batch_fail;
-                  }
-               }
-            }
+         if (mongoc_optional_value(&self->is_acknowledged) &&
+             !_bulkwrite_apply_batch_reply(self, &ret, &parts.assembled, batch->ops_doc_offset, &batch->reply)) {
+            window_ok = false;
          }
       }
+      has_write_errors = !bson_empty(&ret.exc->write_errors);
+
+      for (size_t i = 0; i < n_batches; i++) {
+         mcd_nsinfo_destroy(batches[i].nsinfo);
+         bson_destroy(&batches[i].reply);
+      }
 
-      ops_doc_offset += ops_doc_len;
-      ops_byte_offset += ops_byte_len;
-      batch_ok = true;
-   batch_fail:
-      mcd_nsinfo_destroy(nsinfo);
-      mongoc_cursor_destroy(reply_cursor);
-      bson_destroy(&cmd_reply);
-      if (!batch_ok) {
+      if (!window_ok || !ready_ok) {
          goto fail;
       }
       if (has_write_errors && is_ordered) {
@@ -1980,6 +2234,7 @@ fail:
       mongoc_cmd_parts_cleanup(&parts);
    }
    bson_destroy(&cmd);
+   bson_free(batches);
    if (ss) {
       self->serverid.value = ss->sd->id;
       self->serverid.is_set = true;
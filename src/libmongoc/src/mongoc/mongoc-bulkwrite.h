@@ -47,6 +47,11 @@ mongoc_bulkwriteopts_set_extra(mongoc_bulkwriteopts_t *self, const bson_t *extra
 // wrapping drivers that select a server before running the operation.
 MONGOC_EXPORT(void)
 mongoc_bulkwriteopts_set_serverid(mongoc_bulkwriteopts_t *self, uint32_t serverid);
+// `mongoc_bulkwriteopts_set_maxinflightbatches` permits sending up to `maxinflightbatches` `bulkWrite` commands on one
+// connection before reading their replies. Only applies to unordered, acknowledged, retryable bulk writes.
+// Defaults to 1.
+MONGOC_EXPORT(void)
+mongoc_bulkwriteopts_set_maxinflightbatches(mongoc_bulkwriteopts_t *self, uint32_t maxinflightbatches);
 MONGOC_EXPORT(void)
 mongoc_bulkwriteopts_destroy(mongoc_bulkwriteopts_t *self);
 
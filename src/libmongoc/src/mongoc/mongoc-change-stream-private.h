@@ -23,8 +23,11 @@
 
 //
 
+#include <common-thread-private.h>
+#include <mongoc/mongoc-array-private.h>
 #include <mongoc/mongoc-opts-helpers-private.h>
 #include <mongoc/mongoc-opts-private.h>
+#include <mongoc/mongoc-thread-private.h>
 
 #include <mongoc/mongoc-client-session.h>
 #include <mongoc/mongoc-collection.h>
@@ -71,6 +74,26 @@ struct _mongoc_change_stream_t {
 
    /* The max_wire_version of the server the change stream is tied to. */
    uint32_t max_wire_version;
+
+   /* Views of the events returned by mongoc_change_stream_next_batch. */
+   mongoc_array_t batch;
+
+   /* With the "prefetch" option, the events of the last batch are copied to
+    * batch_data while prefetch_thread runs the next getMore. The thread is
+    * started with the first prefetch and serves every later one. */
+   uint8_t *batch_data;
+   size_t batch_data_len;
+   bool prefetching; /* a getMore was requested and its result not taken */
+   bool prefetch_thread_started;
+   bson_thread_t prefetch_thread;
+   bson_mutex_t prefetch_mutex;
+   mongoc_cond_t prefetch_cond;
+   /* the following are guarded by prefetch_mutex. */
+   bool prefetch_requested;
+   bool prefetch_done;
+   bool prefetch_shutdown;
+   bool prefetch_ret;
+   const bson_t *prefetch_doc;
 };
 
 mongoc_change_stream_t *
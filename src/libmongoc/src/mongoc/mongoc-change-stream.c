@@ -364,6 +364,7 @@ _change_stream_init(mongoc_change_stream_t *stream, const bson_t *pipeline, cons
    bson_init(&stream->pipeline_to_append);
    bson_init(&stream->resume_token);
    bson_init(&stream->err_doc);
+   _mongoc_array_init(&stream->batch, sizeof(bson_t));
 
    if (!_mongoc_change_stream_opts_parse(stream->client, opts, &stream->opts, &stream->err)) {
       return;
@@ -470,6 +471,149 @@ mongoc_change_stream_get_resume_token(mongoc_change_stream_t *stream)
 }
 
 
+static BSON_THREAD_FUN(_prefetch_thread, stream_void)
+{
+   mongoc_change_stream_t *const stream = (mongoc_change_stream_t *)stream_void;
+
+   bson_mutex_lock(&stream->prefetch_mutex);
+   while (true) {
+      if (stream->prefetch_shutdown) {
+         break;
+      }
+
+      if (!stream->prefetch_requested) {
+         mongoc_cond_wait(&stream->prefetch_cond, &stream->prefetch_mutex);
+         continue;
+      }
+
+      /* the stream only touches its cursor again once the getMore is done. */
+      bson_mutex_unlock(&stream->prefetch_mutex);
+      const bson_t *doc;
+      const bool ret = mongoc_cursor_next(stream->cursor, &doc);
+      bson_mutex_lock(&stream->prefetch_mutex);
+
+      stream->prefetch_ret = ret;
+      stream->prefetch_doc = doc;
+      stream->prefetch_requested = false;
+      stream->prefetch_done = true;
+      mongoc_cond_broadcast(&stream->prefetch_cond);
+   }
+   bson_mutex_unlock(&stream->prefetch_mutex);
+
+   BSON_THREAD_RETURN;
+}
+
+
+/* waits for a getMore started by _start_prefetch, if any. */
+static void
+_join_prefetch(mongoc_change_stream_t *stream)
+{
+   if (!stream->prefetching) {
+      return;
+   }
+
+   bson_mutex_lock(&stream->prefetch_mutex);
+   while (!stream->prefetch_done) {
+      mongoc_cond_wait(&stream->prefetch_cond, &stream->prefetch_mutex);
+   }
+   stream->prefetch_done = false;
+   bson_mutex_unlock(&stream->prefetch_mutex);
+
+   stream->prefetching = false;
+}
+
+
+/* stops the thread started by _start_prefetch, if any. */
+static void
+_stop_prefetch_thread(mongoc_change_stream_t *stream)
+{
+   if (!stream->prefetch_thread_started) {
+      return;
+   }
+
+   _join_prefetch(stream);
+
+   bson_mutex_lock(&stream->prefetch_mutex);
+   stream->prefetch_shutdown = true;
+   mongoc_cond_broadcast(&stream->prefetch_cond);
+   bson_mutex_unlock(&stream->prefetch_mutex);
+
+   mcommon_thread_join(stream->prefetch_thread);
+   mongoc_cond_destroy(&stream->prefetch_cond);
+   bson_mutex_destroy(&stream->prefetch_mutex);
+   stream->prefetch_thread_started = false;
+}
+
+
+/* like mongoc_cursor_next, but returns the result of a prefetched getMore if
+ * one was started. */
+static bool
+_cursor_next(mongoc_change_stream_t *stream, const bson_t **bson)
+{
+   if (stream->prefetching) {
+      _join_prefetch(stream);
+      *bson = stream->prefetch_doc;
+      return stream->prefetch_ret;
+   }
+
+   return mongoc_cursor_next(stream->cursor, bson);
+}
+
+
+/* copies the events of the current batch out of the cursor's reply, then sends
+ * the next getMore in the background. */
+static void
+_start_prefetch(mongoc_change_stream_t *stream)
+{
+   BSON_ASSERT(!stream->prefetching);
+
+   if (!stream->opts.prefetch || stream->err.code != 0 || !stream->cursor || stream->cursor->cursor_id == 0 ||
+       mongoc_cursor_error(stream->cursor, NULL)) {
+      return;
+   }
+
+   /* the events are consecutive elements of the batch array, copy them at once. */
+   if (stream->batch.len > 0u) {
+      bson_t *const events = (bson_t *)stream->batch.data;
+      const bson_t *const last = &events[stream->batch.len - 1u];
+      const uint8_t *const start = bson_get_data(&events[0]);
+      const size_t len = (size_t)(bson_get_data(last) + last->len - start);
+
+      if (stream->batch_data_len < len) {
+         stream->batch_data = bson_realloc(stream->batch_data, len);
+         stream->batch_data_len = len;
+      }
+      memcpy(stream->batch_data, start, len);
+
+      for (size_t i = 0u; i < stream->batch.len; i++) {
+         const size_t offset = (size_t)(bson_get_data(&events[i]) - start);
+         BSON_ASSERT(bson_init_static(&events[i], stream->batch_data + offset, events[i].len));
+      }
+   }
+
+   if (!stream->prefetch_thread_started) {
+      bson_mutex_init(&stream->prefetch_mutex);
+      mongoc_cond_init(&stream->prefetch_cond);
+
+      /* if the thread cannot start, batches are fetched synchronously. */
+      if (mcommon_thread_create(&stream->prefetch_thread, _prefetch_thread, stream) != 0) {
+         mongoc_cond_destroy(&stream->prefetch_cond);
+         bson_mutex_destroy(&stream->prefetch_mutex);
+         return;
+      }
+
+      stream->prefetch_thread_started = true;
+   }
+
+   bson_mutex_lock(&stream->prefetch_mutex);
+   stream->prefetch_requested = true;
+   mongoc_cond_broadcast(&stream->prefetch_cond);
+   bson_mutex_unlock(&stream->prefetch_mutex);
+
+   stream->prefetching = true;
+}
+
+
 bool
 mongoc_change_stream_next(mongoc_change_stream_t *stream, const bson_t **bson)
 {
@@ -487,7 +631,7 @@ mongoc_change_stream_next(mongoc_change_stream_t *stream, const bson_t **bson)
    }
 
    BSON_ASSERT(stream->cursor);
-   if (!mongoc_cursor_next(stream->cursor, bson)) {
+   if (!_cursor_next(stream, bson)) {
       const bson_t *err_doc;
       bson_error_t err;
       bool resumable = false;
@@ -589,6 +733,86 @@ end:
    return ret;
 }
 
+static void
+_append_event(mongoc_array_t *batch, const bson_t *event)
+{
+   const bson_t placeholder = BSON_INITIALIZER;
+
+   _mongoc_array_append_val(batch, placeholder);
+   /* a bson_t cannot be copied by value, create a new view of the event. */
+   BSON_ASSERT(
+      bson_init_static(&_mongoc_array_index(batch, bson_t, batch->len - 1u), bson_get_data(event), event->len));
+}
+
+
+bool
+mongoc_change_stream_next_batch(mongoc_change_stream_t *stream, const bson_t **events, size_t *n_events)
+{
+   const bson_t *doc;
+   bson_iter_t iter;
+   bool end_of_batch = true;
+
+   BSON_ASSERT_PARAM(stream);
+   BSON_ASSERT_PARAM(events);
+   BSON_ASSERT_PARAM(n_events);
+
+   *events = NULL;
+   *n_events = 0u;
+   _mongoc_array_clear(&stream->batch);
+
+   /* the first event resumes after errors and updates the resume token. */
+   if (!mongoc_change_stream_next(stream, &doc)) {
+      return false;
+   }
+
+   _append_event(&stream->batch, doc);
+
+   /* the rest of the batch only needs its resume tokens checked. */
+   while (!_mongoc_cursor_change_stream_end_of_batch(stream->cursor)) {
+      if (!_mongoc_cursor_change_stream_next_in_batch(stream->cursor, &doc)) {
+         end_of_batch = false;
+         break;
+      }
+
+      if (!bson_iter_init_find(&iter, doc, "_id") || !BSON_ITER_HOLDS_DOCUMENT(&iter)) {
+         /* return the valid events, the next call reports the error. */
+         _mongoc_set_error(&stream->err,
+                           MONGOC_ERROR_CURSOR,
+                           MONGOC_ERROR_CHANGE_STREAM_NO_RESUME_TOKEN,
+                           "Cannot provide resume functionality when the resume "
+                           "token is missing");
+         end_of_batch = false;
+         break;
+      }
+
+      _append_event(&stream->batch, doc);
+   }
+
+   /* Change stream spec: Updating the Cached Resume Token. the token is only
+    * copied once per batch. */
+   if (end_of_batch && _mongoc_cursor_change_stream_has_post_batch_resume_token(stream->cursor)) {
+      _set_resume_token(stream, _mongoc_cursor_change_stream_get_post_batch_resume_token(stream->cursor));
+   } else if (stream->batch.len > 1u) {
+      const bson_t *const last = &_mongoc_array_index(&stream->batch, bson_t, stream->batch.len - 1u);
+      uint32_t len;
+      const uint8_t *data;
+      bson_t doc_resume_token;
+
+      BSON_ASSERT(bson_iter_init_find(&iter, last, "_id"));
+      bson_iter_document(&iter, &len, &data);
+      BSON_ASSERT(bson_init_static(&doc_resume_token, data, len));
+      _set_resume_token(stream, &doc_resume_token);
+   }
+
+   _start_prefetch(stream);
+
+   *events = (const bson_t *)stream->batch.data;
+   *n_events = stream->batch.len;
+
+   return true;
+}
+
+
 bool
 mongoc_change_stream_error_document(const mongoc_change_stream_t *stream, bson_error_t *err, const bson_t **bson)
 {
@@ -617,6 +841,8 @@ mongoc_change_stream_destroy(mongoc_change_stream_t *stream)
       return;
    }
 
+   _stop_prefetch_thread(stream);
+
    bson_destroy(&stream->pipeline_to_append);
    bson_destroy(&stream->resume_token);
    bson_destroy(stream->full_document);
@@ -628,6 +854,8 @@ mongoc_change_stream_destroy(mongoc_change_stream_t *stream)
    mongoc_read_prefs_destroy(stream->read_prefs);
    mongoc_read_concern_destroy(stream->read_concern);
 
+   _mongoc_array_destroy(&stream->batch);
+   bson_free(stream->batch_data);
    bson_free(stream->db);
    bson_free(stream->coll);
    bson_free(stream);
@@ -24,7 +24,9 @@
 #include <mongoc/mongoc-client-side-encryption-private.h>
 #include <mongoc/mongoc-counters-private.h>
 #include <mongoc/mongoc-error-private.h>
+#include <mongoc/mongoc-group-commit-private.h>
 #include <mongoc/mongoc-log-and-monitor-private.h>
+#include <mongoc/mongoc-lookup-batcher-private.h>
 #include <mongoc/mongoc-oidc-callback-private.h>
 #include <mongoc/mongoc-queue-private.h>
 #include <mongoc/mongoc-thread-private.h>
@@ -70,6 +72,10 @@ struct _mongoc_client_pool_t {
    mongoc_server_api_t *api;
    // `last_known_serverids` is a sorted array of uint32_t.
    mongoc_array_t last_known_serverids;
+   /* Set by mongoc_client_pool_set_group_commit, NULL if disabled. */
+   mongoc_group_commit_t *group_commit;
+   /* Set by mongoc_client_pool_set_lookup_batching, NULL if disabled. */
+   mongoc_lookup_batcher_t *lookup_batcher;
 };
 
 
@@ -260,6 +266,8 @@ mongoc_client_pool_destroy(mongoc_client_pool_t *pool)
    mongoc_cond_destroy(&pool->cond);
 
    mongoc_server_api_destroy(pool->api);
+   _mongoc_group_commit_destroy(pool->group_commit);
+   _mongoc_lookup_batcher_destroy(pool->lookup_batcher);
 
 #ifdef MONGOC_ENABLE_SSL
    _mongoc_ssl_opts_cleanup(&pool->ssl_opts, true);
@@ -305,6 +313,8 @@ _initialize_new_client(mongoc_client_pool_t *pool, mongoc_client_t *client)
    client->error_api_version = pool->error_api_version;
 
    client->api = mongoc_server_api_copy(pool->api);
+   client->group_commit = pool->group_commit;
+   client->lookup_batcher = pool->lookup_batcher;
 
 #ifdef MONGOC_ENABLE_SSL
    if (pool->ssl_opts_set) {
@@ -450,6 +460,14 @@ mongoc_client_pool_push(mongoc_client_pool_t *pool, mongoc_client_t *client)
    /* reset sockettimeoutms to the default in case it was changed with mongoc_client_set_sockettimeoutms() */
    mongoc_cluster_reset_sockettimeoutms(&client->cluster);
 
+   /* do not keep unacknowledged writes buffered while the client is unused */
+   {
+      bson_error_t error;
+      if (!mongoc_cluster_flush_w0_buffer(&client->cluster, &error)) {
+         MONGOC_WARNING("Unacknowledged writes failed: %s", error.message);
+      }
+   }
+
    bson_mutex_lock(&pool->mutex);
    // Check if `last_known_server_ids` needs update.
    bool serverids_have_changed = false;
@@ -691,6 +709,100 @@ mongoc_client_pool_set_server_api(mongoc_client_pool_t *pool, const mongoc_serve
    return true;
 }
 
+bool
+mongoc_client_pool_set_group_commit(mongoc_client_pool_t *pool,
+                                    int64_t window_ms,
+                                    int32_t max_documents,
+                                    bson_error_t *error)
+{
+   BSON_ASSERT_PARAM(pool);
+
+   if (window_ms < 0 || window_ms > INT64_MAX / 1000) {
+      _mongoc_set_error(error,
+                        MONGOC_ERROR_COMMAND,
+                        MONGOC_ERROR_COMMAND_INVALID_ARG,
+                        "Invalid group commit window: %" PRId64 " milliseconds",
+                        window_ms);
+      return false;
+   }
+
+   if (max_documents <= 0) {
+      _mongoc_set_error(error,
+                        MONGOC_ERROR_COMMAND,
+                        MONGOC_ERROR_COMMAND_INVALID_ARG,
+                        "Invalid group commit maximum: %" PRId32 " documents",
+                        max_documents);
+      return false;
+   }
+
+   if (pool->group_commit) {
+      _mongoc_set_error(error,
+                        MONGOC_ERROR_COMMAND,
+                        MONGOC_ERROR_COMMAND_INVALID_ARG,
+                        "Cannot set group commit more than once per pool");
+      return false;
+   }
+
+   if (pool->client_initialized) {
+      _mongoc_set_error(error,
+                        MONGOC_ERROR_COMMAND,
+                        MONGOC_ERROR_COMMAND_INVALID_ARG,
+                        "Cannot set group commit after a client has been created");
+      return false;
+   }
+
+   pool->group_commit = _mongoc_group_commit_new(window_ms, max_documents);
+
+   return true;
+}
+
+bool
+mongoc_client_pool_set_lookup_batching(mongoc_client_pool_t *pool,
+                                       int64_t max_delay_us,
+                                       int32_t max_batch_size,
+                                       bson_error_t *error)
+{
+   BSON_ASSERT_PARAM(pool);
+
+   if (max_delay_us < 0) {
+      _mongoc_set_error(error,
+                        MONGOC_ERROR_COMMAND,
+                        MONGOC_ERROR_COMMAND_INVALID_ARG,
+                        "Invalid lookup batching delay: %" PRId64 " microseconds",
+                        max_delay_us);
+      return false;
+   }
+
+   if (max_batch_size <= 0) {
+      _mongoc_set_error(error,
+                        MONGOC_ERROR_COMMAND,
+                        MONGOC_ERROR_COMMAND_INVALID_ARG,
+                        "Invalid lookup batching maximum: %" PRId32 " lookups",
+                        max_batch_size);
+      return false;
+   }
+
+   if (pool->lookup_batcher) {
+      _mongoc_set_error(error,
+                        MONGOC_ERROR_COMMAND,
+                        MONGOC_ERROR_COMMAND_INVALID_ARG,
+                        "Cannot set lookup batching more than once per pool");
+      return false;
+   }
+
+   if (pool->client_initialized) {
+      _mongoc_set_error(error,
+                        MONGOC_ERROR_COMMAND,
+                        MONGOC_ERROR_COMMAND_INVALID_ARG,
+                        "Cannot set lookup batching after a client has been created");
+      return false;
+   }
+
+   pool->lookup_batcher = _mongoc_lookup_batcher_new(max_delay_us, max_batch_size);
+
+   return true;
+}
+
 bool
 mongoc_client_pool_set_oidc_callback(mongoc_client_pool_t *pool, const mongoc_oidc_callback_t *callback)
 {
@@ -84,6 +84,18 @@ mongoc_client_pool_set_server_api(mongoc_client_pool_t *pool, const mongoc_serve
 MONGOC_EXPORT(bool)
 mongoc_client_pool_set_structured_log_opts(mongoc_client_pool_t *pool, const mongoc_structured_log_opts_t *opts);
 
+MONGOC_EXPORT(bool)
+mongoc_client_pool_set_group_commit(mongoc_client_pool_t *pool,
+                                    int64_t window_ms,
+                                    int32_t max_documents,
+                                    bson_error_t *error);
+
+MONGOC_EXPORT(bool)
+mongoc_client_pool_set_lookup_batching(mongoc_client_pool_t *pool,
+                                       int64_t max_delay_us,
+                                       int32_t max_batch_size,
+                                       bson_error_t *error);
+
 MONGOC_EXPORT(bool)
 mongoc_client_pool_set_oidc_callback(mongoc_client_pool_t *pool, const mongoc_oidc_callback_t *callback);
 
@@ -26,8 +26,12 @@
 #include <mongoc/mongoc-apm-private.h>
 #include <mongoc/mongoc-buffer-private.h>
 #include <mongoc/mongoc-cluster-private.h>
+#include <mongoc/mongoc-find-cache-private.h>
+#include <mongoc/mongoc-group-commit-private.h>
 #include <mongoc/mongoc-jitter-source-private.h>
+#include <mongoc/mongoc-lookup-batcher-private.h>
 #include <mongoc/mongoc-rpc-private.h>
+#include <mongoc/mongoc-shard-routing-private.h>
 
 #include <mongoc/mongoc-config.h>
 #include <mongoc/mongoc-host-list.h>
@@ -131,6 +135,18 @@ struct _mongoc_client_t {
    mongoc_jitter_source_t *jitter_source;
    int32_t max_adaptive_retries;
    bool enable_overload_retargeting;
+
+   /* Set by mongoc_client_set_find_cache, NULL if disabled. */
+   mongoc_find_cache_t *find_cache;
+
+   /* Owned by the pool that created this client, NULL if disabled. */
+   mongoc_group_commit_t *group_commit;
+
+   /* Owned by the pool that created this client, NULL if disabled. */
+   mongoc_lookup_batcher_t *lookup_batcher;
+
+   /* Created by the first bulk operation grouped by shard. */
+   mongoc_shard_routing_t *shard_routing;
 };
 
 /* Defines whether _mongoc_client_command_with_opts() is acting as a read
@@ -1201,6 +1201,11 @@ void
 mongoc_client_destroy(mongoc_client_t *client)
 {
    if (client) {
+      bson_error_t error;
+      if (!mongoc_cluster_flush_w0_buffer(&client->cluster, &error)) {
+         MONGOC_WARNING("Unacknowledged writes failed: %s", error.message);
+      }
+
       if (client->topology->single_threaded) {
          _mongoc_client_end_sessions(client);
          mongoc_topology_destroy(client->topology);
@@ -1214,6 +1219,8 @@ mongoc_client_destroy(mongoc_client_t *client)
       mongoc_set_destroy(client->client_sessions);
       mongoc_server_api_destroy(client->api);
       _mongoc_jitter_source_destroy(client->jitter_source);
+      _mongoc_find_cache_destroy(client->find_cache);
+      _mongoc_shard_routing_destroy(client->shard_routing);
 
 #ifdef MONGOC_ENABLE_SSL
       _mongoc_ssl_opts_cleanup(&client->ssl_opts, true);
@@ -2839,3 +2846,102 @@ mongoc_client_append_metadata(mongoc_client_t *client, const char *name, const c
 
    return _mongoc_topology_scanner_append_metadata(client->topology->scanner, name, version, platform);
 }
+
+
+bool
+mongoc_client_set_find_cache(mongoc_client_t *client, int64_t ttl_ms, size_t max_bytes, bson_error_t *error)
+{
+   BSON_ASSERT_PARAM(client);
+
+   if (ttl_ms < 0 || ttl_ms > INT64_MAX / 1000) {
+      _mongoc_set_error(error,
+                        MONGOC_ERROR_COMMAND,
+                        MONGOC_ERROR_COMMAND_INVALID_ARG,
+                        "Invalid find cache TTL: %" PRId64 " milliseconds",
+                        ttl_ms);
+      return false;
+   }
+
+   _mongoc_find_cache_destroy(client->find_cache);
+   client->find_cache = NULL;
+
+   if (ttl_ms > 0 && max_bytes > 0) {
+      client->find_cache = _mongoc_find_cache_new(ttl_ms, max_bytes);
+   }
+
+   return true;
+}
+
+
+void
+mongoc_client_invalidate_find_cache(mongoc_client_t *client, const char *db, const char *collection)
+{
+   BSON_ASSERT_PARAM(client);
+   BSON_OPTIONAL_PARAM(db);
+   BSON_OPTIONAL_PARAM(collection);
+
+   if (client->find_cache) {
+      _mongoc_find_cache_invalidate(client->find_cache, db, collection);
+   }
+}
+
+
+bool
+mongoc_client_set_unacknowledged_write_buffer(mongoc_client_t *client,
+                                              size_t max_bytes,
+                                              int64_t flush_interval_ms,
+                                              int64_t probe_interval_ms,
+                                              bson_error_t *error)
+{
+   BSON_ASSERT_PARAM(client);
+
+   if (flush_interval_ms < 0 || flush_interval_ms > INT64_MAX / 1000) {
+      _mongoc_set_error(error,
+                        MONGOC_ERROR_COMMAND,
+                        MONGOC_ERROR_COMMAND_INVALID_ARG,
+                        "Invalid flush interval: %" PRId64 " milliseconds",
+                        flush_interval_ms);
+      return false;
+   }
+
+   if (probe_interval_ms < 0 || probe_interval_ms > INT64_MAX / 1000) {
+      _mongoc_set_error(error,
+                        MONGOC_ERROR_COMMAND,
+                        MONGOC_ERROR_COMMAND_INVALID_ARG,
+                        "Invalid probe interval: %" PRId64 " milliseconds",
+                        probe_interval_ms);
+      return false;
+   }
+
+   mongoc_cluster_set_w0_buffer(&client->cluster, max_bytes, flush_interval_ms, probe_interval_ms);
+
+   return true;
+}
+
+
+bool
+mongoc_client_flush_unacknowledged_writes(mongoc_client_t *client, bson_error_t *error)
+{
+   BSON_ASSERT_PARAM(client);
+
+   mongoc_cluster_w0_buffer_t *const w0 = &client->cluster.w0_buffer;
+
+   if (!mongoc_cluster_flush_w0_buffer(&client->cluster, error)) {
+      return false;
+   }
+
+   if (!w0->last_server_id) {
+      return true;
+   }
+
+   // Writes on a connection are applied in order: the reply to a command shows that earlier writes were applied.
+   const uint32_t server_id = w0->last_server_id;
+   w0->last_server_id = 0;
+
+   bson_t ping = BSON_INITIALIZER;
+   BSON_APPEND_INT32(&ping, "ping", 1);
+   const bool ret = mongoc_client_command_simple_with_server_id(client, "admin", &ping, NULL, server_id, NULL, error);
+   bson_destroy(&ping);
+
+   return ret;
+}
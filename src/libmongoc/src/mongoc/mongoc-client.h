@@ -283,6 +283,22 @@ mongoc_client_set_oidc_callback(mongoc_client_t *client, const mongoc_oidc_callb
 MONGOC_EXPORT(bool)
 mongoc_client_append_metadata(mongoc_client_t *client, const char *name, const char *version, const char *platform);
 
+MONGOC_EXPORT(bool)
+mongoc_client_set_find_cache(mongoc_client_t *client, int64_t ttl_ms, size_t max_bytes, bson_error_t *error);
+
+MONGOC_EXPORT(void)
+mongoc_client_invalidate_find_cache(mongoc_client_t *client, const char *db, const char *collection);
+
+MONGOC_EXPORT(bool)
+mongoc_client_set_unacknowledged_write_buffer(mongoc_client_t *client,
+                                              size_t max_bytes,
+                                              int64_t flush_interval_ms,
+                                              int64_t probe_interval_ms,
+                                              bson_error_t *error);
+
+MONGOC_EXPORT(bool)
+mongoc_client_flush_unacknowledged_writes(mongoc_client_t *client, bson_error_t *error);
+
 BSON_END_DECLS
 
 
@@ -54,6 +54,21 @@ typedef struct _mongoc_cluster_node_t {
    mongoc_oidc_connection_cache_t *oidc_connection_cache;
 } mongoc_cluster_node_t;
 
+// `mongoc_cluster_w0_buffer_t` holds unacknowledged OP_MSG messages to one stream until they are written with a single
+// call. See `mongoc_client_set_unacknowledged_write_buffer`.
+typedef struct {
+   size_t max_bytes; // 0 if messages are written when sent.
+   int64_t flush_interval_usec;
+   int64_t probe_interval_usec;
+   mongoc_buffer_t messages;
+   uint32_t server_id;
+   mongoc_stream_t *stream;
+   int64_t oldest_usec;     // When the first message in `messages` was buffered.
+   int64_t last_probe_usec; // When the connection was last checked.
+   uint32_t last_server_id; // The server of the last buffered message, 0 if none.
+   bson_error_t error;      // The first error of a write or probe not yet reported.
+} mongoc_cluster_w0_buffer_t;
+
 typedef struct _mongoc_cluster_t {
    int64_t operation_id;
    int32_t request_id;
@@ -66,6 +81,8 @@ typedef struct _mongoc_cluster_t {
 
    mongoc_set_t *nodes;
    mongoc_array_t iov;
+
+   mongoc_cluster_w0_buffer_t w0_buffer;
 } mongoc_cluster_t;
 
 
@@ -83,6 +100,19 @@ mongoc_cluster_reset_sockettimeoutms(mongoc_cluster_t *cluster);
 
 void
 mongoc_cluster_disconnect_node(mongoc_cluster_t *cluster, uint32_t id);
+
+// `mongoc_cluster_set_w0_buffer` buffers unacknowledged messages up to `max_bytes`, or writes them when sent if
+// `max_bytes` is 0. Buffered messages are written first.
+void
+mongoc_cluster_set_w0_buffer(mongoc_cluster_t *cluster,
+                             size_t max_bytes,
+                             int64_t flush_interval_ms,
+                             int64_t probe_interval_ms);
+
+// `mongoc_cluster_flush_w0_buffer` writes buffered unacknowledged messages. Returns false and sets `error` if this or
+// an earlier write or probe of buffered messages failed since the last call.
+bool
+mongoc_cluster_flush_w0_buffer(mongoc_cluster_t *cluster, bson_error_t *error);
 int32_t
 mongoc_cluster_get_max_bson_obj_size(mongoc_cluster_t *cluster);
 
@@ -203,6 +233,34 @@ mongoc_cluster_run_retryable_write(mongoc_cluster_t *cluster,
                                    bson_t *reply,
                                    bson_error_t *error);
 
+// `mongoc_cluster_pipelined_t` tracks a command sent with `mongoc_cluster_send_pipelined` until its reply is received.
+typedef struct {
+   int32_t request_id;
+   int64_t started;
+   bool is_redacted_by_apm;
+} mongoc_cluster_pipelined_t;
+
+// `mongoc_cluster_send_pipelined` sends an acknowledged command without waiting for the reply, so several commands may
+// be in flight on `cmd->server_stream` at once. Replies must be received with `mongoc_cluster_recv_pipelined` in the
+// order the commands were sent. Command started events are published on send. Auto encryption is not supported.
+// `reply` is a required out-param. `*reply` is always initialized upon return.
+bool
+mongoc_cluster_send_pipelined(mongoc_cluster_t *cluster,
+                              mongoc_cmd_t *cmd,
+                              mongoc_cluster_pipelined_t *pipelined,
+                              bson_t *reply,
+                              bson_error_t *error);
+
+// `mongoc_cluster_recv_pipelined` receives the reply to a command sent with `mongoc_cluster_send_pipelined`. `cmd` must
+// have the same server stream, session, and command name as when it was sent.
+// `reply` is a required out-param. `*reply` is always initialized upon return.
+bool
+mongoc_cluster_recv_pipelined(mongoc_cluster_t *cluster,
+                              const mongoc_cmd_t *cmd,
+                              const mongoc_cluster_pipelined_t *pipelined,
+                              bson_t *reply,
+                              bson_error_t *error);
+
 /**
  * @param reply is an optional out-param. If non-NULL, `*reply` is always initialized upon return.
  */
@@ -579,51 +579,14 @@ _handle_txn_error_labels(bool cmd_ret, const bson_error_t *cmd_err, const mongoc
    _mongoc_write_error_handle_labels(cmd_ret, cmd_err, reply, cmd->server_stream->sd);
 }
 
-/**
- * @brief An internal helper to run a command with APM monitoring.
- * @param reply is an optional out-param. If non-NULL, `*reply` is always initialized upon return.
- */
-static bool
-run_command_monitored(mongoc_cluster_t *cluster, mongoc_cmd_t *cmd, bson_t *reply, bson_error_t *error)
+// `_command_started` logs and publishes the command started event for `cmd`.
+static void
+_command_started(mongoc_cluster_t *cluster, mongoc_cmd_t *cmd, int32_t request_id, bool *is_redacted_by_apm)
 {
-   BSON_OPTIONAL_PARAM(reply);
-
-   bool retval;
-   const int32_t request_id = ++cluster->request_id;
-   uint32_t server_id;
    mongoc_apm_command_started_t started_event;
-   mongoc_apm_command_succeeded_t succeeded_event;
-   mongoc_apm_command_failed_t failed_event;
-   int64_t started = bson_get_monotonic_time();
-   const mongoc_server_stream_t *server_stream;
-   bson_t reply_local;
-   bson_iter_t iter;
-   bson_t encrypted = BSON_INITIALIZER;
-   bson_t decrypted = BSON_INITIALIZER;
-   mongoc_cmd_t encrypted_cmd;
-   bool is_redacted_by_apm = false;
-
-   server_stream = cmd->server_stream;
-   server_id = server_stream->sd->id;
-
+   const mongoc_server_stream_t *server_stream = cmd->server_stream;
    const mongoc_log_and_monitor_instance_t *log_and_monitor = &cluster->client->topology->log_and_monitor;
 
-   if (!reply) {
-      reply = &reply_local;
-   }
-   bson_error_reset(error);
-
-   if (_mongoc_cse_is_enabled(cluster->client)) {
-      bson_destroy(&encrypted);
-
-      retval = _mongoc_cse_auto_encrypt(cluster->client, cmd, &encrypted_cmd, &encrypted, error);
-      cmd = &encrypted_cmd;
-      if (!retval) {
-         bson_init(reply);
-         goto fail_no_events;
-      }
-   }
-
    mongoc_structured_log(
       log_and_monitor->structured_log,
       MONGOC_STRUCTURED_LOG_LEVEL_DEBUG,
@@ -635,17 +598,33 @@ run_command_monitored(mongoc_cluster_t *cluster, mongoc_cmd_t *cmd, bson_t *repl
 
    if (log_and_monitor->apm_callbacks.started) {
       mongoc_apm_command_started_init_with_cmd(
-         &started_event, cmd, request_id, &is_redacted_by_apm, log_and_monitor->apm_context);
+         &started_event, cmd, request_id, is_redacted_by_apm, log_and_monitor->apm_context);
 
       log_and_monitor->apm_callbacks.started(&started_event);
       mongoc_apm_command_started_cleanup(&started_event);
    }
+}
 
-   retval = mongoc_cluster_run_opmsg(cluster, cmd, reply, error);
+// `_command_completed` logs and publishes the command succeeded or failed event for `cmd`.
+static void
+_command_completed(mongoc_cluster_t *cluster,
+                   const mongoc_cmd_t *cmd,
+                   int32_t request_id,
+                   int64_t started,
+                   bool is_redacted_by_apm,
+                   bool retval,
+                   const bson_t *reply,
+                   const bson_error_t *error)
+{
+   mongoc_apm_command_succeeded_t succeeded_event;
+   mongoc_apm_command_failed_t failed_event;
+   const mongoc_server_stream_t *server_stream = cmd->server_stream;
+   const uint32_t server_id = server_stream->sd->id;
+   const mongoc_log_and_monitor_instance_t *log_and_monitor = &cluster->client->topology->log_and_monitor;
+   const int64_t duration = bson_get_monotonic_time() - started;
 
    if (retval) {
       bson_t fake_reply = BSON_INITIALIZER;
-      int64_t duration = bson_get_monotonic_time() - started;
 
       /*
        * Unacknowledged writes must provide a CommandSucceededEvent with an
@@ -688,8 +667,6 @@ run_command_monitored(mongoc_cluster_t *cluster, mongoc_cmd_t *cmd, bson_t *repl
 
       bson_destroy(&fake_reply);
    } else {
-      int64_t duration = bson_get_monotonic_time() - started;
-
       mongoc_structured_log(
          log_and_monitor->structured_log,
          MONGOC_STRUCTURED_LOG_LEVEL_DEBUG,
@@ -721,19 +698,15 @@ run_command_monitored(mongoc_cluster_t *cluster, mongoc_cmd_t *cmd, bson_t *repl
          mongoc_apm_command_failed_cleanup(&failed_event);
       }
    }
+}
 
-   if (retval && _mongoc_cse_is_enabled(cluster->client)) {
-      bson_destroy(&decrypted);
-      retval = _mongoc_cse_auto_decrypt(cluster->client, cmd->db_name, reply, &decrypted, error);
-      bson_destroy(reply);
-      bson_steal(reply, &decrypted);
-      bson_init(&decrypted);
-      if (!retval) {
-         goto fail_no_events;
-      }
-   }
+// `_handle_reply` applies the side effects of a (decrypted) reply to the cluster and session.
+static void
+_handle_reply(mongoc_cluster_t *cluster, const mongoc_cmd_t *cmd, bool retval, const bson_error_t *error, bson_t *reply)
+{
+   bson_iter_t iter;
 
-   _handle_not_primary_error(cluster, server_stream, reply);
+   _handle_not_primary_error(cluster, cmd->server_stream, reply);
 
    _handle_txn_error_labels(retval, error, cmd, reply);
 
@@ -747,6 +720,63 @@ run_command_monitored(mongoc_cluster_t *cluster, mongoc_cmd_t *cmd, bson_t *repl
          cmd->session->recovery_token = NULL;
       }
    }
+}
+
+/**
+ * @brief An internal helper to run a command with APM monitoring.
+ * @param reply is an optional out-param. If non-NULL, `*reply` is always initialized upon return.
+ */
+static bool
+run_command_monitored(mongoc_cluster_t *cluster, mongoc_cmd_t *cmd, bson_t *reply, bson_error_t *error)
+{
+   BSON_OPTIONAL_PARAM(reply);
+
+   bool retval;
+   const int32_t request_id = ++cluster->request_id;
+   uint32_t server_id;
+   int64_t started = bson_get_monotonic_time();
+   bson_t reply_local;
+   bson_t encrypted = BSON_INITIALIZER;
+   bson_t decrypted = BSON_INITIALIZER;
+   mongoc_cmd_t encrypted_cmd;
+   bool is_redacted_by_apm = false;
+
+   server_id = cmd->server_stream->sd->id;
+
+   if (!reply) {
+      reply = &reply_local;
+   }
+   bson_error_reset(error);
+
+   if (_mongoc_cse_is_enabled(cluster->client)) {
+      bson_destroy(&encrypted);
+
+      retval = _mongoc_cse_auto_encrypt(cluster->client, cmd, &encrypted_cmd, &encrypted, error);
+      cmd = &encrypted_cmd;
+      if (!retval) {
+         bson_init(reply);
+         goto fail_no_events;
+      }
+   }
+
+   _command_started(cluster, cmd, request_id, &is_redacted_by_apm);
+
+   retval = mongoc_cluster_run_opmsg(cluster, cmd, reply, error);
+
+   _command_completed(cluster, cmd, request_id, started, is_redacted_by_apm, retval, reply, error);
+
+   if (retval && _mongoc_cse_is_enabled(cluster->client)) {
+      bson_destroy(&decrypted);
+      retval = _mongoc_cse_auto_decrypt(cluster->client, cmd->db_name, reply, &decrypted, error);
+      bson_destroy(reply);
+      bson_steal(reply, &decrypted);
+      bson_init(&decrypted);
+      if (!retval) {
+         goto fail_no_events;
+      }
+   }
+
+   _handle_reply(cluster, cmd, retval, error, reply);
 
 fail_no_events:
    if (reply == &reply_local) {
@@ -1895,6 +1925,158 @@ _mongoc_cluster_auth_node(mongoc_cluster_t *cluster,
  * now invalid, be careful of dangling pointers.
  */
 
+// Discards buffered unacknowledged messages to `server_id`: the connection they were buffered for is closed.
+static void
+_mongoc_cluster_w0_discard(mongoc_cluster_t *cluster, uint32_t server_id)
+{
+   mongoc_cluster_w0_buffer_t *const w0 = &cluster->w0_buffer;
+
+   if (!w0->messages.len || w0->server_id != server_id) {
+      return;
+   }
+
+   if (!w0->error.code) {
+      _mongoc_set_error(&w0->error,
+                        MONGOC_ERROR_STREAM,
+                        MONGOC_ERROR_STREAM_SOCKET,
+                        "Connection to server %" PRIu32 " closed before %zu bytes of unacknowledged writes were sent",
+                        server_id,
+                        w0->messages.len);
+   }
+
+   _mongoc_buffer_clear(&w0->messages, false);
+   w0->stream = NULL;
+}
+
+
+// Returns the stream of the connection to `server_id`, or NULL if not connected.
+static mongoc_stream_t *
+_mongoc_cluster_node_stream(mongoc_cluster_t *cluster, uint32_t server_id)
+{
+   mongoc_topology_t *const topology = cluster->client->topology;
+
+   if (topology->single_threaded) {
+      mongoc_topology_scanner_node_t *const scanner_node =
+         mongoc_topology_scanner_get_node(topology->scanner, server_id);
+      return scanner_node ? scanner_node->stream : NULL;
+   }
+
+   mongoc_cluster_node_t *const node = (mongoc_cluster_node_t *)mongoc_set_get(cluster->nodes, server_id);
+   return node ? node->stream : NULL;
+}
+
+
+// Writes buffered unacknowledged messages with a single write. On error, the messages are discarded, but the
+// connection is left for the caller to close.
+static bool
+_mongoc_cluster_w0_write(mongoc_cluster_t *cluster, bson_error_t *error)
+{
+   mongoc_cluster_w0_buffer_t *const w0 = &cluster->w0_buffer;
+   bool ret = true;
+
+   if (!w0->messages.len) {
+      return true;
+   }
+
+   if (_mongoc_cluster_node_stream(cluster, w0->server_id) != w0->stream) {
+      // Closed without calling mongoc_cluster_disconnect_node, e.g. by a reset of the client.
+      _mongoc_cluster_w0_discard(cluster, w0->server_id);
+      memcpy(error, &w0->error, sizeof *error);
+      return false;
+   }
+
+   mongoc_iovec_t iov = {.iov_base = w0->messages.data, .iov_len = w0->messages.len};
+   ret = _mongoc_stream_writev_full(w0->stream, &iov, 1u, cluster->sockettimeoutms, error);
+
+   const int64_t now = bson_get_monotonic_time();
+   if (ret && w0->probe_interval_usec > 0 && now - w0->last_probe_usec >= w0->probe_interval_usec) {
+      // The server closes the connection if it cannot apply an unacknowledged write, e.g. after a stepdown.
+      w0->last_probe_usec = now;
+      if (mongoc_stream_check_closed(w0->stream)) {
+         _mongoc_set_error(error,
+                           MONGOC_ERROR_STREAM,
+                           MONGOC_ERROR_STREAM_SOCKET,
+                           "Connection to server %" PRIu32 " was closed by the server, unacknowledged writes may "
+                           "have failed",
+                           w0->server_id);
+         ret = false;
+      }
+   }
+
+   _mongoc_buffer_clear(&w0->messages, false);
+   w0->stream = NULL;
+
+   return ret;
+}
+
+
+// Writes buffered unacknowledged messages that are not to `stream`. An error is kept to be reported by
+// `mongoc_cluster_flush_w0_buffer`, and closes the connection of the messages.
+static void
+_mongoc_cluster_w0_write_other(mongoc_cluster_t *cluster, const mongoc_stream_t *stream)
+{
+   mongoc_cluster_w0_buffer_t *const w0 = &cluster->w0_buffer;
+   bson_error_t error;
+
+   if (!w0->messages.len || w0->stream == stream) {
+      return;
+   }
+
+   const uint32_t server_id = w0->server_id;
+   if (!_mongoc_cluster_w0_write(cluster, &error)) {
+      if (!w0->error.code) {
+         memcpy(&w0->error, &error, sizeof error);
+      }
+      mongoc_cluster_disconnect_node(cluster, server_id);
+   }
+}
+
+
+void
+mongoc_cluster_set_w0_buffer(mongoc_cluster_t *cluster,
+                             size_t max_bytes,
+                             int64_t flush_interval_ms,
+                             int64_t probe_interval_ms)
+{
+   BSON_ASSERT_PARAM(cluster);
+   BSON_ASSERT(flush_interval_ms >= 0 && flush_interval_ms <= INT64_MAX / 1000);
+   BSON_ASSERT(probe_interval_ms >= 0 && probe_interval_ms <= INT64_MAX / 1000);
+
+   mongoc_cluster_w0_buffer_t *const w0 = &cluster->w0_buffer;
+
+   _mongoc_cluster_w0_write_other(cluster, NULL);
+
+   if (!w0->messages.data) {
+      _mongoc_buffer_init(&w0->messages, NULL, 0, NULL, NULL);
+   }
+
+   w0->max_bytes = max_bytes;
+   w0->flush_interval_usec = flush_interval_ms * 1000;
+   w0->probe_interval_usec = probe_interval_ms * 1000;
+}
+
+
+bool
+mongoc_cluster_flush_w0_buffer(mongoc_cluster_t *cluster, bson_error_t *error)
+{
+   BSON_ASSERT_PARAM(cluster);
+
+   mongoc_cluster_w0_buffer_t *const w0 = &cluster->w0_buffer;
+
+   _mongoc_cluster_w0_write_other(cluster, NULL);
+
+   if (w0->error.code) {
+      if (error) {
+         memcpy(error, &w0->error, sizeof *error);
+      }
+      memset(&w0->error, 0, sizeof w0->error);
+      return false;
+   }
+
+   return true;
+}
+
+
 void
 mongoc_cluster_disconnect_node(mongoc_cluster_t *cluster, uint32_t server_id)
 {
@@ -1902,6 +2084,8 @@ mongoc_cluster_disconnect_node(mongoc_cluster_t *cluster, uint32_t server_id)
 
    ENTRY;
 
+   _mongoc_cluster_w0_discard(cluster, server_id);
+
    if (topology->single_threaded) {
       mongoc_topology_scanner_node_t *scanner_node;
 
@@ -2630,6 +2814,7 @@ mongoc_cluster_destroy(mongoc_cluster_t *cluster) /* INOUT */
    mongoc_set_destroy(cluster->nodes);
 
    _mongoc_array_destroy(&cluster->iov);
+   _mongoc_buffer_destroy(&cluster->w0_buffer.messages);
 
    EXIT;
 }
@@ -3189,8 +3374,35 @@ _mongoc_cluster_run_opmsg_send(
    BSON_ASSERT(iovecs);
 
    mcd_rpc_message_egress(rpc);
-   const bool res =
-      _mongoc_stream_writev_full(server_stream->stream, iovecs, num_iovecs, cluster->sockettimeoutms, error);
+
+   mongoc_cluster_w0_buffer_t *const w0 = &cluster->w0_buffer;
+   bool res = true;
+
+   // Keep the order of messages: buffered messages are written before any other message.
+   _mongoc_cluster_w0_write_other(cluster, server_stream->stream);
+
+   if (!cmd->is_acknowledged && w0->max_bytes > 0) {
+      const int64_t now = bson_get_monotonic_time();
+
+      if (!w0->messages.len) {
+         w0->server_id = server_stream->sd->id;
+         w0->stream = server_stream->stream;
+         w0->oldest_usec = now;
+      }
+      w0->last_server_id = server_stream->sd->id;
+
+      for (size_t i = 0u; i < num_iovecs; i++) {
+         _mongoc_buffer_append(&w0->messages, iovecs[i].iov_base, iovecs[i].iov_len);
+      }
+
+      if (w0->messages.len >= w0->max_bytes ||
+          (w0->flush_interval_usec > 0 && now - w0->oldest_usec >= w0->flush_interval_usec)) {
+         res = _mongoc_cluster_w0_write(cluster, error);
+      }
+   } else {
+      res = _mongoc_cluster_w0_write(cluster, error) &&
+            _mongoc_stream_writev_full(server_stream->stream, iovecs, num_iovecs, cluster->sockettimeoutms, error);
+   }
 
    if (!res) {
       RUN_CMD_ERR_DECORATE;
@@ -3221,11 +3433,19 @@ _mongoc_cluster_run_opmsg_recv(
 
    mongoc_server_stream_t *const server_stream = cmd->server_stream;
 
-   mongoc_buffer_t buffer;
-   _mongoc_buffer_init(&buffer, NULL, 0, NULL, NULL);
+   // Receive into the caller's reusable buffer if one was provided to avoid a fresh allocation per reply.
+   mongoc_buffer_t local_buffer;
+   mongoc_buffer_t *const buffer = cmd->reply_buffer ? cmd->reply_buffer : &local_buffer;
+   mongoc_buffer_t decompressed_buffer = {0};
+
+   if (buffer == &local_buffer || !buffer->data) {
+      _mongoc_buffer_init(buffer, NULL, 0, NULL, NULL);
+   } else {
+      _mongoc_buffer_clear(buffer, false);
+   }
 
    if (!_mongoc_buffer_append_from_stream(
-          &buffer, server_stream->stream, sizeof(int32_t), cluster->sockettimeoutms, error)) {
+          buffer, server_stream->stream, sizeof(int32_t), cluster->sockettimeoutms, error)) {
       MONGOC_DEBUG("could not read message length, stream probably closed or timed out");
       RUN_CMD_ERR_DECORATE;
       _handle_network_error(cluster, cmd, reply, error);
@@ -3234,7 +3454,7 @@ _mongoc_cluster_run_opmsg_recv(
    }
 
    const int32_t max_msg_size = mongoc_cluster_get_max_msg_size(cluster);
-   const int32_t message_length = mlib_read_i32le(buffer.data);
+   const int32_t message_length = mlib_read_i32le(buffer->data);
 
    if (message_length < message_header_length || message_length > max_msg_size) {
       RUN_CMD_ERR(MONGOC_ERROR_PROTOCOL,
@@ -3251,14 +3471,14 @@ _mongoc_cluster_run_opmsg_recv(
    const size_t remaining_bytes = (size_t)message_length - sizeof(int32_t);
 
    if (!_mongoc_buffer_append_from_stream(
-          &buffer, server_stream->stream, remaining_bytes, cluster->sockettimeoutms, error)) {
+          buffer, server_stream->stream, remaining_bytes, cluster->sockettimeoutms, error)) {
       RUN_CMD_ERR_DECORATE;
       _handle_network_error(cluster, cmd, reply, error);
       server_stream->stream = NULL;
       goto done;
    }
 
-   if (!mcd_rpc_message_from_data_in_place(rpc, buffer.data, buffer.len, NULL)) {
+   if (!mcd_rpc_message_from_data_in_place(rpc, buffer->data, buffer->len, NULL)) {
       RUN_CMD_ERR(MONGOC_ERROR_PROTOCOL, MONGOC_ERROR_PROTOCOL_INVALID_REPLY, "malformed server message");
       _handle_network_error(cluster, cmd, reply, error);
       server_stream->stream = NULL;
@@ -3278,8 +3498,7 @@ _mongoc_cluster_run_opmsg_recv(
    }
 
    if (decompressed_data) {
-      _mongoc_buffer_destroy(&buffer);
-      _mongoc_buffer_init(&buffer, decompressed_data, decompressed_data_len, NULL, NULL);
+      _mongoc_buffer_init(&decompressed_buffer, decompressed_data, decompressed_data_len, NULL, NULL);
    }
 
    // CDRIVER-5584
@@ -3316,11 +3535,20 @@ _mongoc_cluster_run_opmsg_recv(
       _mongoc_client_session_handle_reply(cmd->session, cmd->is_acknowledged, cmd->command_name, &body);
    }
 
-   bson_copy_to(&body, reply);
+   if (ret && buffer == cmd->reply_buffer && !decompressed_data) {
+      // The body is a view into the reusable buffer: return it without copying. Error replies are still copied
+      // since error labels may be appended to them later.
+      BSON_ASSERT(bson_init_static(reply, bson_get_data(&body), body.len));
+   } else {
+      bson_copy_to(&body, reply);
+   }
    bson_destroy(&body);
 
 done:
-   _mongoc_buffer_destroy(&buffer);
+   if (buffer == &local_buffer) {
+      _mongoc_buffer_destroy(&local_buffer);
+   }
+   _mongoc_buffer_destroy(&decompressed_buffer);
 
    return ret;
 }
@@ -3381,6 +3609,101 @@ done:
 }
 
 
+bool
+mongoc_cluster_send_pipelined(mongoc_cluster_t *cluster,
+                              mongoc_cmd_t *cmd,
+                              mongoc_cluster_pipelined_t *pipelined,
+                              bson_t *reply,
+                              bson_error_t *error)
+{
+   BSON_ASSERT_PARAM(cluster);
+   BSON_ASSERT_PARAM(cmd);
+   BSON_ASSERT_PARAM(pipelined);
+   BSON_ASSERT_PARAM(reply);
+   BSON_ASSERT_PARAM(error);
+
+   BSON_ASSERT(cmd->command_name);
+   BSON_ASSERT(cmd->is_acknowledged);
+   BSON_ASSERT(!cmd->op_msg_is_exhaust);
+   BSON_ASSERT(!_mongoc_cse_is_enabled(cluster->client));
+
+   bson_error_reset(error);
+
+   *pipelined = (mongoc_cluster_pipelined_t){
+      .request_id = ++cluster->request_id,
+      .started = bson_get_monotonic_time(),
+      .is_redacted_by_apm = false,
+   };
+
+   if (cluster->client->in_exhaust) {
+      _mongoc_set_error(error,
+                        MONGOC_ERROR_CLIENT,
+                        MONGOC_ERROR_CLIENT_IN_EXHAUST,
+                        "another cursor derived from this client is in exhaust");
+      bson_init(reply);
+      return false;
+   }
+
+   _command_started(cluster, cmd, pipelined->request_id, &pipelined->is_redacted_by_apm);
+
+   mcd_rpc_message *const rpc = mcd_rpc_message_new();
+   const bool ret = _mongoc_cluster_run_opmsg_send(cluster, cmd, rpc, reply, error);
+   mcd_rpc_message_destroy(rpc);
+
+   if (ret) {
+      bson_init(reply);
+   } else {
+      // The reply will never arrive: complete the command now.
+      _command_completed(
+         cluster, cmd, pipelined->request_id, pipelined->started, pipelined->is_redacted_by_apm, false, reply, error);
+      _handle_reply(cluster, cmd, false, error, reply);
+      _mongoc_topology_update_last_used(cluster->client->topology, cmd->server_stream->sd->id);
+   }
+
+   return ret;
+}
+
+
+bool
+mongoc_cluster_recv_pipelined(mongoc_cluster_t *cluster,
+                              const mongoc_cmd_t *cmd,
+                              const mongoc_cluster_pipelined_t *pipelined,
+                              bson_t *reply,
+                              bson_error_t *error)
+{
+   BSON_ASSERT_PARAM(cluster);
+   BSON_ASSERT_PARAM(cmd);
+   BSON_ASSERT_PARAM(pipelined);
+   BSON_ASSERT_PARAM(reply);
+   BSON_ASSERT_PARAM(error);
+
+   bool ret;
+
+   bson_error_reset(error);
+
+   if (!cmd->server_stream->stream || !mongoc_cluster_stream_valid(cluster, cmd->server_stream)) {
+      // An error on an earlier reply closed the connection.
+      _mongoc_set_error(error,
+                        MONGOC_ERROR_STREAM,
+                        MONGOC_ERROR_STREAM_SOCKET,
+                        "connection closed before the reply to a pipelined command was received");
+      bson_init(reply);
+      ret = false;
+   } else {
+      mcd_rpc_message *const rpc = mcd_rpc_message_new();
+      ret = _mongoc_cluster_run_opmsg_recv(cluster, cmd, rpc, reply, error);
+      mcd_rpc_message_destroy(rpc);
+   }
+
+   _command_completed(
+      cluster, cmd, pipelined->request_id, pipelined->started, pipelined->is_redacted_by_apm, ret, reply, error);
+   _handle_reply(cluster, cmd, ret, error, reply);
+   _mongoc_topology_update_last_used(cluster->client->topology, cmd->server_stream->sd->id);
+
+   return ret;
+}
+
+
 bool
 mcd_rpc_message_compress(mcd_rpc_message *rpc,
                          int32_t compressor_id,
@@ -27,6 +27,7 @@
 #ifndef MONGOC_CMD_PRIVATE_H
 #define MONGOC_CMD_PRIVATE_H
 
+#include <mongoc/mongoc-buffer-private.h>
 #include <mongoc/mongoc-opts-private.h>
 #include <mongoc/mongoc-server-stream-private.h>
 
@@ -77,13 +78,23 @@ typedef struct _mongoc_cmd_t {
    bool is_acknowledged;
    bool is_txn_finish;
    bool op_msg_is_exhaust;
+   // If set, the reply is received into `reply_buffer` instead of a temporary buffer. A successful reply may then be
+   // returned as a read-only view into `reply_buffer`, valid until the buffer is reused or destroyed.
+   mongoc_buffer_t *reply_buffer;
 } mongoc_cmd_t;
 
 
+// The size of the arena buffer of a mongoc_cmd_parts_t, enough for the documents of most commands.
+#define MONGOC_CMD_PARTS_ARENA_SIZE 2048
+
 typedef struct _mongoc_cmd_parts_t {
    mongoc_cmd_t assembled;
    mongoc_query_flags_t user_query_flags;
    const bson_t *body;
+   // The documents below are allocated from `arena`, drawing from `arena_buffer` first, and released together by
+   // mongoc_cmd_parts_cleanup().
+   bson_arena_t arena;
+   uint8_t arena_buffer[MONGOC_CMD_PARTS_ARENA_SIZE];
    bson_t read_concern_document;
    bson_t write_concern_document;
    bson_t extra;
@@ -50,10 +50,11 @@ mongoc_cmd_parts_init(mongoc_cmd_parts_t *parts,
    parts->is_retryable_write = false;
    parts->has_temp_session = false;
    parts->client = client;
-   bson_init(&parts->read_concern_document);
-   bson_init(&parts->write_concern_document);
-   bson_init(&parts->extra);
-   bson_init(&parts->assembled_body);
+   bson_arena_init(&parts->arena, parts->arena_buffer, sizeof parts->arena_buffer);
+   bson_init_arena(&parts->read_concern_document, &parts->arena);
+   bson_init_arena(&parts->write_concern_document, &parts->arena);
+   bson_init_arena(&parts->extra, &parts->arena);
+   bson_init_arena(&parts->assembled_body, &parts->arena);
 
    parts->assembled.db_name = db_name;
    parts->assembled.command = NULL;
@@ -64,6 +65,7 @@ mongoc_cmd_parts_init(mongoc_cmd_parts_t *parts,
    parts->assembled.session = NULL;
    parts->assembled.is_acknowledged = true;
    parts->assembled.is_txn_finish = false;
+   parts->assembled.reply_buffer = NULL;
 }
 
 
@@ -150,8 +152,8 @@ mongoc_cmd_parts_append_opts(mongoc_cmd_parts_t *parts, bson_iter_t *iter, bson_
          /* add readConcern later, once we know about causal consistency */
          bson_iter_document(iter, &len, &data);
          BSON_ASSERT(bson_init_static(&read_concern, data, (size_t)len));
-         bson_destroy(&parts->read_concern_document);
-         bson_copy_to(&read_concern, &parts->read_concern_document);
+         bson_reinit(&parts->read_concern_document);
+         bson_concat(&parts->read_concern_document, &read_concern);
          continue;
       } else if (BSON_ITER_IS_KEY(iter, "sessionId")) {
          BSON_ASSERT(!parts->assembled.session);
@@ -215,8 +217,8 @@ mongoc_cmd_parts_set_read_concern(mongoc_cmd_parts_t *parts, const mongoc_read_c
       RETURN(true);
    }
 
-   bson_destroy(&parts->read_concern_document);
-   bson_copy_to(_mongoc_read_concern_get_bson((mongoc_read_concern_t *)rc), &parts->read_concern_document);
+   bson_reinit(&parts->read_concern_document);
+   bson_concat(&parts->read_concern_document, _mongoc_read_concern_get_bson((mongoc_read_concern_t *)rc));
 
    RETURN(true);
 }
@@ -240,8 +242,8 @@ mongoc_cmd_parts_set_write_concern(mongoc_cmd_parts_t *parts, const mongoc_write
    }
 
    parts->assembled.is_acknowledged = mongoc_write_concern_is_acknowledged(wc);
-   bson_destroy(&parts->write_concern_document);
-   bson_copy_to(_mongoc_write_concern_get_bson((mongoc_write_concern_t *)wc), &parts->write_concern_document);
+   bson_reinit(&parts->write_concern_document);
+   bson_concat(&parts->write_concern_document, _mongoc_write_concern_get_bson((mongoc_write_concern_t *)wc));
 
    RETURN(true);
 }
@@ -287,8 +289,8 @@ mongoc_cmd_parts_append_read_write(mongoc_cmd_parts_t *parts, mongoc_read_write_
    /* process explicit read concern */
    if (!bson_empty(&rw_opts->readConcern)) {
       /* save readConcern for later, once we know about causal consistency */
-      bson_destroy(&parts->read_concern_document);
-      bson_copy_to(&rw_opts->readConcern, &parts->read_concern_document);
+      bson_reinit(&parts->read_concern_document);
+      bson_concat(&parts->read_concern_document, &rw_opts->readConcern);
    }
 
    if (rw_opts->client_session) {
@@ -936,6 +938,7 @@ mongoc_cmd_parts_cleanup(mongoc_cmd_parts_t *parts)
    bson_destroy(&parts->write_concern_document);
    bson_destroy(&parts->extra);
    bson_destroy(&parts->assembled_body);
+   bson_arena_destroy(&parts->arena);
 
    if (parts->has_temp_session) {
       /* client session returns its server session to server session pool */
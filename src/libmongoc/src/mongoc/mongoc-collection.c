@@ -21,6 +21,7 @@
 #include <common-macros-private.h> // BEGIN_IGNORE_DEPRECATIONS
 #include <common-string-private.h>
 #include <mongoc/mongoc-aggregate-private.h>
+#include <mongoc/mongoc-buffer-private.h>
 #include <mongoc/mongoc-bulk-operation-private.h>
 #include <mongoc/mongoc-change-stream-private.h>
 #include <mongoc/mongoc-client-private.h>
@@ -29,6 +30,8 @@
 #include <mongoc/mongoc-database-private.h>
 #include <mongoc/mongoc-error-private.h>
 #include <mongoc/mongoc-find-and-modify-private.h>
+#include <mongoc/mongoc-group-commit-private.h>
+#include <mongoc/mongoc-lookup-batcher-private.h>
 #include <mongoc/mongoc-opts-private.h>
 #include <mongoc/mongoc-read-concern-private.h>
 #include <mongoc/mongoc-read-prefs-private.h>
@@ -43,6 +46,8 @@
 
 #include <bson/bson.h>
 
+#include <mlib/intencode.h>
+
 #include <stdio.h>
 
 #undef MONGOC_LOG_DOMAIN
@@ -90,6 +95,7 @@ static void
 _mongoc_collection_write_command_execute_idl(mongoc_write_command_t *command,
                                              const mongoc_collection_t *collection,
                                              mongoc_crud_opts_t *crud,
+                                             uint32_t offset,
                                              mongoc_write_result_t *result)
 {
    mongoc_server_stream_t *server_stream;
@@ -125,7 +131,7 @@ _mongoc_collection_write_command_execute_idl(mongoc_write_command_t *command,
    }
 
    _mongoc_write_command_execute_idl(
-      command, collection->client, server_stream, collection->db, collection->collection, 0 /* offset */, crud, result);
+      command, collection->client, server_stream, collection->db, collection->collection, offset, crud, result);
 
    mongoc_server_stream_cleanup(server_stream);
 
@@ -339,6 +345,102 @@ mongoc_collection_find_with_opts(mongoc_collection_t *collection,
 }
 
 
+typedef struct {
+   mongoc_collection_t *collection;
+   const mongoc_read_prefs_t *read_prefs;
+} _lookup_batcher_ctx_t;
+
+
+static mongoc_cursor_t *
+_lookup_batcher_find(const bson_t *filter, void *ctx)
+{
+   _lookup_batcher_ctx_t *const lb_ctx = (_lookup_batcher_ctx_t *)ctx;
+
+   return mongoc_collection_find_with_opts(lb_ctx->collection, filter, NULL, lb_ctx->read_prefs);
+}
+
+
+/* Looks up the document with _id `id` together with concurrent lookups of
+ * other threads with the same namespace and read options. */
+static bool
+_lookup_batcher_find_one_by_id(mongoc_collection_t *collection,
+                               const bson_value_t *id,
+                               const mongoc_read_prefs_t *read_prefs,
+                               bson_t *document,
+                               bson_error_t *error)
+{
+   _lookup_batcher_ctx_t ctx = {.collection = collection, .read_prefs = read_prefs};
+   bson_t read_opts = BSON_INITIALIZER;
+
+   BSON_ASSERT(mongoc_read_prefs_append_contents_to_bson(read_prefs ? read_prefs : collection->read_prefs,
+                                                         &read_opts,
+                                                         MONGOC_READ_PREFS_CONTENT_FLAG_MODE |
+                                                            MONGOC_READ_PREFS_CONTENT_FLAG_TAGS |
+                                                            MONGOC_READ_PREFS_CONTENT_FLAG_MAX_STALENESS_SECONDS |
+                                                            MONGOC_READ_PREFS_CONTENT_FLAG_HEDGE));
+   BSON_ASSERT(
+      BSON_APPEND_DOCUMENT(&read_opts, "readConcern", _mongoc_read_concern_get_bson(collection->read_concern)));
+
+   char *const read_json = bson_as_relaxed_extended_json(&read_opts, NULL);
+   char *const key = bson_strdup_printf("%s %s", collection->ns, read_json);
+
+   const bool ret = _mongoc_lookup_batcher_find(
+      collection->client->lookup_batcher, key, id, _lookup_batcher_find, &ctx, document, error);
+
+   bson_free(key);
+   bson_free(read_json);
+   bson_destroy(&read_opts);
+   return ret;
+}
+
+
+bool
+mongoc_collection_find_one_by_id(mongoc_collection_t *collection,
+                                 const bson_value_t *id,
+                                 const bson_t *opts,
+                                 const mongoc_read_prefs_t *read_prefs,
+                                 bson_t *document,
+                                 bson_error_t *error)
+{
+   BSON_ASSERT_PARAM(collection);
+   BSON_ASSERT_PARAM(id);
+   BSON_OPTIONAL_PARAM(opts);
+   BSON_OPTIONAL_PARAM(read_prefs);
+   BSON_ASSERT_PARAM(document);
+   BSON_OPTIONAL_PARAM(error);
+
+   bson_init(document);
+
+   // Options such as a session, a projection, or a collation are not shared by concurrent lookups.
+   if (collection->client->lookup_batcher && (!opts || bson_empty(opts)) &&
+       collection->client->topology->cse_state == MONGOC_CSE_DISABLED) {
+      return _lookup_batcher_find_one_by_id(collection, id, read_prefs, document, error);
+   }
+
+   bson_t filter = BSON_INITIALIZER;
+   bson_t find_opts = BSON_INITIALIZER;
+   const bson_t *doc;
+
+   BSON_ASSERT(BSON_APPEND_VALUE(&filter, "_id", id));
+   if (opts) {
+      bson_copy_to_excluding_noinit(opts, &find_opts, "limit", NULL);
+   }
+   BSON_ASSERT(BSON_APPEND_INT64(&find_opts, "limit", 1));
+
+   mongoc_cursor_t *const cursor = mongoc_collection_find_with_opts(collection, &filter, &find_opts, read_prefs);
+   if (mongoc_cursor_next(cursor, &doc)) {
+      BSON_ASSERT(bson_concat(document, doc));
+   }
+
+   const bool ret = !mongoc_cursor_error(cursor, error);
+
+   mongoc_cursor_destroy(cursor);
+   bson_destroy(&find_opts);
+   bson_destroy(&filter);
+   return ret;
+}
+
+
 bool
 mongoc_collection_read_command_with_opts(mongoc_collection_t *collection,
                                          const bson_t *command,
@@ -1174,6 +1276,54 @@ mongoc_collection_insert(mongoc_collection_t *collection,
  *--------------------------------------------------------------------------
  */
 
+typedef struct {
+   const mongoc_collection_t *collection;
+   mongoc_crud_opts_t *crud;
+} _group_commit_ctx_t;
+
+
+static void
+_group_commit_execute(mongoc_write_command_t *combined, void *ctx, mongoc_write_result_t *result)
+{
+   _group_commit_ctx_t *const gc_ctx = (_group_commit_ctx_t *)ctx;
+
+   _mongoc_collection_write_command_execute_idl(combined, gc_ctx->collection, gc_ctx->crud, 0 /* offset */, result);
+}
+
+
+/* Whether an insert_one may be combined with those of other threads. Options
+ * that are not shared by all callers with the same namespace and write concern
+ * must be sent in an insert of their own. */
+static bool
+_use_group_commit(const mongoc_collection_t *collection,
+                  const mongoc_insert_one_opts_t *insert_one_opts,
+                  const bson_t *cmd_opts)
+{
+   return collection->client->group_commit && !insert_one_opts->crud.writeConcern &&
+          !insert_one_opts->crud.client_session && !insert_one_opts->bypass && bson_empty(cmd_opts) &&
+          mongoc_write_concern_is_acknowledged(collection->write_concern) &&
+          collection->client->topology->cse_state == MONGOC_CSE_DISABLED;
+}
+
+
+static void
+_group_commit_insert_one(mongoc_collection_t *collection,
+                         mongoc_write_command_t *command,
+                         mongoc_crud_opts_t *crud,
+                         mongoc_write_result_t *result)
+{
+   _group_commit_ctx_t ctx = {.collection = collection, .crud = crud};
+   char *const wc_json =
+      bson_as_relaxed_extended_json(_mongoc_write_concern_get_bson(collection->write_concern), NULL);
+   char *const key = bson_strdup_printf("%s %s", collection->ns, wc_json);
+
+   _mongoc_group_commit_insert(collection->client->group_commit, key, command, _group_commit_execute, &ctx, result);
+
+   bson_free(key);
+   bson_free(wc_json);
+}
+
+
 bool
 mongoc_collection_insert_one(
    mongoc_collection_t *collection, const bson_t *document, const bson_t *opts, bson_t *reply, bson_error_t *error)
@@ -1213,7 +1363,12 @@ mongoc_collection_insert_one(
       &command, document, &cmd_opts, &insert_id, ++collection->client->cluster.operation_id);
 
    command.flags.bypass_document_validation = insert_one_opts.bypass;
-   _mongoc_collection_write_command_execute_idl(&command, collection, &insert_one_opts.crud, &result);
+   if (_use_group_commit(collection, &insert_one_opts, &cmd_opts)) {
+      _group_commit_insert_one(collection, &command, &insert_one_opts.crud, &result);
+   } else {
+      _mongoc_collection_write_command_execute_idl(
+         &command, collection, &insert_one_opts.crud, 0 /* offset */, &result);
+   }
 
    ret = MONGOC_WRITE_RESULT_COMPLETE(&result,
                                       collection->client->error_api_version,
@@ -1316,7 +1471,7 @@ mongoc_collection_insert_many(mongoc_collection_t *collection,
       _mongoc_write_command_insert_append(&command, documents[i]);
    }
 
-   _mongoc_collection_write_command_execute_idl(&command, collection, &insert_many_opts.crud, &result);
+   _mongoc_collection_write_command_execute_idl(&command, collection, &insert_many_opts.crud, 0 /* offset */, &result);
 
    ret = MONGOC_WRITE_RESULT_COMPLETE(&result,
                                       collection->client->error_api_version,
@@ -1336,6 +1491,317 @@ done:
    RETURN(ret);
 }
 
+/* Bounds the documents sent with one insert command by an import. Data is
+ * split to fit the payload size of a write command. Documents of a reader are
+ * copied into a buffer of at most this size. */
+#define MONGOC_IMPORT_DATA_CHUNK_SIZE (1024u * 1024u * 1024u)
+#define MONGOC_IMPORT_READER_CHUNK_SIZE (64u * 1024u * 1024u)
+/* The size of the "_id" added to a document without one: an ObjectId element. */
+#define MONGOC_IMPORT_ID_LEN (1u + 4u + 12u)
+
+typedef struct {
+   mongoc_collection_t *collection;
+   mongoc_insert_many_opts_t insert_many_opts;
+   bson_t cmd_opts;
+   uint32_t max_in_flight_batches;
+   int64_t operation_id;
+   // The number of documents sent so far, to report the indexes of write errors.
+   uint32_t n_sent;
+   mongoc_write_result_t result;
+} _import_t;
+
+
+static bool
+_import_init(_import_t *import, mongoc_collection_t *collection, const bson_t *opts, bson_error_t *error)
+{
+   bson_iter_t iter;
+
+   import->collection = collection;
+   bson_init(&import->cmd_opts);
+   import->max_in_flight_batches = 1;
+   import->n_sent = 0;
+   _mongoc_write_result_init(&import->result);
+
+   if (!_mongoc_insert_many_opts_parse(collection->client, opts, &import->insert_many_opts, error)) {
+      return false;
+   }
+
+   if (import->insert_many_opts.crud.comment.value_type != BSON_TYPE_EOD) {
+      bson_append_value(&import->cmd_opts, "comment", 7, &import->insert_many_opts.crud.comment);
+   }
+
+   // "maxInFlightBatches" is an option of the import, not of the insert command.
+   BSON_ASSERT(bson_iter_init(&iter, &import->insert_many_opts.extra));
+   while (bson_iter_next(&iter)) {
+      if (BSON_ITER_IS_KEY(&iter, "maxInFlightBatches")) {
+         if (!BSON_ITER_HOLDS_NUMBER(&iter) || bson_iter_as_int64(&iter) < 1 ||
+             bson_iter_as_int64(&iter) > UINT32_MAX) {
+            _mongoc_set_error(error,
+                              MONGOC_ERROR_COMMAND,
+                              MONGOC_ERROR_COMMAND_INVALID_ARG,
+                              "Invalid \"maxInFlightBatches\": must be a positive number");
+            return false;
+         }
+         import->max_in_flight_batches = (uint32_t)bson_iter_as_int64(&iter);
+      } else {
+         bson_append_iter(&import->cmd_opts, NULL, 0, &iter);
+      }
+   }
+
+   import->operation_id = ++collection->client->cluster.operation_id;
+
+   return true;
+}
+
+
+static void
+_import_cleanup(_import_t *import)
+{
+   _mongoc_write_result_destroy(&import->result);
+   _mongoc_insert_many_opts_cleanup(&import->insert_many_opts);
+   bson_destroy(&import->cmd_opts);
+}
+
+
+// Returns true if no more documents may be sent.
+static bool
+_import_must_stop(const _import_t *import)
+{
+   return import->result.must_stop || (import->insert_many_opts.ordered && import->result.failed);
+}
+
+
+/* Validates the document at `data`, which has at most `max_len` bytes. Only
+ * reads the document in place. */
+static bool
+_import_validate(
+   const _import_t *import, uint32_t index, const uint8_t *data, size_t max_len, uint32_t *len, bson_error_t *error)
+{
+   bson_t doc;
+
+   if (max_len < 5 || (*len = mlib_read_u32le(data)) < 5 || *len > max_len || data[*len - 1] != 0 ||
+       !bson_init_static(&doc, data, *len)) {
+      _mongoc_set_error(error,
+                        MONGOC_ERROR_BSON,
+                        MONGOC_ERROR_BSON_INVALID,
+                        "Document %" PRIu32 " is not valid BSON",
+                        index);
+      return false;
+   }
+
+   return _mongoc_validate_new_document(&doc, import->insert_many_opts.crud.validate, error);
+}
+
+
+/* Sends the `n_documents` documents at `data` as one insert, which may be split
+ * in several batches. The documents are not copied. */
+static void
+_import_send(_import_t *import, const uint8_t *data, uint32_t len, uint32_t n_documents)
+{
+   mongoc_write_command_t command;
+
+   if (!n_documents) {
+      return;
+   }
+
+   _mongoc_write_command_init_insert_borrowed(
+      &command, data, len, n_documents, &import->cmd_opts, import->operation_id);
+   command.flags.ordered = import->insert_many_opts.ordered;
+   command.flags.bypass_document_validation = import->insert_many_opts.bypass;
+   command.max_in_flight_batches = import->max_in_flight_batches;
+
+   _mongoc_collection_write_command_execute_idl(
+      &command, import->collection, &import->insert_many_opts.crud, import->n_sent, &import->result);
+   import->n_sent += n_documents;
+
+   _mongoc_write_command_destroy(&command);
+}
+
+
+static bool
+_import_complete(_import_t *import, bool ok, bson_t *reply, bson_error_t *error)
+{
+   bson_error_t result_error;
+   const bool result_ok = MONGOC_WRITE_RESULT_COMPLETE(&import->result,
+                                                       import->collection->client->error_api_version,
+                                                       import->insert_many_opts.crud.writeConcern,
+                                                       /* no error domain override */
+                                                       (mongoc_error_domain_t)0,
+                                                       reply,
+                                                       &result_error,
+                                                       "insertedCount");
+
+   // An invalid document takes precedence over errors of the documents sent before it.
+   if (ok && !result_ok && error) {
+      memcpy(error, &result_error, sizeof *error);
+   }
+
+   return ok && result_ok;
+}
+
+
+bool
+mongoc_collection_import_bson(mongoc_collection_t *collection,
+                              const uint8_t *data,
+                              size_t length,
+                              const bson_t *opts,
+                              bson_t *reply,
+                              bson_error_t *error)
+{
+   _import_t import;
+   mongoc_buffer_t copy;
+   size_t offset = 0;
+   bool ok = true;
+
+   ENTRY;
+
+   BSON_ASSERT_PARAM(collection);
+   BSON_ASSERT(data || length == 0);
+
+   _mongoc_bson_init_if_set(reply);
+
+   if (!_import_init(&import, collection, opts, error)) {
+      _import_cleanup(&import);
+      RETURN(false);
+   }
+
+   _mongoc_buffer_init(&copy, NULL, 0, NULL, NULL);
+
+   while (offset < length && !_import_must_stop(&import)) {
+      const uint8_t *const chunk = data + offset;
+      uint32_t chunk_len = 0;
+      uint32_t n_documents = 0;
+      bool copied = false;
+
+      /* Find the documents of the chunk. They are sent from `data` in place,
+       * unless a document needs a generated "_id": the chunk is then copied
+       * from that document on. */
+      while (offset + chunk_len < length) {
+         const uint32_t payload_len = copied ? (uint32_t)copy.len : chunk_len;
+         bson_iter_t iter;
+         uint32_t len;
+         bson_t doc;
+
+         if (!_import_validate(
+                &import, import.n_sent + n_documents, chunk + chunk_len, length - offset - chunk_len, &len, error)) {
+            ok = false;
+            break;
+         }
+
+         BSON_ASSERT(bson_init_static(&doc, chunk + chunk_len, len));
+         const bool has_id = bson_iter_init_find(&iter, &doc, "_id");
+         const uint32_t sent_len = has_id ? len : len + MONGOC_IMPORT_ID_LEN;
+
+         if (n_documents > 0 && payload_len + sent_len > MONGOC_IMPORT_DATA_CHUNK_SIZE) {
+            break;
+         }
+
+         if (!has_id && !copied) {
+            _mongoc_buffer_append(&copy, chunk, chunk_len);
+            copied = true;
+         }
+
+         if (copied) {
+            _mongoc_write_command_append_insert_document(&copy, &doc);
+         }
+
+         chunk_len += len;
+         n_documents++;
+      }
+
+      // Send the documents before an invalid document.
+      if (copied) {
+         _import_send(&import, copy.data, (uint32_t)copy.len, n_documents);
+         _mongoc_buffer_clear(&copy, false);
+      } else {
+         _import_send(&import, chunk, chunk_len, n_documents);
+      }
+      offset += chunk_len;
+
+      if (!ok) {
+         break;
+      }
+   }
+
+   _mongoc_buffer_destroy(&copy);
+   ok = _import_complete(&import, ok, reply, error);
+   _import_cleanup(&import);
+
+   RETURN(ok);
+}
+
+
+bool
+mongoc_collection_import_bson_reader(mongoc_collection_t *collection,
+                                     bson_reader_t *reader,
+                                     const bson_t *opts,
+                                     bson_t *reply,
+                                     bson_error_t *error)
+{
+   _import_t import;
+   mongoc_buffer_t chunk;
+   uint32_t n_documents = 0;
+   bool reached_eof = false;
+   bool ok = true;
+
+   ENTRY;
+
+   BSON_ASSERT_PARAM(collection);
+   BSON_ASSERT_PARAM(reader);
+
+   _mongoc_bson_init_if_set(reply);
+
+   if (!_import_init(&import, collection, opts, error)) {
+      _import_cleanup(&import);
+      RETURN(false);
+   }
+
+   _mongoc_buffer_init(&chunk, NULL, 0, NULL, NULL);
+
+   while (!_import_must_stop(&import)) {
+      const bson_t *const doc = bson_reader_read(reader, &reached_eof);
+
+      if (doc) {
+         uint32_t len;
+
+         if (!_import_validate(&import, import.n_sent + n_documents, bson_get_data(doc), doc->len, &len, error)) {
+            ok = false;
+         } else if (chunk.len + len + MONGOC_IMPORT_ID_LEN > MONGOC_IMPORT_READER_CHUNK_SIZE && n_documents > 0) {
+            _import_send(&import, chunk.data, (uint32_t)chunk.len, n_documents);
+            _mongoc_buffer_clear(&chunk, false);
+            n_documents = 0;
+         }
+      } else if (!reached_eof) {
+         _mongoc_set_error(error,
+                           MONGOC_ERROR_BSON,
+                           MONGOC_ERROR_BSON_INVALID,
+                           "Document %" PRIu32 " is not valid BSON",
+                           import.n_sent + n_documents);
+         ok = false;
+      }
+
+      if (!doc || !ok || _import_must_stop(&import)) {
+         break;
+      }
+
+      // The only copy of the document: from the reader into the payload, with a generated "_id" if it has none.
+      _mongoc_write_command_append_insert_document(&chunk, doc);
+      n_documents++;
+   }
+
+   // Send the documents before the end or an invalid document.
+   if (!_import_must_stop(&import)) {
+      _import_send(&import, chunk.data, (uint32_t)chunk.len, n_documents);
+   }
+
+   _mongoc_buffer_destroy(&chunk);
+   ok = _import_complete(&import, ok, reply, error);
+   _import_cleanup(&import);
+
+   RETURN(ok);
+}
+
+
 bool
 mongoc_collection_update(mongoc_collection_t *collection,
                          mongoc_update_flags_t uflags,
@@ -1800,7 +2266,7 @@ _mongoc_delete_one_or_many(mongoc_collection_t *collection,
       command.flags.has_delete_hint = true;
    }
 
-   _mongoc_collection_write_command_execute_idl(&command, collection, &delete_opts->crud, &result);
+   _mongoc_collection_write_command_execute_idl(&command, collection, &delete_opts->crud, 0 /* offset */, &result);
 
    /* set field described in CRUD spec for the DeleteResult */
    ret = MONGOC_WRITE_RESULT_COMPLETE(&result,
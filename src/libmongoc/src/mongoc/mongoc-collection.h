@@ -125,6 +125,14 @@ mongoc_collection_find_with_opts(mongoc_collection_t *collection,
                                  const bson_t *opts,
                                  const mongoc_read_prefs_t *read_prefs) BSON_GNUC_WARN_UNUSED_RESULT;
 
+MONGOC_EXPORT(bool)
+mongoc_collection_find_one_by_id(mongoc_collection_t *collection,
+                                 const bson_value_t *id,
+                                 const bson_t *opts,
+                                 const mongoc_read_prefs_t *read_prefs,
+                                 bson_t *document,
+                                 bson_error_t *error);
+
 MONGOC_EXPORT(bool)
 mongoc_collection_insert(mongoc_collection_t *collection,
                          mongoc_insert_flags_t flags,
@@ -144,6 +152,21 @@ mongoc_collection_insert_many(mongoc_collection_t *collection,
                               bson_t *reply,
                               bson_error_t *error);
 
+MONGOC_EXPORT(bool)
+mongoc_collection_import_bson(mongoc_collection_t *collection,
+                              const uint8_t *data,
+                              size_t length,
+                              const bson_t *opts,
+                              bson_t *reply,
+                              bson_error_t *error);
+
+MONGOC_EXPORT(bool)
+mongoc_collection_import_bson_reader(mongoc_collection_t *collection,
+                                     bson_reader_t *reader,
+                                     const bson_t *opts,
+                                     bson_t *reply,
+                                     bson_error_t *error);
+
 MONGOC_EXPORT(bool)
 mongoc_collection_update(mongoc_collection_t *collection,
                          mongoc_update_flags_t flags,
@@ -0,0 +1,495 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mongoc/mongoc-columns.h>
+
+#include <common-macros-private.h> // MC_ENABLE_CONVERSION_WARNING_BEGIN
+#include <mongoc/mongoc-array-private.h>
+#include <mongoc/mongoc-error-private.h>
+
+#include <mongoc/mongoc-error.h>
+
+#include <bson/bson.h>
+
+#include <mlib/cmp.h>
+
+MC_ENABLE_CONVERSION_WARNING_BEGIN
+
+typedef struct {
+   const char *key;
+   size_t key_len;
+} segment_t;
+
+typedef struct {
+   char *path;
+   mongoc_column_type_t type;
+   // `segments` points into `path`. The first segment is the column's root.
+   segment_t *segments;
+   size_t n_segments;
+   size_t root;
+   // `values` stores `int64_t`, `double`, or (for UTF-8 columns) `uint32_t` offsets into `utf8_data`.
+   mongoc_array_t values;
+   mongoc_array_t utf8_data;
+   // `validity` is a bitmap with one bit per row. A set bit means the row has a value.
+   mongoc_array_t validity;
+} column_t;
+
+// `root_t` is a distinct first path segment shared by one or more columns. `key` points into the path of the first
+// column added with that root.
+typedef struct {
+   segment_t key;
+} root_t;
+
+typedef struct {
+   uint32_t position;
+   uint32_t root;
+} layout_entry_t;
+
+struct _mongoc_columns_t {
+   mongoc_array_t columns; // column_t
+   mongoc_array_t roots;   // root_t
+   size_t num_rows;
+   // `layout` records the ordinal position of each root found in the previous document, in ascending order. Documents
+   // sharing the same key order as their predecessor match each root with a single key comparison.
+   mongoc_array_t layout;      // layout_entry_t
+   mongoc_array_t next_layout; // layout_entry_t
+   // Per-document scratch space sized to the number of roots.
+   mongoc_array_t root_iters; // bson_iter_t
+   mongoc_array_t root_found; // bool
+   // `key_len_mask` has bit N set if some root has length N (modulo 64). Used to skip non-matching keys cheaply.
+   uint64_t key_len_mask;
+};
+
+
+mongoc_columns_t *
+mongoc_columns_new(void)
+{
+   mongoc_columns_t *columns = bson_malloc0(sizeof(mongoc_columns_t));
+   _mongoc_array_init(&columns->columns, sizeof(column_t));
+   _mongoc_array_init(&columns->roots, sizeof(root_t));
+   _mongoc_array_init(&columns->layout, sizeof(layout_entry_t));
+   _mongoc_array_init(&columns->next_layout, sizeof(layout_entry_t));
+   _mongoc_array_init(&columns->root_iters, sizeof(bson_iter_t));
+   _mongoc_array_init(&columns->root_found, sizeof(bool));
+   return columns;
+}
+
+
+static column_t *
+_column_at(const mongoc_columns_t *columns, size_t i)
+{
+   BSON_ASSERT(i < columns->columns.len);
+   return &_mongoc_array_index(&columns->columns, column_t, i);
+}
+
+
+void
+mongoc_columns_destroy(mongoc_columns_t *columns)
+{
+   if (!columns) {
+      return;
+   }
+
+   for (size_t i = 0; i < columns->columns.len; i++) {
+      column_t *col = _column_at(columns, i);
+      _mongoc_array_destroy(&col->values);
+      _mongoc_array_destroy(&col->utf8_data);
+      _mongoc_array_destroy(&col->validity);
+      bson_free(col->segments);
+      bson_free(col->path);
+   }
+
+   _mongoc_array_destroy(&columns->root_found);
+   _mongoc_array_destroy(&columns->root_iters);
+   _mongoc_array_destroy(&columns->next_layout);
+   _mongoc_array_destroy(&columns->layout);
+   _mongoc_array_destroy(&columns->roots);
+   _mongoc_array_destroy(&columns->columns);
+   bson_free(columns);
+}
+
+
+static void
+_column_init_values(column_t *col)
+{
+   switch (col->type) {
+   case MONGOC_COLUMN_TYPE_INT64:
+      _mongoc_array_init(&col->values, sizeof(int64_t));
+      break;
+   case MONGOC_COLUMN_TYPE_DOUBLE:
+      _mongoc_array_init(&col->values, sizeof(double));
+      break;
+   case MONGOC_COLUMN_TYPE_UTF8:
+   default: {
+      const uint32_t zero = 0;
+      // UTF-8 offsets always begin with a leading 0 so row N spans [offsets[N], offsets[N + 1]).
+      _mongoc_array_init(&col->values, sizeof(uint32_t));
+      _mongoc_array_append_val(&col->values, zero);
+      break;
+   }
+   }
+   _mongoc_array_init(&col->utf8_data, sizeof(char));
+   _mongoc_array_init(&col->validity, sizeof(uint8_t));
+}
+
+
+bool
+mongoc_columns_add(mongoc_columns_t *columns, const char *path, mongoc_column_type_t type, bson_error_t *error)
+{
+   BSON_ASSERT_PARAM(columns);
+   BSON_ASSERT_PARAM(path);
+   BSON_OPTIONAL_PARAM(error);
+
+   if (columns->num_rows > 0) {
+      _mongoc_set_error(
+         error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "cannot add a column after rows are appended");
+      return false;
+   }
+
+   if (type != MONGOC_COLUMN_TYPE_INT64 && type != MONGOC_COLUMN_TYPE_DOUBLE && type != MONGOC_COLUMN_TYPE_UTF8) {
+      _mongoc_set_error(
+         error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "invalid column type: %d", (int)type);
+      return false;
+   }
+
+   // Split the dotted path into segments. Empty segments ("a..b", ".a", "a.") are rejected.
+   size_t n_segments = 1;
+   for (const char *p = path; *p; p++) {
+      if (*p == '.') {
+         n_segments++;
+      }
+   }
+
+   column_t col = {0};
+   col.path = bson_strdup(path);
+   col.type = type;
+   col.n_segments = n_segments;
+   col.segments = bson_malloc0(sizeof(segment_t) * n_segments);
+
+   {
+      const char *start = col.path;
+      size_t i = 0;
+      for (const char *p = col.path;; p++) {
+         if (*p == '.' || *p == '\0') {
+            const size_t len = (size_t)(p - start);
+            if (len == 0) {
+               _mongoc_set_error(
+                  error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "invalid column path: \"%s\"", path);
+               bson_free(col.segments);
+               bson_free(col.path);
+               return false;
+            }
+            col.segments[i++] = (segment_t){.key = start, .key_len = len};
+            start = p + 1;
+         }
+         if (*p == '\0') {
+            break;
+         }
+      }
+   }
+
+   // Share roots between columns with the same first segment, e.g. "meta.a" and "meta.b".
+   {
+      const segment_t *first = &col.segments[0];
+      size_t r;
+      for (r = 0; r < columns->roots.len; r++) {
+         const root_t *root = &_mongoc_array_index(&columns->roots, root_t, r);
+         if (root->key.key_len == first->key_len && 0 == memcmp(root->key.key, first->key, first->key_len)) {
+            break;
+         }
+      }
+      if (r == columns->roots.len) {
+         const root_t root = {.key = *first};
+         const bool not_found = false;
+         bson_iter_t unset = {0};
+         _mongoc_array_append_val(&columns->roots, root);
+         _mongoc_array_append_val(&columns->root_found, not_found);
+         _mongoc_array_append_val(&columns->root_iters, unset);
+         columns->key_len_mask |= (uint64_t)1 << (first->key_len % 64u);
+      }
+      col.root = r;
+   }
+
+   _column_init_values(&col);
+   _mongoc_array_append_val(&columns->columns, col);
+
+   return true;
+}
+
+
+void
+mongoc_columns_clear(mongoc_columns_t *columns)
+{
+   BSON_ASSERT_PARAM(columns);
+
+   for (size_t i = 0; i < columns->columns.len; i++) {
+      column_t *col = _column_at(columns, i);
+      _mongoc_array_destroy(&col->values);
+      _mongoc_array_destroy(&col->utf8_data);
+      _mongoc_array_destroy(&col->validity);
+      _column_init_values(col);
+   }
+
+   columns->num_rows = 0;
+}
+
+
+static void
+_column_append(column_t *col, size_t row, const bson_iter_t *iter)
+{
+   bool valid = false;
+
+   switch (col->type) {
+   case MONGOC_COLUMN_TYPE_INT64: {
+      int64_t v = 0;
+      if (iter && (BSON_ITER_HOLDS_INT64(iter) || BSON_ITER_HOLDS_INT32(iter))) {
+         v = bson_iter_as_int64(iter);
+         valid = true;
+      }
+      _mongoc_array_append_val(&col->values, v);
+      break;
+   }
+   case MONGOC_COLUMN_TYPE_DOUBLE: {
+      double v = 0.0;
+      if (iter && BSON_ITER_HOLDS_DOUBLE(iter)) {
+         v = bson_iter_double(iter);
+         valid = true;
+      } else if (iter && (BSON_ITER_HOLDS_INT64(iter) || BSON_ITER_HOLDS_INT32(iter))) {
+         v = (double)bson_iter_as_int64(iter);
+         valid = true;
+      }
+      _mongoc_array_append_val(&col->values, v);
+      break;
+   }
+   case MONGOC_COLUMN_TYPE_UTF8:
+   default: {
+      if (iter && BSON_ITER_HOLDS_UTF8(iter)) {
+         uint32_t len;
+         const char *str = bson_iter_utf8(iter, &len);
+         // Offsets are 32-bit. Treat a string that would overflow them as missing.
+         if (mlib_cmp(col->utf8_data.len + len, <=, UINT32_MAX)) {
+            _mongoc_array_append_vals(&col->utf8_data, str, len);
+            valid = true;
+         }
+      }
+      const uint32_t end = (uint32_t)col->utf8_data.len;
+      _mongoc_array_append_val(&col->values, end);
+      break;
+   }
+   }
+
+   if (row % 8u == 0) {
+      const uint8_t zero = 0;
+      _mongoc_array_append_val(&col->validity, zero);
+   }
+   if (valid) {
+      _mongoc_array_index(&col->validity, uint8_t, row / 8u) |= (uint8_t)(1u << (row % 8u));
+   }
+}
+
+
+// `_column_descend` follows the remaining segments of `col` starting from the root value in `iter`. Array elements are
+// addressed by their index, e.g. "tags.0".
+static bool
+_column_descend(const column_t *col, const bson_iter_t *root_iter, bson_iter_t *out)
+{
+   bson_iter_t iter = *root_iter;
+
+   for (size_t i = 1; i < col->n_segments; i++) {
+      bson_iter_t child;
+      if (!(BSON_ITER_HOLDS_DOCUMENT(&iter) || BSON_ITER_HOLDS_ARRAY(&iter)) || !bson_iter_recurse(&iter, &child)) {
+         return false;
+      }
+      if (!bson_iter_find_w_len(&child, col->segments[i].key, (int)col->segments[i].key_len)) {
+         return false;
+      }
+      iter = child;
+   }
+
+   *out = iter;
+   return true;
+}
+
+
+static bool
+_root_matches(const root_t *root, const char *key, uint32_t key_len)
+{
+   return root->key.key_len == key_len && 0 == memcmp(root->key.key, key, key_len);
+}
+
+
+void
+mongoc_columns_append_document(mongoc_columns_t *columns, const bson_t *doc)
+{
+   BSON_ASSERT_PARAM(columns);
+   BSON_ASSERT_PARAM(doc);
+
+   const size_t n_roots = columns->roots.len;
+   bool *found = (bool *)columns->root_found.data;
+   bson_iter_t *root_iters = (bson_iter_t *)columns->root_iters.data;
+   size_t n_found = 0;
+   bson_iter_t iter;
+
+   for (size_t r = 0; r < n_roots; r++) {
+      found[r] = false;
+   }
+
+   _mongoc_array_clear(&columns->next_layout);
+
+   // Single pass over the top-level keys. Stop as soon as every root has been seen.
+   if (n_roots > 0 && bson_iter_init(&iter, doc)) {
+      const layout_entry_t *predicted = (const layout_entry_t *)columns->layout.data;
+      const size_t n_predicted = columns->layout.len;
+      size_t next_prediction = 0;
+      uint32_t position = 0;
+
+      while (n_found < n_roots && bson_iter_next(&iter)) {
+         const char *key = bson_iter_key(&iter);
+         const uint32_t key_len = bson_iter_key_len(&iter);
+         size_t match = SIZE_MAX;
+
+         while (next_prediction < n_predicted && predicted[next_prediction].position < position) {
+            next_prediction++;
+         }
+
+         // Fast path: the key is where the root was found in the previous document.
+         if (next_prediction < n_predicted && predicted[next_prediction].position == position) {
+            const uint32_t r = predicted[next_prediction].root;
+            if (!found[r] && _root_matches(&_mongoc_array_index(&columns->roots, root_t, r), key, key_len)) {
+               match = r;
+            }
+         }
+
+         // Slow path: compare against every root not yet found.
+         if (match == SIZE_MAX && (columns->key_len_mask & ((uint64_t)1 << (key_len % 64u)))) {
+            for (size_t r = 0; r < n_roots; r++) {
+               if (!found[r] && _root_matches(&_mongoc_array_index(&columns->roots, root_t, r), key, key_len)) {
+                  match = r;
+                  break;
+               }
+            }
+         }
+
+         if (match != SIZE_MAX) {
+            const layout_entry_t entry = {.position = position, .root = (uint32_t)match};
+            found[match] = true;
+            root_iters[match] = iter;
+            n_found++;
+            _mongoc_array_append_val(&columns->next_layout, entry);
+         }
+
+         position++;
+      }
+   }
+
+   // Keep the layout of this document as the prediction for the next one.
+   {
+      mongoc_array_t tmp = columns->layout;
+      columns->layout = columns->next_layout;
+      columns->next_layout = tmp;
+   }
+
+   for (size_t i = 0; i < columns->columns.len; i++) {
+      column_t *col = _column_at(columns, i);
+      bson_iter_t value;
+      const bool has_value = found[col->root] && _column_descend(col, &root_iters[col->root], &value);
+      _column_append(col, columns->num_rows, has_value ? &value : NULL);
+   }
+
+   columns->num_rows++;
+}
+
+
+size_t
+mongoc_columns_num_columns(const mongoc_columns_t *columns)
+{
+   BSON_ASSERT_PARAM(columns);
+   return columns->columns.len;
+}
+
+
+size_t
+mongoc_columns_num_rows(const mongoc_columns_t *columns)
+{
+   BSON_ASSERT_PARAM(columns);
+   return columns->num_rows;
+}
+
+
+mongoc_column_type_t
+mongoc_columns_get_type(const mongoc_columns_t *columns, size_t column)
+{
+   BSON_ASSERT_PARAM(columns);
+   return _column_at(columns, column)->type;
+}
+
+
+const uint8_t *
+mongoc_columns_get_validity(const mongoc_columns_t *columns, size_t column)
+{
+   BSON_ASSERT_PARAM(columns);
+   return (const uint8_t *)_column_at(columns, column)->validity.data;
+}
+
+
+const int64_t *
+mongoc_columns_get_int64(const mongoc_columns_t *columns, size_t column)
+{
+   BSON_ASSERT_PARAM(columns);
+   const column_t *col = _column_at(columns, column);
+   if (col->type != MONGOC_COLUMN_TYPE_INT64) {
+      return NULL;
+   }
+   return (const int64_t *)col->values.data;
+}
+
+
+const double *
+mongoc_columns_get_double(const mongoc_columns_t *columns, size_t column)
+{
+   BSON_ASSERT_PARAM(columns);
+   const column_t *col = _column_at(columns, column);
+   if (col->type != MONGOC_COLUMN_TYPE_DOUBLE) {
+      return NULL;
+   }
+   return (const double *)col->values.data;
+}
+
+
+const uint32_t *
+mongoc_columns_get_utf8_offsets(const mongoc_columns_t *columns, size_t column)
+{
+   BSON_ASSERT_PARAM(columns);
+   const column_t *col = _column_at(columns, column);
+   if (col->type != MONGOC_COLUMN_TYPE_UTF8) {
+      return NULL;
+   }
+   return (const uint32_t *)col->values.data;
+}
+
+
+const char *
+mongoc_columns_get_utf8_data(const mongoc_columns_t *columns, size_t column)
+{
+   BSON_ASSERT_PARAM(columns);
+   const column_t *col = _column_at(columns, column);
+   if (col->type != MONGOC_COLUMN_TYPE_UTF8) {
+      return NULL;
+   }
+   return (const char *)col->utf8_data.data;
+}
+
+MC_ENABLE_CONVERSION_WARNING_END
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mongoc/mongoc-prelude.h>
+
+#ifndef MONGOC_COLUMNS_H
+#define MONGOC_COLUMNS_H
+
+#include <mongoc/mongoc-macros.h>
+
+#include <bson/bson.h>
+
+BSON_BEGIN_DECLS
+
+typedef struct _mongoc_columns_t mongoc_columns_t;
+
+typedef enum {
+   MONGOC_COLUMN_TYPE_INT64 = 1,
+   MONGOC_COLUMN_TYPE_DOUBLE = 2,
+   MONGOC_COLUMN_TYPE_UTF8 = 3,
+} mongoc_column_type_t;
+
+MONGOC_EXPORT(mongoc_columns_t *)
+mongoc_columns_new(void) BSON_GNUC_WARN_UNUSED_RESULT;
+
+MONGOC_EXPORT(void)
+mongoc_columns_destroy(mongoc_columns_t *columns);
+
+MONGOC_EXPORT(bool)
+mongoc_columns_add(mongoc_columns_t *columns, const char *path, mongoc_column_type_t type, bson_error_t *error);
+
+MONGOC_EXPORT(void)
+mongoc_columns_clear(mongoc_columns_t *columns);
+
+MONGOC_EXPORT(void)
+mongoc_columns_append_document(mongoc_columns_t *columns, const bson_t *doc);
+
+MONGOC_EXPORT(size_t)
+mongoc_columns_num_columns(const mongoc_columns_t *columns);
+
+MONGOC_EXPORT(size_t)
+mongoc_columns_num_rows(const mongoc_columns_t *columns);
+
+MONGOC_EXPORT(mongoc_column_type_t)
+mongoc_columns_get_type(const mongoc_columns_t *columns, size_t column);
+
+MONGOC_EXPORT(const uint8_t *)
+mongoc_columns_get_validity(const mongoc_columns_t *columns, size_t column);
+
+MONGOC_EXPORT(const int64_t *)
+mongoc_columns_get_int64(const mongoc_columns_t *columns, size_t column);
+
+MONGOC_EXPORT(const double *)
+mongoc_columns_get_double(const mongoc_columns_t *columns, size_t column);
+
+MONGOC_EXPORT(const uint32_t *)
+mongoc_columns_get_utf8_offsets(const mongoc_columns_t *columns, size_t column);
+
+MONGOC_EXPORT(const char *)
+mongoc_columns_get_utf8_data(const mongoc_columns_t *columns, size_t column);
+
+BSON_END_DECLS
+
+#endif /* MONGOC_COLUMNS_H */
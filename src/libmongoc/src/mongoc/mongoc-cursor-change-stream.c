@@ -94,7 +94,7 @@ static void
 _destroy(mongoc_cursor_impl_t *impl)
 {
    _data_change_stream_t *data = (_data_change_stream_t *)impl->data;
-   bson_destroy(&data->response.reply);
+   _mongoc_cursor_response_destroy(&data->response);
    bson_destroy(&data->post_batch_resume_token);
    bson_free(data);
 }
@@ -166,6 +166,34 @@ _mongoc_cursor_change_stream_end_of_batch(mongoc_cursor_t *cursor)
 }
 
 
+/* reads the next document of the current batch. unlike mongoc_cursor_next,
+ * never sends a getMore: returns false at the end of the batch. */
+bool
+_mongoc_cursor_change_stream_next_in_batch(mongoc_cursor_t *cursor, const bson_t **bson)
+{
+   _data_change_stream_t *data = (_data_change_stream_t *)cursor->impl.data;
+
+   *bson = NULL;
+
+   if (mongoc_cursor_error(cursor, NULL) || cursor->state != IN_BATCH) {
+      return false;
+   }
+
+   cursor->current = NULL;
+   _mongoc_cursor_response_read(cursor, &data->response, &cursor->current);
+   *bson = cursor->current;
+
+   if (!cursor->current) {
+      return false;
+   }
+
+   /* like mongoc_cursor_next, count the documents returned. */
+   cursor->count++;
+
+   return true;
+}
+
+
 const bson_t *
 _mongoc_cursor_change_stream_get_post_batch_resume_token(mongoc_cursor_t *cursor)
 {
@@ -77,7 +77,7 @@ static void
 _destroy(mongoc_cursor_impl_t *impl)
 {
    data_cmd_t *data = (data_cmd_t *)impl->data;
-   bson_destroy(&data->response.reply);
+   _mongoc_cursor_response_destroy(&data->response);
    bson_destroy(&data->cmd);
    bson_free(data);
 }
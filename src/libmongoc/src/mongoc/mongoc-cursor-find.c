@@ -34,7 +34,7 @@ _prime(mongoc_cursor_t *cursor)
    cursor->operation_id = ++cursor->client->cluster.operation_id;
    /* construct { find: "<collection>", filter: {<filter>} } */
    _mongoc_cursor_prepare_find_command(cursor, &data->filter, &find_cmd);
-   _mongoc_cursor_response_refresh(cursor, &find_cmd, &cursor->opts, &data->response);
+   _mongoc_cursor_find_response_refresh(cursor, &find_cmd, &cursor->opts, &data->response);
    bson_destroy(&find_cmd);
    return IN_BATCH;
 }
@@ -74,7 +74,7 @@ _destroy(mongoc_cursor_impl_t *impl)
 {
    data_find_t *data = (data_find_t *)impl->data;
    bson_destroy(&data->filter);
-   bson_destroy(&data->response.reply);
+   _mongoc_cursor_response_destroy(&data->response);
    bson_free(data);
 }
 
@@ -111,6 +111,8 @@ typedef struct _mongoc_cursor_response_t {
    bson_t reply;           /* the entire command reply */
    bson_iter_t batch_iter; /* iterates over the batch array */
    bson_t current_doc;     /* the current doc inside the batch array */
+   mongoc_buffer_t buffer; /* replies are received here and reused across batches, reply may point into it */
+   int small_replies;      /* consecutive replies much smaller than the buffer */
 } mongoc_cursor_response_t;
 
 struct _mongoc_cursor_t {
@@ -195,11 +197,18 @@ _mongoc_cursor_response_refresh(mongoc_cursor_t *cursor,
                                 const bson_t *command,
                                 const bson_t *opts,
                                 mongoc_cursor_response_t *response);
+void
+_mongoc_cursor_find_response_refresh(mongoc_cursor_t *cursor,
+                                     const bson_t *command,
+                                     const bson_t *opts,
+                                     mongoc_cursor_response_t *response);
 bool
 _mongoc_cursor_start_reading_response(mongoc_cursor_t *cursor, mongoc_cursor_response_t *response);
 void
 _mongoc_cursor_response_read(mongoc_cursor_t *cursor, mongoc_cursor_response_t *response, const bson_t **bson);
 void
+_mongoc_cursor_response_destroy(mongoc_cursor_response_t *response);
+void
 _mongoc_cursor_prepare_getmore_command(mongoc_cursor_t *cursor, bson_t *command);
 void
 _mongoc_cursor_set_empty(mongoc_cursor_t *cursor);
@@ -254,6 +263,9 @@ _mongoc_cursor_change_stream_new(mongoc_client_t *client, bson_t *reply, const b
 bool
 _mongoc_cursor_change_stream_end_of_batch(mongoc_cursor_t *cursor);
 
+bool
+_mongoc_cursor_change_stream_next_in_batch(mongoc_cursor_t *cursor, const bson_t **bson);
+
 const bson_t *
 _mongoc_cursor_change_stream_get_post_batch_resume_token(mongoc_cursor_t *cursor);
 
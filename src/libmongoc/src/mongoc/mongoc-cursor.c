@@ -764,8 +764,13 @@ _retryable_cursor_commmand_select_retry_server(void *user_data,
    return (*context->server_stream)->sd;
 }
 
-bool
-_mongoc_cursor_run_command(mongoc_cursor_t *cursor, const bson_t *command, const bson_t *opts, bson_t *reply)
+/* if reply_buffer is set, a successful reply may point into it. */
+static bool
+_mongoc_cursor_run_command_with_buffer(mongoc_cursor_t *cursor,
+                                       const bson_t *command,
+                                       const bson_t *opts,
+                                       mongoc_buffer_t *reply_buffer,
+                                       bson_t *reply)
 {
    mongoc_server_stream_t *server_stream;
    bson_iter_t iter;
@@ -785,6 +790,7 @@ _mongoc_cursor_run_command(mongoc_cursor_t *cursor, const bson_t *command, const
    parts.is_read_command = true;
    parts.read_prefs = cursor->read_prefs;
    parts.assembled.operation_id = cursor->operation_id;
+   parts.assembled.reply_buffer = reply_buffer;
 
    const mongoc_ss_log_context_t ss_log_context = {
       .operation = cmd_name, .has_operation_id = true, .operation_id = parts.assembled.operation_id};
@@ -957,6 +963,12 @@ done:
    return ret;
 }
 
+bool
+_mongoc_cursor_run_command(mongoc_cursor_t *cursor, const bson_t *command, const bson_t *opts, bson_t *reply)
+{
+   return _mongoc_cursor_run_command_with_buffer(cursor, command, opts, NULL, reply);
+}
+
 
 void
 _mongoc_cursor_collection(const mongoc_cursor_t *cursor, const char **collection, int *collection_len)
@@ -1137,6 +1149,48 @@ done:
 }
 
 
+bool
+mongoc_cursor_next_columns(mongoc_cursor_t *cursor, mongoc_columns_t *columns)
+{
+   const bson_t *doc;
+
+   ENTRY;
+
+   BSON_ASSERT_PARAM(cursor);
+   BSON_ASSERT_PARAM(columns);
+
+   /* the previous call may have drained the final batch. like the last call
+    * to mongoc_cursor_next in a loop, report the end without an error. */
+   if (cursor->state == DONE && !CURSOR_FAILED(cursor)) {
+      RETURN(false);
+   }
+
+   /* fetches the next batch if needed, and reports errors like
+    * mongoc_cursor_next. */
+   if (!mongoc_cursor_next(cursor, &doc)) {
+      RETURN(false);
+   }
+
+   mongoc_columns_append_document(columns, doc);
+
+   /* drain the remainder of the current batch without sending another
+    * getMore. */
+   while (cursor->state == IN_BATCH) {
+      cursor->current = NULL;
+      cursor->state = _call_transition(cursor);
+
+      if (!cursor->current) {
+         break;
+      }
+
+      cursor->count++;
+      mongoc_columns_append_document(columns, cursor->current);
+   }
+
+   RETURN(true);
+}
+
+
 bool
 mongoc_cursor_more(mongoc_cursor_t *cursor)
 {
@@ -1449,6 +1503,33 @@ _mongoc_cursor_response_read(mongoc_cursor_t *cursor, mongoc_cursor_response_t *
    }
 }
 
+/* the receive buffer is only shrunk once it reaches this size */
+#define REPLY_BUFFER_SHRINK_MIN_SIZE (1024u * 1024u)
+/* the number of consecutive replies using under a quarter of the buffer before it is shrunk */
+#define REPLY_BUFFER_SHRINK_AFTER 4
+
+/* the receive buffer grows to fit the largest reply. if a cursor returns a few
+ * huge batches followed by many small ones, give the memory back. */
+static void
+_mongoc_cursor_response_trim_buffer(mongoc_cursor_response_t *response)
+{
+   mongoc_buffer_t *const buffer = &response->buffer;
+
+   /* buffer->len is the length of the last message received */
+   if (!buffer->data || buffer->datalen < REPLY_BUFFER_SHRINK_MIN_SIZE || buffer->len > buffer->datalen / 4u) {
+      response->small_replies = 0;
+      return;
+   }
+
+   if (++response->small_replies < REPLY_BUFFER_SHRINK_AFTER) {
+      return;
+   }
+
+   /* keep room for a reply twice the size of the last one */
+   _mongoc_buffer_shrink(buffer, bson_next_power_of_two(BSON_MAX(buffer->len, 512u) * 2u));
+   response->small_replies = 0;
+}
+
 /* sets cursor error if could not get the next batch. */
 void
 _mongoc_cursor_response_refresh(mongoc_cursor_t *cursor,
@@ -1458,11 +1539,13 @@ _mongoc_cursor_response_refresh(mongoc_cursor_t *cursor,
 {
    ENTRY;
 
+   /* the reply may point into response->buffer, release it before the buffer is reused */
    bson_destroy(&response->reply);
+   _mongoc_cursor_response_trim_buffer(response);
 
    /* server replies to find / aggregate with {cursor: {id: N, firstBatch: []}},
     * to getMore command with {cursor: {id: N, nextBatch: []}}. */
-   if (_mongoc_cursor_run_command(cursor, command, opts, &response->reply)) {
+   if (_mongoc_cursor_run_command_with_buffer(cursor, command, opts, &response->buffer, &response->reply)) {
       if (_mongoc_cursor_start_reading_response(cursor, response)) {
          cursor->in_exhaust = cursor->client->in_exhaust;
          return;
@@ -1477,6 +1560,91 @@ _mongoc_cursor_response_refresh(mongoc_cursor_t *cursor,
    }
 }
 
+
+/* builds the key of a find command in the client's find cache, or returns
+ * false if the results must not be cached */
+static bool
+_mongoc_cursor_find_cache_key(mongoc_cursor_t *cursor, const bson_t *command, bson_t *key)
+{
+   const char *level;
+
+   /* explicit sessions may need causally consistent or snapshot reads */
+   if (!cursor->client->find_cache || cursor->explicit_session ||
+       cursor->client->topology->cse_state != MONGOC_CSE_DISABLED ||
+       _mongoc_cursor_get_opt_bool(cursor, MONGOC_CURSOR_EXHAUST)) {
+      return false;
+   }
+
+   /* the command holds the filter, opts hold projection, sort, limit, etc. */
+   bson_init(key);
+   BSON_APPEND_DOCUMENT(key, "command", command);
+   BSON_APPEND_DOCUMENT(key, "opts", &cursor->opts);
+
+   if (cursor->read_prefs) {
+      BSON_APPEND_INT32(key, "mode", (int32_t)mongoc_read_prefs_get_mode(cursor->read_prefs));
+      BSON_APPEND_ARRAY(key, "tags", mongoc_read_prefs_get_tags(cursor->read_prefs));
+      BSON_APPEND_INT64(key, "maxStalenessSeconds", mongoc_read_prefs_get_max_staleness_seconds(cursor->read_prefs));
+   }
+
+   if (cursor->read_concern && (level = mongoc_read_concern_get_level(cursor->read_concern))) {
+      BSON_APPEND_UTF8(key, "readConcern", level);
+   }
+
+   return true;
+}
+
+
+/* like _mongoc_cursor_response_refresh, but serves the reply from the
+ * client's find cache if possible. only results that fit in the first batch
+ * are cached, since a cached reply cannot be continued with getMore. */
+void
+_mongoc_cursor_find_response_refresh(mongoc_cursor_t *cursor,
+                                     const bson_t *command,
+                                     const bson_t *opts,
+                                     mongoc_cursor_response_t *response)
+{
+   const bson_t *cached;
+   bson_t key;
+
+   ENTRY;
+
+   if (!_mongoc_cursor_find_cache_key(cursor, command, &key)) {
+      _mongoc_cursor_response_refresh(cursor, command, opts, response);
+      EXIT;
+   }
+
+   cached = _mongoc_find_cache_get(cursor->client->find_cache, cursor->ns, &key);
+   if (cached) {
+      bson_destroy(&response->reply);
+      bson_copy_to(cached, &response->reply);
+
+      /* only replies that could be read are cached */
+      BSON_ASSERT(_mongoc_cursor_start_reading_response(cursor, response));
+      bson_destroy(&key);
+      EXIT;
+   }
+
+   _mongoc_cursor_response_refresh(cursor, command, opts, response);
+
+   if (!cursor->error.domain && cursor->cursor_id == 0) {
+      _mongoc_find_cache_put(cursor->client->find_cache, cursor->ns, &key, &response->reply);
+   }
+
+   bson_destroy(&key);
+   EXIT;
+}
+
+
+void
+_mongoc_cursor_response_destroy(mongoc_cursor_response_t *response)
+{
+   BSON_ASSERT_PARAM(response);
+
+   /* destroy the reply first, it may point into the buffer */
+   bson_destroy(&response->reply);
+   _mongoc_buffer_destroy(&response->buffer);
+}
+
 void
 _mongoc_cursor_prepare_getmore_command(mongoc_cursor_t *cursor, bson_t *command)
 {
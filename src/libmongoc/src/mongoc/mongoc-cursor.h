@@ -19,6 +19,7 @@
 #ifndef MONGOC_CURSOR_H
 #define MONGOC_CURSOR_H
 
+#include <mongoc/mongoc-columns.h>
 #include <mongoc/mongoc-host-list.h>
 #include <mongoc/mongoc-macros.h>
 
@@ -46,6 +47,9 @@ mongoc_cursor_more(mongoc_cursor_t *cursor);
 MONGOC_EXPORT(bool)
 mongoc_cursor_next(mongoc_cursor_t *cursor, const bson_t **bson);
 
+MONGOC_EXPORT(bool)
+mongoc_cursor_next_columns(mongoc_cursor_t *cursor, mongoc_columns_t *columns);
+
 MONGOC_EXPORT(bool)
 mongoc_cursor_error(mongoc_cursor_t *cursor, bson_error_t *error);
 
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mongoc/mongoc-prelude.h>
+
+#ifndef MONGOC_FIND_CACHE_PRIVATE_H
+#define MONGOC_FIND_CACHE_PRIVATE_H
+
+#include <bson/bson.h>
+
+BSON_BEGIN_DECLS
+
+/* Caches complete replies to find commands whose results fit in the first
+ * batch. Entries expire after a TTL and the least recently used entries are
+ * evicted once the cached replies exceed a total size. Not thread safe, each
+ * mongoc_client_t owns its cache. */
+typedef struct _mongoc_find_cache_t mongoc_find_cache_t;
+
+mongoc_find_cache_t *
+_mongoc_find_cache_new(int64_t ttl_ms, size_t max_bytes);
+
+void
+_mongoc_find_cache_destroy(mongoc_find_cache_t *cache);
+
+/* Returns the cached reply for the query `key` on namespace `ns`, or NULL.
+ * The reply is valid until the next call on the cache. */
+const bson_t *
+_mongoc_find_cache_get(mongoc_find_cache_t *cache, const char *ns, const bson_t *key);
+
+void
+_mongoc_find_cache_put(mongoc_find_cache_t *cache, const char *ns, const bson_t *key, const bson_t *reply);
+
+/* Removes entries for collection "db.coll", for all collections in "db" if
+ * `coll` is NULL, or all entries if `db` is NULL. */
+void
+_mongoc_find_cache_invalidate(mongoc_find_cache_t *cache, const char *db, const char *coll);
+
+BSON_END_DECLS
+
+#endif /* MONGOC_FIND_CACHE_PRIVATE_H */
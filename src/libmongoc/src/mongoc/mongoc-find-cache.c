@@ -0,0 +1,263 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mongoc/mongoc-find-cache-private.h>
+
+#include <mongoc/utlist.h>
+
+#include <bson/bson.h>
+
+#include <string.h>
+
+#define MIN_BUCKETS 16u
+
+typedef struct _entry_t {
+   uint32_t hash;
+   char *ns;
+   bson_t *key;
+   bson_t *reply;
+   int64_t expires_at;
+   struct _entry_t *bucket_next; /* in the chain of its hash bucket */
+   struct _entry_t *prev;        /* in the LRU list, most recently used first */
+   struct _entry_t *next;
+} entry_t;
+
+/* Entries are found through a hash table chained by entry_t.bucket_next, and
+ * are kept in least recently used order in an intrusive list, so that get,
+ * put and eviction do not depend on the number of entries. */
+struct _mongoc_find_cache_t {
+   int64_t ttl_usec;
+   size_t max_bytes;
+   size_t bytes;
+   entry_t **buckets;
+   size_t n_buckets; /* a power of 2 */
+   size_t n_entries;
+   entry_t *lru; /* utlist DL list, lru->prev is the least recently used */
+};
+
+
+/* FNV-1a */
+static uint32_t
+_hash(const char *ns, const bson_t *key)
+{
+   uint32_t h = 2166136261u;
+   const uint8_t *data = bson_get_data(key);
+
+   for (const char *p = ns; *p; p++) {
+      h = (h ^ (uint8_t)*p) * 16777619u;
+   }
+
+   for (uint32_t i = 0; i < key->len; i++) {
+      h = (h ^ data[i]) * 16777619u;
+   }
+
+   return h;
+}
+
+
+static size_t
+_entry_size(const entry_t *entry)
+{
+   return strlen(entry->ns) + entry->key->len + entry->reply->len;
+}
+
+
+static entry_t **
+_bucket(mongoc_find_cache_t *cache, uint32_t hash)
+{
+   return &cache->buckets[hash & (cache->n_buckets - 1u)];
+}
+
+
+static entry_t *
+_find(mongoc_find_cache_t *cache, uint32_t hash, const char *ns, const bson_t *key)
+{
+   for (entry_t *entry = *_bucket(cache, hash); entry; entry = entry->bucket_next) {
+      if (entry->hash == hash && !strcmp(entry->ns, ns) && bson_equal(entry->key, key)) {
+         return entry;
+      }
+   }
+
+   return NULL;
+}
+
+
+static void
+_remove(mongoc_find_cache_t *cache, entry_t *entry)
+{
+   entry_t **link = _bucket(cache, entry->hash);
+
+   while (*link != entry) {
+      link = &(*link)->bucket_next;
+   }
+   *link = entry->bucket_next;
+
+   DL_DELETE(cache->lru, entry);
+   cache->n_entries--;
+   cache->bytes -= _entry_size(entry);
+
+   bson_free(entry->ns);
+   bson_destroy(entry->key);
+   bson_destroy(entry->reply);
+   bson_free(entry);
+}
+
+
+/* Doubles the number of buckets once there are more entries than buckets. */
+static void
+_grow(mongoc_find_cache_t *cache)
+{
+   const size_t n_buckets = cache->n_buckets * 2u;
+   entry_t **buckets = bson_malloc0(n_buckets * sizeof *buckets);
+
+   for (size_t i = 0; i < cache->n_buckets; i++) {
+      entry_t *entry = cache->buckets[i];
+
+      while (entry) {
+         entry_t *const next = entry->bucket_next;
+         entry_t **const bucket = &buckets[entry->hash & (n_buckets - 1u)];
+
+         entry->bucket_next = *bucket;
+         *bucket = entry;
+         entry = next;
+      }
+   }
+
+   bson_free(cache->buckets);
+   cache->buckets = buckets;
+   cache->n_buckets = n_buckets;
+}
+
+
+mongoc_find_cache_t *
+_mongoc_find_cache_new(int64_t ttl_ms, size_t max_bytes)
+{
+   mongoc_find_cache_t *cache = bson_malloc0(sizeof *cache);
+
+   cache->ttl_usec = ttl_ms * 1000;
+   cache->max_bytes = max_bytes;
+   cache->n_buckets = MIN_BUCKETS;
+   cache->buckets = bson_malloc0(cache->n_buckets * sizeof *cache->buckets);
+
+   return cache;
+}
+
+
+void
+_mongoc_find_cache_destroy(mongoc_find_cache_t *cache)
+{
+   if (!cache) {
+      return;
+   }
+
+   _mongoc_find_cache_invalidate(cache, NULL, NULL);
+   bson_free(cache->buckets);
+   bson_free(cache);
+}
+
+
+const bson_t *
+_mongoc_find_cache_get(mongoc_find_cache_t *cache, const char *ns, const bson_t *key)
+{
+   entry_t *entry;
+
+   BSON_ASSERT_PARAM(cache);
+
+   if (!(entry = _find(cache, _hash(ns, key), ns, key))) {
+      return NULL;
+   }
+
+   if (bson_get_monotonic_time() >= entry->expires_at) {
+      _remove(cache, entry);
+      return NULL;
+   }
+
+   /* move to the front of the LRU list */
+   DL_DELETE(cache->lru, entry);
+   DL_PREPEND(cache->lru, entry);
+
+   return entry->reply;
+}
+
+
+void
+_mongoc_find_cache_put(mongoc_find_cache_t *cache, const char *ns, const bson_t *key, const bson_t *reply)
+{
+   const uint32_t hash = _hash(ns, key);
+   const int64_t now = bson_get_monotonic_time();
+   entry_t *entry;
+   size_t size;
+
+   BSON_ASSERT_PARAM(cache);
+
+   size = strlen(ns) + key->len + reply->len;
+   if (size > cache->max_bytes) {
+      return;
+   }
+
+   /* replace a previous entry for the same query */
+   if ((entry = _find(cache, hash, ns, key))) {
+      _remove(cache, entry);
+   }
+
+   /* evict expired entries from the end of the LRU list, then the least
+    * recently used entries until the new one fits */
+   while (cache->lru && (now >= cache->lru->prev->expires_at || cache->bytes + size > cache->max_bytes)) {
+      _remove(cache, cache->lru->prev);
+   }
+
+   entry = bson_malloc0(sizeof *entry);
+   entry->hash = hash;
+   entry->ns = bson_strdup(ns);
+   entry->key = bson_copy(key);
+   entry->reply = bson_copy(reply);
+   entry->expires_at = now + cache->ttl_usec;
+
+   if (cache->n_entries >= cache->n_buckets) {
+      _grow(cache);
+   }
+
+   entry->bucket_next = *_bucket(cache, hash);
+   *_bucket(cache, hash) = entry;
+   DL_PREPEND(cache->lru, entry);
+   cache->n_entries++;
+   cache->bytes += size;
+}
+
+
+void
+_mongoc_find_cache_invalidate(mongoc_find_cache_t *cache, const char *db, const char *coll)
+{
+   const size_t db_len = db ? strlen(db) : 0u;
+   entry_t *entry;
+   entry_t *tmp;
+
+   BSON_ASSERT_PARAM(cache);
+
+   DL_FOREACH_SAFE(cache->lru, entry, tmp)
+   {
+      const char *const ns = entry->ns;
+      bool match = true;
+
+      if (db) {
+         match = !strncmp(ns, db, db_len) && ns[db_len] == '.' && (!coll || !strcmp(ns + db_len + 1u, coll));
+      }
+
+      if (match) {
+         _remove(cache, entry);
+      }
+   }
+}
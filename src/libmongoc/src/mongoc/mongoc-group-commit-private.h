@@ -0,0 +1,62 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mongoc/mongoc-prelude.h>
+
+#ifndef MONGOC_GROUP_COMMIT_PRIVATE_H
+#define MONGOC_GROUP_COMMIT_PRIVATE_H
+
+#include <mongoc/mongoc-write-command-private.h>
+
+#include <bson/bson.h>
+
+BSON_BEGIN_DECLS
+
+/* Combines single-document inserts that threads of a client pool issue
+ * concurrently into one insert command. The first caller to arrive becomes the
+ * leader: it waits up to a window for other callers, sends all queued documents
+ * as one unordered insert, and gives each caller its own result. Callers that
+ * arrive while an insert is in flight are sent together by the next leader.
+ * Shared by all clients of a pool, thread safe. */
+typedef struct _mongoc_group_commit_t mongoc_group_commit_t;
+
+/* Sends `combined`, an unordered insert of the documents of several callers,
+ * and fills `result`. Called by the leader, without the lock held. */
+typedef void (*mongoc_group_commit_execute_fn)(mongoc_write_command_t *combined,
+                                               void *ctx,
+                                               mongoc_write_result_t *result);
+
+mongoc_group_commit_t *
+_mongoc_group_commit_new(int64_t window_ms, int32_t max_documents);
+
+void
+_mongoc_group_commit_destroy(mongoc_group_commit_t *gc);
+
+/* Inserts the one document of `command` together with concurrent callers
+ * using the same `key`. Documents are only combined with documents of the same
+ * `key`, which must identify the namespace and write options. Blocks until
+ * `result` holds the outcome of this document. */
+void
+_mongoc_group_commit_insert(mongoc_group_commit_t *gc,
+                            const char *key,
+                            const mongoc_write_command_t *command,
+                            mongoc_group_commit_execute_fn execute,
+                            void *ctx,
+                            mongoc_write_result_t *result);
+
+BSON_END_DECLS
+
+#endif /* MONGOC_GROUP_COMMIT_PRIVATE_H */
@@ -0,0 +1,284 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mongoc/mongoc-group-commit-private.h>
+
+#include <common-thread-private.h>
+#include <mongoc/mongoc-buffer-private.h>
+#include <mongoc/mongoc-thread-private.h>
+
+#include <bson/bson.h>
+
+typedef struct _waiter_t {
+   const mongoc_write_command_t *command;
+   mongoc_write_result_t *result;
+   bool done;
+   struct _waiter_t *next;
+} waiter_t;
+
+typedef struct _group_t {
+   char *key;
+   // Callers waiting for their document to be sent, in arrival order.
+   waiter_t *head;
+   waiter_t *tail;
+   size_t n_waiting;
+   // True while a caller leads this group. At most one insert per group is in flight.
+   bool has_leader;
+   struct _group_t *next;
+} group_t;
+
+struct _mongoc_group_commit_t {
+   int64_t window_ms;
+   int32_t max_documents;
+   bson_mutex_t mutex;
+   // Broadcast when documents are queued and when an insert completes.
+   mongoc_cond_t cond;
+   group_t *groups;
+};
+
+
+mongoc_group_commit_t *
+_mongoc_group_commit_new(int64_t window_ms, int32_t max_documents)
+{
+   BSON_ASSERT(window_ms >= 0);
+   BSON_ASSERT(max_documents > 0);
+
+   mongoc_group_commit_t *gc = bson_malloc0(sizeof(*gc));
+
+   gc->window_ms = window_ms;
+   gc->max_documents = max_documents;
+   bson_mutex_init(&gc->mutex);
+   mongoc_cond_init(&gc->cond);
+
+   return gc;
+}
+
+
+void
+_mongoc_group_commit_destroy(mongoc_group_commit_t *gc)
+{
+   if (!gc) {
+      return;
+   }
+
+   group_t *group = gc->groups;
+   while (group) {
+      group_t *const next = group->next;
+      BSON_ASSERT(!group->head);
+      bson_free(group->key);
+      bson_free(group);
+      group = next;
+   }
+
+   mongoc_cond_destroy(&gc->cond);
+   bson_mutex_destroy(&gc->mutex);
+   bson_free(gc);
+}
+
+
+static group_t *
+_find_or_add_group(mongoc_group_commit_t *gc, const char *key)
+{
+   for (group_t *group = gc->groups; group; group = group->next) {
+      if (0 == strcmp(group->key, key)) {
+         return group;
+      }
+   }
+
+   group_t *const group = bson_malloc0(sizeof(*group));
+   group->key = bson_strdup(key);
+   group->next = gc->groups;
+   gc->groups = group;
+   return group;
+}
+
+
+/* Copies the outcome of the document at `index` of the combined insert into
+ * `result`, as if the document had been inserted alone. */
+static void
+_split_result(const mongoc_write_result_t *combined, uint32_t index, mongoc_write_result_t *result)
+{
+   bool has_write_error = false;
+   bson_iter_t iter;
+   bson_iter_t error_iter;
+
+   if (bson_iter_init(&iter, &combined->writeErrors)) {
+      while (bson_iter_next(&iter)) {
+         if (!BSON_ITER_HOLDS_DOCUMENT(&iter) || !bson_iter_recurse(&iter, &error_iter) ||
+             !bson_iter_find(&error_iter, "index") || bson_iter_as_int64(&error_iter) != (int64_t)index) {
+            continue;
+         }
+
+         // Copy the write error with the index of the document in its own insert.
+         bson_t write_error;
+         bson_t combined_error;
+         uint32_t len;
+         const uint8_t *data;
+
+         bson_iter_document(&iter, &len, &data);
+         BSON_ASSERT(bson_init_static(&combined_error, data, len));
+         bson_append_document_begin(&result->writeErrors, "0", 1, &write_error);
+         bson_copy_to_excluding_noinit(&combined_error, &write_error, "index", NULL);
+         BSON_APPEND_INT32(&write_error, "index", 0);
+         bson_append_document_end(&result->writeErrors, &write_error);
+
+         has_write_error = true;
+         break;
+      }
+   }
+
+   // Write errors of other documents fail the combined insert, but not this document.
+   result->failed = has_write_error || (combined->failed && bson_empty(&combined->writeErrors));
+   if (!result->failed && !combined->error.code) {
+      result->nInserted = 1;
+   }
+
+   result->must_stop = combined->must_stop;
+   result->error = combined->error;
+
+   result->n_writeConcernErrors = combined->n_writeConcernErrors;
+   bson_destroy(&result->writeConcernErrors);
+   bson_copy_to(&combined->writeConcernErrors, &result->writeConcernErrors);
+
+   bson_destroy(&result->errorLabels);
+   bson_copy_to(&combined->errorLabels, &result->errorLabels);
+
+   result->n_errorReplies = combined->n_errorReplies;
+   bson_destroy(&result->rawErrorReplies);
+   bson_copy_to(&combined->rawErrorReplies, &result->rawErrorReplies);
+}
+
+
+/* Sends the documents of up to `max_documents` queued callers. Called by the
+ * leader with the lock held; the lock is released while sending. */
+static void
+_lead(mongoc_group_commit_t *gc, group_t *group, mongoc_group_commit_execute_fn execute, void *ctx)
+{
+   // Give other callers the window to join, unless there is already a full batch.
+   if (gc->window_ms > 0) {
+      const int64_t deadline = bson_get_monotonic_time() + gc->window_ms * 1000;
+
+      while (group->n_waiting < (size_t)gc->max_documents) {
+         const int64_t remaining_ms = (deadline - bson_get_monotonic_time()) / 1000;
+         if (remaining_ms <= 0) {
+            break;
+         }
+         mongoc_cond_timedwait(&gc->cond, &gc->mutex, remaining_ms);
+      }
+   }
+
+   // Take the first callers off the queue.
+   waiter_t *const batch = group->head;
+   waiter_t *last = batch;
+   uint32_t n = 1;
+
+   while (last->next && n < (uint32_t)gc->max_documents) {
+      last = last->next;
+      n++;
+   }
+   group->head = last->next;
+   if (!group->head) {
+      group->tail = NULL;
+   }
+   group->n_waiting -= n;
+   last->next = NULL;
+
+   bson_mutex_unlock(&gc->mutex);
+
+   mongoc_write_command_t combined;
+   mongoc_write_result_t combined_result;
+
+   _mongoc_write_command_init_insert_idl(&combined, NULL, NULL, batch->command->operation_id);
+   // Documents of different callers are independent.
+   combined.flags.ordered = false;
+
+   // Each payload holds one document that already has an _id.
+   for (const waiter_t *w = batch; w; w = w->next) {
+      _mongoc_buffer_append(&combined.payload, w->command->payload.data, w->command->payload.len);
+      combined.n_documents++;
+   }
+
+   _mongoc_write_result_init(&combined_result);
+   execute(&combined, ctx, &combined_result);
+
+   {
+      uint32_t index = 0;
+      for (waiter_t *w = batch; w; w = w->next) {
+         _split_result(&combined_result, index++, w->result);
+      }
+   }
+
+   _mongoc_write_result_destroy(&combined_result);
+   _mongoc_write_command_destroy(&combined);
+
+   bson_mutex_lock(&gc->mutex);
+
+   for (waiter_t *w = batch; w;) {
+      waiter_t *const next = w->next;
+      // `w` belongs to a caller that may return as soon as it is done.
+      w->done = true;
+      w = next;
+   }
+}
+
+
+void
+_mongoc_group_commit_insert(mongoc_group_commit_t *gc,
+                            const char *key,
+                            const mongoc_write_command_t *command,
+                            mongoc_group_commit_execute_fn execute,
+                            void *ctx,
+                            mongoc_write_result_t *result)
+{
+   BSON_ASSERT_PARAM(gc);
+   BSON_ASSERT_PARAM(key);
+   BSON_ASSERT_PARAM(command);
+   BSON_ASSERT_PARAM(execute);
+   BSON_ASSERT_PARAM(result);
+
+   BSON_ASSERT(command->type == MONGOC_WRITE_COMMAND_INSERT);
+   BSON_ASSERT(command->n_documents == 1);
+
+   waiter_t waiter = {.command = command, .result = result};
+
+   bson_mutex_lock(&gc->mutex);
+
+   group_t *const group = _find_or_add_group(gc, key);
+
+   if (group->tail) {
+      group->tail->next = &waiter;
+   } else {
+      group->head = &waiter;
+   }
+   group->tail = &waiter;
+   group->n_waiting++;
+   mongoc_cond_broadcast(&gc->cond);
+
+   while (!waiter.done) {
+      if (group->has_leader) {
+         mongoc_cond_wait(&gc->cond, &gc->mutex);
+         continue;
+      }
+
+      // Lead until this caller's document was sent. Documents queued earlier are sent first.
+      group->has_leader = true;
+      _lead(gc, group, execute, ctx);
+      group->has_leader = false;
+      mongoc_cond_broadcast(&gc->cond);
+   }
+
+   bson_mutex_unlock(&gc->mutex);
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mongoc/mongoc-prelude.h>
+
+#ifndef MONGOC_LOOKUP_BATCHER_PRIVATE_H
+#define MONGOC_LOOKUP_BATCHER_PRIVATE_H
+
+#include <mongoc/mongoc-cursor.h>
+
+#include <bson/bson.h>
+
+BSON_BEGIN_DECLS
+
+/* Combines lookups of single documents by _id that threads of a client pool
+ * issue concurrently into one find with an $in filter. The first caller to
+ * arrive becomes the leader: it waits up to a delay for other callers, sends
+ * one find for all queued ids, and gives each caller the document with its id.
+ * Callers that arrive while a find is in flight are sent together by the next
+ * leader. A lookup whose _id the server may consider equal to other values,
+ * such as a string under a collation, is sent again alone if it matched no
+ * returned document. Shared by all clients of a pool, thread safe. */
+typedef struct _mongoc_lookup_batcher_t mongoc_lookup_batcher_t;
+
+/* Returns a cursor for `filter`, {"_id": {"$in": [...]}}. Called by the leader,
+ * without the lock held. */
+typedef mongoc_cursor_t *(*mongoc_lookup_batcher_find_fn)(const bson_t *filter, void *ctx);
+
+mongoc_lookup_batcher_t *
+_mongoc_lookup_batcher_new(int64_t max_delay_us, int32_t max_batch_size);
+
+void
+_mongoc_lookup_batcher_destroy(mongoc_lookup_batcher_t *batcher);
+
+/* Looks up the document with _id `id` together with concurrent callers using
+ * the same `key`, which must identify the namespace and read options. Blocks
+ * until the lookup completed. On success, appends the document to `document`
+ * if one was found. */
+bool
+_mongoc_lookup_batcher_find(mongoc_lookup_batcher_t *batcher,
+                            const char *key,
+                            const bson_value_t *id,
+                            mongoc_lookup_batcher_find_fn find,
+                            void *ctx,
+                            bson_t *document,
+                            bson_error_t *error);
+
+BSON_END_DECLS
+
+#endif /* MONGOC_LOOKUP_BATCHER_PRIVATE_H */
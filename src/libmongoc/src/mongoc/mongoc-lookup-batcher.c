@@ -0,0 +1,399 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mongoc/mongoc-lookup-batcher-private.h>
+
+#include <common-atomic-private.h>
+#include <common-thread-private.h>
+#include <mongoc/mongoc-thread-private.h>
+
+#include <mongoc/utlist.h>
+
+#include <bson/bson.h>
+
+#include <math.h>
+
+typedef struct _waiter_t {
+   // The document { "_id": <id> }.
+   bson_t id;
+   bson_t *document;
+   bson_error_t error;
+   bool ok;
+   bool found;
+   bool done;
+   // Signaled when this caller's lookup is done, or when it must lead its group.
+   mongoc_cond_t cond;
+   struct _waiter_t *next;
+} waiter_t;
+
+typedef struct _group_t {
+   char *key;
+   // Callers waiting for their lookup to be sent, in arrival order.
+   waiter_t *head;
+   waiter_t *tail;
+   size_t n_waiting;
+   // The callers using this group. The group is removed when the last one returns.
+   size_t n_callers;
+   // True while a caller leads this group. At most one find per group is in flight.
+   bool has_leader;
+   // Signaled when a batch is full, to end the leader's delay.
+   mongoc_cond_t full;
+   struct _group_t *prev;
+   struct _group_t *next;
+} group_t;
+
+struct _mongoc_lookup_batcher_t {
+   int64_t max_delay_us;
+   int32_t max_batch_size;
+   bson_mutex_t mutex;
+   // The groups with callers.
+   group_t *groups;
+};
+
+
+mongoc_lookup_batcher_t *
+_mongoc_lookup_batcher_new(int64_t max_delay_us, int32_t max_batch_size)
+{
+   BSON_ASSERT(max_delay_us >= 0);
+   BSON_ASSERT(max_batch_size > 0);
+
+   mongoc_lookup_batcher_t *batcher = bson_malloc0(sizeof(*batcher));
+
+   batcher->max_delay_us = max_delay_us;
+   batcher->max_batch_size = max_batch_size;
+   bson_mutex_init(&batcher->mutex);
+
+   return batcher;
+}
+
+
+void
+_mongoc_lookup_batcher_destroy(mongoc_lookup_batcher_t *batcher)
+{
+   if (!batcher) {
+      return;
+   }
+
+   // Groups are removed by their last caller.
+   BSON_ASSERT(!batcher->groups);
+
+   bson_mutex_destroy(&batcher->mutex);
+   bson_free(batcher);
+}
+
+
+static group_t *
+_join_group(mongoc_lookup_batcher_t *batcher, const char *key)
+{
+   group_t *group;
+
+   DL_FOREACH (batcher->groups, group) {
+      if (0 == strcmp(group->key, key)) {
+         group->n_callers++;
+         return group;
+      }
+   }
+
+   group = bson_malloc0(sizeof(*group));
+   group->key = bson_strdup(key);
+   group->n_callers = 1;
+   mongoc_cond_init(&group->full);
+   DL_APPEND(batcher->groups, group);
+   return group;
+}
+
+
+static void
+_leave_group(mongoc_lookup_batcher_t *batcher, group_t *group)
+{
+   if (--group->n_callers > 0) {
+      return;
+   }
+
+   BSON_ASSERT(!group->head);
+   BSON_ASSERT(!group->has_leader);
+   DL_DELETE(batcher->groups, group);
+   mongoc_cond_destroy(&group->full);
+   bson_free(group->key);
+   bson_free(group);
+}
+
+
+static bool
+_is_integer(bson_type_t type)
+{
+   return type == BSON_TYPE_INT32 || type == BSON_TYPE_INT64;
+}
+
+
+// Whether the integer `i` and the double `d` have the same value. Exact for any int64.
+static bool
+_integer_equals_double(int64_t i, double d)
+{
+   // 2^63 is exactly representable as a double, unlike INT64_MAX.
+   if (!(d >= -9223372036854775808.0 && d < 9223372036854775808.0) || trunc(d) != d) {
+      return false;
+   }
+
+   return (int64_t)d == i;
+}
+
+
+/* Whether the server may consider the _id `id` equal to an _id with other
+ * bytes: strings may be equal under a collation, and numbers within documents,
+ * arrays, and decimals may be equal to numbers of other types. */
+static bool
+_id_needs_server_comparison(const bson_t *id)
+{
+   bson_iter_t iter;
+   BSON_ASSERT(bson_iter_init_find(&iter, id, "_id"));
+
+   const bson_type_t type = bson_iter_type(&iter);
+   return type == BSON_TYPE_UTF8 || type == BSON_TYPE_SYMBOL || type == BSON_TYPE_DOCUMENT ||
+          type == BSON_TYPE_ARRAY || type == BSON_TYPE_DECIMAL128;
+}
+
+
+/* Whether the _id `found`, of a document returned by the find, is equal to the
+ * requested `id`. Numbers are compared by their exact value, other values by
+ * type and content. A lookup whose _id the server may compare otherwise is sent
+ * again alone if no document matched, see _id_needs_server_comparison. */
+static bool
+_id_matches(const bson_t *id, const bson_iter_t *found)
+{
+   bson_iter_t id_iter;
+   BSON_ASSERT(bson_iter_init_find(&id_iter, id, "_id"));
+
+   const bson_type_t id_type = bson_iter_type(&id_iter);
+   const bson_type_t found_type = bson_iter_type(found);
+
+   if (_is_integer(id_type) && _is_integer(found_type)) {
+      return bson_iter_as_int64(&id_iter) == bson_iter_as_int64(found);
+   }
+
+   if (_is_integer(id_type) && found_type == BSON_TYPE_DOUBLE) {
+      return _integer_equals_double(bson_iter_as_int64(&id_iter), bson_iter_double(found));
+   }
+
+   if (id_type == BSON_TYPE_DOUBLE && _is_integer(found_type)) {
+      return _integer_equals_double(bson_iter_as_int64(found), bson_iter_double(&id_iter));
+   }
+
+   if (id_type == BSON_TYPE_DOUBLE && found_type == BSON_TYPE_DOUBLE) {
+      const double a = bson_iter_double(&id_iter);
+      const double b = bson_iter_double(found);
+      // The server considers NaN equal to NaN.
+      return a == b || (isnan(a) && isnan(b));
+   }
+
+   if (id_type != found_type) {
+      return false;
+   }
+
+   bson_t found_id = BSON_INITIALIZER;
+   BSON_ASSERT(bson_append_iter(&found_id, "_id", 3, found));
+   const bool equal = bson_equal(id, &found_id);
+   bson_destroy(&found_id);
+   return equal;
+}
+
+
+// Finds the document of one lookup alone, with the filter { "_id": <id> }.
+static void
+_find_alone(waiter_t *w, mongoc_lookup_batcher_find_fn find, void *ctx)
+{
+   mongoc_cursor_t *const cursor = find(&w->id, ctx);
+   const bson_t *doc;
+
+   if (mongoc_cursor_next(cursor, &doc)) {
+      BSON_ASSERT(bson_concat(w->document, doc));
+      w->found = true;
+   }
+
+   w->ok = !mongoc_cursor_error(cursor, &w->error);
+   mongoc_cursor_destroy(cursor);
+}
+
+
+/* Sends the lookups of up to `max_batch_size` queued callers. Called by the
+ * leader with the lock held; the lock is released while sending. */
+static void
+_lead(mongoc_lookup_batcher_t *batcher, group_t *group, mongoc_lookup_batcher_find_fn find, void *ctx)
+{
+   // Give other callers the delay to join, unless there is already a full batch.
+   if (batcher->max_delay_us > 0) {
+      const int64_t deadline = bson_get_monotonic_time() + batcher->max_delay_us;
+
+      while (group->n_waiting < (size_t)batcher->max_batch_size) {
+         const int64_t remaining_us = deadline - bson_get_monotonic_time();
+         if (remaining_us <= 0) {
+            break;
+         }
+         if (remaining_us >= 1000) {
+            mongoc_cond_timedwait(&group->full, &batcher->mutex, remaining_us / 1000);
+         } else {
+            // Condition variables wait in milliseconds. Yield for the rest of a shorter delay.
+            bson_mutex_unlock(&batcher->mutex);
+            mcommon_thrd_yield();
+            bson_mutex_lock(&batcher->mutex);
+         }
+      }
+   }
+
+   // Take the first callers off the queue.
+   waiter_t *const batch = group->head;
+   waiter_t *last = batch;
+   uint32_t n = 1;
+
+   while (last->next && n < (uint32_t)batcher->max_batch_size) {
+      last = last->next;
+      n++;
+   }
+   group->head = last->next;
+   if (!group->head) {
+      group->tail = NULL;
+   }
+   group->n_waiting -= n;
+   last->next = NULL;
+
+   bson_mutex_unlock(&batcher->mutex);
+
+   bson_t filter = BSON_INITIALIZER;
+   {
+      bson_t id_filter;
+      bson_array_builder_t *in;
+      bson_iter_t iter;
+
+      BSON_ASSERT(BSON_APPEND_DOCUMENT_BEGIN(&filter, "_id", &id_filter));
+      BSON_ASSERT(BSON_APPEND_ARRAY_BUILDER_BEGIN(&id_filter, "$in", &in));
+      for (const waiter_t *w = batch; w; w = w->next) {
+         BSON_ASSERT(bson_iter_init_find(&iter, &w->id, "_id"));
+         BSON_ASSERT(bson_array_builder_append_iter(in, &iter));
+      }
+      BSON_ASSERT(bson_append_array_builder_end(&id_filter, in));
+      BSON_ASSERT(bson_append_document_end(&filter, &id_filter));
+   }
+
+   mongoc_cursor_t *const cursor = find(&filter, ctx);
+   const bson_t *doc;
+   bson_error_t error;
+
+   // Give each document to every caller that requested its _id.
+   while (mongoc_cursor_next(cursor, &doc)) {
+      bson_iter_t iter;
+      if (!bson_iter_init_find(&iter, doc, "_id")) {
+         continue;
+      }
+      for (waiter_t *w = batch; w; w = w->next) {
+         if (!w->found && _id_matches(&w->id, &iter)) {
+            BSON_ASSERT(bson_concat(w->document, doc));
+            w->found = true;
+         }
+      }
+   }
+
+   const bool ok = !mongoc_cursor_error(cursor, &error);
+   mongoc_cursor_destroy(cursor);
+   bson_destroy(&filter);
+
+   for (waiter_t *w = batch; w; w = w->next) {
+      if (ok && !w->found && _id_needs_server_comparison(&w->id)) {
+         // Another document may be equal to this _id for the server, and was only returned for another lookup.
+         _find_alone(w, find, ctx);
+         continue;
+      }
+      w->ok = ok;
+      if (!ok) {
+         w->error = error;
+      }
+   }
+
+   bson_mutex_lock(&batcher->mutex);
+
+   for (waiter_t *w = batch; w;) {
+      waiter_t *const next = w->next;
+      // `w` belongs to a caller that may return as soon as it is done.
+      w->done = true;
+      mongoc_cond_signal(&w->cond);
+      w = next;
+   }
+}
+
+
+bool
+_mongoc_lookup_batcher_find(mongoc_lookup_batcher_t *batcher,
+                            const char *key,
+                            const bson_value_t *id,
+                            mongoc_lookup_batcher_find_fn find,
+                            void *ctx,
+                            bson_t *document,
+                            bson_error_t *error)
+{
+   BSON_ASSERT_PARAM(batcher);
+   BSON_ASSERT_PARAM(key);
+   BSON_ASSERT_PARAM(id);
+   BSON_ASSERT_PARAM(find);
+   BSON_ASSERT_PARAM(document);
+   BSON_OPTIONAL_PARAM(error);
+
+   waiter_t waiter = {.document = document};
+   bson_init(&waiter.id);
+   BSON_ASSERT(BSON_APPEND_VALUE(&waiter.id, "_id", id));
+   mongoc_cond_init(&waiter.cond);
+
+   bson_mutex_lock(&batcher->mutex);
+
+   group_t *const group = _join_group(batcher, key);
+
+   if (group->tail) {
+      group->tail->next = &waiter;
+   } else {
+      group->head = &waiter;
+   }
+   group->tail = &waiter;
+   group->n_waiting++;
+   if (group->has_leader && group->n_waiting == (size_t)batcher->max_batch_size) {
+      mongoc_cond_signal(&group->full);
+   }
+
+   while (!waiter.done) {
+      if (group->has_leader) {
+         mongoc_cond_wait(&waiter.cond, &batcher->mutex);
+         continue;
+      }
+
+      // Lead until this caller's lookup was sent. Lookups queued earlier are sent first.
+      group->has_leader = true;
+      _lead(batcher, group, find, ctx);
+      group->has_leader = false;
+   }
+
+   // Hand the group over to the first caller still waiting.
+   if (!group->has_leader && group->head) {
+      mongoc_cond_signal(&group->head->cond);
+   }
+
+   _leave_group(batcher, group);
+
+   bson_mutex_unlock(&batcher->mutex);
+
+   mongoc_cond_destroy(&waiter.cond);
+   bson_destroy(&waiter.id);
+   if (!waiter.ok && error) {
+      *error = waiter.error;
+   }
+   return waiter.ok;
+}
@@ -168,6 +168,7 @@ typedef struct _mongoc_change_stream_opts_t {
    const char *fullDocument;
    const char *fullDocumentBeforeChange;
    bool showExpandedEvents;
+   bool prefetch;
    bson_value_t comment;
    bson_t extra;
 } mongoc_change_stream_opts_t;
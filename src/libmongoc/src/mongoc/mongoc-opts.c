@@ -1658,6 +1658,7 @@ _mongoc_change_stream_opts_parse (
    mongoc_change_stream_opts->fullDocument = NULL;
    mongoc_change_stream_opts->fullDocumentBeforeChange = NULL;
    mongoc_change_stream_opts->showExpandedEvents = false;
+   mongoc_change_stream_opts->prefetch = false;
    memset (&mongoc_change_stream_opts->comment, 0, sizeof (bson_value_t));
    bson_init (&mongoc_change_stream_opts->extra);
 
@@ -1746,6 +1747,15 @@ _mongoc_change_stream_opts_parse (
             return false;
          }
       }
+      else if (!strcmp (bson_iter_key (&iter), "prefetch")) {
+         if (!_mongoc_convert_bool (
+               client,
+               &iter,
+               &mongoc_change_stream_opts->prefetch,
+               error)) {
+            return false;
+         }
+      }
       else if (!strcmp (bson_iter_key (&iter), "comment")) {
          if (!_mongoc_convert_bson_value_t (
                client,
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mongoc/mongoc-prelude.h>
+
+#ifndef MONGOC_SHARD_ROUTING_PRIVATE_H
+#define MONGOC_SHARD_ROUTING_PRIVATE_H
+
+#include <mongoc/mongoc-client.h>
+
+#include <bson/bson.h>
+
+BSON_BEGIN_DECLS
+
+/* Caches the shard key and chunk ranges of sharded collections, read from
+ * config.collections and config.chunks through mongos. A cached table is
+ * reused while the collection entry and the highest chunk version are
+ * unchanged. Not thread safe, each mongoc_client_t owns its cache. */
+typedef struct _mongoc_shard_routing_t mongoc_shard_routing_t;
+
+/* The shard key and chunk ranges of one collection. */
+typedef struct _mongoc_shard_routing_table_t mongoc_shard_routing_table_t;
+
+mongoc_shard_routing_t *
+_mongoc_shard_routing_new(void);
+
+void
+_mongoc_shard_routing_destroy(mongoc_shard_routing_t *routing);
+
+/* Returns the table of collection "db.coll", read with `client` if it is not
+ * cached or is out of date. Returns NULL if the collection is not sharded or
+ * the config database could not be read. The table is valid until the next
+ * call on `routing`. */
+const mongoc_shard_routing_table_t *
+_mongoc_shard_routing_get(mongoc_shard_routing_t *routing, mongoc_client_t *client, const char *db, const char *coll);
+
+uint32_t
+_mongoc_shard_routing_table_n_shards(const mongoc_shard_routing_table_t *table);
+
+/* Returns the index of the shard owning the document `doc`, or of the
+ * documents matched by the query `filter`, or -1 if it is not known. A filter
+ * is routed only if it has an equality condition on every shard key field.
+ * Hashed shard keys are not routed. */
+int32_t
+_mongoc_shard_routing_table_find_document(const mongoc_shard_routing_table_t *table, const bson_t *doc);
+
+int32_t
+_mongoc_shard_routing_table_find_filter(const mongoc_shard_routing_table_t *table, const bson_t *filter);
+
+BSON_END_DECLS
+
+#endif /* MONGOC_SHARD_ROUTING_PRIVATE_H */
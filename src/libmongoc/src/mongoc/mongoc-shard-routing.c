@@ -0,0 +1,793 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mongoc/mongoc-array-private.h>
+#include <mongoc/mongoc-shard-routing-private.h>
+
+#include <mongoc/mongoc-cursor.h>
+#include <mongoc/mongoc-server-description.h>
+
+#include <bson/bson.h>
+
+#include <math.h>
+#include <string.h>
+
+/* An index, and so a shard key, has at most 32 fields. */
+#define SHARD_KEY_MAX_FIELDS 32
+
+typedef struct {
+   bson_t *min;
+   bson_t *max;
+   int32_t shard;
+} chunk_t;
+
+struct _mongoc_shard_routing_table_t {
+   char *ns;
+   /* The config.collections document, compared to detect a new epoch or shard key. */
+   bson_t *entry;
+   bson_t *key;
+   uint32_t n_fields;
+   bool hashed;
+   /* The highest chunk version, which changes when a chunk is split or moved. */
+   uint32_t lastmod_timestamp;
+   uint32_t lastmod_increment;
+   /* Sorted by "min". */
+   mongoc_array_t chunks;
+   /* Shard names, indexed by chunk_t.shard. */
+   mongoc_array_t shards;
+};
+
+struct _mongoc_shard_routing_t {
+   mongoc_array_t tables;
+};
+
+
+static void
+_table_destroy(mongoc_shard_routing_table_t *table)
+{
+   if (!table) {
+      return;
+   }
+
+   for (size_t i = 0u; i < table->chunks.len; i++) {
+      chunk_t *const chunk = &_mongoc_array_index(&table->chunks, chunk_t, i);
+      bson_destroy(chunk->min);
+      bson_destroy(chunk->max);
+   }
+
+   for (size_t i = 0u; i < table->shards.len; i++) {
+      bson_free(_mongoc_array_index(&table->shards, char *, i));
+   }
+
+   _mongoc_array_destroy(&table->chunks);
+   _mongoc_array_destroy(&table->shards);
+   bson_destroy(table->key);
+   bson_destroy(table->entry);
+   bson_free(table->ns);
+   bson_free(table);
+}
+
+
+mongoc_shard_routing_t *
+_mongoc_shard_routing_new(void)
+{
+   mongoc_shard_routing_t *const routing = bson_malloc0(sizeof *routing);
+
+   _mongoc_array_init(&routing->tables, sizeof(mongoc_shard_routing_table_t *));
+
+   return routing;
+}
+
+
+void
+_mongoc_shard_routing_destroy(mongoc_shard_routing_t *routing)
+{
+   if (!routing) {
+      return;
+   }
+
+   for (size_t i = 0u; i < routing->tables.len; i++) {
+      _table_destroy(_mongoc_array_index(&routing->tables, mongoc_shard_routing_table_t *, i));
+   }
+
+   _mongoc_array_destroy(&routing->tables);
+   bson_free(routing);
+}
+
+
+/* Runs a find command on the config database and returns its cursor, or NULL. */
+static mongoc_cursor_t *
+_config_find(mongoc_client_t *client,
+             uint32_t server_id,
+             const char *coll,
+             const bson_t *filter,
+             const bson_t *sort,
+             int64_t limit)
+{
+   bson_t cmd = BSON_INITIALIZER;
+   bson_t opts = BSON_INITIALIZER;
+   bson_t reply;
+   mongoc_cursor_t *cursor = NULL;
+
+   BSON_APPEND_UTF8(&cmd, "find", coll);
+   BSON_APPEND_DOCUMENT(&cmd, "filter", filter);
+   if (sort) {
+      BSON_APPEND_DOCUMENT(&cmd, "sort", sort);
+   }
+   if (limit) {
+      BSON_APPEND_INT64(&cmd, "limit", limit);
+   }
+   BSON_APPEND_INT32(&opts, "serverId", (int32_t)server_id);
+
+   // Not mongoc_collection_find_with_opts: the client's find cache must not answer these queries.
+   if (mongoc_client_read_command_with_opts(client, "config", &cmd, NULL, &opts, &reply, NULL)) {
+      cursor = mongoc_cursor_new_from_command_reply_with_opts(client, &reply, &opts);
+   } else {
+      bson_destroy(&reply);
+   }
+
+   bson_destroy(&opts);
+   bson_destroy(&cmd);
+
+   return cursor;
+}
+
+
+/* Copies the first result of a find command on the config database into
+ * `doc`. Returns false if there is none or the query failed. */
+static bool
+_config_find_one(mongoc_client_t *client,
+                 uint32_t server_id,
+                 const char *coll,
+                 const bson_t *filter,
+                 const bson_t *sort,
+                 bson_t *doc)
+{
+   mongoc_cursor_t *const cursor = _config_find(client, server_id, coll, filter, sort, 1);
+   const bson_t *result;
+   bool ret = false;
+
+   if (cursor && mongoc_cursor_next(cursor, &result)) {
+      bson_copy_to(result, doc);
+      ret = true;
+   }
+
+   mongoc_cursor_destroy(cursor);
+
+   return ret;
+}
+
+
+/* Chunks are identified by collection UUID since MongoDB 5.0, which added
+ * "timestamp" to config.collections, and by namespace before. */
+static void
+_chunks_filter(const mongoc_shard_routing_table_t *table, bson_t *filter)
+{
+   bson_iter_t iter;
+
+   bson_init(filter);
+
+   if (bson_iter_init_find(&iter, table->entry, "timestamp") && bson_iter_init_find(&iter, table->entry, "uuid")) {
+      BSON_APPEND_VALUE(filter, "uuid", bson_iter_value(&iter));
+   } else {
+      BSON_APPEND_UTF8(filter, "ns", table->ns);
+   }
+}
+
+
+static void
+_chunk_lastmod(const bson_t *chunk, uint32_t *timestamp, uint32_t *increment)
+{
+   bson_iter_t iter;
+
+   *timestamp = 0;
+   *increment = 0;
+
+   if (bson_iter_init_find(&iter, chunk, "lastmod") && BSON_ITER_HOLDS_TIMESTAMP(&iter)) {
+      bson_iter_timestamp(&iter, timestamp, increment);
+   }
+}
+
+
+static int32_t
+_shard_index(mongoc_shard_routing_table_t *table, const char *shard)
+{
+   for (size_t i = 0u; i < table->shards.len; i++) {
+      if (0 == strcmp(_mongoc_array_index(&table->shards, char *, i), shard)) {
+         return (int32_t)i;
+      }
+   }
+
+   char *const copy = bson_strdup(shard);
+   _mongoc_array_append_val(&table->shards, copy);
+
+   return (int32_t)(table->shards.len - 1u);
+}
+
+
+static bool
+_load_chunks(mongoc_shard_routing_table_t *table, mongoc_client_t *client, uint32_t server_id)
+{
+   bson_t filter;
+   bson_t sort = BSON_INITIALIZER;
+   const bson_t *doc;
+   bson_iter_t iter;
+   bool ret = false;
+
+   _chunks_filter(table, &filter);
+   BSON_APPEND_INT32(&sort, "min", 1);
+
+   mongoc_cursor_t *const cursor = _config_find(client, server_id, "chunks", &filter, &sort, 0);
+   if (!cursor) {
+      goto done;
+   }
+
+   while (mongoc_cursor_next(cursor, &doc)) {
+      uint32_t timestamp;
+      uint32_t increment;
+      uint32_t len;
+      const uint8_t *data;
+      chunk_t chunk;
+
+      if (!bson_iter_init_find(&iter, doc, "shard") || !BSON_ITER_HOLDS_UTF8(&iter)) {
+         goto done;
+      }
+      chunk.shard = _shard_index(table, bson_iter_utf8(&iter, NULL));
+
+      if (!bson_iter_init_find(&iter, doc, "min") || !BSON_ITER_HOLDS_DOCUMENT(&iter)) {
+         goto done;
+      }
+      bson_iter_document(&iter, &len, &data);
+      chunk.min = bson_new_from_data(data, len);
+
+      if (!bson_iter_init_find(&iter, doc, "max") || !BSON_ITER_HOLDS_DOCUMENT(&iter)) {
+         bson_destroy(chunk.min);
+         goto done;
+      }
+      bson_iter_document(&iter, &len, &data);
+      chunk.max = bson_new_from_data(data, len);
+
+      _mongoc_array_append_val(&table->chunks, chunk);
+
+      _chunk_lastmod(doc, &timestamp, &increment);
+      if (timestamp > table->lastmod_timestamp ||
+          (timestamp == table->lastmod_timestamp && increment > table->lastmod_increment)) {
+         table->lastmod_timestamp = timestamp;
+         table->lastmod_increment = increment;
+      }
+   }
+
+   ret = !mongoc_cursor_error(cursor, NULL) && table->chunks.len > 0u;
+
+done:
+   mongoc_cursor_destroy(cursor);
+   bson_destroy(&sort);
+   bson_destroy(&filter);
+
+   return ret;
+}
+
+
+static mongoc_shard_routing_table_t *
+_table_new(const char *ns, const bson_t *entry, mongoc_client_t *client, uint32_t server_id)
+{
+   mongoc_shard_routing_table_t *const table = bson_malloc0(sizeof *table);
+   bson_iter_t iter;
+   uint32_t len;
+   const uint8_t *data;
+
+   table->ns = bson_strdup(ns);
+   table->entry = bson_copy(entry);
+   _mongoc_array_init(&table->chunks, sizeof(chunk_t));
+   _mongoc_array_init(&table->shards, sizeof(char *));
+
+   if (!bson_iter_init_find(&iter, entry, "key") || !BSON_ITER_HOLDS_DOCUMENT(&iter)) {
+      goto fail;
+   }
+
+   bson_iter_document(&iter, &len, &data);
+   table->key = bson_new_from_data(data, len);
+   table->n_fields = bson_count_keys(table->key);
+   if (table->n_fields == 0u || table->n_fields > SHARD_KEY_MAX_FIELDS) {
+      goto fail;
+   }
+
+   BSON_ASSERT(bson_iter_init(&iter, table->key));
+   while (bson_iter_next(&iter)) {
+      if (BSON_ITER_HOLDS_UTF8(&iter) && 0 == strcmp(bson_iter_utf8(&iter, NULL), "hashed")) {
+         // Routing a hashed shard key requires the server's hash function: keep the table to skip reloading it.
+         table->hashed = true;
+         return table;
+      }
+   }
+
+   if (!_load_chunks(table, client, server_id)) {
+      goto fail;
+   }
+
+   return table;
+
+fail:
+   _table_destroy(table);
+   return NULL;
+}
+
+
+static bool
+_is_current(const mongoc_shard_routing_table_t *table,
+            const bson_t *entry,
+            mongoc_client_t *client,
+            uint32_t server_id)
+{
+   bson_t filter;
+   bson_t sort = BSON_INITIALIZER;
+   bson_t chunk;
+   uint32_t timestamp;
+   uint32_t increment;
+   bool ret = false;
+
+   if (!bson_equal(table->entry, entry)) {
+      return false;
+   }
+
+   if (table->hashed) {
+      return true;
+   }
+
+   _chunks_filter(table, &filter);
+   BSON_APPEND_INT32(&sort, "lastmod", -1);
+
+   if (_config_find_one(client, server_id, "chunks", &filter, &sort, &chunk)) {
+      _chunk_lastmod(&chunk, &timestamp, &increment);
+      ret = timestamp == table->lastmod_timestamp && increment == table->lastmod_increment;
+      bson_destroy(&chunk);
+   }
+
+   bson_destroy(&sort);
+   bson_destroy(&filter);
+
+   return ret;
+}
+
+
+const mongoc_shard_routing_table_t *
+_mongoc_shard_routing_get(mongoc_shard_routing_t *routing, mongoc_client_t *client, const char *db, const char *coll)
+{
+   BSON_ASSERT_PARAM(routing);
+   BSON_ASSERT_PARAM(client);
+   BSON_ASSERT_PARAM(db);
+   BSON_ASSERT_PARAM(coll);
+
+   char *const ns = bson_strdup_printf("%s.%s", db, coll);
+   mongoc_shard_routing_table_t *table = NULL;
+   mongoc_shard_routing_table_t **slot = NULL;
+   bson_t filter = BSON_INITIALIZER;
+   bson_t entry = BSON_INITIALIZER;
+   bson_iter_t iter;
+   uint32_t server_id;
+
+   for (size_t i = 0u; i < routing->tables.len; i++) {
+      mongoc_shard_routing_table_t **const t =
+         &_mongoc_array_index(&routing->tables, mongoc_shard_routing_table_t *, i);
+      if (0 == strcmp((*t)->ns, ns)) {
+         slot = t;
+         break;
+      }
+   }
+
+   // Send every query to the same mongos.
+   mongoc_server_description_t *const sd = mongoc_client_select_server(client, false, NULL, NULL);
+   if (!sd) {
+      goto done;
+   }
+
+   server_id = mongoc_server_description_id(sd);
+   mongoc_server_description_destroy(sd);
+
+   BSON_APPEND_UTF8(&filter, "_id", ns);
+   if (!_config_find_one(client, server_id, "collections", &filter, NULL, &entry) ||
+       (bson_iter_init_find(&iter, &entry, "dropped") && bson_iter_as_bool(&iter))) {
+      goto done;
+   }
+
+   if (slot && _is_current(*slot, &entry, client, server_id)) {
+      table = *slot;
+      goto done;
+   }
+
+   table = _table_new(ns, &entry, client, server_id);
+   if (table) {
+      if (slot) {
+         _table_destroy(*slot);
+         *slot = table;
+      } else {
+         _mongoc_array_append_val(&routing->tables, table);
+      }
+      slot = NULL;
+   }
+
+done:
+   if (slot && *slot != table) {
+      // The collection is no longer sharded or could not be read: forget it.
+      _table_destroy(*slot);
+      *slot = _mongoc_array_index(&routing->tables, mongoc_shard_routing_table_t *, routing->tables.len - 1u);
+      routing->tables.len--;
+   }
+
+   bson_destroy(&entry);
+   bson_destroy(&filter);
+   bson_free(ns);
+
+   return table;
+}
+
+
+uint32_t
+_mongoc_shard_routing_table_n_shards(const mongoc_shard_routing_table_t *table)
+{
+   BSON_ASSERT_PARAM(table);
+
+   return (uint32_t)table->shards.len;
+}
+
+
+/* The rank of each type in the server's sort order, or -1 if values of the
+ * type are not compared here. */
+static int
+_type_rank(bson_type_t type)
+{
+   switch (type) {
+   case BSON_TYPE_MINKEY:
+      return 0;
+   case BSON_TYPE_NULL:
+      return 1;
+   case BSON_TYPE_DOUBLE:
+   case BSON_TYPE_INT32:
+   case BSON_TYPE_INT64:
+      return 2;
+   case BSON_TYPE_UTF8:
+   case BSON_TYPE_SYMBOL:
+      return 3;
+   case BSON_TYPE_BINARY:
+      return 6;
+   case BSON_TYPE_OID:
+      return 7;
+   case BSON_TYPE_BOOL:
+      return 8;
+   case BSON_TYPE_DATE_TIME:
+      return 9;
+   case BSON_TYPE_TIMESTAMP:
+      return 10;
+   case BSON_TYPE_MAXKEY:
+      return 14;
+   case BSON_TYPE_EOD:
+   case BSON_TYPE_DOCUMENT:
+   case BSON_TYPE_ARRAY:
+   case BSON_TYPE_UNDEFINED:
+   case BSON_TYPE_REGEX:
+   case BSON_TYPE_DBPOINTER:
+   case BSON_TYPE_CODE:
+   case BSON_TYPE_CODEWSCOPE:
+   case BSON_TYPE_DECIMAL128:
+   default:
+      return -1;
+   }
+}
+
+
+#define CMP(a, b) ((a) < (b) ? -1 : (a) > (b) ? 1 : 0)
+
+
+static int
+_compare_int64_double(int64_t i, double d)
+{
+   if (isnan(d)) {
+      return 1; // NaN sorts before other numbers.
+   }
+
+   // Rounding is monotonic: a strict inequality of the rounded value holds for `i`.
+   const double rounded = (double)i;
+   if (rounded != d) {
+      return CMP(rounded, d);
+   }
+
+   // `d` is an integer. 2^63 is the only one that does not fit an int64.
+   if (d >= 9223372036854775808.0) {
+      return -1;
+   }
+
+   return CMP(i, (int64_t)d);
+}
+
+
+static bool
+_as_int64(const bson_value_t *value, int64_t *i)
+{
+   if (value->value_type == BSON_TYPE_INT32) {
+      *i = value->value.v_int32;
+      return true;
+   }
+
+   if (value->value_type == BSON_TYPE_INT64) {
+      *i = value->value.v_int64;
+      return true;
+   }
+
+   return false;
+}
+
+
+static int
+_compare_numbers(const bson_value_t *a, const bson_value_t *b)
+{
+   int64_t ia, ib;
+   const bool a_int = _as_int64(a, &ia);
+   const bool b_int = _as_int64(b, &ib);
+
+   if (a_int && b_int) {
+      return CMP(ia, ib);
+   }
+
+   if (a_int) {
+      return _compare_int64_double(ia, b->value.v_double);
+   }
+
+   if (b_int) {
+      return -_compare_int64_double(ib, a->value.v_double);
+   }
+
+   const double da = a->value.v_double;
+   const double db = b->value.v_double;
+
+   if (isnan(da) || isnan(db)) {
+      return CMP(!isnan(da), !isnan(db));
+   }
+
+   return CMP(da, db);
+}
+
+
+static int
+_compare_bytes(const void *a, size_t a_len, const void *b, size_t b_len)
+{
+   const int cmp = memcmp(a, b, BSON_MIN(a_len, b_len));
+
+   return cmp ? CMP(cmp, 0) : CMP(a_len, b_len);
+}
+
+
+/* Compares two values in the server's sort order. Returns false if one of
+ * them has a type that is not compared here. */
+static bool
+_compare_values(const bson_value_t *a, const bson_value_t *b, int *cmp)
+{
+   const int a_rank = _type_rank(a->value_type);
+   const int b_rank = _type_rank(b->value_type);
+
+   if (a_rank < 0 || b_rank < 0) {
+      return false;
+   }
+
+   if (a_rank != b_rank) {
+      *cmp = CMP(a_rank, b_rank);
+      return true;
+   }
+
+   switch (a->value_type) {
+   case BSON_TYPE_DOUBLE:
+   case BSON_TYPE_INT32:
+   case BSON_TYPE_INT64:
+      *cmp = _compare_numbers(a, b);
+      break;
+   case BSON_TYPE_UTF8:
+   case BSON_TYPE_SYMBOL: {
+      // Both types share the layout of their string and length.
+      *cmp = _compare_bytes(a->value.v_utf8.str, a->value.v_utf8.len, b->value.v_utf8.str, b->value.v_utf8.len);
+      break;
+   }
+   case BSON_TYPE_BINARY:
+      *cmp = CMP(a->value.v_binary.data_len, b->value.v_binary.data_len);
+      if (!*cmp) {
+         *cmp = CMP((int)a->value.v_binary.subtype, (int)b->value.v_binary.subtype);
+      }
+      if (!*cmp) {
+         *cmp = _compare_bytes(
+            a->value.v_binary.data, a->value.v_binary.data_len, b->value.v_binary.data, b->value.v_binary.data_len);
+      }
+      break;
+   case BSON_TYPE_OID:
+      *cmp = CMP(bson_oid_compare(&a->value.v_oid, &b->value.v_oid), 0);
+      break;
+   case BSON_TYPE_BOOL:
+      *cmp = CMP(a->value.v_bool, b->value.v_bool);
+      break;
+   case BSON_TYPE_DATE_TIME:
+      *cmp = CMP(a->value.v_datetime, b->value.v_datetime);
+      break;
+   case BSON_TYPE_TIMESTAMP:
+      *cmp = CMP(a->value.v_timestamp.timestamp, b->value.v_timestamp.timestamp);
+      if (!*cmp) {
+         *cmp = CMP(a->value.v_timestamp.increment, b->value.v_timestamp.increment);
+      }
+      break;
+   case BSON_TYPE_EOD:
+   case BSON_TYPE_DOCUMENT:
+   case BSON_TYPE_ARRAY:
+   case BSON_TYPE_UNDEFINED:
+   case BSON_TYPE_NULL:
+   case BSON_TYPE_REGEX:
+   case BSON_TYPE_DBPOINTER:
+   case BSON_TYPE_CODE:
+   case BSON_TYPE_CODEWSCOPE:
+   case BSON_TYPE_DECIMAL128:
+   case BSON_TYPE_MAXKEY:
+   case BSON_TYPE_MINKEY:
+   default:
+      *cmp = 0;
+      break;
+   }
+
+   return true;
+}
+
+
+/* Compares the shard key `values` to a chunk bound like {"a": 1, "b": MinKey}. */
+static bool
+_compare_to_bound(const bson_value_t *values, uint32_t n_fields, const bson_t *bound, int *cmp)
+{
+   bson_iter_t iter;
+   uint32_t i = 0u;
+
+   *cmp = 0;
+
+   if (!bson_iter_init(&iter, bound)) {
+      return false;
+   }
+
+   while (i < n_fields && bson_iter_next(&iter)) {
+      if (!_compare_values(&values[i], bson_iter_value(&iter), cmp)) {
+         return false;
+      }
+
+      if (*cmp) {
+         return true;
+      }
+
+      i++;
+   }
+
+   return i == n_fields;
+}
+
+
+static int32_t
+_find_chunk(const mongoc_shard_routing_table_t *table, const bson_value_t *values)
+{
+   const chunk_t *const chunks = (const chunk_t *)table->chunks.data;
+   size_t lo = 0u;
+   size_t hi = table->chunks.len;
+   int cmp;
+
+   // Find the last chunk whose "min" is not greater than `values`.
+   while (lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2u;
+
+      if (!_compare_to_bound(values, table->n_fields, chunks[mid].min, &cmp)) {
+         return -1;
+      }
+
+      if (cmp >= 0) {
+         lo = mid + 1u;
+      } else {
+         hi = mid;
+      }
+   }
+
+   if (lo == 0u) {
+      return -1;
+   }
+
+   const chunk_t *const chunk = &chunks[lo - 1u];
+   if (!_compare_to_bound(values, table->n_fields, chunk->max, &cmp) || cmp >= 0) {
+      return -1;
+   }
+
+   return chunk->shard;
+}
+
+
+int32_t
+_mongoc_shard_routing_table_find_document(const mongoc_shard_routing_table_t *table, const bson_t *doc)
+{
+   BSON_ASSERT_PARAM(table);
+   BSON_ASSERT_PARAM(doc);
+
+   bson_value_t values[SHARD_KEY_MAX_FIELDS];
+   bson_iter_t key_iter;
+   bson_iter_t iter;
+   uint32_t i = 0u;
+
+   if (table->hashed || !bson_iter_init(&key_iter, table->key)) {
+      return -1;
+   }
+
+   while (bson_iter_next(&key_iter)) {
+      BSON_ASSERT(i < table->n_fields);
+
+      if (bson_iter_init(&iter, doc) && bson_iter_find_descendant(&iter, bson_iter_key(&key_iter), &iter)) {
+         if (BSON_ITER_HOLDS_ARRAY(&iter)) {
+            return -1;
+         }
+         values[i] = *bson_iter_value(&iter);
+      } else {
+         // A missing shard key field is stored as null.
+         values[i].value_type = BSON_TYPE_NULL;
+      }
+
+      i++;
+   }
+
+   return _find_chunk(table, values);
+}
+
+
+int32_t
+_mongoc_shard_routing_table_find_filter(const mongoc_shard_routing_table_t *table, const bson_t *filter)
+{
+   BSON_ASSERT_PARAM(table);
+   BSON_ASSERT_PARAM(filter);
+
+   bson_value_t values[SHARD_KEY_MAX_FIELDS];
+   bson_iter_t key_iter;
+   bson_iter_t iter;
+   bson_iter_t child;
+   uint32_t i = 0u;
+
+   if (table->hashed || !bson_iter_init(&key_iter, table->key)) {
+      return -1;
+   }
+
+   while (bson_iter_next(&key_iter)) {
+      const char *const path = bson_iter_key(&key_iter);
+
+      BSON_ASSERT(i < table->n_fields);
+
+      // Like {"a.b": 1}, or {"a": {"b": 1}}.
+      if (!bson_iter_init_find(&iter, filter, path) &&
+          !(bson_iter_init(&iter, filter) && bson_iter_find_descendant(&iter, path, &iter))) {
+         return -1;
+      }
+
+      if (BSON_ITER_HOLDS_DOCUMENT(&iter)) {
+         // Only {"$eq": value} is an equality condition.
+         if (!bson_iter_recurse(&iter, &child) || !bson_iter_next(&child) || !BSON_ITER_IS_KEY(&child, "$eq")) {
+            return -1;
+         }
+         values[i] = *bson_iter_value(&child);
+         if (bson_iter_next(&child)) {
+            return -1;
+         }
+      } else if (BSON_ITER_HOLDS_ARRAY(&iter) || BSON_ITER_HOLDS_REGEX(&iter)) {
+         return -1;
+      } else {
+         values[i] = *bson_iter_value(&iter);
+      }
+
+      i++;
+   }
+
+   return _find_chunk(table, values);
+}
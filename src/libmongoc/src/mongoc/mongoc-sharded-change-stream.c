@@ -0,0 +1,392 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mongoc/mongoc-sharded-change-stream.h>
+
+#include <common-thread-private.h>
+#include <mongoc/mongoc-change-stream-private.h>
+#include <mongoc/mongoc-client-private.h>
+#include <mongoc/mongoc-cursor-private.h>
+#include <mongoc/mongoc-error-private.h>
+#include <mongoc/mongoc-opts-helpers-private.h>
+#include <mongoc/mongoc-uri-private.h>
+
+#include <mongoc/mongoc-error.h>
+
+#include <bson/bson.h>
+
+typedef struct {
+   char *name;
+   mongoc_client_t *client;
+   mongoc_change_stream_t *stream;
+   // The cluster time up to which all events of this shard were acknowledged.
+   mongoc_timestamp_t watermark;
+   bool has_watermark;
+} shard_t;
+
+struct _mongoc_sharded_change_stream_t {
+   shard_t *shards;
+   size_t n_shards;
+   // Guards the watermarks, which are acknowledged from the threads iterating the shards.
+   bson_mutex_t mutex;
+};
+
+
+static int
+_timestamp_cmp(const mongoc_timestamp_t *a, const mongoc_timestamp_t *b)
+{
+   if (a->timestamp != b->timestamp) {
+      return a->timestamp < b->timestamp ? -1 : 1;
+   }
+
+   if (a->increment != b->increment) {
+      return a->increment < b->increment ? -1 : 1;
+   }
+
+   return 0;
+}
+
+
+static void
+_advance_watermark(shard_t *shard, const mongoc_timestamp_t *ts)
+{
+   if (!shard->has_watermark || _timestamp_cmp(&shard->watermark, ts) < 0) {
+      shard->watermark = *ts;
+      shard->has_watermark = true;
+   }
+}
+
+
+static int
+_hex_value(char c)
+{
+   if (c >= '0' && c <= '9') {
+      return c - '0';
+   }
+   if (c >= 'a' && c <= 'f') {
+      return c - 'a' + 10;
+   }
+   if (c >= 'A' && c <= 'F') {
+      return c - 'A' + 10;
+   }
+   return -1;
+}
+
+
+/* Resume tokens are opaque, but the "_data" string of every server version
+ * that supports change streams on sharded clusters begins with the cluster
+ * time of the event: the type byte 0x82 followed by the big-endian seconds and
+ * increment. */
+static bool
+_timestamp_from_resume_token(const bson_t *resume_token, mongoc_timestamp_t *ts)
+{
+   bson_iter_t iter;
+   const char *data;
+   uint32_t len;
+   uint8_t bytes[9];
+
+   if (!resume_token || !bson_iter_init_find(&iter, resume_token, "_data") || !BSON_ITER_HOLDS_UTF8(&iter)) {
+      return false;
+   }
+
+   data = bson_iter_utf8(&iter, &len);
+   if (len < 2u * sizeof bytes) {
+      return false;
+   }
+
+   for (size_t i = 0; i < sizeof bytes; i++) {
+      const int hi = _hex_value(data[2u * i]);
+      const int lo = _hex_value(data[2u * i + 1u]);
+
+      if (hi < 0 || lo < 0) {
+         return false;
+      }
+
+      bytes[i] = (uint8_t)(hi << 4 | lo);
+   }
+
+   if (bytes[0] != 0x82) {
+      return false;
+   }
+
+   ts->timestamp = (uint32_t)bytes[1] << 24 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 8 | (uint32_t)bytes[4];
+   ts->increment = (uint32_t)bytes[5] << 24 | (uint32_t)bytes[6] << 16 | (uint32_t)bytes[7] << 8 | (uint32_t)bytes[8];
+   return true;
+}
+
+
+static bool
+_open_shard(mongoc_client_t *parent,
+            shard_t *shard,
+            const char *host,
+            const bson_t *pipeline,
+            const bson_t *opts,
+            bson_error_t *error)
+{
+   mongoc_uri_t *uri;
+   const bson_t *err_doc;
+   const bson_t *reply;
+   bson_iter_t iter;
+
+   uri = _mongoc_uri_copy_for_shard(parent->uri, host, error);
+   if (!uri) {
+      return false;
+   }
+
+   shard->client = mongoc_client_new_from_uri_with_error(uri, error);
+   mongoc_uri_destroy(uri);
+   if (!shard->client) {
+      return false;
+   }
+
+   if (parent->error_api_set) {
+      BSON_ASSERT(mongoc_client_set_error_api(shard->client, parent->error_api_version));
+   }
+
+   if (parent->api && !mongoc_client_set_server_api(shard->client, parent->api, error)) {
+      return false;
+   }
+
+#ifdef MONGOC_ENABLE_SSL
+   if (parent->use_ssl) {
+      mongoc_client_set_ssl_opts(shard->client, &parent->ssl_opts);
+   }
+#endif
+
+   shard->stream = _mongoc_change_stream_new_from_client(shard->client, pipeline, opts);
+   if (mongoc_change_stream_error_document(shard->stream, error, &err_doc)) {
+      return false;
+   }
+
+   reply = _mongoc_cursor_change_stream_get_reply(shard->stream->cursor);
+
+   // The stream starts at "startAtOperationTime" or at the operationTime of the initial aggregate. Nothing before it
+   // needs to be replayed.
+   if (!_mongoc_timestamp_empty(&shard->stream->operation_time)) {
+      _advance_watermark(shard, &shard->stream->operation_time);
+   } else if (bson_iter_init_find(&iter, reply, "operationTime") &&
+              BSON_ITER_HOLDS_TIMESTAMP(&iter)) {
+      mongoc_timestamp_t ts;
+
+      _mongoc_timestamp_set_from_bson(&ts, &iter);
+      _advance_watermark(shard, &ts);
+   }
+
+   return true;
+}
+
+
+mongoc_sharded_change_stream_t *
+mongoc_client_watch_shards(mongoc_client_t *client, const bson_t *pipeline, const bson_t *opts, bson_error_t *error)
+{
+   mongoc_sharded_change_stream_t *stream;
+   bson_t cmd = BSON_INITIALIZER;
+   bson_t reply;
+   bson_iter_t iter;
+   bson_iter_t shards_iter;
+   size_t n_shards = 0;
+   size_t i = 0;
+
+   BSON_ASSERT_PARAM(client);
+   BSON_ASSERT_PARAM(pipeline);
+   BSON_OPTIONAL_PARAM(opts);
+
+   if (opts && (bson_has_field(opts, "resumeAfter") || bson_has_field(opts, "startAfter"))) {
+      _mongoc_set_error(error,
+                        MONGOC_ERROR_COMMAND,
+                        MONGOC_ERROR_COMMAND_INVALID_ARG,
+                        "Cannot watch shards with \"resumeAfter\" or \"startAfter\", use \"startAtOperationTime\"");
+      return NULL;
+   }
+
+   BSON_APPEND_INT32(&cmd, "listShards", 1);
+   if (!mongoc_client_command_simple(client, "admin", &cmd, NULL, &reply, error)) {
+      bson_destroy(&cmd);
+      bson_destroy(&reply);
+      return NULL;
+   }
+
+   bson_destroy(&cmd);
+
+   if (!bson_iter_init_find(&iter, &reply, "shards") || !BSON_ITER_HOLDS_ARRAY(&iter) ||
+       !bson_iter_recurse(&iter, &shards_iter)) {
+      _mongoc_set_error(error, MONGOC_ERROR_PROTOCOL, MONGOC_ERROR_PROTOCOL_INVALID_REPLY, "Invalid listShards reply");
+      bson_destroy(&reply);
+      return NULL;
+   }
+
+   while (bson_iter_next(&shards_iter)) {
+      n_shards++;
+   }
+
+   stream = BSON_ALIGNED_ALLOC0(mongoc_sharded_change_stream_t);
+   stream->shards = bson_malloc0(sizeof(shard_t) * (n_shards ? n_shards : 1u));
+   stream->n_shards = n_shards;
+   bson_mutex_init(&stream->mutex);
+
+   BSON_ASSERT(bson_iter_recurse(&iter, &shards_iter));
+   while (bson_iter_next(&shards_iter)) {
+      bson_iter_t shard_iter;
+      const char *name = NULL;
+      const char *host = NULL;
+
+      if (BSON_ITER_HOLDS_DOCUMENT(&shards_iter) && bson_iter_recurse(&shards_iter, &shard_iter)) {
+         while (bson_iter_next(&shard_iter)) {
+            if (BSON_ITER_IS_KEY(&shard_iter, "_id") && BSON_ITER_HOLDS_UTF8(&shard_iter)) {
+               name = bson_iter_utf8(&shard_iter, NULL);
+            } else if (BSON_ITER_IS_KEY(&shard_iter, "host") && BSON_ITER_HOLDS_UTF8(&shard_iter)) {
+               host = bson_iter_utf8(&shard_iter, NULL);
+            }
+         }
+      }
+
+      if (!name || !host) {
+         _mongoc_set_error(
+            error, MONGOC_ERROR_PROTOCOL, MONGOC_ERROR_PROTOCOL_INVALID_REPLY, "Invalid shard in listShards reply");
+         goto fail;
+      }
+
+      stream->shards[i].name = bson_strdup(name);
+      if (!_open_shard(client, &stream->shards[i++], host, pipeline, opts, error)) {
+         goto fail;
+      }
+   }
+
+   bson_destroy(&reply);
+   return stream;
+
+fail:
+   bson_destroy(&reply);
+   mongoc_sharded_change_stream_destroy(stream);
+   return NULL;
+}
+
+
+void
+mongoc_sharded_change_stream_destroy(mongoc_sharded_change_stream_t *stream)
+{
+   if (!stream) {
+      return;
+   }
+
+   for (size_t i = 0; i < stream->n_shards; i++) {
+      mongoc_change_stream_destroy(stream->shards[i].stream);
+      mongoc_client_destroy(stream->shards[i].client);
+      bson_free(stream->shards[i].name);
+   }
+
+   bson_mutex_destroy(&stream->mutex);
+   bson_free(stream->shards);
+   bson_free(stream);
+}
+
+
+size_t
+mongoc_sharded_change_stream_num_shards(const mongoc_sharded_change_stream_t *stream)
+{
+   BSON_ASSERT_PARAM(stream);
+
+   return stream->n_shards;
+}
+
+
+const char *
+mongoc_sharded_change_stream_get_shard_name(const mongoc_sharded_change_stream_t *stream, size_t shard)
+{
+   BSON_ASSERT_PARAM(stream);
+   BSON_ASSERT(shard < stream->n_shards);
+
+   return stream->shards[shard].name;
+}
+
+
+mongoc_change_stream_t *
+mongoc_sharded_change_stream_get_stream(mongoc_sharded_change_stream_t *stream, size_t shard)
+{
+   BSON_ASSERT_PARAM(stream);
+   BSON_ASSERT(shard < stream->n_shards);
+
+   return stream->shards[shard].stream;
+}
+
+
+bool
+mongoc_sharded_change_stream_ack(mongoc_sharded_change_stream_t *stream,
+                                 size_t shard,
+                                 const bson_t *event,
+                                 bson_error_t *error)
+{
+   mongoc_timestamp_t ts;
+   bson_iter_t iter;
+
+   BSON_ASSERT_PARAM(stream);
+   BSON_OPTIONAL_PARAM(event);
+   BSON_ASSERT(shard < stream->n_shards);
+
+   if (event) {
+      if (!bson_iter_init_find(&iter, event, "clusterTime") || !BSON_ITER_HOLDS_TIMESTAMP(&iter)) {
+         _mongoc_set_error(
+            error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Change event has no \"clusterTime\"");
+         return false;
+      }
+
+      _mongoc_timestamp_set_from_bson(&ts, &iter);
+   } else if (!_timestamp_from_resume_token(mongoc_change_stream_get_resume_token(stream->shards[shard].stream), &ts)) {
+      // An idle shard whose resume token cannot be decoded keeps its current watermark.
+      return true;
+   }
+
+   bson_mutex_lock(&stream->mutex);
+   _advance_watermark(&stream->shards[shard], &ts);
+   bson_mutex_unlock(&stream->mutex);
+
+   return true;
+}
+
+
+bool
+mongoc_sharded_change_stream_get_low_watermark(mongoc_sharded_change_stream_t *stream,
+                                               uint32_t *timestamp,
+                                               uint32_t *increment)
+{
+   mongoc_timestamp_t low = {0};
+   bool ret;
+
+   BSON_ASSERT_PARAM(stream);
+   BSON_ASSERT_PARAM(timestamp);
+   BSON_ASSERT_PARAM(increment);
+
+   ret = stream->n_shards > 0;
+
+   bson_mutex_lock(&stream->mutex);
+   for (size_t i = 0; ret && i < stream->n_shards; i++) {
+      const shard_t *shard = &stream->shards[i];
+
+      if (!shard->has_watermark) {
+         ret = false;
+      } else if (i == 0 || _timestamp_cmp(&shard->watermark, &low) < 0) {
+         low = shard->watermark;
+      }
+   }
+   bson_mutex_unlock(&stream->mutex);
+
+   if (ret) {
+      *timestamp = low.timestamp;
+      *increment = low.increment;
+   }
+
+   return ret;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2009-present MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mongoc/mongoc-prelude.h>
+
+#ifndef MONGOC_SHARDED_CHANGE_STREAM_H
+#define MONGOC_SHARDED_CHANGE_STREAM_H
+
+#include <mongoc/mongoc-change-stream.h>
+#include <mongoc/mongoc-client.h>
+#include <mongoc/mongoc-macros.h>
+
+#include <bson/bson.h>
+
+BSON_BEGIN_DECLS
+
+typedef struct _mongoc_sharded_change_stream_t mongoc_sharded_change_stream_t;
+
+MONGOC_EXPORT(mongoc_sharded_change_stream_t *)
+mongoc_client_watch_shards(mongoc_client_t *client, const bson_t *pipeline, const bson_t *opts, bson_error_t *error)
+   BSON_GNUC_WARN_UNUSED_RESULT;
+
+MONGOC_EXPORT(void)
+mongoc_sharded_change_stream_destroy(mongoc_sharded_change_stream_t *stream);
+
+MONGOC_EXPORT(size_t)
+mongoc_sharded_change_stream_num_shards(const mongoc_sharded_change_stream_t *stream);
+
+MONGOC_EXPORT(const char *)
+mongoc_sharded_change_stream_get_shard_name(const mongoc_sharded_change_stream_t *stream, size_t shard);
+
+MONGOC_EXPORT(mongoc_change_stream_t *)
+mongoc_sharded_change_stream_get_stream(mongoc_sharded_change_stream_t *stream, size_t shard);
+
+MONGOC_EXPORT(bool)
+mongoc_sharded_change_stream_ack(mongoc_sharded_change_stream_t *stream,
+                                 size_t shard,
+                                 const bson_t *event,
+                                 bson_error_t *error);
+
+MONGOC_EXPORT(bool)
+mongoc_sharded_change_stream_get_low_watermark(mongoc_sharded_change_stream_t *stream,
+                                               uint32_t *timestamp,
+                                               uint32_t *increment);
+
+BSON_END_DECLS
+
+#endif /* MONGOC_SHARDED_CHANGE_STREAM_H */
@@ -68,6 +68,9 @@ mongoc_uri_canonicalize_option(const char *key);
 mongoc_uri_t *
 _mongoc_uri_copy_and_replace_host_list(const mongoc_uri_t *original, const char *host);
 
+mongoc_uri_t *
+_mongoc_uri_copy_for_shard(const mongoc_uri_t *original, const char *shard_host, bson_error_t *error);
+
 bool
 mongoc_uri_init_with_srv_host_list(mongoc_uri_t *uri, mongoc_host_list_t *hosts, bson_error_t *error);
 
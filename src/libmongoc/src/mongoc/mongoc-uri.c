@@ -3441,6 +3441,80 @@ _mongoc_uri_copy_and_replace_host_list(const mongoc_uri_t *original, const char
    return uri;
 }
 
+/* Create a URI with the same auth, TLS, and compressor settings as @original
+ * that connects to a shard. @shard_host is the "host" field of a listShards
+ * entry, like "rs0/a:27018,b:27018" or "a:27018". */
+mongoc_uri_t *
+_mongoc_uri_copy_for_shard(const mongoc_uri_t *original, const char *shard_host, bson_error_t *error)
+{
+   BSON_ASSERT_PARAM(original);
+   BSON_ASSERT_PARAM(shard_host);
+
+   mongoc_uri_t *uri = mongoc_uri_copy(original);
+   const char *hosts = shard_host;
+   const char *slash = strchr(shard_host, '/');
+   char *set_name = NULL;
+   bool ok = false;
+
+   _mongoc_host_list_destroy_all(uri->hosts);
+   uri->hosts = NULL;
+   uri->is_srv = false;
+   uri->srv[0] = '\0';
+
+   /* these describe how to reach the mongos, not the shard. */
+   {
+      bson_t options = BSON_INITIALIZER;
+      bson_copy_to_excluding_noinit(&uri->options,
+                                    &options,
+                                    MONGOC_URI_LOADBALANCED,
+                                    MONGOC_URI_DIRECTCONNECTION,
+                                    MONGOC_URI_REPLICASET,
+                                    MONGOC_URI_SRVSERVICENAME,
+                                    MONGOC_URI_SRVMAXHOSTS,
+                                    NULL);
+      bson_destroy(&uri->options);
+      bson_steal(&uri->options, &options);
+   }
+
+   if (slash) {
+      set_name = bson_strndup(shard_host, (size_t)(slash - shard_host));
+      hosts = slash + 1;
+      if (!mongoc_uri_set_option_as_utf8(uri, MONGOC_URI_REPLICASET, set_name)) {
+         MONGOC_URI_ERROR(error, "Invalid shard host: \"%s\"", shard_host);
+         goto done;
+      }
+   }
+
+   while (*hosts) {
+      const char *comma = strchr(hosts, ',');
+      const size_t len = comma ? (size_t)(comma - hosts) : strlen(hosts);
+      char *host_and_port = bson_strndup(hosts, len);
+      const bool upserted = len > 0u && mongoc_uri_upsert_host_and_port(uri, host_and_port, error);
+
+      bson_free(host_and_port);
+      if (!upserted) {
+         MONGOC_URI_ERROR(error, "Invalid shard host: \"%s\"", shard_host);
+         goto done;
+      }
+      hosts += comma ? len + 1u : len;
+   }
+
+   if (!uri->hosts) {
+      MONGOC_URI_ERROR(error, "Invalid shard host: \"%s\"", shard_host);
+      goto done;
+   }
+
+   ok = true;
+
+done:
+   bson_free(set_name);
+   if (!ok) {
+      mongoc_uri_destroy(uri);
+      return NULL;
+   }
+   return uri;
+}
+
 bool
 mongoc_uri_init_with_srv_host_list(mongoc_uri_t *uri, mongoc_host_list_t *host_list, bson_error_t *error)
 {
@@ -19,6 +19,7 @@
 #ifndef MONGOC_WRITE_COMMAND_PRIVATE_H
 #define MONGOC_WRITE_COMMAND_PRIVATE_H
 
+#include <mongoc/mongoc-array-private.h>
 #include <mongoc/mongoc-buffer-private.h>
 #include <mongoc/mongoc-server-stream-private.h>
 
@@ -61,6 +62,13 @@ typedef struct {
    mongoc_bulk_write_flags_t flags;
    int64_t operation_id;
    bson_t *cmd_opts;
+   /* Unordered, acknowledged writes send up to this many batches before
+    * reading their replies. 0 or 1 waits for each reply. */
+   uint32_t max_in_flight_batches;
+   /* If not empty, the uint32_t index in the bulk write of each document, for
+    * commands whose documents were regrouped. Results are reported with these
+    * indexes, and the command is executed with an offset of 0. */
+   mongoc_array_t indexes;
 } mongoc_write_command_t;
 
 
@@ -123,6 +131,13 @@ _mongoc_write_command_init_insert_idl(mongoc_write_command_t *command,
                                       const bson_t *cmd_opts,
                                       int64_t operation_id);
 void
+_mongoc_write_command_init_insert_borrowed(mongoc_write_command_t *command,
+                                           const uint8_t *data,
+                                           uint32_t len,
+                                           uint32_t n_documents,
+                                           const bson_t *cmd_opts,
+                                           int64_t operation_id);
+void
 _mongoc_write_command_init_delete(mongoc_write_command_t *command,
                                   const bson_t *selectors,
                                   const bson_t *cmd_opts,
@@ -151,8 +166,14 @@ _mongoc_write_command_init_update_idl(mongoc_write_command_t *command,
                                       const bson_t *opts,
                                       int64_t operation_id);
 void
+_mongoc_write_command_init_empty_copy(mongoc_write_command_t *command, const mongoc_write_command_t *from);
+void
 _mongoc_write_command_insert_append(mongoc_write_command_t *command, const bson_t *document);
 void
+_mongoc_write_command_append_insert_document(mongoc_buffer_t *payload, const bson_t *document);
+void
+_mongoc_write_command_append_raw(mongoc_write_command_t *command, const bson_t *document, uint32_t index);
+void
 _mongoc_write_command_update_append(mongoc_write_command_t *command,
                                     const bson_t *selector,
                                     const bson_t *update,
@@ -195,6 +216,8 @@ _mongoc_write_result_complete(mongoc_write_result_t *result,
                               ...);
 void
 _mongoc_write_result_destroy(mongoc_write_result_t *result);
+void
+_mongoc_write_result_append(mongoc_write_result_t *result, const mongoc_write_result_t *other);
 
 mongoc_write_err_type_t
 _mongoc_write_error_get_type(bson_t *reply);
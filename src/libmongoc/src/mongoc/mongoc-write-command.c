@@ -41,10 +41,6 @@ static const uint32_t gCommandFieldLens[] = {7, 9, 7};
 void
 _mongoc_write_command_insert_append(mongoc_write_command_t *command, const bson_t *document)
 {
-   bson_iter_t iter;
-   bson_oid_t oid;
-   bson_t tmp;
-
    ENTRY;
 
    BSON_ASSERT(command);
@@ -52,6 +48,25 @@ _mongoc_write_command_insert_append(mongoc_write_command_t *command, const bson_
    BSON_ASSERT(document);
    BSON_ASSERT(document->len >= 5);
 
+   _mongoc_write_command_append_insert_document(&command->payload, document);
+   command->n_documents++;
+
+   EXIT;
+}
+
+/* Appends `document` to the insert payload `payload`. A document without an
+ * "_id" is prefixed with a new ObjectId, so that a retry does not insert the
+ * document again with another "_id". */
+void
+_mongoc_write_command_append_insert_document(mongoc_buffer_t *payload, const bson_t *document)
+{
+   bson_iter_t iter;
+   bson_oid_t oid;
+   bson_t tmp;
+
+   BSON_ASSERT_PARAM(payload);
+   BSON_ASSERT_PARAM(document);
+
    /*
     * If the document does not contain an "_id" field, we need to generate
     * a new oid for "_id".
@@ -61,15 +76,11 @@ _mongoc_write_command_insert_append(mongoc_write_command_t *command, const bson_
       bson_oid_init(&oid, NULL);
       BSON_APPEND_OID(&tmp, "_id", &oid);
       bson_concat(&tmp, document);
-      _mongoc_buffer_append(&command->payload, bson_get_data(&tmp), tmp.len);
+      _mongoc_buffer_append(payload, bson_get_data(&tmp), tmp.len);
       bson_destroy(&tmp);
    } else {
-      _mongoc_buffer_append(&command->payload, bson_get_data(document), document->len);
+      _mongoc_buffer_append(payload, bson_get_data(document), document->len);
    }
-
-   command->n_documents++;
-
-   EXIT;
 }
 
 void
@@ -151,6 +162,8 @@ _mongoc_write_command_init_bulk(
 
    _mongoc_buffer_init(&command->payload, NULL, 0, NULL, NULL);
    command->n_documents = 0;
+   command->max_in_flight_batches = 0;
+   _mongoc_array_init(&command->indexes, sizeof(uint32_t));
 
    EXIT;
 }
@@ -249,6 +262,71 @@ _mongoc_write_command_init_insert_idl(mongoc_write_command_t *command,
 }
 
 
+// `_mongoc_write_command_init_insert_borrowed` uses `len` bytes of concatenated documents at `data` as the payload,
+// without copying them. `data` must outlive `command`, and no documents may be appended.
+void
+_mongoc_write_command_init_insert_borrowed(mongoc_write_command_t *command,
+                                           const uint8_t *data,
+                                           uint32_t len,
+                                           uint32_t n_documents,
+                                           const bson_t *cmd_opts,
+                                           int64_t operation_id)
+{
+   mongoc_bulk_write_flags_t flags = MONGOC_BULK_WRITE_FLAGS_INIT;
+
+   ENTRY;
+
+   BSON_ASSERT_PARAM(command);
+   BSON_ASSERT_PARAM(data);
+
+   _mongoc_write_command_init_bulk(command, MONGOC_WRITE_COMMAND_INSERT, flags, operation_id, cmd_opts);
+
+   // Without a realloc function, `_mongoc_buffer_destroy` leaves `data` to the caller.
+   _mongoc_buffer_destroy(&command->payload);
+   command->payload.data = (uint8_t *)data;
+   command->payload.datalen = len;
+   command->payload.len = len;
+   command->n_documents = n_documents;
+
+   EXIT;
+}
+
+
+/* Initializes `command` with no documents, to execute like `from`. */
+void
+_mongoc_write_command_init_empty_copy(mongoc_write_command_t *command, const mongoc_write_command_t *from)
+{
+   ENTRY;
+
+   BSON_ASSERT_PARAM(command);
+   BSON_ASSERT_PARAM(from);
+
+   _mongoc_write_command_init_bulk(command, from->type, from->flags, from->operation_id, from->cmd_opts);
+   command->max_in_flight_batches = from->max_in_flight_batches;
+
+   EXIT;
+}
+
+
+/* Appends an insert document, or an update or delete statement, taken from
+ * another command's payload. `index` is its index in the bulk write. */
+void
+_mongoc_write_command_append_raw(mongoc_write_command_t *command, const bson_t *document, uint32_t index)
+{
+   ENTRY;
+
+   BSON_ASSERT_PARAM(command);
+   BSON_ASSERT_PARAM(document);
+   BSON_ASSERT(command->indexes.len == command->n_documents);
+
+   _mongoc_buffer_append(&command->payload, bson_get_data(document), document->len);
+   _mongoc_array_append_val(&command->indexes, index);
+   command->n_documents++;
+
+   EXIT;
+}
+
+
 void
 _mongoc_write_command_init_delete(mongoc_write_command_t *command, /* IN */
                                   const bson_t *selector,          /* IN */
@@ -413,8 +491,21 @@ _empty_error(mongoc_write_command_t *command, bson_error_t *error)
 }
 
 
+/* Returns the index in the bulk write of the document at `offset` in `command`. */
 static int32_t
-_mongoc_write_result_merge_arrays(uint32_t offset,
+_mongoc_write_command_bulk_index(const mongoc_write_command_t *command, int64_t offset)
+{
+   if (command->indexes.len && offset >= 0 && (uint64_t)offset < command->indexes.len) {
+      return (int32_t)_mongoc_array_index(&command->indexes, uint32_t, offset);
+   }
+
+   return (int32_t)offset;
+}
+
+
+static int32_t
+_mongoc_write_result_merge_arrays(const mongoc_write_command_t *command,
+                                  uint32_t offset,
                                   mongoc_write_result_t *result, /* IN */
                                   bson_t *dest,                  /* IN */
                                   bson_iter_t *iter)             /* IN */
@@ -446,7 +537,7 @@ _mongoc_write_result_merge_arrays(uint32_t offset,
             bson_append_document_begin(dest, keyptr, len, &child);
             while (bson_iter_next(&citer)) {
                if (BSON_ITER_IS_KEY(&citer, "index")) {
-                  idx = bson_iter_int32(&citer) + offset;
+                  idx = _mongoc_write_command_bulk_index(command, (int64_t)bson_iter_int32(&citer) + offset);
                   BSON_APPEND_INT32(&child, "index", idx);
                } else {
                   value = bson_iter_value(&citer);
@@ -533,7 +624,8 @@ _mongoc_write_result_merge(mongoc_write_result_t *result,   /* IN */
 
                   if (bson_iter_recurse(&ar, &citer) && bson_iter_find(&citer, "_id")) {
                      value = bson_iter_value(&citer);
-                     _mongoc_write_result_append_upsert(result, offset + server_index, value);
+                     _mongoc_write_result_append_upsert(
+                        result, _mongoc_write_command_bulk_index(command, (int64_t)offset + server_index), value);
                      n_upserted++;
                   }
                }
@@ -558,7 +650,7 @@ _mongoc_write_result_merge(mongoc_write_result_t *result,   /* IN */
    }
 
    if (bson_iter_init_find(&iter, reply, "writeErrors") && BSON_ITER_HOLDS_ARRAY(&iter)) {
-      _mongoc_write_result_merge_arrays(offset, result, &result->writeErrors, &iter);
+      _mongoc_write_result_merge_arrays(command, offset, result, &result->writeErrors, &iter);
    }
 
    if (bson_iter_init_find(&iter, reply, "writeConcernError") && BSON_ITER_HOLDS_DOCUMENT(&iter)) {
@@ -605,6 +697,221 @@ _mongoc_write_result_merge(mongoc_write_result_t *result,   /* IN */
 }
 
 
+typedef struct {
+   int32_t max_msg_size;
+   int32_t max_bson_obj_size;
+   int32_t max_document_count;
+   // Size of the OP_MSG excluding the documents of the batch.
+   uint32_t opmsg_overhead;
+} _opmsg_limits_t;
+
+
+/* Splits the batch of documents starting at `payload_offset`: as many as fit in
+ * a message, but at least one. Returns false and sets `too_large_len` if a
+ * document of the batch exceeds the maximum document size. */
+static bool
+_mongoc_write_opmsg_split_batch(const mongoc_write_command_t *command,
+                                uint32_t payload_offset,
+                                const _opmsg_limits_t *limits,
+                                uint32_t *payload_batch_size,
+                                int *document_count,
+                                int32_t *too_large_len)
+{
+   *payload_batch_size = 0;
+   *document_count = 0;
+
+   do {
+      const int32_t len = mlib_read_i32le(command->payload.data + payload_offset + *payload_batch_size);
+
+      // Although messageLength is an int32, it should never be negative.
+      BSON_ASSERT(len >= 0);
+
+      if (len > limits->max_bson_obj_size + BSON_OBJECT_ALLOWANCE) {
+         *too_large_len = len;
+         return false;
+      }
+
+      if (mlib_cmp(*payload_batch_size + limits->opmsg_overhead + len, >, limits->max_msg_size) &&
+          *document_count > 0) {
+         /* This document starts the next batch */
+         break;
+      }
+
+      *payload_batch_size += len;
+
+      /* If this document filled the maximum document count */
+      if (++*document_count == limits->max_document_count) {
+         break;
+      }
+      /* While we have more documents to write */
+   } while (payload_offset + *payload_batch_size < command->payload.len);
+
+   return true;
+}
+
+
+typedef struct {
+   uint32_t payload_offset;
+   uint32_t payload_batch_size;
+   // The index of the first document of the batch in the write.
+   uint32_t index_offset;
+   mongoc_cluster_pipelined_t pipelined;
+   bool sent;
+   bool ok;
+   bson_t reply;
+   bson_error_t error;
+} _opmsg_batch_t;
+
+
+static void
+_mongoc_write_opmsg_set_batch(mongoc_write_command_t *command,
+                              mongoc_cmd_parts_t *parts,
+                              const _opmsg_batch_t *batch)
+{
+   parts->assembled.payloads_count = 1;
+   mongoc_cmd_payload_t *const payload = &parts->assembled.payloads[0];
+   payload->documents = command->payload.data + batch->payload_offset;
+   payload->size = batch->payload_batch_size;
+   payload->identifier = gCommandFields[command->type];
+}
+
+
+/* The server does not read the next command while a reply is not read, so the
+ * replies of pipelined batches must fit in the socket buffers. Bounds the
+ * expected size of the replies of the batches in flight. */
+#define MONGOC_WRITE_PIPELINED_REPLY_BUDGET (64u * 1024u)
+
+/* The size of an entry of "writeErrors", excluding what its message quotes of
+ * the document (e.g. the key of a duplicate key error). */
+#define MONGOC_WRITE_ERROR_REPLY_SIZE 256u
+
+/* Bounds the size of the reply to a batch of `document_count` documents,
+ * `batch_size` bytes in total: a fixed envelope, plus a write error for each
+ * document, which may quote the document in its message and "keyValue". An
+ * unordered batch may fail entirely, e.g. an import of duplicate _ids. Each
+ * update may also have an "upserted" entry. */
+static uint32_t
+_mongoc_write_opmsg_expected_reply_size(const mongoc_write_command_t *command,
+                                        int document_count,
+                                        uint32_t batch_size)
+{
+   const uint32_t per_document =
+      MONGOC_WRITE_ERROR_REPLY_SIZE + (command->type == MONGOC_WRITE_COMMAND_UPDATE ? 64u : 0u);
+
+   return 1024u + (uint32_t)document_count * per_document + 2u * batch_size;
+}
+
+
+/* Like the loop in _mongoc_write_opmsg, but sends up to
+ * `command->max_in_flight_batches` batches before reading their replies. Only
+ * for unordered, acknowledged writes that are not retryable: a batch is never
+ * sent again, so no batch needs a txnNumber older than a later batch's.
+ * Returns true if all batches succeeded. */
+static bool
+_mongoc_write_opmsg_pipelined(mongoc_write_command_t *command,
+                              mongoc_client_t *client,
+                              mongoc_cmd_parts_t *parts,
+                              const _opmsg_limits_t *limits,
+                              uint32_t index_offset,
+                              mongoc_write_result_t *result,
+                              bson_error_t *error)
+{
+   mongoc_cluster_t *const cluster = &client->cluster;
+   mongoc_cmd_t *const cmd = &parts->assembled;
+   const uint32_t max_batches = command->max_in_flight_batches;
+   _opmsg_batch_t *const batches = bson_malloc(sizeof(_opmsg_batch_t) * max_batches);
+   uint32_t payload_total_offset = 0;
+   bool ret = true;
+
+   BSON_ASSERT(!command->flags.ordered);
+   BSON_ASSERT(cmd->is_acknowledged);
+   BSON_ASSERT(!parts->is_retryable_write);
+
+   while (payload_total_offset < command->payload.len && !result->must_stop) {
+      uint32_t n_batches = 0;
+      uint32_t reply_size = 0;
+      int32_t too_large_len = 0;
+      int document_count;
+
+      while (n_batches < max_batches && payload_total_offset < command->payload.len) {
+         _opmsg_batch_t *const batch = &batches[n_batches];
+
+         *batch = (_opmsg_batch_t){.payload_offset = payload_total_offset, .index_offset = index_offset};
+         if (!_mongoc_write_opmsg_split_batch(
+                command, payload_total_offset, limits, &batch->payload_batch_size, &document_count, &too_large_len)) {
+            break;
+         }
+
+         reply_size += _mongoc_write_opmsg_expected_reply_size(command, document_count, batch->payload_batch_size);
+         if (n_batches > 0 && reply_size > MONGOC_WRITE_PIPELINED_REPLY_BUDGET) {
+            // Leave the batch to the next round.
+            break;
+         }
+
+         bson_init(&batch->reply);
+         payload_total_offset += batch->payload_batch_size;
+         index_offset += (uint32_t)document_count;
+         n_batches++;
+      }
+
+      for (uint32_t i = 0; i < n_batches; i++) {
+         _opmsg_batch_t *const batch = &batches[i];
+
+         _mongoc_write_opmsg_set_batch(command, parts, batch);
+         bson_destroy(&batch->reply);
+         batch->sent = mongoc_cluster_send_pipelined(cluster, cmd, &batch->pipelined, &batch->reply, &batch->error);
+         if (!batch->sent) {
+            // Like a network error of a batch that is not pipelined.
+            result->must_stop = true;
+            break;
+         }
+      }
+
+      // Replies arrive in the order the batches were sent.
+      for (uint32_t i = 0; i < n_batches && batches[i].sent; i++) {
+         _opmsg_batch_t *const batch = &batches[i];
+
+         bson_destroy(&batch->reply);
+         batch->ok = mongoc_cluster_recv_pipelined(cluster, cmd, &batch->pipelined, &batch->reply, &batch->error);
+      }
+
+      for (uint32_t i = 0; i < n_batches; i++) {
+         _opmsg_batch_t *const batch = &batches[i];
+
+         if (!batch->ok) {
+            result->failed = true;
+            ret = false;
+            if (!mongoc_cluster_stream_valid(cluster, cmd->server_stream)) {
+               result->must_stop = true;
+            }
+         }
+
+         // A batch after one that failed to send has no reply or error of its own.
+         if (batch->sent || batch->error.code != 0) {
+            if (!batch->ok) {
+               memcpy(error, &batch->error, sizeof *error);
+            }
+            _mongoc_write_result_merge(result, command, &batch->reply, batch->index_offset);
+         }
+         bson_destroy(&batch->reply);
+      }
+
+      if (too_large_len) {
+         /* Quit if the document is too large */
+         _mongoc_write_command_too_large_error(
+            error, _mongoc_write_command_bulk_index(command, index_offset), too_large_len, limits->max_bson_obj_size);
+         result->failed = true;
+         ret = false;
+         break;
+      }
+   }
+
+   bson_free(batches);
+
+   return ret;
+}
+
+
 static void
 _mongoc_write_opmsg(mongoc_write_command_t *command,
                     mongoc_client_t *client,
@@ -627,7 +934,6 @@ _mongoc_write_opmsg(mongoc_write_command_t *command,
    int32_t max_document_count;
    uint32_t payload_batch_size = 0;
    uint32_t payload_total_offset = 0;
-   bool ship_it = false;
    int document_count = 0;
    mongoc_server_stream_t *retry_server_stream = NULL;
 
@@ -694,36 +1000,29 @@ _mongoc_write_opmsg(mongoc_write_command_t *command,
       // OP_MSG.Section[1].payload.documents is omitted. Calculated below with remaining size.
    }
 
-   do {
-      const int32_t len = mlib_read_i32le(command->payload.data + payload_batch_size + payload_total_offset);
+   const _opmsg_limits_t limits = {.max_msg_size = max_msg_size,
+                                   .max_bson_obj_size = max_bson_obj_size,
+                                   .max_document_count = max_document_count,
+                                   .opmsg_overhead = opmsg_overhead};
 
-      // Although messageLength is an int32, it should never be negative.
-      BSON_ASSERT(len >= 0);
-
-      if (len > max_bson_obj_size + BSON_OBJECT_ALLOWANCE) {
-         /* Quit if the document is too large */
-         _mongoc_write_command_too_large_error(error, index_offset, len, max_bson_obj_size);
-         result->failed = true;
-         break;
-
-      } else if (mlib_cmp(payload_batch_size + opmsg_overhead + len, <=, max_msg_size) || document_count == 0) {
-         /* The current batch is still under max batch size in bytes */
-         payload_batch_size += len;
-
-         /* If this document filled the maximum document count */
-         if (++document_count == max_document_count) {
-            ship_it = true;
-            /* If this document is the last document we have */
-         } else if (payload_batch_size + payload_total_offset == command->payload.len) {
-            ship_it = true;
-         } else {
-            ship_it = false;
+   /* A retryable write is sent one batch at a time, so that a retry uses the
+    * session's latest txnNumber. */
+   if (command->max_in_flight_batches > 1 && !command->flags.ordered && parts.assembled.is_acknowledged &&
+       !parts.is_retryable_write && !_mongoc_cse_is_enabled(client) && !_mongoc_client_session_in_txn(cs)) {
+      ret = _mongoc_write_opmsg_pipelined(command, client, &parts, &limits, index_offset, result, error);
+   } else {
+      do {
+         int32_t too_large_len;
+
+         if (!_mongoc_write_opmsg_split_batch(
+                command, payload_total_offset, &limits, &payload_batch_size, &document_count, &too_large_len)) {
+            /* Quit if the document is too large */
+            _mongoc_write_command_too_large_error(
+               error, _mongoc_write_command_bulk_index(command, index_offset), too_large_len, max_bson_obj_size);
+            result->failed = true;
+            break;
          }
-      } else {
-         ship_it = true;
-      }
 
-      if (ship_it) {
          parts.assembled.payloads_count = 1;
          mongoc_cmd_payload_t *const payload = &parts.assembled.payloads[0];
          /* Seek past the document offset we have already sent */
@@ -732,7 +1031,6 @@ _mongoc_write_opmsg(mongoc_write_command_t *command,
          payload->size = payload_batch_size;
          payload->identifier = gCommandFields[command->type];
 
-
          mongoc_server_stream_t *new_retry_server_stream = NULL;
          ret = mongoc_cluster_run_retryable_write(
             &client->cluster, &parts.assembled, parts.is_retryable_write, &new_retry_server_stream, &reply, error);
@@ -761,9 +1059,9 @@ _mongoc_write_opmsg(mongoc_write_command_t *command,
          index_offset += document_count;
          document_count = 0;
          bson_destroy(&reply);
-      }
-      /* While we have more documents to write */
-   } while (payload_total_offset < command->payload.len && !result->must_stop);
+         /* While we have more documents to write */
+      } while (payload_total_offset < command->payload.len && !result->must_stop);
+   }
 
    bson_destroy(&cmd);
    mongoc_cmd_parts_cleanup(&parts);
@@ -939,6 +1237,7 @@ _mongoc_write_command_destroy(mongoc_write_command_t *command)
    if (command) {
       bson_destroy(command->cmd_opts);
       _mongoc_buffer_destroy(&command->payload);
+      _mongoc_array_destroy(&command->indexes);
    }
 
    EXIT;
@@ -981,6 +1280,79 @@ _mongoc_write_result_destroy(mongoc_write_result_t *result)
 }
 
 
+/* Appends the documents of the array `src` to the array `dst`, which has `n` documents. */
+static void
+_mongoc_write_result_append_array(bson_t *dst, uint32_t n, const bson_t *src)
+{
+   bson_iter_t iter;
+   const char *key;
+   char str[16];
+
+   BSON_ASSERT(bson_iter_init(&iter, src));
+
+   while (bson_iter_next(&iter)) {
+      bson_uint32_to_string(n++, &key, str, sizeof str);
+      BSON_APPEND_VALUE(dst, key, bson_iter_value(&iter));
+   }
+}
+
+
+/*
+ *--------------------------------------------------------------------------
+ *
+ * _mongoc_write_result_append --
+ *
+ *       Adds the outcome of commands executed into their own result, like
+ *       if they were executed into `result` after its earlier commands.
+ *       Write errors and upserts in `other` have their index in the bulk
+ *       write already.
+ *
+ *--------------------------------------------------------------------------
+ */
+
+void
+_mongoc_write_result_append(mongoc_write_result_t *result, const mongoc_write_result_t *other)
+{
+   bson_iter_t iter;
+
+   ENTRY;
+
+   BSON_ASSERT_PARAM(result);
+   BSON_ASSERT_PARAM(other);
+
+   result->nInserted += other->nInserted;
+   result->nMatched += other->nMatched;
+   result->nModified += other->nModified;
+   result->nRemoved += other->nRemoved;
+   result->nUpserted += other->nUpserted;
+
+   _mongoc_write_result_append_array(&result->writeErrors, bson_count_keys(&result->writeErrors), &other->writeErrors);
+   _mongoc_write_result_append_array(&result->upserted, result->upsert_append_count, &other->upserted);
+   result->upsert_append_count += other->upsert_append_count;
+   _mongoc_write_result_append_array(
+      &result->writeConcernErrors, result->n_writeConcernErrors, &other->writeConcernErrors);
+   result->n_writeConcernErrors += other->n_writeConcernErrors;
+   _mongoc_write_result_append_array(&result->rawErrorReplies, result->n_errorReplies, &other->rawErrorReplies);
+   result->n_errorReplies += other->n_errorReplies;
+
+   BSON_ASSERT(bson_iter_init(&iter, &other->errorLabels));
+   while (bson_iter_next(&iter)) {
+      if (BSON_ITER_HOLDS_UTF8(&iter)) {
+         _mongoc_bson_array_add_label(&result->errorLabels, bson_iter_utf8(&iter, NULL));
+      }
+   }
+
+   result->failed |= other->failed;
+   result->must_stop |= other->must_stop;
+
+   if (other->error.code) {
+      memcpy(&result->error, &other->error, sizeof result->error);
+   }
+
+   EXIT;
+}
+
+
 /*
  * If error is not set, set code from first document in array like
  * [{"code": 64, "errmsg": "duplicate"}, ...]. Format the error message
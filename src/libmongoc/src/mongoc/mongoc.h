@@ -23,6 +23,7 @@
 
 #define MONGOC_INSIDE
 #include <mongoc/mongoc-apm.h>
+#include <mongoc/mongoc-bulk-inserter.h>
 #include <mongoc/mongoc-bulk-operation.h>
 #include <mongoc/mongoc-bulkwrite.h>
 #include <mongoc/mongoc-change-stream.h>
@@ -31,6 +32,7 @@
 #include <mongoc/mongoc-client-side-encryption.h>
 #include <mongoc/mongoc-client.h>
 #include <mongoc/mongoc-collection.h>
+#include <mongoc/mongoc-columns.h>
 #include <mongoc/mongoc-config.h>
 #include <mongoc/mongoc-cursor.h>
 #include <mongoc/mongoc-database.h>
@@ -47,6 +49,7 @@
 #include <mongoc/mongoc-log.h>
 #include <mongoc/mongoc-macros.h>
 #include <mongoc/mongoc-opcode.h>
+#include <mongoc/mongoc-sharded-change-stream.h>
 #include <mongoc/mongoc-sleep.h>
 #include <mongoc/mongoc-socket.h>
 #include <mongoc/mongoc-stream-buffered.h>
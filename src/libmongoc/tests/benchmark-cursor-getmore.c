@@ -0,0 +1,198 @@
+/*
+ * Used as a benchmark to measure the effect of reusing the reply buffer of a cursor across getMore batches. Iterates
+ * collections of documents of several sizes, with several batch sizes, and reports for each scenario the throughput in
+ * documents and megabytes per second and the peak RSS.
+ *
+ * TO BUILD: % cmake --build cmake-build --target benchmark-cursor-getmore
+ * TO RUN: % ./cmake-build/src/libmongoc/benchmark-cursor-getmore [URI] [iterations]
+ * The arguments are optional. By default, each scenario reads its collection 10 times from mongodb://localhost:27017.
+ *
+ * Each scenario runs in a child process, so that its peak RSS is not that of a previous scenario.
+ */
+
+#include <mongoc/mongoc.h>
+
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+typedef struct {
+   const char *name;
+   int num_docs;
+   size_t doc_size;
+   int32_t batch_size; // 0 for the server default.
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+   {"64 KiB docs, default batches", 2000, 64u * 1024u, 0},
+   {"64 KiB docs, batches of 50", 2000, 64u * 1024u, 50},
+   {"1 MiB docs, default batches", 200, 1024u * 1024u, 0},
+   {"1 KiB docs, default batches", 100000, 1024u, 0},
+};
+
+
+static long
+peak_rss_kb(void)
+{
+   struct rusage usage;
+
+   if (getrusage(RUSAGE_SELF, &usage) != 0) {
+      return -1;
+   }
+
+   // ru_maxrss is in kilobytes on Linux and in bytes on macOS.
+#ifdef __APPLE__
+   return usage.ru_maxrss / 1024;
+#else
+   return usage.ru_maxrss;
+#endif
+}
+
+
+static bool
+populate(mongoc_collection_t *coll, const scenario_t *scenario, bson_error_t *error)
+{
+   char *str = bson_malloc(scenario->doc_size + 1u);
+   memset(str, 'x', scenario->doc_size);
+   str[scenario->doc_size] = '\0';
+
+   bool ok = mongoc_collection_drop(coll, error) || strstr(error->message, "ns not found");
+
+   for (int i = 0; ok && i < scenario->num_docs; i++) {
+      bson_t doc = BSON_INITIALIZER;
+      BSON_APPEND_INT32(&doc, "_id", i);
+      BSON_APPEND_UTF8(&doc, "s", str);
+      ok = mongoc_collection_insert_one(coll, &doc, NULL, NULL, error);
+      bson_destroy(&doc);
+   }
+
+   bson_free(str);
+   return ok;
+}
+
+
+// Runs in a child process. Returns an exit code.
+static int
+run_scenario(const char *uri_str, const scenario_t *scenario, int iterations)
+{
+   bson_t filter = BSON_INITIALIZER;
+   bson_t opts = BSON_INITIALIZER;
+   mongoc_client_t *client = NULL;
+   mongoc_collection_t *coll = NULL;
+   bson_error_t error;
+   int64_t bytes = 0;
+   int64_t docs = 0;
+   int ret = EXIT_FAILURE;
+
+   mongoc_init();
+
+   client = mongoc_client_new(uri_str);
+   if (!client) {
+      fprintf(stderr, "Invalid URI: %s\n", uri_str);
+      goto done;
+   }
+   mongoc_client_set_error_api(client, MONGOC_ERROR_API_VERSION_2);
+
+   coll = mongoc_client_get_collection(client, "benchmark", "cursor_getmore");
+
+   if (!populate(coll, scenario, &error)) {
+      fprintf(stderr, "Failed to insert documents: %s\n", error.message);
+      goto done;
+   }
+
+   if (scenario->batch_size) {
+      BSON_APPEND_INT32(&opts, "batchSize", scenario->batch_size);
+   }
+
+   const long rss_before = peak_rss_kb();
+   const int64_t start = bson_get_monotonic_time();
+
+   for (int i = 0; i < iterations; i++) {
+      mongoc_cursor_t *cursor = mongoc_collection_find_with_opts(coll, &filter, &opts, NULL);
+      const bson_t *doc;
+
+      while (mongoc_cursor_next(cursor, &doc)) {
+         bytes += doc->len;
+         docs++;
+      }
+
+      if (mongoc_cursor_error(cursor, &error)) {
+         fprintf(stderr, "Cursor failure: %s\n", error.message);
+         mongoc_cursor_destroy(cursor);
+         goto done;
+      }
+
+      mongoc_cursor_destroy(cursor);
+   }
+
+   {
+      const double secs = (double)(bson_get_monotonic_time() - start) / 1e6;
+
+      printf("%-30s %12.0f %10.2f %14ld %14ld\n",
+             scenario->name,
+             (double)docs / secs,
+             (double)bytes / (1024.0 * 1024.0) / secs,
+             rss_before,
+             peak_rss_kb());
+      fflush(stdout);
+   }
+
+   ret = EXIT_SUCCESS;
+
+done:
+   if (coll) {
+      mongoc_collection_drop(coll, NULL);
+   }
+   mongoc_collection_destroy(coll);
+   mongoc_client_destroy(client);
+   bson_destroy(&opts);
+   bson_destroy(&filter);
+   mongoc_cleanup();
+   return ret;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+   const char *uri_str = "mongodb://localhost:27017";
+   int iterations = 10;
+   int ret = EXIT_SUCCESS;
+
+   if (argc > 1) {
+      uri_str = argv[1];
+   }
+   if (argc > 2) {
+      iterations = atoi(argv[2]);
+   }
+
+   printf("%-30s %12s %10s %14s %14s\n", "scenario", "docs/s", "MB/s", "RSS before KiB", "peak RSS KiB");
+   fflush(stdout);
+
+   for (size_t i = 0; i < sizeof scenarios / sizeof scenarios[0]; i++) {
+      const pid_t pid = fork();
+      int status;
+
+      if (pid < 0) {
+         perror("fork");
+         return EXIT_FAILURE;
+      }
+
+      if (pid == 0) {
+         _exit(run_scenario(uri_str, &scenarios[i], iterations));
+      }
+
+      if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+         fprintf(stderr, "Scenario \"%s\" failed\n", scenarios[i].name);
+         ret = EXIT_FAILURE;
+      }
+   }
+
+   return ret;
+}
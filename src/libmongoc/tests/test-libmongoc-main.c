@@ -27,6 +27,7 @@ main(int argc, char *argv[])
    } else                                      \
       ((void)0)
 
+   TEST_INSTALL(test_arena_install);
    TEST_INSTALL(test_bcon_basic_install);
    TEST_INSTALL(test_bcon_extract_install);
    TEST_INSTALL(test_bson_corpus_install);
@@ -38,10 +39,13 @@ main(int argc, char *argv[])
    TEST_INSTALL(test_clock_install);
    TEST_INSTALL(test_decimal128_install);
    TEST_INSTALL(test_endian_install);
+   TEST_INSTALL(test_index_install);
    TEST_INSTALL(test_iso8601_install);
    TEST_INSTALL(test_iter_install);
    TEST_INSTALL(test_json_install);
+   TEST_INSTALL(test_mem_cache_install);
    TEST_INSTALL(test_oid_install);
+   TEST_INSTALL(test_path_install);
    TEST_INSTALL(test_reader_install);
    TEST_INSTALL(test_string_install);
    TEST_INSTALL(test_utf8_install);
@@ -70,6 +74,7 @@ main(int argc, char *argv[])
    TEST_INSTALL(test_cluster_install);
    TEST_INSTALL(test_collection_install);
    TEST_INSTALL(test_collection_find_with_opts_install);
+   TEST_INSTALL(test_columns_install);
    TEST_INSTALL(test_connection_uri_install);
    TEST_INSTALL(test_command_logging_and_monitoring_install);
    TEST_INSTALL(test_command_monitoring_install);
@@ -110,6 +115,7 @@ main(int argc, char *argv[])
    TEST_INSTALL(test_server_selection_errors_install);
    TEST_INSTALL(test_session_install);
    TEST_INSTALL(test_set_install);
+   TEST_INSTALL(test_sharded_change_stream_install);
    TEST_INSTALL(test_speculative_auth_install);
    TEST_INSTALL(test_stream_install);
    TEST_INSTALL(test_thread_install);
@@ -161,6 +167,7 @@ main(int argc, char *argv[])
    TEST_INSTALL(test_service_gcp_install);
    TEST_INSTALL(test_mcd_nsinfo_install);
    TEST_INSTALL(test_bulkwrite_install);
+   TEST_INSTALL(test_bulk_inserter_install);
    TEST_INSTALL(test_mongoc_oidc_install);
    TEST_INSTALL(test_mongoc_oidc_callback_install);
    TEST_INSTALL(test_secure_channel_install);
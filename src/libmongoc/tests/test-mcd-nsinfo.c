@@ -86,10 +86,32 @@ test_nsinfo_calculates_bson_size(void)
    ASSERT_CMPUINT32(got, ==, expect->len);
 }
 
+static void
+test_nsinfo_interns(void)
+{
+   mcd_nsinfo_t *nsinfo = mcd_nsinfo_new();
+   bson_error_t error;
+   char ns[] = "db.coll1";
+
+   const char *interned = mcd_nsinfo_intern(nsinfo, ns, &error);
+   ASSERT_OR_PRINT(interned, error);
+   ASSERT(interned != ns);
+   ASSERT_CMPSTR(interned, "db.coll1");
+   ASSERT_CMPINT32(0, ==, mcd_nsinfo_find(nsinfo, "db.coll1"));
+
+   // Interning an equal string returns the stored copy.
+   ASSERT(interned == mcd_nsinfo_intern(nsinfo, "db.coll1", &error));
+   ASSERT_OR_PRINT(mcd_nsinfo_intern(nsinfo, "db.coll2", &error), error);
+   ASSERT_CMPINT32(1, ==, mcd_nsinfo_find(nsinfo, "db.coll2"));
+
+   mcd_nsinfo_destroy(nsinfo);
+}
+
 void
 test_mcd_nsinfo_install(TestSuite *suite)
 {
    TestSuite_Add(suite, "/nsinfo/works", test_nsinfo_works);
    TestSuite_Add(suite, "/nsinfo/handles_100k_namespaces", test_nsinfo_handles_100k_namespaces);
    TestSuite_Add(suite, "/nsinfo/calculates_bson_size", test_nsinfo_calculates_bson_size);
+   TestSuite_Add(suite, "/nsinfo/interns", test_nsinfo_interns);
 }
@@ -0,0 +1,202 @@
+#include <common-thread-private.h>
+#include <mongoc/mongoc-thread-private.h>
+
+#include <mongoc/mongoc.h>
+
+#include <mock_server/mock-server.h>
+#include <mock_server/request.h>
+
+#include <TestSuite.h>
+#include <test-conveniences.h>
+#include <test-libmongoc.h>
+
+
+typedef struct {
+   bson_mutex_t mutex;
+   int n_calls;
+   // `codes[i]` is the error code reported for the document with `doc_ctx` `i`, or 0 on success.
+   uint32_t codes[8];
+} results_t;
+
+
+static void
+_result_cb(void *doc_ctx, const bson_error_t *error, void *cb_ctx)
+{
+   results_t *const results = (results_t *)cb_ctx;
+   const size_t i = (size_t)(uintptr_t)doc_ctx;
+
+   bson_mutex_lock(&results->mutex);
+   results->n_calls++;
+   results->codes[i] = error ? error->code : 0u;
+   bson_mutex_unlock(&results->mutex);
+}
+
+
+// Documents are written once `maxDocuments` are pending, and each document gets its own outcome.
+static void
+test_bulk_inserter_max_documents(void)
+{
+   mock_server_t *const server = mock_server_with_auto_hello(WIRE_VERSION_8_0);
+   mock_server_auto_endsessions(server);
+   mock_server_run(server);
+
+   mongoc_client_pool_t *const pool = test_framework_client_pool_new_from_uri(mock_server_get_uri(server), NULL);
+   results_t results = {.n_calls = 0};
+   bson_error_t error;
+
+   bson_mutex_init(&results.mutex);
+
+   mongoc_bulk_inserter_t *const inserter =
+      mongoc_bulk_inserter_new(pool, "db.coll", tmp_bson("{'maxDocuments': 3, 'flushIntervalMS': 60000}"), &error);
+   ASSERT_OR_PRINT(inserter, error);
+   mongoc_bulk_inserter_set_result_cb(inserter, _result_cb, &results);
+
+   for (uintptr_t i = 0; i < 3; i++) {
+      ASSERT_OR_PRINT(mongoc_bulk_inserter_insert(inserter, tmp_bson("{'_id': %d}", (int)i), (void *)i, &error), error);
+   }
+
+   request_t *const request = mock_server_receives_msg(server,
+                                                       MONGOC_MSG_NONE,
+                                                       tmp_bson("{'bulkWrite': 1, 'ordered': false}"),
+                                                       tmp_bson("{'ns': 'db.coll'}"),
+                                                       tmp_bson("{'insert': 0, 'document': {'_id': 0}}"),
+                                                       tmp_bson("{'insert': 0, 'document': {'_id': 1}}"),
+                                                       tmp_bson("{'insert': 0, 'document': {'_id': 2}}"));
+   ASSERT(request);
+   reply_to_request_simple(request, BSON_STR({
+                              "ok" : 1,
+                              "nInserted" : 2,
+                              "nMatched" : 0,
+                              "nModified" : 0,
+                              "nDeleted" : 0,
+                              "nUpserted" : 0,
+                              "nErrors" : 1,
+                              "cursor" : {
+                                 "id" : 0,
+                                 "firstBatch" : [
+                                    {"ok" : 1, "idx" : 0, "n" : 1},
+                                    {"ok" : 0, "idx" : 1, "code" : 11000, "errmsg" : "duplicate key"},
+                                    {"ok" : 1, "idx" : 2, "n" : 1}
+                                 ],
+                                 "ns" : "admin.$cmd.bulkWrite"
+                              }
+                           }));
+
+   mongoc_bulk_inserter_flush(inserter);
+
+   bson_mutex_lock(&results.mutex);
+   ASSERT_CMPINT(results.n_calls, ==, 3);
+   ASSERT_CMPUINT32(results.codes[0], ==, 0u);
+   ASSERT_CMPUINT32(results.codes[1], ==, 11000u);
+   ASSERT_CMPUINT32(results.codes[2], ==, 0u);
+   bson_mutex_unlock(&results.mutex);
+
+   request_destroy(request);
+   mongoc_bulk_inserter_destroy(inserter);
+   bson_mutex_destroy(&results.mutex);
+   mongoc_client_pool_destroy(pool);
+   mock_server_destroy(server);
+}
+
+
+// A pending document is written once `flushIntervalMS` passed, without an explicit flush.
+static void
+test_bulk_inserter_flush_interval(void)
+{
+   mock_server_t *const server = mock_server_with_auto_hello(WIRE_VERSION_8_0);
+   mock_server_auto_endsessions(server);
+   mock_server_run(server);
+
+   mongoc_client_pool_t *const pool = test_framework_client_pool_new_from_uri(mock_server_get_uri(server), NULL);
+   results_t results = {.n_calls = 0};
+   bson_error_t error;
+
+   bson_mutex_init(&results.mutex);
+
+   mongoc_bulk_inserter_t *const inserter =
+      mongoc_bulk_inserter_new(pool, "db.coll", tmp_bson("{'flushIntervalMS': 10}"), &error);
+   ASSERT_OR_PRINT(inserter, error);
+   mongoc_bulk_inserter_set_result_cb(inserter, _result_cb, &results);
+
+   ASSERT_OR_PRINT(mongoc_bulk_inserter_insert(inserter, tmp_bson("{'_id': 0}"), (void *)(uintptr_t)0, &error), error);
+
+   request_t *const request = mock_server_receives_msg(server,
+                                                       MONGOC_MSG_NONE,
+                                                       tmp_bson("{'bulkWrite': 1}"),
+                                                       tmp_bson("{'ns': 'db.coll'}"),
+                                                       tmp_bson("{'insert': 0, 'document': {'_id': 0}}"));
+   ASSERT(request);
+   reply_to_request_simple(request, BSON_STR({
+                              "ok" : 1,
+                              "nInserted" : 1,
+                              "nMatched" : 0,
+                              "nModified" : 0,
+                              "nDeleted" : 0,
+                              "nUpserted" : 0,
+                              "nErrors" : 0,
+                              "cursor" : {
+                                 "id" : 0,
+                                 "firstBatch" : [ {"ok" : 1, "idx" : 0, "n" : 1} ],
+                                 "ns" : "admin.$cmd.bulkWrite"
+                              }
+                           }));
+
+   // Destroying the inserter waits for outstanding documents.
+   request_destroy(request);
+   mongoc_bulk_inserter_destroy(inserter);
+
+   ASSERT_CMPINT(results.n_calls, ==, 1);
+   ASSERT_CMPUINT32(results.codes[0], ==, 0u);
+
+   bson_mutex_destroy(&results.mutex);
+   mongoc_client_pool_destroy(pool);
+   mock_server_destroy(server);
+}
+
+
+static void
+test_bulk_inserter_invalid(void)
+{
+   mock_server_t *const server = mock_server_with_auto_hello(WIRE_VERSION_8_0);
+   mock_server_run(server);
+
+   mongoc_client_pool_t *const pool = test_framework_client_pool_new_from_uri(mock_server_get_uri(server), NULL);
+   bson_error_t error;
+
+   ASSERT(!mongoc_bulk_inserter_new(pool, "db.coll", tmp_bson("{'foo': 1}"), &error));
+   ASSERT_ERROR_CONTAINS(
+      error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Invalid bulk inserter option: \"foo\"");
+
+   ASSERT(!mongoc_bulk_inserter_new(pool, "db.coll", tmp_bson("{'maxDocuments': 0}"), &error));
+   ASSERT_ERROR_CONTAINS(error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "must be a positive number");
+
+   ASSERT(!mongoc_bulk_inserter_new(
+      pool, "db.coll", tmp_bson("{'flushIntervalMS': {'$numberLong': '9223372036854775807'}}"), &error));
+   ASSERT_ERROR_CONTAINS(error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "must be at most");
+
+   ASSERT(!mongoc_bulk_inserter_new(pool, "db", NULL, &error));
+   ASSERT_ERROR_CONTAINS(error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Invalid namespace");
+
+   // A document that can never fit in the buffer is rejected rather than blocking forever.
+   mongoc_bulk_inserter_t *const inserter =
+      mongoc_bulk_inserter_new(pool, "db.coll", tmp_bson("{'maxBufferedBytes': 8}"), &error);
+   ASSERT_OR_PRINT(inserter, error);
+   ASSERT(!mongoc_bulk_inserter_insert(inserter, tmp_bson("{'_id': 0}"), NULL, &error));
+   ASSERT_ERROR_CONTAINS(error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "exceeds maxBufferedBytes");
+
+   // Nothing to flush.
+   mongoc_bulk_inserter_flush(inserter);
+   mongoc_bulk_inserter_destroy(inserter);
+
+   mongoc_client_pool_destroy(pool);
+   mock_server_destroy(server);
+}
+
+
+void
+test_bulk_inserter_install(TestSuite *suite)
+{
+   TestSuite_AddMockServerTest(suite, "/bulk_inserter/max_documents", test_bulk_inserter_max_documents);
+   TestSuite_AddMockServerTest(suite, "/bulk_inserter/flush_interval", test_bulk_inserter_flush_interval);
+   TestSuite_AddMockServerTest(suite, "/bulk_inserter/invalid", test_bulk_inserter_invalid);
+}
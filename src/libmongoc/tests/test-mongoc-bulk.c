@@ -4852,6 +4852,197 @@ test_bulk_big_let(void *unused)
 }
 
 
+#define SHARDED_COLLECTION                                                                             \
+   "{'_id': 'db.coll', 'key': {'_id': 1}, 'lastmodEpoch': {'$oid': '000000000000000000000001'}," \
+   " 'timestamp': {'$timestamp': {'t': 1, 'i': 0}},"                                             \
+   " 'uuid': {'$binary': {'subType': '04', 'base64': 'AAAAAAAAAAAAAAAAAAAAAA=='}}}"
+
+
+static void
+_receives_config_find(mock_server_t *server, const char *coll, const char *filter, const char *docs)
+{
+   request_t *const request = mock_server_receives_msg(
+      server, MONGOC_MSG_NONE, tmp_bson("{'$db': 'config', 'find': '%s', 'filter': %s}", coll, filter));
+   ASSERT(request);
+   reply_to_request_simple(
+      request, tmp_str("{'ok': 1, 'cursor': {'id': 0, 'ns': 'config.%s', 'firstBatch': [%s]}}", coll, docs));
+   request_destroy(request);
+}
+
+
+static void
+_receives_write(mock_server_t *server, const char *cmd, const char *statements, const char *reply)
+{
+   request_t *const request =
+      mock_server_receives_msg(server, MONGOC_MSG_NONE, tmp_bson(cmd), tmp_bson("%s", statements));
+   ASSERT(request);
+   reply_to_request_simple(request, reply);
+   request_destroy(request);
+}
+
+
+// Statements are grouped by the shard owning their shard key, and results keep the indexes of the bulk write.
+static void
+test_bulk_group_by_shard(void)
+{
+   mock_server_t *const server = mock_mongos_new(WIRE_VERSION_MAX);
+   mock_server_auto_endsessions(server);
+   mock_server_run(server);
+
+   mongoc_client_t *const client = test_framework_client_new_from_uri(mock_server_get_uri(server), NULL);
+   mongoc_collection_t *const coll = mongoc_client_get_collection(client, "db", "coll");
+   mongoc_bulk_operation_t *bulk;
+   future_t *future;
+   bson_error_t error;
+   bson_t reply;
+   const char *const chunks = "{'min': {'_id': {'$minKey': 1}}, 'max': {'_id': 50}, 'shard': 'shard0',"
+                              " 'lastmod': {'$timestamp': {'t': 1, 'i': 0}}},"
+                              "{'min': {'_id': 50}, 'max': {'_id': {'$maxKey': 1}}, 'shard': 'shard1',"
+                              " 'lastmod': {'$timestamp': {'t': 1, 'i': 1}}}";
+
+   bulk = mongoc_collection_create_bulk_operation_with_opts(coll, tmp_bson("{'ordered': false}"));
+   mongoc_bulk_operation_set_group_by_shard(bulk, true);
+   mongoc_bulk_operation_insert(bulk, tmp_bson("{'_id': 1}"));
+   mongoc_bulk_operation_insert(bulk, tmp_bson("{'_id': 100}"));
+   mongoc_bulk_operation_insert(bulk, tmp_bson("{'_id': 2}"));
+   mongoc_bulk_operation_update_one(bulk, tmp_bson("{'_id': {'$eq': 101}}"), tmp_bson("{'$set': {'x': 1}}"), false);
+   mongoc_bulk_operation_remove_one(bulk, tmp_bson("{'x': 1}"));
+
+   future = future_bulk_operation_execute(bulk, &reply, &error);
+   _receives_config_find(server, "collections", "{'_id': 'db.coll'}", SHARDED_COLLECTION);
+   _receives_config_find(
+      server, "chunks", "{'uuid': {'$binary': {'subType': '04', 'base64': 'AAAAAAAAAAAAAAAAAAAAAA=='}}}", chunks);
+   {
+      request_t *const request = mock_server_receives_msg(server,
+                                                          MONGOC_MSG_NONE,
+                                                          tmp_bson("{'insert': 'coll', 'ordered': false}"),
+                                                          tmp_bson("{'_id': 1}"),
+                                                          tmp_bson("{'_id': 2}"));
+      ASSERT(request);
+      reply_to_request_simple(request, "{'ok': 1, 'n': 2}");
+      request_destroy(request);
+   }
+   _receives_write(server,
+                   "{'insert': 'coll'}",
+                   "{'_id': 100}",
+                   "{'ok': 1, 'n': 0, 'writeErrors': [{'index': 0, 'code': 11000, 'errmsg': 'duplicate key'}]}");
+   _receives_write(server, "{'update': 'coll'}", "{'q': {'_id': {'$eq': 101}}}", "{'ok': 1, 'n': 1, 'nModified': 1}");
+   _receives_write(server, "{'delete': 'coll'}", "{'q': {'x': 1}}", "{'ok': 1, 'n': 1}");
+
+   ASSERT(!future_get_uint32_t(future));
+   ASSERT_MATCH(&reply,
+                "{'nInserted': 2, 'nMatched': 1, 'nModified': 1, 'nRemoved': 1,"
+                " 'writeErrors': [{'index': 1, 'code': 11000}]}");
+   future_destroy(future);
+   bson_destroy(&reply);
+   mongoc_bulk_operation_destroy(bulk);
+
+   // The cached chunks are reused while the collection entry and the highest chunk version are unchanged.
+   bulk = mongoc_collection_create_bulk_operation_with_opts(coll, tmp_bson("{'ordered': false}"));
+   mongoc_bulk_operation_set_group_by_shard(bulk, true);
+   mongoc_bulk_operation_insert(bulk, tmp_bson("{'_id': 200}"));
+   mongoc_bulk_operation_insert(bulk, tmp_bson("{'_id': 3}"));
+
+   future = future_bulk_operation_execute(bulk, &reply, &error);
+   _receives_config_find(server, "collections", "{'_id': 'db.coll'}", SHARDED_COLLECTION);
+   {
+      request_t *const request = mock_server_receives_msg(
+         server,
+         MONGOC_MSG_NONE,
+         tmp_bson("{'$db': 'config', 'find': 'chunks', 'sort': {'lastmod': -1}, 'limit': {'$numberLong': '1'}}"));
+      ASSERT(request);
+      reply_to_request_simple(request,
+                              "{'ok': 1, 'cursor': {'id': 0, 'ns': 'config.chunks', 'firstBatch': ["
+                              "{'lastmod': {'$timestamp': {'t': 1, 'i': 1}}}]}}");
+      request_destroy(request);
+   }
+   _receives_write(server, "{'insert': 'coll'}", "{'_id': 3}", "{'ok': 1, 'n': 1}");
+   _receives_write(server, "{'insert': 'coll'}", "{'_id': 200}", "{'ok': 1, 'n': 1}");
+
+   ASSERT_OR_PRINT(future_get_uint32_t(future), error);
+   ASSERT_MATCH(&reply, "{'nInserted': 2}");
+   future_destroy(future);
+   bson_destroy(&reply);
+   mongoc_bulk_operation_destroy(bulk);
+
+   mongoc_collection_destroy(coll);
+   mongoc_client_destroy(client);
+   mock_server_destroy(server);
+}
+
+
+// Inserts, updates, and deletes run concurrently on clients from the pool, and results are merged in order.
+static void
+test_bulk_parallel_pool(void)
+{
+   mock_server_t *const server = mock_server_with_auto_hello(WIRE_VERSION_MAX);
+   mock_server_auto_endsessions(server);
+   mock_server_run(server);
+
+   mongoc_client_pool_t *const pool = test_framework_client_pool_new_from_uri(mock_server_get_uri(server), NULL);
+   mongoc_client_t *const client = mongoc_client_pool_pop(pool);
+   mongoc_collection_t *const coll = mongoc_client_get_collection(client, "db", "coll");
+   mongoc_bulk_operation_t *const bulk =
+      mongoc_collection_create_bulk_operation_with_opts(coll, tmp_bson("{'ordered': false}"));
+   request_t *requests[3] = {NULL};
+   request_t *request;
+   bson_error_t error;
+   bson_t reply;
+
+   mongoc_bulk_operation_set_parallel_pool(bulk, pool);
+   mongoc_bulk_operation_insert(bulk, tmp_bson("{'_id': 0}"));
+   mongoc_bulk_operation_update_one(bulk, tmp_bson("{'_id': 1}"), tmp_bson("{'$set': {'x': 1}}"), false);
+   mongoc_bulk_operation_remove_one(bulk, tmp_bson("{'_id': 2}"));
+   mongoc_bulk_operation_insert(bulk, tmp_bson("{'_id': 3}"));
+
+   future_t *const future = future_bulk_operation_execute(bulk, &reply, &error);
+
+   // The first insert, the update, and the delete are all sent before any reply.
+   for (int i = 0; i < 3; i++) {
+      request = mock_server_receives_request(server);
+      ASSERT(request);
+      if (0 == strcmp(request->command_name, "insert")) {
+         requests[0] = request;
+      } else if (0 == strcmp(request->command_name, "update")) {
+         requests[1] = request;
+      } else {
+         ASSERT_CMPSTR(request->command_name, "delete");
+         requests[2] = request;
+      }
+   }
+
+   ASSERT(requests[0] && requests[1] && requests[2]);
+   reply_to_request_simple(requests[2], "{'ok': 1, 'n': 1}");
+   reply_to_request_simple(requests[1],
+                           "{'ok': 1, 'n': 0, 'nModified': 0,"
+                           " 'writeErrors': [{'index': 0, 'code': 2, 'errmsg': 'bad update'}]}");
+   reply_to_request_simple(requests[0], "{'ok': 1, 'n': 1}");
+
+   // The second insert follows the first one on the same connection.
+   request = mock_server_receives_msg(server, MONGOC_MSG_NONE, tmp_bson("{'insert': 'coll'}"), tmp_bson("{'_id': 3}"));
+   ASSERT(request);
+   reply_to_request_simple(request,
+                           "{'ok': 1, 'n': 0, 'writeErrors': [{'index': 0, 'code': 11000, 'errmsg': 'duplicate'}]}");
+
+   ASSERT(!future_get_uint32_t(future));
+   ASSERT_MATCH(&reply,
+                "{'nInserted': 1, 'nMatched': 0, 'nRemoved': 1,"
+                " 'writeErrors': [{'index': 1, 'code': 2}, {'index': 3, 'code': 11000}]}");
+
+   for (int i = 0; i < 3; i++) {
+      request_destroy(requests[i]);
+   }
+   request_destroy(request);
+   future_destroy(future);
+   bson_destroy(&reply);
+   mongoc_bulk_operation_destroy(bulk);
+   mongoc_collection_destroy(coll);
+   mongoc_client_pool_push(pool, client);
+   mongoc_client_pool_destroy(pool);
+   mock_server_destroy(server);
+}
+
+
 void
 test_bulk_install(TestSuite *suite)
 {
@@ -4859,6 +5050,8 @@ test_bulk_install(TestSuite *suite)
    TestSuite_AddLive(suite, "/BulkOperation/opts", test_opts);
    TestSuite_AddMockServerTest(suite, "/BulkOperation/error", test_bulk_error);
    TestSuite_AddMockServerTest(suite, "/BulkOperation/error/unordered", test_bulk_error_unordered);
+   TestSuite_AddMockServerTest(suite, "/BulkOperation/group_by_shard", test_bulk_group_by_shard);
+   TestSuite_AddMockServerTest(suite, "/BulkOperation/parallel_pool", test_bulk_parallel_pool);
    TestSuite_AddLive(suite, "/BulkOperation/insert_ordered", test_insert_ordered);
    TestSuite_AddLive(suite, "/BulkOperation/insert_unordered", test_insert_unordered);
    TestSuite_AddLive(suite, "/BulkOperation/insert_check_keys", test_insert_check_keys);
@@ -903,6 +903,555 @@ test_bulkwrite_check_acknowledged(void *unused)
    mongoc_client_destroy(client);
 }
 
+// Test the ops written by `mongoc_bulkwrite_append_insertone`, with and without an `_id` in the document.
+static void
+test_bulkwrite_insertone_ops(void)
+{
+   mock_server_t *server = mock_server_with_auto_hello(WIRE_VERSION_8_0);
+   mock_server_run(server);
+   mongoc_client_t *client = mongoc_client_new_from_uri(mock_server_get_uri(server));
+   mongoc_bulkwrite_t *bw = mongoc_client_bulkwrite_new(client);
+
+   bson_error_t error;
+   ASSERT_OR_PRINT(mongoc_bulkwrite_append_insertone(bw, "db.coll1", tmp_bson("{'_id': 1, 'x': 1}"), NULL, &error),
+                   error);
+   ASSERT_OR_PRINT(mongoc_bulkwrite_append_insertone(bw, "db.coll2", tmp_bson("{'y': 2}"), NULL, &error), error);
+   ASSERT_OR_PRINT(mongoc_bulkwrite_append_insertone(bw, "db.coll1", tmp_bson("{}"), NULL, &error), error);
+
+   mongoc_bulkwriteopts_t *bwo = mongoc_bulkwriteopts_new();
+   mongoc_bulkwriteopts_set_verboseresults(bwo, true);
+
+   future_t *fut = future_bulkwrite_execute(bw, bwo);
+   request_t *req = mock_server_receives_msg(server,
+                                             MONGOC_MSG_NONE,
+                                             tmp_bson("{'bulkWrite': 1}"),
+                                             tmp_bson("{'ns': 'db.coll1'}"), // "nsInfo"
+                                             tmp_bson("{'ns': 'db.coll2'}"),
+                                             tmp_bson("{'insert': 0, 'document': {'_id': 1, 'x': 1}}"), // "ops"
+                                             tmp_bson("{'insert': 1, 'document': {'_id': {'$exists': true}, 'y': 2}}"),
+                                             tmp_bson("{'insert': 0, 'document': {'_id': {'$exists': true}}}"));
+
+   // The generated `_id` is the first field of the persisted document.
+   {
+      const bson_t *ops = request_get_doc(req, 4);
+      bson_iter_t iter;
+      ASSERT(ops);
+      ASSERT(bson_iter_init_find(&iter, ops, "document"));
+      ASSERT(bson_iter_recurse(&iter, &iter));
+      ASSERT(bson_iter_next(&iter));
+      ASSERT_CMPSTR(bson_iter_key(&iter), "_id");
+      ASSERT(BSON_ITER_HOLDS_OID(&iter));
+   }
+
+   reply_to_request_simple(req, BSON_STR({
+                              "ok" : 1,
+                              "nInserted" : 3,
+                              "nMatched" : 0,
+                              "nModified" : 0,
+                              "nDeleted" : 0,
+                              "nUpserted" : 0,
+                              "nErrors" : 0,
+                              "cursor" : {
+                                 "id" : 0,
+                                 "firstBatch" : [
+                                    {"ok" : 1, "idx" : 0, "n" : 1},
+                                    {"ok" : 1, "idx" : 1, "n" : 1},
+                                    {"ok" : 1, "idx" : 2, "n" : 1}
+                                 ],
+                                 "ns" : "admin.$cmd.bulkWrite"
+                              }
+                           }));
+   mongoc_bulkwritereturn_t bwr = future_get_mongoc_bulkwritereturn_t(fut);
+   ASSERT_NO_BULKWRITEEXCEPTION(bwr);
+
+   // The inserted IDs are read back from the ops.
+   ASSERT(bwr.res);
+   const bson_t *insertResults = mongoc_bulkwriteresult_insertresults(bwr.res);
+   ASSERT(insertResults);
+   ASSERT_MATCH(insertResults,
+                BSON_STR({
+                   "0" : {"insertedId" : 1},
+                   "1" : {"insertedId" : {"$$type" : "objectId"}},
+                   "2" : {"insertedId" : {"$$type" : "objectId"}}
+                }));
+
+   future_destroy(fut);
+   request_destroy(req);
+   mongoc_bulkwriteexception_destroy(bwr.exc);
+   mongoc_bulkwriteresult_destroy(bwr.res);
+   mongoc_bulkwriteopts_destroy(bwo);
+   mongoc_bulkwrite_destroy(bw);
+   mongoc_client_destroy(client);
+   mock_server_destroy(server);
+}
+
+// Test the ops written by the update, replace, and delete appends. The large replacement grows the ops buffer while the
+// op is written into it.
+static void
+test_bulkwrite_update_ops(void)
+{
+   mock_server_t *server = mock_server_with_auto_hello(WIRE_VERSION_8_0);
+   mock_server_run(server);
+   mongoc_client_t *client = mongoc_client_new_from_uri(mock_server_get_uri(server));
+   mongoc_bulkwrite_t *bw = mongoc_client_bulkwrite_new(client);
+
+   char *large = bson_malloc(4096);
+   memset(large, 'a', 4095);
+   large[4095] = '\0';
+   bson_t *replacement = BCON_NEW("x", BCON_UTF8(large));
+
+   bson_error_t error;
+   {
+      mongoc_bulkwrite_updateoneopts_t *opts = mongoc_bulkwrite_updateoneopts_new();
+      mongoc_bulkwrite_updateoneopts_set_arrayfilters(opts, tmp_bson("[{'e': 1}]"));
+      mongoc_bulkwrite_updateoneopts_set_upsert(opts, true);
+      ASSERT_OR_PRINT(mongoc_bulkwrite_append_updateone(
+                         bw, "db.coll1", tmp_bson("{'_id': 1}"), tmp_bson("{'$set': {'x': 1}}"), opts, &error),
+                      error);
+      mongoc_bulkwrite_updateoneopts_destroy(opts);
+   }
+   {
+      mongoc_bulkwrite_replaceoneopts_t *opts = mongoc_bulkwrite_replaceoneopts_new();
+      mongoc_bulkwrite_replaceoneopts_set_sort(opts, tmp_bson("{'_id': -1}"));
+      ASSERT_OR_PRINT(
+         mongoc_bulkwrite_append_replaceone(bw, "db.coll2", tmp_bson("{'_id': 2}"), replacement, opts, &error), error);
+      mongoc_bulkwrite_replaceoneopts_destroy(opts);
+   }
+   ASSERT_OR_PRINT(mongoc_bulkwrite_append_updatemany(
+                      bw, "db.coll1", tmp_bson("{}"), tmp_bson("[{'$set': {'y': 1}}]"), NULL, &error),
+                   error);
+   ASSERT_OR_PRINT(mongoc_bulkwrite_append_deleteone(bw, "db.coll2", tmp_bson("{'_id': 3}"), NULL, &error), error);
+   ASSERT_OR_PRINT(mongoc_bulkwrite_append_deletemany(bw, "db.coll1", tmp_bson("{'z': 1}"), NULL, &error), error);
+
+   // Validation errors do not leave a partial op behind.
+   ASSERT(!mongoc_bulkwrite_append_replaceone(
+      bw, "db.coll1", tmp_bson("{}"), tmp_bson("{'$set': {'x': 1}}"), NULL, &error));
+   ASSERT_ERROR_CONTAINS(
+      error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "replace prohibits $ operators");
+
+   future_t *fut = future_bulkwrite_execute(bw, NULL);
+   bson_t *expected_replace = BCON_NEW("update",
+                                       BCON_INT32(1),
+                                       "filter",
+                                       "{",
+                                       "_id",
+                                       BCON_INT32(2),
+                                       "}",
+                                       "updateMods",
+                                       BCON_DOCUMENT(replacement),
+                                       "multi",
+                                       BCON_BOOL(false),
+                                       "sort",
+                                       "{",
+                                       "_id",
+                                       BCON_INT32(-1),
+                                       "}");
+   request_t *req = mock_server_receives_msg(
+      server,
+      MONGOC_MSG_NONE,
+      tmp_bson("{'bulkWrite': 1}"),
+      tmp_bson("{'ns': 'db.coll1'}"), // "nsInfo"
+      tmp_bson("{'ns': 'db.coll2'}"),
+      tmp_bson("{'update': 0, 'filter': {'_id': 1}, 'updateMods': {'$set': {'x': 1}}, 'multi': false, "
+               "'arrayFilters': [{'e': 1}], 'upsert': true}"), // "ops"
+      expected_replace,
+      tmp_bson("{'update': 0, 'filter': {}, 'updateMods': [{'$set': {'y': 1}}], 'multi': true}"),
+      tmp_bson("{'delete': 1, 'filter': {'_id': 3}, 'multi': false}"),
+      tmp_bson("{'delete': 0, 'filter': {'z': 1}, 'multi': true}"));
+
+   // The pipeline is sent as an array.
+   {
+      const bson_t *op = request_get_doc(req, 5);
+      bson_iter_t iter;
+      ASSERT(op);
+      ASSERT(bson_iter_init_find(&iter, op, "updateMods"));
+      ASSERT(BSON_ITER_HOLDS_ARRAY(&iter));
+   }
+
+   reply_to_request_simple(req, BSON_STR({
+                              "ok" : 1,
+                              "nInserted" : 0,
+                              "nMatched" : 2,
+                              "nModified" : 2,
+                              "nDeleted" : 2,
+                              "nUpserted" : 0,
+                              "nErrors" : 0,
+                              "cursor" : {"id" : 0, "firstBatch" : [], "ns" : "admin.$cmd.bulkWrite"}
+                           }));
+   mongoc_bulkwritereturn_t bwr = future_get_mongoc_bulkwritereturn_t(fut);
+   ASSERT_NO_BULKWRITEEXCEPTION(bwr);
+
+   future_destroy(fut);
+   request_destroy(req);
+   mongoc_bulkwriteexception_destroy(bwr.exc);
+   mongoc_bulkwriteresult_destroy(bwr.res);
+   bson_destroy(expected_replace);
+   bson_destroy(replacement);
+   bson_free(large);
+   mongoc_bulkwrite_destroy(bw);
+   mongoc_client_destroy(client);
+   mock_server_destroy(server);
+}
+
+static mock_server_t *
+_pipelined_server_new(int max_write_batch_size)
+{
+   mock_server_t *server = mock_server_new();
+   mock_server_auto_endsessions(server);
+   // Retryable writes require sessions and a non-standalone server.
+   mock_server_auto_hello(server,
+                          "{'ok': 1, 'isWritablePrimary': true, 'msg': 'isdbgrid', 'minWireVersion': %d,"
+                          " 'maxWireVersion': %d, 'maxWriteBatchSize': %d, 'logicalSessionTimeoutMinutes': 30}",
+                          WIRE_VERSION_MIN,
+                          WIRE_VERSION_8_0,
+                          max_write_batch_size);
+   mock_server_run(server);
+   return server;
+}
+
+static mongoc_client_t *
+_pipelined_client_new(mock_server_t *server, bool retry_writes)
+{
+   mongoc_uri_t *uri = mongoc_uri_copy(mock_server_get_uri(server));
+   mongoc_uri_set_option_as_bool(uri, MONGOC_URI_RETRYWRITES, retry_writes);
+   mongoc_client_t *client = test_framework_client_new_from_uri(uri, NULL);
+   mongoc_uri_destroy(uri);
+   return client;
+}
+
+static void
+_pipelined_assert_no_request(mock_server_t *server)
+{
+   mock_server_set_request_timeout_msec(server, 100);
+   ASSERT(!mock_server_receives_request(server));
+   mock_server_set_request_timeout_msec(server, get_future_timeout_ms());
+}
+
+static const char *const pipelined_reply_fmt =
+   "{'ok': 1, 'nInserted': %d, 'nMatched': 0, 'nModified': 0, 'nDeleted': 0, 'nUpserted': 0,"
+   " 'nErrors': 0, 'cursor': {'id': 0, 'firstBatch': [%s], 'ns': 'admin.$cmd.bulkWrite'}}";
+
+static void
+test_bulkwrite_pipelined(void)
+{
+   mock_server_t *server = _pipelined_server_new(2);
+   mongoc_client_t *client = _pipelined_client_new(server, false);
+   mongoc_bulkwrite_t *bw = mongoc_client_bulkwrite_new(client);
+
+   bson_error_t error;
+   for (int i = 0; i < 5; i++) {
+      ASSERT_OR_PRINT(mongoc_bulkwrite_append_insertone(bw, "db.coll", tmp_bson("{'_id': %d}", i), NULL, &error),
+                      error);
+   }
+
+   mongoc_bulkwriteopts_t *bwo = mongoc_bulkwriteopts_new();
+   mongoc_bulkwriteopts_set_ordered(bwo, false);
+   mongoc_bulkwriteopts_set_maxinflightbatches(bwo, 3);
+
+   future_t *fut = future_bulkwrite_execute(bw, bwo);
+
+   // All three batches are sent before any reply is read. Writes are not retryable: no batch has a transaction number.
+   request_t *req1 = mock_server_receives_msg(server,
+                                              MONGOC_MSG_NONE,
+                                              tmp_bson("{'bulkWrite': 1, 'txnNumber': {'$exists': false}}"),
+                                              tmp_bson("{'ns': 'db.coll'}"),
+                                              tmp_bson("{'insert': 0, 'document': {'_id': 0}}"),
+                                              tmp_bson("{'insert': 0, 'document': {'_id': 1}}"));
+   request_t *req2 = mock_server_receives_msg(server,
+                                              MONGOC_MSG_NONE,
+                                              tmp_bson("{'bulkWrite': 1, 'txnNumber': {'$exists': false}}"),
+                                              tmp_bson("{'ns': 'db.coll'}"),
+                                              tmp_bson("{'insert': 0, 'document': {'_id': 2}}"),
+                                              tmp_bson("{'insert': 0, 'document': {'_id': 3}}"));
+   request_t *req3 = mock_server_receives_msg(server,
+                                              MONGOC_MSG_NONE,
+                                              tmp_bson("{'bulkWrite': 1, 'txnNumber': {'$exists': false}}"),
+                                              tmp_bson("{'ns': 'db.coll'}"),
+                                              tmp_bson("{'insert': 0, 'document': {'_id': 4}}"));
+
+   reply_to_request_simple(req1, tmp_str(pipelined_reply_fmt, 2, ""));
+   // The second batch fails. It is not retried, even with a retryable error.
+   reply_to_request_simple(
+      req2, "{'ok': 0, 'code': 6, 'errmsg': 'host unreachable', 'errorLabels': ['RetryableWriteError']}");
+   reply_to_request_simple(req3, tmp_str(pipelined_reply_fmt, 1, ""));
+
+   mongoc_bulkwritereturn_t bwr = future_get_mongoc_bulkwritereturn_t(fut);
+   _pipelined_assert_no_request(server);
+
+   ASSERT(bwr.exc);
+   ASSERT(mongoc_bulkwriteexception_error(bwr.exc, &error));
+   ASSERT_ERROR_CONTAINS(error, MONGOC_ERROR_QUERY, 6, "host unreachable");
+
+   // The replies of the other batches are still applied.
+   ASSERT(bwr.res);
+   ASSERT_CMPINT64(mongoc_bulkwriteresult_insertedcount(bwr.res), ==, 3);
+
+   future_destroy(fut);
+   request_destroy(req3);
+   request_destroy(req2);
+   request_destroy(req1);
+   mongoc_bulkwriteexception_destroy(bwr.exc);
+   mongoc_bulkwriteresult_destroy(bwr.res);
+   mongoc_bulkwriteopts_destroy(bwo);
+   mongoc_bulkwrite_destroy(bw);
+   mongoc_client_destroy(client);
+   mock_server_destroy(server);
+}
+
+static void
+test_bulkwrite_pipelined_retryable(void)
+{
+   mock_server_t *server = _pipelined_server_new(2);
+   mongoc_client_t *client = _pipelined_client_new(server, true);
+   mongoc_bulkwrite_t *bw = mongoc_client_bulkwrite_new(client);
+
+   bson_error_t error;
+   for (int i = 0; i < 5; i++) {
+      ASSERT_OR_PRINT(mongoc_bulkwrite_append_insertone(bw, "db.coll", tmp_bson("{'_id': %d}", i), NULL, &error),
+                      error);
+   }
+
+   mongoc_bulkwriteopts_t *bwo = mongoc_bulkwriteopts_new();
+   mongoc_bulkwriteopts_set_ordered(bwo, false);
+   mongoc_bulkwriteopts_set_verboseresults(bwo, true);
+   mongoc_bulkwriteopts_set_maxinflightbatches(bwo, 3);
+
+   future_t *fut = future_bulkwrite_execute(bw, bwo);
+
+   // Retryable writes are not pipelined: the next batch is only sent after the reply is read.
+   request_t *req1 = mock_server_receives_msg(server,
+                                              MONGOC_MSG_NONE,
+                                              tmp_bson("{'bulkWrite': 1, 'txnNumber': {'$numberLong': '1'}}"),
+                                              tmp_bson("{'ns': 'db.coll'}"),
+                                              tmp_bson("{'insert': 0, 'document': {'_id': 0}}"),
+                                              tmp_bson("{'insert': 0, 'document': {'_id': 1}}"));
+   _pipelined_assert_no_request(server);
+   reply_to_request_simple(
+      req1, tmp_str(pipelined_reply_fmt, 2, "{'ok': 1, 'idx': 0, 'n': 1}, {'ok': 1, 'idx': 1, 'n': 1}"));
+
+   request_t *req2 = mock_server_receives_msg(server,
+                                              MONGOC_MSG_NONE,
+                                              tmp_bson("{'bulkWrite': 1, 'txnNumber': {'$numberLong': '2'}}"),
+                                              tmp_bson("{'ns': 'db.coll'}"),
+                                              tmp_bson("{'insert': 0, 'document': {'_id': 2}}"),
+                                              tmp_bson("{'insert': 0, 'document': {'_id': 3}}"));
+   _pipelined_assert_no_request(server);
+   reply_to_request_simple(
+      req2, "{'ok': 0, 'code': 6, 'errmsg': 'host unreachable', 'errorLabels': ['RetryableWriteError']}");
+
+   // The retry uses the latest transaction number of the session.
+   request_t *retry = mock_server_receives_msg(server,
+                                               MONGOC_MSG_NONE,
+                                               tmp_bson("{'bulkWrite': 1, 'txnNumber': {'$numberLong': '2'}}"),
+                                               tmp_bson("{'ns': 'db.coll'}"),
+                                               tmp_bson("{'insert': 0, 'document': {'_id': 2}}"),
+                                               tmp_bson("{'insert': 0, 'document': {'_id': 3}}"));
+   reply_to_request_simple(
+      retry, tmp_str(pipelined_reply_fmt, 2, "{'ok': 1, 'idx': 0, 'n': 1}, {'ok': 1, 'idx': 1, 'n': 1}"));
+
+   request_t *req3 = mock_server_receives_msg(server,
+                                              MONGOC_MSG_NONE,
+                                              tmp_bson("{'bulkWrite': 1, 'txnNumber': {'$numberLong': '3'}}"),
+                                              tmp_bson("{'ns': 'db.coll'}"),
+                                              tmp_bson("{'insert': 0, 'document': {'_id': 4}}"));
+   reply_to_request_simple(req3, tmp_str(pipelined_reply_fmt, 1, "{'ok': 1, 'idx': 0, 'n': 1}"));
+
+   mongoc_bulkwritereturn_t bwr = future_get_mongoc_bulkwritereturn_t(fut);
+   ASSERT_NO_BULKWRITEEXCEPTION(bwr);
+
+   ASSERT(bwr.res);
+   ASSERT_CMPINT64(mongoc_bulkwriteresult_insertedcount(bwr.res), ==, 5);
+   ASSERT_MATCH(mongoc_bulkwriteresult_insertresults(bwr.res),
+                BSON_STR({
+                   "0" : {"insertedId" : 0},
+                   "1" : {"insertedId" : 1},
+                   "2" : {"insertedId" : 2},
+                   "3" : {"insertedId" : 3},
+                   "4" : {"insertedId" : 4}
+                }));
+
+   future_destroy(fut);
+   request_destroy(req3);
+   request_destroy(retry);
+   request_destroy(req2);
+   request_destroy(req1);
+   mongoc_bulkwriteexception_destroy(bwr.exc);
+   mongoc_bulkwriteresult_destroy(bwr.res);
+   mongoc_bulkwriteopts_destroy(bwo);
+   mongoc_bulkwrite_destroy(bw);
+   mongoc_client_destroy(client);
+   mock_server_destroy(server);
+}
+
+static void
+test_bulkwrite_pipelined_reply_budget(void)
+{
+   mock_server_t *server = _pipelined_server_new(1000);
+   mongoc_client_t *client = _pipelined_client_new(server, false);
+   mongoc_bulkwrite_t *bw = mongoc_client_bulkwrite_new(client);
+
+   bson_error_t error;
+   for (int i = 0; i < 1500; i++) {
+      ASSERT_OR_PRINT(mongoc_bulkwrite_append_insertone(bw, "db.coll", tmp_bson("{'_id': %d}", i), NULL, &error),
+                      error);
+   }
+
+   mongoc_bulkwriteopts_t *bwo = mongoc_bulkwriteopts_new();
+   mongoc_bulkwriteopts_set_ordered(bwo, false);
+   mongoc_bulkwriteopts_set_maxinflightbatches(bwo, 2);
+
+   future_t *fut = future_bulkwrite_execute(bw, bwo);
+
+   // Even without verbose results, a reply to 1000 operations may hold 1000 write errors, which may not fit in the
+   // socket buffers: the second batch waits for the first reply.
+   request_t *req1 = mock_server_receives_request(server);
+   ASSERT(req1);
+   ASSERT_CMPSIZE_T(req1->docs.len, ==, 1002u);
+   _pipelined_assert_no_request(server);
+   reply_to_request_simple(req1, tmp_str(pipelined_reply_fmt, 1000, ""));
+
+   request_t *req2 = mock_server_receives_request(server);
+   ASSERT(req2);
+   ASSERT_CMPSIZE_T(req2->docs.len, ==, 502u);
+   reply_to_request_simple(req2, tmp_str(pipelined_reply_fmt, 500, ""));
+
+   mongoc_bulkwritereturn_t bwr = future_get_mongoc_bulkwritereturn_t(fut);
+   ASSERT_NO_BULKWRITEEXCEPTION(bwr);
+   ASSERT(bwr.res);
+   ASSERT_CMPINT64(mongoc_bulkwriteresult_insertedcount(bwr.res), ==, 1500);
+
+   future_destroy(fut);
+   request_destroy(req2);
+   request_destroy(req1);
+   mongoc_bulkwriteexception_destroy(bwr.exc);
+   mongoc_bulkwriteresult_destroy(bwr.res);
+   mongoc_bulkwriteopts_destroy(bwo);
+   mongoc_bulkwrite_destroy(bw);
+   mongoc_client_destroy(client);
+   mock_server_destroy(server);
+}
+
+static void
+test_bulkwrite_pipelined_write_errors(void)
+{
+   mock_server_t *server = _pipelined_server_new(2);
+   mongoc_client_t *client = _pipelined_client_new(server, false);
+   mongoc_bulkwrite_t *bw = mongoc_client_bulkwrite_new(client);
+
+   bson_error_t error;
+   for (int i = 0; i < 5; i++) {
+      ASSERT_OR_PRINT(mongoc_bulkwrite_append_insertone(bw, "db.coll", tmp_bson("{'_id': %d}", i), NULL, &error),
+                      error);
+   }
+
+   mongoc_bulkwriteopts_t *bwo = mongoc_bulkwriteopts_new();
+   mongoc_bulkwriteopts_set_ordered(bwo, false);
+   mongoc_bulkwriteopts_set_maxinflightbatches(bwo, 3);
+
+   future_t *fut = future_bulkwrite_execute(bw, bwo);
+
+   // The replies to small batches fit in the budget even if every operation fails: all batches are sent at once.
+   request_t *req1 = mock_server_receives_request(server);
+   request_t *req2 = mock_server_receives_request(server);
+   request_t *req3 = mock_server_receives_request(server);
+   ASSERT(req1);
+   ASSERT(req2);
+   ASSERT(req3);
+
+   const char *const errors_fmt =
+      "{'ok': 1, 'nInserted': 0, 'nMatched': 0, 'nModified': 0, 'nDeleted': 0, 'nUpserted': 0, 'nErrors': %d,"
+      " 'cursor': {'id': 0, 'firstBatch': [%s], 'ns': 'admin.$cmd.bulkWrite'}}";
+   const char *const error_fmt = "{'ok': 0, 'idx': %d, 'code': 11000, 'errmsg': 'E11000 duplicate key error'}";
+
+   reply_to_request_simple(
+      req1, tmp_str(errors_fmt, 2, tmp_str("%s, %s", tmp_str(error_fmt, 0), tmp_str(error_fmt, 1))));
+   reply_to_request_simple(
+      req2, tmp_str(errors_fmt, 2, tmp_str("%s, %s", tmp_str(error_fmt, 0), tmp_str(error_fmt, 1))));
+   reply_to_request_simple(req3, tmp_str(errors_fmt, 1, tmp_str(error_fmt, 0)));
+
+   mongoc_bulkwritereturn_t bwr = future_get_mongoc_bulkwritereturn_t(fut);
+   _pipelined_assert_no_request(server);
+
+   // Every write error is reported at the index of its write model.
+   ASSERT(bwr.exc);
+   ASSERT(!mongoc_bulkwriteexception_error(bwr.exc, &error));
+   const bson_t *write_errors = mongoc_bulkwriteexception_writeerrors(bwr.exc);
+   ASSERT_CMPUINT32(bson_count_keys(write_errors), ==, 5u);
+   ASSERT_MATCH(write_errors, BSON_STR({
+                   "0" : {"code" : 11000},
+                   "1" : {"code" : 11000},
+                   "2" : {"code" : 11000},
+                   "3" : {"code" : 11000},
+                   "4" : {"code" : 11000}
+                }));
+
+   future_destroy(fut);
+   request_destroy(req3);
+   request_destroy(req2);
+   request_destroy(req1);
+   mongoc_bulkwriteexception_destroy(bwr.exc);
+   mongoc_bulkwriteresult_destroy(bwr.res);
+   mongoc_bulkwriteopts_destroy(bwo);
+   mongoc_bulkwrite_destroy(bw);
+   mongoc_client_destroy(client);
+   mock_server_destroy(server);
+}
+
+static void
+test_bulkwrite_pipelined_default_uri(void)
+{
+   mock_server_t *server = _pipelined_server_new(2);
+   // Do not use the URI of the mock server: it disables retryable writes.
+   mongoc_uri_t *uri = mongoc_uri_new(tmp_str("mongodb://%s", mock_server_get_host_and_port(server)));
+   mongoc_client_t *client = test_framework_client_new_from_uri(uri, NULL);
+   mongoc_bulkwrite_t *bw = mongoc_client_bulkwrite_new(client);
+
+   bson_error_t error;
+   for (int i = 0; i < 3; i++) {
+      ASSERT_OR_PRINT(mongoc_bulkwrite_append_insertone(bw, "db.coll", tmp_bson("{'_id': %d}", i), NULL, &error),
+                      error);
+   }
+
+   mongoc_bulkwriteopts_t *bwo = mongoc_bulkwriteopts_new();
+   mongoc_bulkwriteopts_set_ordered(bwo, false);
+   mongoc_bulkwriteopts_set_maxinflightbatches(bwo, 2);
+
+   future_t *fut = future_bulkwrite_execute(bw, bwo);
+
+   // retryWrites defaults to true: the batches are retryable and sent one at a time.
+   request_t *req1 = mock_server_receives_msg(server,
+                                              MONGOC_MSG_NONE,
+                                              tmp_bson("{'bulkWrite': 1, 'txnNumber': {'$numberLong': '1'}}"),
+                                              tmp_bson("{'ns': 'db.coll'}"),
+                                              tmp_bson("{'insert': 0, 'document': {'_id': 0}}"),
+                                              tmp_bson("{'insert': 0, 'document': {'_id': 1}}"));
+   _pipelined_assert_no_request(server);
+   reply_to_request_simple(req1, tmp_str(pipelined_reply_fmt, 2, ""));
+
+   request_t *req2 = mock_server_receives_msg(server,
+                                              MONGOC_MSG_NONE,
+                                              tmp_bson("{'bulkWrite': 1, 'txnNumber': {'$numberLong': '2'}}"),
+                                              tmp_bson("{'ns': 'db.coll'}"),
+                                              tmp_bson("{'insert': 0, 'document': {'_id': 2}}"));
+   reply_to_request_simple(req2, tmp_str(pipelined_reply_fmt, 1, ""));
+
+   mongoc_bulkwritereturn_t bwr = future_get_mongoc_bulkwritereturn_t(fut);
+   ASSERT_NO_BULKWRITEEXCEPTION(bwr);
+   ASSERT(bwr.res);
+   ASSERT_CMPINT64(mongoc_bulkwriteresult_insertedcount(bwr.res), ==, 3);
+
+   future_destroy(fut);
+   request_destroy(req2);
+   request_destroy(req1);
+   mongoc_bulkwriteexception_destroy(bwr.exc);
+   mongoc_bulkwriteresult_destroy(bwr.res);
+   mongoc_bulkwriteopts_destroy(bwo);
+   mongoc_bulkwrite_destroy(bw);
+   mongoc_client_destroy(client);
+   mongoc_uri_destroy(uri);
+   mock_server_destroy(server);
+}
+
 // test_bulkwrite_missing_nModified mocks a server reply missing "nModified" in a per-operation update result.
 // The missing "nModified" is a bug: SERVER-113026. This tests how the driver handles the reply.
 static void
@@ -1215,6 +1764,13 @@ test_bulkwrite_install(TestSuite *suite)
                      test_framework_skip_if_max_wire_version_less_than_25 // require server 8.0
    );
 
+   TestSuite_AddMockServerTest(suite, "/bulkwrite/insertone_ops", test_bulkwrite_insertone_ops);
+   TestSuite_AddMockServerTest(suite, "/bulkwrite/update_ops", test_bulkwrite_update_ops);
+   TestSuite_AddMockServerTest(suite, "/bulkwrite/pipelined", test_bulkwrite_pipelined);
+   TestSuite_AddMockServerTest(suite, "/bulkwrite/pipelined/retryable", test_bulkwrite_pipelined_retryable);
+   TestSuite_AddMockServerTest(suite, "/bulkwrite/pipelined/reply_budget", test_bulkwrite_pipelined_reply_budget);
+   TestSuite_AddMockServerTest(suite, "/bulkwrite/pipelined/write_errors", test_bulkwrite_pipelined_write_errors);
+   TestSuite_AddMockServerTest(suite, "/bulkwrite/pipelined/default_uri", test_bulkwrite_pipelined_default_uri);
    TestSuite_AddMockServerTest(suite, "/bulkwrite/missing_nModified", test_bulkwrite_missing_nModified);
    TestSuite_AddMockServerTest(suite, "/bulkwrite/unexpected_results", test_bulkwrite_unexpected_results);
    TestSuite_AddMockServerTest(suite, "/bulkwrite/bad_result_index", test_bulkwrite_bad_result_index);
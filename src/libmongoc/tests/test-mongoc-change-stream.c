@@ -2375,6 +2375,174 @@ test_change_stream_socket_timeouts_nonconsecutive(void *unused)
 }
 
 
+/* mongoc_change_stream_next_batch returns the rest of the current batch and
+ * caches the post-batch resume token. */
+static void
+test_change_stream_next_batch(void)
+{
+   mock_server_t *server;
+   request_t *request;
+   future_t *future;
+   mongoc_client_t *client;
+   mongoc_collection_t *coll;
+   mongoc_change_stream_t *stream;
+   const bson_t *next_doc = NULL;
+   const bson_t *events;
+   size_t n_events;
+   bson_error_t error;
+
+   server = mock_server_with_auto_hello(WIRE_VERSION_MIN);
+   mock_server_run(server);
+
+   client = test_framework_client_new_from_uri(mock_server_get_uri(server), NULL);
+   coll = mongoc_client_get_collection(client, "db", "coll");
+
+   future = future_collection_watch(coll, tmp_bson("{}"), NULL);
+   request = mock_server_receives_msg(server, MONGOC_MSG_NONE, tmp_bson("{'aggregate': 'coll'}"));
+   reply_to_request_simple(request,
+                           "{'cursor': {'id': 123, 'ns': 'db.coll',"
+                           "            'firstBatch': [{'_id': {'t': 1}}, {'_id': {'t': 2}}, {'_id': {'t': 3}}],"
+                           "            'postBatchResumeToken': {'t': 'post'}},"
+                           " 'ok': 1}");
+   request_destroy(request);
+   stream = future_get_mongoc_change_stream_ptr(future);
+   ASSERT(stream);
+   future_destroy(future);
+
+   /* the first batch is already available, no getMore is sent. */
+   ASSERT(mongoc_change_stream_next_batch(stream, &events, &n_events));
+   ASSERT_CMPSIZE_T(n_events, ==, 3);
+   for (size_t i = 0; i < n_events; i++) {
+      ASSERT_MATCH(&events[i], "{'_id': {'t': %d}}", (int)i + 1);
+   }
+   /* like mongoc_change_stream_next, every event returned is counted. */
+   ASSERT_CMPUINT32(stream->cursor->count, ==, 3u);
+   ASSERT_MATCH(mongoc_change_stream_get_resume_token(stream), "{'t': 'post'}");
+
+   /* mongoc_change_stream_next and mongoc_change_stream_next_batch can be mixed. */
+   future = future_change_stream_next(stream, &next_doc);
+   request = mock_server_receives_msg(server, MONGOC_MSG_NONE, tmp_bson("{'getMore': {'$numberLong': '123'}}"));
+   reply_to_request_simple(request,
+                           "{'cursor': {'id': 123, 'ns': 'db.coll',"
+                           "            'nextBatch': [{'_id': {'t': 4}}, {'_id': {'t': 5}},"
+                           "                          {'x': 1}, {'_id': {'t': 7}}],"
+                           "            'postBatchResumeToken': {'t': 'post2'}},"
+                           " 'ok': 1}");
+   request_destroy(request);
+   ASSERT(future_get_bool(future));
+   future_destroy(future);
+   ASSERT_MATCH(next_doc, "{'_id': {'t': 4}}");
+
+   /* the batch stops at the event without a resume token. */
+   ASSERT(mongoc_change_stream_next_batch(stream, &events, &n_events));
+   ASSERT_CMPSIZE_T(n_events, ==, 1);
+   ASSERT_MATCH(&events[0], "{'_id': {'t': 5}}");
+   /* as with mongoc_change_stream_next, the event without a resume token was read from the cursor. */
+   ASSERT_CMPUINT32(stream->cursor->count, ==, 6u);
+   ASSERT_MATCH(mongoc_change_stream_get_resume_token(stream), "{'t': 5}");
+
+   ASSERT(!mongoc_change_stream_next_batch(stream, &events, &n_events));
+   ASSERT_CMPSIZE_T(n_events, ==, 0);
+   ASSERT(mongoc_change_stream_error_document(stream, &error, NULL));
+   ASSERT_ERROR_CONTAINS(
+      error, MONGOC_ERROR_CURSOR, MONGOC_ERROR_CHANGE_STREAM_NO_RESUME_TOKEN, "resume token is missing");
+
+   future = future_change_stream_destroy(stream);
+   request = mock_server_receives_msg(server, MONGOC_MSG_NONE, tmp_bson("{'killCursors': 'coll'}"));
+   reply_to_request_with_ok_and_destroy(request);
+   future_wait(future);
+   future_destroy(future);
+
+   mongoc_collection_destroy(coll);
+   mongoc_client_destroy(client);
+   mock_server_destroy(server);
+}
+
+
+/* with the "prefetch" option, the next getMore is sent while the application
+ * processes the current batch. */
+static void
+test_change_stream_next_batch_prefetch(void)
+{
+   mock_server_t *server;
+   request_t *request;
+   future_t *future;
+   mongoc_client_t *client;
+   mongoc_collection_t *coll;
+   mongoc_change_stream_t *stream;
+   const bson_t *events;
+   size_t n_events;
+
+   server = mock_server_with_auto_hello(WIRE_VERSION_MIN);
+   mock_server_run(server);
+
+   client = test_framework_client_new_from_uri(mock_server_get_uri(server), NULL);
+   coll = mongoc_client_get_collection(client, "db", "coll");
+
+   future = future_collection_watch(coll, tmp_bson("{}"), tmp_bson("{'prefetch': true}"));
+   request = mock_server_receives_msg(
+      server, MONGOC_MSG_NONE, tmp_bson("{'aggregate': 'coll', 'prefetch': {'$exists': false}}"));
+   reply_to_request_simple(request,
+                           "{'cursor': {'id': 123, 'ns': 'db.coll',"
+                           "            'firstBatch': [{'_id': {'t': 1}}, {'_id': {'t': 2}}]},"
+                           " 'ok': 1}");
+   request_destroy(request);
+   stream = future_get_mongoc_change_stream_ptr(future);
+   ASSERT(stream);
+   future_destroy(future);
+
+   ASSERT(mongoc_change_stream_next_batch(stream, &events, &n_events));
+   ASSERT_CMPSIZE_T(n_events, ==, 2);
+
+   /* the getMore is sent before the application asks for the next batch. */
+   request = mock_server_receives_msg(server, MONGOC_MSG_NONE, tmp_bson("{'getMore': {'$numberLong': '123'}}"));
+   reply_to_request_simple(request,
+                           "{'cursor': {'id': 123, 'ns': 'db.coll',"
+                           "            'nextBatch': [{'_id': {'t': 3}, 'payload': 'overwrites the reply buffer'}],"
+                           "            'postBatchResumeToken': {'t': 'post'}},"
+                           " 'ok': 1}");
+   request_destroy(request);
+
+   /* the events of the current batch do not point into the cursor's reply. */
+   ASSERT_MATCH(&events[0], "{'_id': {'t': 1}}");
+   ASSERT_MATCH(&events[1], "{'_id': {'t': 2}}");
+   ASSERT_MATCH(mongoc_change_stream_get_resume_token(stream), "{'t': 2}");
+
+   ASSERT(mongoc_change_stream_next_batch(stream, &events, &n_events));
+   ASSERT_CMPSIZE_T(n_events, ==, 1);
+   ASSERT_MATCH(&events[0], "{'_id': {'t': 3}}");
+   ASSERT_MATCH(mongoc_change_stream_get_resume_token(stream), "{'t': 'post'}");
+
+   /* the same thread sends every later getMore. */
+   request = mock_server_receives_msg(server, MONGOC_MSG_NONE, tmp_bson("{'getMore': {'$numberLong': '123'}}"));
+   reply_to_request_simple(request,
+                           "{'cursor': {'id': 123, 'ns': 'db.coll',"
+                           "            'nextBatch': [{'_id': {'t': 4}}, {'_id': {'t': 5}}]},"
+                           " 'ok': 1}");
+   request_destroy(request);
+
+   ASSERT(mongoc_change_stream_next_batch(stream, &events, &n_events));
+   ASSERT_CMPSIZE_T(n_events, ==, 2);
+   ASSERT_MATCH(&events[0], "{'_id': {'t': 4}}");
+   ASSERT_MATCH(&events[1], "{'_id': {'t': 5}}");
+   ASSERT_CMPUINT32(stream->cursor->count, ==, 5u);
+
+   /* the stream waits for the pending getMore. */
+   request = mock_server_receives_msg(server, MONGOC_MSG_NONE, tmp_bson("{'getMore': {'$numberLong': '123'}}"));
+   reply_to_request_simple(request, "{'cursor': {'id': 0, 'ns': 'db.coll', 'nextBatch': []}, 'ok': 1}");
+   request_destroy(request);
+
+   ASSERT(!mongoc_change_stream_next_batch(stream, &events, &n_events));
+   ASSERT_CMPSIZE_T(n_events, ==, 0);
+   ASSERT(!mongoc_change_stream_error_document(stream, NULL, NULL));
+
+   mongoc_change_stream_destroy(stream);
+   mongoc_collection_destroy(coll);
+   mongoc_client_destroy(client);
+   mock_server_destroy(server);
+}
+
+
 void
 test_change_stream_install(TestSuite *suite)
 {
@@ -2503,6 +2671,8 @@ test_change_stream_install(TestSuite *suite)
                      test_framework_skip_if_not_replset);
    TestSuite_AddMockServerTest(suite, "/change_streams/prose_test_17", prose_test_17);
    TestSuite_AddMockServerTest(suite, "/change_streams/prose_test_18", prose_test_18);
+   TestSuite_AddMockServerTest(suite, "/change_stream/next_batch", test_change_stream_next_batch);
+   TestSuite_AddMockServerTest(suite, "/change_stream/next_batch/prefetch", test_change_stream_next_batch_prefetch);
    TestSuite_AddFull(suite,
                      "/change_streams/iterate_after_invalidate [lock:live-server]",
                      iterate_after_invalidate,
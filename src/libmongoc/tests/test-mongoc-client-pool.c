@@ -1,4 +1,5 @@
 #include <common-macros-private.h> // BEGIN_IGNORE_DEPRECATIONS
+#include <common-thread-private.h>
 #include <mongoc/mongoc-client-pool-private.h>
 #include <mongoc/mongoc-client-private.h>
 #include <mongoc/mongoc-util-private.h>
@@ -7,7 +8,11 @@
 
 #include <mlib/time_point.h>
 
+#include <mock_server/mock-server.h>
+#include <mock_server/request.h>
+
 #include <TestSuite.h>
+#include <test-conveniences.h>
 #include <test-libmongoc.h>
 
 #include <stream-tracker.h>
@@ -601,6 +606,367 @@ test_mongoc_client_set_stream_initiator(void)
    mongoc_client_pool_destroy(pool);
 }
 
+
+typedef struct {
+   mongoc_client_pool_t *pool;
+   int32_t id;
+   // If set, the _id to look up instead of `id`.
+   bson_value_t value;
+   const bson_t *opts;
+   bool ret;
+   bson_error_t error;
+   bson_thread_t thread;
+} group_commit_insert_t;
+
+
+static BSON_THREAD_FUN(group_commit_insert_one, arg)
+{
+   group_commit_insert_t *const insert = (group_commit_insert_t *)arg;
+   mongoc_client_t *const client = mongoc_client_pool_pop(insert->pool);
+   mongoc_collection_t *const coll = mongoc_client_get_collection(client, "db", "coll");
+   bson_t *const doc = BCON_NEW("_id", BCON_INT32(insert->id));
+
+   insert->ret = mongoc_collection_insert_one(coll, doc, NULL, NULL, &insert->error);
+
+   bson_destroy(doc);
+   mongoc_collection_destroy(coll);
+   mongoc_client_pool_push(insert->pool, client);
+   BSON_THREAD_RETURN;
+}
+
+
+// Concurrent insert_one calls are sent as one insert, and each caller gets the outcome of its own document.
+static void
+test_client_pool_group_commit(void)
+{
+   mock_server_t *const server = mock_server_with_auto_hello(WIRE_VERSION_8_0);
+   mock_server_auto_endsessions(server);
+   mock_server_run(server);
+
+   mongoc_client_pool_t *const pool = test_framework_client_pool_new_from_uri(mock_server_get_uri(server), NULL);
+   group_commit_insert_t inserts[3];
+   bson_error_t error;
+
+   // The long window ensures all three documents are sent together.
+   ASSERT_OR_PRINT(mongoc_client_pool_set_group_commit(pool, 60000, 3, &error), error);
+
+   for (int32_t i = 0; i < 3; i++) {
+      inserts[i] = (group_commit_insert_t){.pool = pool, .id = i};
+      ASSERT_CMPINT(mcommon_thread_create(&inserts[i].thread, group_commit_insert_one, &inserts[i]), ==, 0);
+   }
+
+   request_t *const request = mock_server_receives_request(server);
+   ASSERT(request);
+   ASSERT_CMPSTR(request->command_name, "insert");
+   ASSERT_MATCH(request_get_doc(request, 0), "{'insert': 'coll', 'ordered': false}");
+   ASSERT_CMPSIZE_T(request->docs.len, ==, 4u);
+
+   // Fail the document with _id 1, wherever its caller was queued.
+   int32_t failed_index = -1;
+   for (int32_t i = 0; i < 3; i++) {
+      bson_iter_t iter;
+      ASSERT(bson_iter_init_find(&iter, request_get_doc(request, (size_t)i + 1u), "_id"));
+      if (bson_iter_int32(&iter) == 1) {
+         failed_index = i;
+      }
+   }
+   ASSERT_CMPINT32(failed_index, !=, -1);
+
+   reply_to_request_simple(
+      request,
+      tmp_str("{'ok': 1, 'n': 2, 'writeErrors': [{'index': %d, 'code': 11000, 'errmsg': 'duplicate key'}]}",
+              failed_index));
+
+   for (int32_t i = 0; i < 3; i++) {
+      ASSERT_CMPINT(mcommon_thread_join(inserts[i].thread), ==, 0);
+   }
+
+   ASSERT_OR_PRINT(inserts[0].ret, inserts[0].error);
+   ASSERT(!inserts[1].ret);
+   ASSERT_ERROR_CONTAINS(inserts[1].error, MONGOC_ERROR_COLLECTION, 11000, "duplicate key");
+   ASSERT_OR_PRINT(inserts[2].ret, inserts[2].error);
+
+   request_destroy(request);
+   mongoc_client_pool_destroy(pool);
+   mock_server_destroy(server);
+}
+
+
+static void
+test_client_pool_group_commit_invalid(void)
+{
+   mongoc_uri_t *const uri = mongoc_uri_new("mongodb://localhost");
+   mongoc_client_pool_t *const pool = test_framework_client_pool_new_from_uri(uri, NULL);
+   bson_error_t error;
+
+   ASSERT(!mongoc_client_pool_set_group_commit(pool, -1, 1000, &error));
+   ASSERT_ERROR_CONTAINS(
+      error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Invalid group commit window: -1 milliseconds");
+
+   ASSERT(!mongoc_client_pool_set_group_commit(pool, 0, 0, &error));
+   ASSERT_ERROR_CONTAINS(
+      error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Invalid group commit maximum: 0 documents");
+
+   ASSERT_OR_PRINT(mongoc_client_pool_set_group_commit(pool, 0, 1000, &error), error);
+   ASSERT(!mongoc_client_pool_set_group_commit(pool, 0, 1000, &error));
+   ASSERT_ERROR_CONTAINS(error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "more than once");
+
+   mongoc_client_pool_destroy(pool);
+
+   mongoc_client_pool_t *const popped = test_framework_client_pool_new_from_uri(uri, NULL);
+   mongoc_client_pool_push(popped, mongoc_client_pool_pop(popped));
+   ASSERT(!mongoc_client_pool_set_group_commit(popped, 0, 1000, &error));
+   ASSERT_ERROR_CONTAINS(
+      error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "after a client has been created");
+
+   mongoc_client_pool_destroy(popped);
+   mongoc_uri_destroy(uri);
+}
+
+
+typedef struct {
+   mongoc_client_pool_t *pool;
+   int32_t id;
+   // If set, the _id to look up instead of `id`.
+   bson_value_t value;
+   const bson_t *opts;
+   bool ret;
+   bson_t document;
+   bson_error_t error;
+   bson_thread_t thread;
+} lookup_batching_find_t;
+
+
+static BSON_THREAD_FUN(lookup_batching_find_one, arg)
+{
+   lookup_batching_find_t *const find = (lookup_batching_find_t *)arg;
+   mongoc_client_t *const client = mongoc_client_pool_pop(find->pool);
+   mongoc_collection_t *const coll = mongoc_client_get_collection(client, "db", "coll");
+   const bson_value_t id =
+      find->value.value_type ? find->value : (bson_value_t){.value_type = BSON_TYPE_INT32, .value.v_int32 = find->id};
+
+   find->ret = mongoc_collection_find_one_by_id(coll, &id, find->opts, NULL, &find->document, &find->error);
+
+   mongoc_collection_destroy(coll);
+   mongoc_client_pool_push(find->pool, client);
+   BSON_THREAD_RETURN;
+}
+
+
+// Concurrent lookups by _id are sent as one find, and each caller gets the document with its own _id.
+static void
+test_client_pool_lookup_batching(void)
+{
+   mock_server_t *const server = mock_server_with_auto_hello(WIRE_VERSION_8_0);
+   mock_server_auto_endsessions(server);
+   mock_server_run(server);
+
+   mongoc_client_pool_t *const pool = test_framework_client_pool_new_from_uri(mock_server_get_uri(server), NULL);
+   lookup_batching_find_t finds[3];
+   bson_error_t error;
+
+   // The long delay ensures all three lookups are sent together.
+   ASSERT_OR_PRINT(mongoc_client_pool_set_lookup_batching(pool, 60 * 1000 * 1000, 3, &error), error);
+
+   for (int32_t i = 0; i < 3; i++) {
+      finds[i] = (lookup_batching_find_t){.pool = pool, .id = i};
+      ASSERT_CMPINT(mcommon_thread_create(&finds[i].thread, lookup_batching_find_one, &finds[i]), ==, 0);
+   }
+
+   request_t *const request = mock_server_receives_request(server);
+   ASSERT(request);
+   ASSERT_CMPSTR(request->command_name, "find");
+   ASSERT_MATCH(request_get_doc(request, 0), "{'find': 'coll'}");
+
+   // The ids are in arrival order.
+   {
+      bson_iter_t iter;
+      bson_iter_t in;
+      uint32_t n = 0;
+
+      ASSERT(bson_iter_init(&iter, request_get_doc(request, 0)));
+      ASSERT(bson_iter_find_descendant(&iter, "filter._id.$in", &in));
+      ASSERT(BSON_ITER_HOLDS_ARRAY(&in));
+      ASSERT(bson_iter_recurse(&in, &iter));
+      while (bson_iter_next(&iter)) {
+         ASSERT(BSON_ITER_HOLDS_INT32(&iter));
+         n++;
+      }
+      ASSERT_CMPUINT32(n, ==, 3u);
+   }
+
+   // The document with _id 2 does not exist. Numeric _id values of other types match.
+   reply_to_request_simple(request,
+                           "{'ok': 1, 'cursor': {'id': 0, 'ns': 'db.coll', 'firstBatch': ["
+                           "{'_id': 0, 'x': 0}, {'_id': {'$numberDouble': '1.0'}, 'x': 1}]}}");
+
+   for (int32_t i = 0; i < 3; i++) {
+      ASSERT_CMPINT(mcommon_thread_join(finds[i].thread), ==, 0);
+      ASSERT_OR_PRINT(finds[i].ret, finds[i].error);
+   }
+
+   ASSERT_MATCH(&finds[0].document, "{'_id': 0, 'x': 0}");
+   ASSERT_MATCH(&finds[1].document, "{'_id': 1, 'x': 1}");
+   ASSERT(bson_empty(&finds[2].document));
+
+   for (int32_t i = 0; i < 3; i++) {
+      bson_destroy(&finds[i].document);
+   }
+   request_destroy(request);
+   mongoc_client_pool_destroy(pool);
+   mock_server_destroy(server);
+}
+
+
+// Numbers are matched by their exact value. A string _id that matched no returned document is looked up again alone,
+// since the server may compare it with a collation.
+static void
+test_client_pool_lookup_batching_exact(void)
+{
+   mock_server_t *const server = mock_server_with_auto_hello(WIRE_VERSION_8_0);
+   mock_server_auto_endsessions(server);
+   mock_server_run(server);
+
+   mongoc_client_pool_t *const pool = test_framework_client_pool_new_from_uri(mock_server_get_uri(server), NULL);
+   lookup_batching_find_t finds[2];
+   bson_error_t error;
+
+   ASSERT_OR_PRINT(mongoc_client_pool_set_lookup_batching(pool, 60 * 1000 * 1000, 2, &error), error);
+
+   // 2^53 + 1 is not equal to any double.
+   finds[0] = (lookup_batching_find_t){
+      .pool = pool, .value = {.value_type = BSON_TYPE_INT64, .value.v_int64 = 9007199254740993LL}};
+   finds[1] = (lookup_batching_find_t){
+      .pool = pool, .value = {.value_type = BSON_TYPE_UTF8, .value.v_utf8 = {.str = "a", .len = 1u}}};
+   for (int i = 0; i < 2; i++) {
+      ASSERT_CMPINT(mcommon_thread_create(&finds[i].thread, lookup_batching_find_one, &finds[i]), ==, 0);
+   }
+
+   request_t *const request = mock_server_receives_request(server);
+   ASSERT(request);
+   ASSERT_MATCH(request_get_doc(request, 0), "{'find': 'coll', 'filter': {'_id': {'$in': {'$exists': true}}}}");
+   // 2^53 as a double, and a string equal to "a" under a case-insensitive collation.
+   reply_to_request_simple(request,
+                           "{'ok': 1, 'cursor': {'id': 0, 'ns': 'db.coll', 'firstBatch': ["
+                           "{'_id': {'$numberDouble': '9007199254740992'}}, {'_id': 'A', 'x': 1}]}}");
+
+   request_t *const alone = mock_server_receives_request(server);
+   ASSERT(alone);
+   ASSERT_MATCH(request_get_doc(alone, 0), "{'find': 'coll', 'filter': {'_id': 'a'}}");
+   reply_to_request_simple(alone,
+                           "{'ok': 1, 'cursor': {'id': 0, 'ns': 'db.coll', 'firstBatch': [{'_id': 'A', 'x': 1}]}}");
+
+   for (int i = 0; i < 2; i++) {
+      ASSERT_CMPINT(mcommon_thread_join(finds[i].thread), ==, 0);
+      ASSERT_OR_PRINT(finds[i].ret, finds[i].error);
+   }
+
+   ASSERT(bson_empty(&finds[0].document));
+   ASSERT_MATCH(&finds[1].document, "{'_id': 'A', 'x': 1}");
+
+   for (int i = 0; i < 2; i++) {
+      bson_destroy(&finds[i].document);
+   }
+   request_destroy(alone);
+   request_destroy(request);
+   mongoc_client_pool_destroy(pool);
+   mock_server_destroy(server);
+}
+
+
+// A lookup with a collation is not combined with others: it is sent at once, with a limit of one.
+static void
+test_client_pool_lookup_batching_collation(void)
+{
+   mock_server_t *const server = mock_server_with_auto_hello(WIRE_VERSION_8_0);
+   mock_server_auto_endsessions(server);
+   mock_server_run(server);
+
+   mongoc_client_pool_t *const pool = test_framework_client_pool_new_from_uri(mock_server_get_uri(server), NULL);
+   lookup_batching_find_t find = {.pool = pool, .id = 1, .opts = tmp_bson("{'collation': {'locale': 'en'}}")};
+   bson_error_t error;
+
+   // A batched lookup would wait a minute for others.
+   ASSERT_OR_PRINT(mongoc_client_pool_set_lookup_batching(pool, 60 * 1000 * 1000, 2, &error), error);
+   ASSERT_CMPINT(mcommon_thread_create(&find.thread, lookup_batching_find_one, &find), ==, 0);
+
+   request_t *const request = mock_server_receives_request(server);
+   ASSERT(request);
+   ASSERT_MATCH(request_get_doc(request, 0),
+                "{'find': 'coll', 'filter': {'_id': 1}, 'collation': {'locale': 'en'}, 'limit': {'$numberLong': '1'}}");
+   reply_to_request_simple(request, "{'ok': 1, 'cursor': {'id': 0, 'ns': 'db.coll', 'firstBatch': [{'_id': 1}]}}");
+
+   ASSERT_CMPINT(mcommon_thread_join(find.thread), ==, 0);
+   ASSERT_OR_PRINT(find.ret, find.error);
+   ASSERT_MATCH(&find.document, "{'_id': 1}");
+
+   bson_destroy(&find.document);
+   request_destroy(request);
+   mongoc_client_pool_destroy(pool);
+   mock_server_destroy(server);
+}
+
+
+// Without lookup batching, each lookup is a find with a limit of one.
+static void
+test_client_pool_lookup_batching_disabled(void)
+{
+   mock_server_t *const server = mock_server_with_auto_hello(WIRE_VERSION_8_0);
+   mock_server_auto_endsessions(server);
+   mock_server_run(server);
+
+   mongoc_client_pool_t *const pool = test_framework_client_pool_new_from_uri(mock_server_get_uri(server), NULL);
+   lookup_batching_find_t find = {.pool = pool, .id = 1};
+
+   ASSERT_CMPINT(mcommon_thread_create(&find.thread, lookup_batching_find_one, &find), ==, 0);
+
+   request_t *const request = mock_server_receives_request(server);
+   ASSERT(request);
+   ASSERT_MATCH(request_get_doc(request, 0), "{'find': 'coll', 'filter': {'_id': 1}, 'limit': {'$numberLong': '1'}}");
+   reply_to_request_simple(request, "{'ok': 1, 'cursor': {'id': 0, 'ns': 'db.coll', 'firstBatch': [{'_id': 1}]}}");
+
+   ASSERT_CMPINT(mcommon_thread_join(find.thread), ==, 0);
+   ASSERT_OR_PRINT(find.ret, find.error);
+   ASSERT_MATCH(&find.document, "{'_id': 1}");
+
+   bson_destroy(&find.document);
+   request_destroy(request);
+   mongoc_client_pool_destroy(pool);
+   mock_server_destroy(server);
+}
+
+
+static void
+test_client_pool_lookup_batching_invalid(void)
+{
+   mongoc_uri_t *const uri = mongoc_uri_new("mongodb://localhost");
+   mongoc_client_pool_t *const pool = test_framework_client_pool_new_from_uri(uri, NULL);
+   bson_error_t error;
+
+   ASSERT(!mongoc_client_pool_set_lookup_batching(pool, -1, 100, &error));
+   ASSERT_ERROR_CONTAINS(
+      error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Invalid lookup batching delay: -1 microseconds");
+
+   ASSERT(!mongoc_client_pool_set_lookup_batching(pool, 0, 0, &error));
+   ASSERT_ERROR_CONTAINS(
+      error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Invalid lookup batching maximum: 0 lookups");
+
+   ASSERT_OR_PRINT(mongoc_client_pool_set_lookup_batching(pool, 0, 100, &error), error);
+   ASSERT(!mongoc_client_pool_set_lookup_batching(pool, 0, 100, &error));
+   ASSERT_ERROR_CONTAINS(error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "more than once");
+
+   mongoc_client_pool_destroy(pool);
+
+   mongoc_client_pool_t *const popped = test_framework_client_pool_new_from_uri(uri, NULL);
+   mongoc_client_pool_push(popped, mongoc_client_pool_pop(popped));
+   ASSERT(!mongoc_client_pool_set_lookup_batching(popped, 0, 100, &error));
+   ASSERT_ERROR_CONTAINS(
+      error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "after a client has been created");
+
+   mongoc_client_pool_destroy(popped);
+   mongoc_uri_destroy(uri);
+}
+
 void
 test_client_pool_install(TestSuite *suite)
 {
@@ -654,4 +1020,13 @@ test_client_pool_install(TestSuite *suite)
    TestSuite_AddLive(suite, "/ClientPool/mongoc_client_set_ssl_opts", test_mongoc_client_set_ssl_opts_on_pool);
 #endif // MONGOC_ENABLE_SSL
    TestSuite_AddLive(suite, "/ClientPool/mongoc_client_set_stream_initiator", test_mongoc_client_set_stream_initiator);
+   TestSuite_AddMockServerTest(suite, "/ClientPool/group_commit", test_client_pool_group_commit);
+   TestSuite_Add(suite, "/ClientPool/group_commit/invalid", test_client_pool_group_commit_invalid);
+   TestSuite_AddMockServerTest(suite, "/ClientPool/lookup_batching", test_client_pool_lookup_batching);
+   TestSuite_AddMockServerTest(suite, "/ClientPool/lookup_batching/exact", test_client_pool_lookup_batching_exact);
+   TestSuite_AddMockServerTest(
+      suite, "/ClientPool/lookup_batching/collation", test_client_pool_lookup_batching_collation);
+   TestSuite_AddMockServerTest(
+      suite, "/ClientPool/lookup_batching/disabled", test_client_pool_lookup_batching_disabled);
+   TestSuite_Add(suite, "/ClientPool/lookup_batching/invalid", test_client_pool_lookup_batching_invalid);
 }
@@ -20,6 +20,7 @@
 #endif
 #include <common-macros-private.h> // BEGIN_IGNORE_DEPRECATIONS
 #include <common-oid-private.h>
+#include <common-thread-private.h>
 #include <mongoc/mongoc-util-private.h>
 #include <mongoc/mongoc-write-concern-private.h>
 
@@ -3791,6 +3792,102 @@ test_killCursors(void)
    mongoc_client_destroy(client);
 }
 
+typedef struct {
+   mongoc_client_t *client;
+   bool ret;
+   bson_error_t error;
+} flush_unacknowledged_writes_t;
+
+
+static BSON_THREAD_FUN(flush_unacknowledged_writes, arg)
+{
+   flush_unacknowledged_writes_t *const flush = (flush_unacknowledged_writes_t *)arg;
+
+   flush->ret = mongoc_client_flush_unacknowledged_writes(flush->client, &flush->error);
+
+   BSON_THREAD_RETURN;
+}
+
+
+// Unacknowledged writes are buffered until another message is sent or they are flushed.
+static void
+test_client_unacknowledged_write_buffer(void)
+{
+   mock_server_t *const server = mock_server_with_auto_hello(WIRE_VERSION_MAX);
+   mock_server_run(server);
+
+   mongoc_client_t *const client = test_framework_client_new_from_uri(mock_server_get_uri(server), NULL);
+   mongoc_collection_t *const coll = mongoc_client_get_collection(client, "db", "coll");
+   mongoc_write_concern_t *const wc = mongoc_write_concern_new();
+   bson_error_t error;
+
+   mongoc_write_concern_set_w(wc, MONGOC_WRITE_CONCERN_W_UNACKNOWLEDGED);
+   mongoc_collection_set_write_concern(coll, wc);
+   ASSERT_OR_PRINT(mongoc_client_set_unacknowledged_write_buffer(client, 1024 * 1024, 0, 0, &error), error);
+
+   for (int i = 0; i < 3; i++) {
+      ASSERT_OR_PRINT(mongoc_collection_insert_one(coll, tmp_bson("{'_id': %d}", i), NULL, NULL, &error), error);
+   }
+
+   // Nothing was written yet.
+   mock_server_set_request_timeout_msec(server, 100);
+   ASSERT(!mock_server_receives_request(server));
+   mock_server_set_request_timeout_msec(server, get_future_timeout_ms());
+
+   // An acknowledged command writes the buffered messages first.
+   future_t *const future = future_client_command_simple(client, "admin", tmp_bson("{'ping': 1}"), NULL, NULL, &error);
+   for (int i = 0; i < 3; i++) {
+      request_t *const request = mock_server_receives_msg(
+         server, MONGOC_MSG_MORE_TO_COME, tmp_bson("{'insert': 'coll'}"), tmp_bson("{'_id': %d}", i));
+      ASSERT(request);
+      request_destroy(request);
+   }
+   request_t *request = mock_server_receives_msg(server, MONGOC_MSG_NONE, tmp_bson("{'ping': 1}"));
+   reply_to_request_with_ok_and_destroy(request);
+   ASSERT_OR_PRINT(future_get_bool(future), error);
+   future_destroy(future);
+
+   // A flush writes the buffered messages and waits for the server to apply them.
+   ASSERT_OR_PRINT(mongoc_collection_insert_one(coll, tmp_bson("{'_id': 3}"), NULL, NULL, &error), error);
+   flush_unacknowledged_writes_t flush = {.client = client};
+   bson_thread_t thread;
+   ASSERT_CMPINT(mcommon_thread_create(&thread, flush_unacknowledged_writes, &flush), ==, 0);
+   request = mock_server_receives_msg(
+      server, MONGOC_MSG_MORE_TO_COME, tmp_bson("{'insert': 'coll'}"), tmp_bson("{'_id': 3}"));
+   request_destroy(request);
+   request = mock_server_receives_msg(server, MONGOC_MSG_NONE, tmp_bson("{'ping': 1}"));
+   reply_to_request_with_ok_and_destroy(request);
+   ASSERT_CMPINT(mcommon_thread_join(thread), ==, 0);
+   ASSERT_OR_PRINT(flush.ret, flush.error);
+
+   // Nothing left to flush.
+   ASSERT_OR_PRINT(mongoc_client_flush_unacknowledged_writes(client, &error), error);
+
+   mongoc_write_concern_destroy(wc);
+   mongoc_collection_destroy(coll);
+   mongoc_client_destroy(client);
+   mock_server_destroy(server);
+}
+
+
+static void
+test_client_unacknowledged_write_buffer_invalid(void)
+{
+   mongoc_client_t *const client = test_framework_client_new("mongodb://localhost", NULL);
+   bson_error_t error;
+
+   ASSERT(!mongoc_client_set_unacknowledged_write_buffer(client, 1024, -1, 0, &error));
+   ASSERT_ERROR_CONTAINS(
+      error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Invalid flush interval: -1 milliseconds");
+
+   ASSERT(!mongoc_client_set_unacknowledged_write_buffer(client, 1024, 0, -1, &error));
+   ASSERT_ERROR_CONTAINS(
+      error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Invalid probe interval: -1 milliseconds");
+
+   mongoc_client_destroy(client);
+}
+
+
 void
 test_client_install(TestSuite *suite)
 {
@@ -4005,4 +4102,7 @@ test_client_install(TestSuite *suite)
                      test_framework_skip_if_no_server_ssl);
 #endif
    TestSuite_AddLive(suite, "/Client/killCursors", test_killCursors);
+   TestSuite_AddMockServerTest(
+      suite, "/Client/unacknowledged_write_buffer", test_client_unacknowledged_write_buffer);
+   TestSuite_Add(suite, "/Client/unacknowledged_write_buffer/invalid", test_client_unacknowledged_write_buffer_invalid);
 }
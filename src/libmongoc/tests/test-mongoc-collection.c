@@ -1,5 +1,7 @@
 #include <common-bson-dsl-private.h>
 #include <common-macros-private.h> // BEGIN_IGNORE_DEPRECATIONS
+#include <common-thread-private.h>
+#include <mongoc/mongoc-array-private.h>
 #include <mongoc/mongoc-client-private.h>
 #include <mongoc/mongoc-collection-private.h>
 #include <mongoc/mongoc-cursor-private.h>
@@ -15,6 +17,7 @@
 #include <mock_server/future-functions.h>
 #include <mock_server/mock-rs.h>
 #include <mock_server/mock-server.h>
+#include <mock_server/request.h>
 #include <test-conveniences.h>
 #include <test-libmongoc.h>
 
@@ -4954,6 +4957,390 @@ test_create_indexes_acts_as_write_command(void *unused)
 }
 
 
+typedef struct {
+   mongoc_collection_t *collection;
+   const uint8_t *data;
+   size_t length;
+   bson_reader_t *reader;
+   const bson_t *opts;
+   bson_t reply;
+   bson_error_t error;
+   bool ret;
+   bson_thread_t thread;
+} import_t;
+
+
+static BSON_THREAD_FUN(import_thread, arg)
+{
+   import_t *const import = (import_t *)arg;
+
+   if (import->reader) {
+      import->ret = mongoc_collection_import_bson_reader(
+         import->collection, import->reader, import->opts, &import->reply, &import->error);
+   } else {
+      import->ret = mongoc_collection_import_bson(
+         import->collection, import->data, import->length, import->opts, &import->reply, &import->error);
+   }
+
+   BSON_THREAD_RETURN;
+}
+
+
+// Appends `{'_id': i}` for i in [0, n) to `data`, as in a .bson file.
+static void
+import_data_append(mongoc_array_t *data, int n)
+{
+   for (int i = 0; i < n; i++) {
+      bson_t *const doc = tmp_bson("{'_id': %d}", i);
+      _mongoc_array_append_vals(data, bson_get_data(doc), doc->len);
+   }
+}
+
+
+// Batches of an unordered import are sent before reading replies, directly from the caller's data.
+static void
+test_import_bson_pipelined(void)
+{
+   mock_server_t *const server = mock_server_new();
+   mock_server_auto_hello(server,
+                          "{'isWritablePrimary': true, "
+                          " 'minWireVersion': %d,"
+                          " 'maxWireVersion': %d,"
+                          " 'maxWriteBatchSize': 2}",
+                          WIRE_VERSION_MIN,
+                          WIRE_VERSION_MAX);
+   mock_server_run(server);
+
+   mongoc_client_t *const client = test_framework_client_new_from_uri(mock_server_get_uri(server), NULL);
+   mongoc_array_t data;
+   import_t import = {0};
+
+   _mongoc_array_init(&data, 1);
+   import_data_append(&data, 5);
+
+   import.collection = mongoc_client_get_collection(client, "db", "coll");
+   import.data = data.data;
+   import.length = data.len;
+   import.opts = tmp_bson("{'ordered': false, 'maxInFlightBatches': 3}");
+   ASSERT_CMPINT(mcommon_thread_create(&import.thread, import_thread, &import), ==, 0);
+
+   request_t *requests[3];
+   requests[0] = mock_server_receives_msg(server,
+                                          MONGOC_MSG_NONE,
+                                          tmp_bson("{'insert': 'coll', 'ordered': false}"),
+                                          tmp_bson("{'_id': 0}"),
+                                          tmp_bson("{'_id': 1}"));
+   requests[1] = mock_server_receives_msg(
+      server, MONGOC_MSG_NONE, tmp_bson("{'insert': 'coll'}"), tmp_bson("{'_id': 2}"), tmp_bson("{'_id': 3}"));
+   requests[2] =
+      mock_server_receives_msg(server, MONGOC_MSG_NONE, tmp_bson("{'insert': 'coll'}"), tmp_bson("{'_id': 4}"));
+   for (int i = 0; i < 3; i++) {
+      ASSERT(requests[i]);
+   }
+
+   reply_to_request_simple(requests[0], "{'ok': 1, 'n': 2}");
+   reply_to_request_simple(
+      requests[1], "{'ok': 1, 'n': 1, 'writeErrors': [{'index': 1, 'code': 11000, 'errmsg': 'duplicate key'}]}");
+   reply_to_request_simple(requests[2], "{'ok': 1, 'n': 1}");
+
+   ASSERT_CMPINT(mcommon_thread_join(import.thread), ==, 0);
+   ASSERT(!import.ret);
+   ASSERT_ERROR_CONTAINS(import.error, MONGOC_ERROR_COLLECTION, 11000, "duplicate key");
+   // The index of the write error is relative to the data.
+   ASSERT_MATCH(&import.reply, "{'insertedCount': 4, 'writeErrors': [{'index': 3, 'code': 11000}]}");
+
+   for (int i = 0; i < 3; i++) {
+      request_destroy(requests[i]);
+   }
+   bson_destroy(&import.reply);
+   mongoc_collection_destroy(import.collection);
+   _mongoc_array_destroy(&data);
+   mongoc_client_destroy(client);
+   mock_server_destroy(server);
+}
+
+
+// Replies to `request`, an insert of `n` documents, with a duplicate key error for each document.
+static void
+import_reply_with_write_errors(request_t *request, int n)
+{
+   bson_t reply = BSON_INITIALIZER;
+   bson_array_builder_t *write_errors;
+
+   BSON_APPEND_INT32(&reply, "ok", 1);
+   BSON_APPEND_INT32(&reply, "n", 0);
+   BSON_APPEND_ARRAY_BUILDER_BEGIN(&reply, "writeErrors", &write_errors);
+   for (int i = 0; i < n; i++) {
+      bson_t write_error;
+      bson_array_builder_append_document_begin(write_errors, &write_error);
+      BSON_APPEND_INT32(&write_error, "index", i);
+      BSON_APPEND_INT32(&write_error, "code", 11000);
+      BSON_APPEND_UTF8(&write_error, "errmsg", "duplicate key");
+      bson_array_builder_append_document_end(write_errors, &write_error);
+   }
+   bson_append_array_builder_end(&reply, write_errors);
+
+   reply_to_op_msg_request(request, MONGOC_OP_MSG_FLAG_NONE, &reply);
+   bson_destroy(&reply);
+}
+
+
+// An unordered import may get a write error for each document. The replies in flight must fit in the socket buffers
+// even then: a large batch is not pipelined.
+static void
+test_import_bson_write_errors(void)
+{
+   mock_server_t *const server = mock_server_new();
+   mock_server_auto_hello(server,
+                          "{'isWritablePrimary': true, "
+                          " 'minWireVersion': %d,"
+                          " 'maxWireVersion': %d,"
+                          " 'maxWriteBatchSize': 1000}",
+                          WIRE_VERSION_MIN,
+                          WIRE_VERSION_MAX);
+   mock_server_run(server);
+
+   mongoc_client_t *const client = test_framework_client_new_from_uri(mock_server_get_uri(server), NULL);
+   mongoc_array_t data;
+   import_t import = {0};
+
+   _mongoc_array_init(&data, 1);
+   import_data_append(&data, 1500);
+
+   import.collection = mongoc_client_get_collection(client, "db", "coll");
+   import.data = data.data;
+   import.length = data.len;
+   import.opts = tmp_bson("{'ordered': false, 'maxInFlightBatches': 2}");
+   ASSERT_CMPINT(mcommon_thread_create(&import.thread, import_thread, &import), ==, 0);
+
+   request_t *const first = mock_server_receives_request(server);
+   ASSERT(first);
+   ASSERT_CMPSIZE_T(first->docs.len, ==, 1001u);
+
+   // The second batch is only sent once the reply to the first is read.
+   mock_server_set_request_timeout_msec(server, 100);
+   ASSERT(!mock_server_receives_request(server));
+   mock_server_set_request_timeout_msec(server, get_future_timeout_ms());
+   import_reply_with_write_errors(first, 1000);
+
+   request_t *const second = mock_server_receives_request(server);
+   ASSERT(second);
+   ASSERT_CMPSIZE_T(second->docs.len, ==, 501u);
+   import_reply_with_write_errors(second, 500);
+
+   ASSERT_CMPINT(mcommon_thread_join(import.thread), ==, 0);
+   ASSERT(!import.ret);
+   ASSERT_ERROR_CONTAINS(import.error, MONGOC_ERROR_COLLECTION, 11000, "duplicate key");
+   ASSERT_MATCH(&import.reply, "{'insertedCount': 0, 'writeErrors': {'$exists': true}}");
+   {
+      bson_iter_t iter;
+      bson_t write_errors;
+
+      ASSERT(bson_iter_init_find(&iter, &import.reply, "writeErrors"));
+      bson_iter_bson(&iter, &write_errors);
+      ASSERT_CMPUINT32(bson_count_keys(&write_errors), ==, 1500u);
+   }
+
+   request_destroy(second);
+   request_destroy(first);
+   bson_destroy(&import.reply);
+   mongoc_collection_destroy(import.collection);
+   _mongoc_array_destroy(&data);
+   mongoc_client_destroy(client);
+   mock_server_destroy(server);
+}
+
+// A retryable import is not pipelined: a retry uses the latest txnNumber of the session.
+static void
+test_import_bson_retryable(void)
+{
+   mock_server_t *const server = mock_server_new();
+   mock_server_auto_endsessions(server);
+   // Retryable writes require sessions and a non-standalone server.
+   mock_server_auto_hello(server,
+                          "{'isWritablePrimary': true, "
+                          " 'msg': 'isdbgrid',"
+                          " 'minWireVersion': %d,"
+                          " 'maxWireVersion': %d,"
+                          " 'maxWriteBatchSize': 2,"
+                          " 'logicalSessionTimeoutMinutes': 30}",
+                          WIRE_VERSION_MIN,
+                          WIRE_VERSION_MAX);
+   mock_server_run(server);
+
+   mongoc_uri_t *const uri = mongoc_uri_copy(mock_server_get_uri(server));
+   mongoc_uri_set_option_as_bool(uri, MONGOC_URI_RETRYWRITES, true);
+   mongoc_client_t *const client = test_framework_client_new_from_uri(uri, NULL);
+   mongoc_array_t data;
+   import_t import = {0};
+
+   _mongoc_array_init(&data, 1);
+   import_data_append(&data, 5);
+
+   import.collection = mongoc_client_get_collection(client, "db", "coll");
+   import.data = data.data;
+   import.length = data.len;
+   import.opts = tmp_bson("{'ordered': false, 'maxInFlightBatches': 3}");
+   ASSERT_CMPINT(mcommon_thread_create(&import.thread, import_thread, &import), ==, 0);
+
+   request_t *requests[4];
+   requests[0] = mock_server_receives_msg(server,
+                                          MONGOC_MSG_NONE,
+                                          tmp_bson("{'insert': 'coll', 'txnNumber': {'$numberLong': '1'}}"),
+                                          tmp_bson("{'_id': 0}"),
+                                          tmp_bson("{'_id': 1}"));
+   ASSERT(requests[0]);
+   // The next batch waits for the reply.
+   mock_server_set_request_timeout_msec(server, 100);
+   ASSERT(!mock_server_receives_request(server));
+   mock_server_set_request_timeout_msec(server, get_future_timeout_ms());
+   reply_to_request_simple(requests[0], "{'ok': 1, 'n': 2}");
+
+   requests[1] = mock_server_receives_msg(server,
+                                          MONGOC_MSG_NONE,
+                                          tmp_bson("{'insert': 'coll', 'txnNumber': {'$numberLong': '2'}}"),
+                                          tmp_bson("{'_id': 2}"),
+                                          tmp_bson("{'_id': 3}"));
+   ASSERT(requests[1]);
+   reply_to_request_simple(
+      requests[1], "{'ok': 0, 'code': 6, 'errmsg': 'host unreachable', 'errorLabels': ['RetryableWriteError']}");
+
+   // The retry has the highest txnNumber of the session so far.
+   requests[2] = mock_server_receives_msg(server,
+                                          MONGOC_MSG_NONE,
+                                          tmp_bson("{'insert': 'coll', 'txnNumber': {'$numberLong': '2'}}"),
+                                          tmp_bson("{'_id': 2}"),
+                                          tmp_bson("{'_id': 3}"));
+   ASSERT(requests[2]);
+   reply_to_request_simple(requests[2], "{'ok': 1, 'n': 2}");
+
+   requests[3] = mock_server_receives_msg(server,
+                                          MONGOC_MSG_NONE,
+                                          tmp_bson("{'insert': 'coll', 'txnNumber': {'$numberLong': '3'}}"),
+                                          tmp_bson("{'_id': 4}"));
+   ASSERT(requests[3]);
+   reply_to_request_simple(requests[3], "{'ok': 1, 'n': 1}");
+
+   ASSERT_CMPINT(mcommon_thread_join(import.thread), ==, 0);
+   ASSERT_OR_PRINT(import.ret, import.error);
+   ASSERT_MATCH(&import.reply, "{'insertedCount': 5}");
+
+   for (int i = 0; i < 4; i++) {
+      request_destroy(requests[i]);
+   }
+   bson_destroy(&import.reply);
+   mongoc_collection_destroy(import.collection);
+   _mongoc_array_destroy(&data);
+   mongoc_client_destroy(client);
+   mongoc_uri_destroy(uri);
+   mock_server_destroy(server);
+}
+
+
+// Like insert_many, an import adds an ObjectId "_id" to documents that have none, without modifying the input.
+static void
+test_import_bson_generated_id(void)
+{
+   mock_server_t *const server = mock_server_with_auto_hello(WIRE_VERSION_MAX);
+   mock_server_run(server);
+
+   mongoc_client_t *const client = test_framework_client_new_from_uri(mock_server_get_uri(server), NULL);
+   mongoc_collection_t *const collection = mongoc_client_get_collection(client, "db", "coll");
+
+   for (int use_reader = 0; use_reader < 2; use_reader++) {
+      mongoc_array_t data;
+      import_t import = {0};
+      const bson_t *docs[] = {tmp_bson("{'_id': 0}"), tmp_bson("{'x': 1}"), tmp_bson("{'_id': 2}")};
+
+      _mongoc_array_init(&data, 1);
+      for (size_t i = 0; i < sizeof docs / sizeof docs[0]; i++) {
+         _mongoc_array_append_vals(&data, bson_get_data(docs[i]), docs[i]->len);
+      }
+      const size_t length = data.len;
+
+      import.collection = collection;
+      if (use_reader) {
+         import.reader = bson_reader_new_from_data(data.data, data.len);
+      } else {
+         import.data = data.data;
+         import.length = data.len;
+      }
+      ASSERT_CMPINT(mcommon_thread_create(&import.thread, import_thread, &import), ==, 0);
+
+      request_t *const request = mock_server_receives_msg(server,
+                                                          MONGOC_MSG_NONE,
+                                                          tmp_bson("{'insert': 'coll'}"),
+                                                          tmp_bson("{'_id': 0}"),
+                                                          tmp_bson("{'_id': {'$$type': 'objectId'}, 'x': 1}"),
+                                                          tmp_bson("{'_id': 2}"));
+      ASSERT(request);
+      reply_to_request_simple(request, "{'ok': 1, 'n': 3}");
+
+      ASSERT_CMPINT(mcommon_thread_join(import.thread), ==, 0);
+      ASSERT_OR_PRINT(import.ret, import.error);
+      ASSERT_MATCH(&import.reply, "{'insertedCount': 3}");
+
+      // The input is left as is.
+      ASSERT_CMPSIZE_T(data.len, ==, length);
+      ASSERT_CMPINT(memcmp((const uint8_t *)data.data + docs[0]->len, bson_get_data(docs[1]), docs[1]->len), ==, 0);
+
+      request_destroy(request);
+      bson_destroy(&import.reply);
+      if (import.reader) {
+         bson_reader_destroy(import.reader);
+      }
+      _mongoc_array_destroy(&data);
+   }
+
+   mongoc_collection_destroy(collection);
+   mongoc_client_destroy(client);
+   mock_server_destroy(server);
+}
+
+
+// Documents before an invalid document are inserted.
+static void
+test_import_bson_reader_invalid(void)
+{
+   mock_server_t *const server = mock_server_with_auto_hello(WIRE_VERSION_MAX);
+   mock_server_run(server);
+
+   mongoc_client_t *const client = test_framework_client_new_from_uri(mock_server_get_uri(server), NULL);
+   mongoc_array_t data;
+   import_t import = {0};
+
+   _mongoc_array_init(&data, 1);
+   import_data_append(&data, 3);
+   // Truncate the last document.
+   data.len -= 2;
+
+   import.collection = mongoc_client_get_collection(client, "db", "coll");
+   import.reader = bson_reader_new_from_data(data.data, data.len);
+   ASSERT_CMPINT(mcommon_thread_create(&import.thread, import_thread, &import), ==, 0);
+
+   request_t *const request = mock_server_receives_msg(server,
+                                                       MONGOC_MSG_NONE,
+                                                       tmp_bson("{'insert': 'coll', 'ordered': true}"),
+                                                       tmp_bson("{'_id': 0}"),
+                                                       tmp_bson("{'_id': 1}"));
+   ASSERT(request);
+   reply_to_request_simple(request, "{'ok': 1, 'n': 2}");
+
+   ASSERT_CMPINT(mcommon_thread_join(import.thread), ==, 0);
+   ASSERT(!import.ret);
+   ASSERT_ERROR_CONTAINS(import.error, MONGOC_ERROR_BSON, MONGOC_ERROR_BSON_INVALID, "Document 2 is not valid BSON");
+   ASSERT_MATCH(&import.reply, "{'insertedCount': 2}");
+
+   request_destroy(request);
+   bson_destroy(&import.reply);
+   bson_reader_destroy(import.reader);
+   mongoc_collection_destroy(import.collection);
+   _mongoc_array_destroy(&data);
+   mongoc_client_destroy(client);
+   mock_server_destroy(server);
+}
+
+
 void
 test_collection_install(TestSuite *suite)
 {
@@ -4982,6 +5369,11 @@ test_collection_install(TestSuite *suite)
                      NULL,
                      test_framework_skip_if_slow_or_live);
    TestSuite_AddMockServerTest(suite, "/Collection/insert/keys", test_insert_command_keys);
+   TestSuite_AddMockServerTest(suite, "/Collection/import_bson/pipelined", test_import_bson_pipelined);
+   TestSuite_AddMockServerTest(suite, "/Collection/import_bson/write_errors", test_import_bson_write_errors);
+   TestSuite_AddMockServerTest(suite, "/Collection/import_bson/retryable", test_import_bson_retryable);
+   TestSuite_AddMockServerTest(suite, "/Collection/import_bson/generated_id", test_import_bson_generated_id);
+   TestSuite_AddMockServerTest(suite, "/Collection/import_bson_reader/invalid", test_import_bson_reader_invalid);
    TestSuite_AddLive(suite, "/Collection/insert/w0", test_insert_w0);
    TestSuite_AddLive(suite, "/Collection/update/w0", test_update_w0);
    TestSuite_AddLive(suite, "/Collection/remove/w0", test_remove_w0);
@@ -0,0 +1,180 @@
+#include <mongoc/mongoc.h>
+
+#include <TestSuite.h>
+#include <test-conveniences.h>
+#include <test-libmongoc.h>
+
+
+static bool
+_is_valid(const mongoc_columns_t *columns, size_t column, size_t row)
+{
+   const uint8_t *validity = mongoc_columns_get_validity(columns, column);
+   return (validity[row / 8u] >> (row % 8u)) & 1u;
+}
+
+
+static void
+test_columns_basic(void)
+{
+   mongoc_columns_t *columns = mongoc_columns_new();
+   bson_error_t error;
+
+   ASSERT_OR_PRINT(mongoc_columns_add(columns, "n", MONGOC_COLUMN_TYPE_INT64, &error), error);
+   ASSERT_OR_PRINT(mongoc_columns_add(columns, "x", MONGOC_COLUMN_TYPE_DOUBLE, &error), error);
+   ASSERT_OR_PRINT(mongoc_columns_add(columns, "s", MONGOC_COLUMN_TYPE_UTF8, &error), error);
+   ASSERT_CMPSIZE_T(mongoc_columns_num_columns(columns), ==, 3);
+
+   mongoc_columns_append_document(columns, tmp_bson("{'n': 1, 'x': 1.5, 's': 'foo'}"));
+   mongoc_columns_append_document(columns, tmp_bson("{'n': {'$numberLong': '2'}, 'x': 2, 's': ''}"));
+   mongoc_columns_append_document(columns, tmp_bson("{'s': 'bar', 'n': 'wrong type'}"));
+   mongoc_columns_append_document(columns, tmp_bson("{}"));
+
+   ASSERT_CMPSIZE_T(mongoc_columns_num_rows(columns), ==, 4);
+
+   {
+      const int64_t *n = mongoc_columns_get_int64(columns, 0);
+      ASSERT(n);
+      ASSERT_CMPINT64(n[0], ==, 1);
+      ASSERT_CMPINT64(n[1], ==, 2);
+      ASSERT(_is_valid(columns, 0, 0));
+      ASSERT(_is_valid(columns, 0, 1));
+      ASSERT(!_is_valid(columns, 0, 2));
+      ASSERT(!_is_valid(columns, 0, 3));
+      ASSERT(!mongoc_columns_get_double(columns, 0));
+   }
+
+   {
+      const double *x = mongoc_columns_get_double(columns, 1);
+      ASSERT(x);
+      ASSERT_CMPDOUBLE(x[0], ==, 1.5);
+      ASSERT_CMPDOUBLE(x[1], ==, 2.0);
+      ASSERT(!_is_valid(columns, 1, 2));
+   }
+
+   {
+      const uint32_t *offsets = mongoc_columns_get_utf8_offsets(columns, 2);
+      const char *data = mongoc_columns_get_utf8_data(columns, 2);
+      ASSERT(offsets);
+      ASSERT_CMPUINT32(offsets[0], ==, 0);
+      ASSERT_CMPUINT32(offsets[1], ==, 3);
+      ASSERT_CMPUINT32(offsets[2], ==, 3);
+      ASSERT_CMPUINT32(offsets[3], ==, 6);
+      ASSERT_CMPUINT32(offsets[4], ==, 6);
+      ASSERT(0 == memcmp(data, "foobar", 6));
+      ASSERT(_is_valid(columns, 2, 1)); // Empty string is not null.
+      ASSERT(!_is_valid(columns, 2, 3));
+   }
+
+   // Columns cannot be added once rows exist.
+   ASSERT(!mongoc_columns_add(columns, "y", MONGOC_COLUMN_TYPE_INT64, &error));
+   ASSERT_ERROR_CONTAINS(error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "after rows are appended");
+
+   mongoc_columns_clear(columns);
+   ASSERT_CMPSIZE_T(mongoc_columns_num_rows(columns), ==, 0);
+   ASSERT_OR_PRINT(mongoc_columns_add(columns, "y", MONGOC_COLUMN_TYPE_INT64, &error), error);
+
+   mongoc_columns_destroy(columns);
+}
+
+
+static void
+test_columns_dotted_paths(void)
+{
+   mongoc_columns_t *columns = mongoc_columns_new();
+   bson_error_t error;
+
+   ASSERT_OR_PRINT(mongoc_columns_add(columns, "meta.tenant.id", MONGOC_COLUMN_TYPE_INT64, &error), error);
+   ASSERT_OR_PRINT(mongoc_columns_add(columns, "meta.name", MONGOC_COLUMN_TYPE_UTF8, &error), error);
+   ASSERT_OR_PRINT(mongoc_columns_add(columns, "tags.1", MONGOC_COLUMN_TYPE_UTF8, &error), error);
+
+   mongoc_columns_append_document(columns,
+                                  tmp_bson("{'meta': {'name': 'a', 'tenant': {'id': 7}}, 'tags': ['x', 'y']}"));
+   mongoc_columns_append_document(columns, tmp_bson("{'meta': 1, 'tags': ['z']}"));
+
+   ASSERT_CMPINT64(mongoc_columns_get_int64(columns, 0)[0], ==, 7);
+   ASSERT(!_is_valid(columns, 0, 1));
+   ASSERT(0 == memcmp(mongoc_columns_get_utf8_data(columns, 1), "a", 1));
+   ASSERT(!_is_valid(columns, 1, 1));
+   ASSERT(0 == memcmp(mongoc_columns_get_utf8_data(columns, 2), "y", 1));
+   ASSERT(!_is_valid(columns, 2, 1));
+
+   ASSERT(!mongoc_columns_add(columns, "a..b", MONGOC_COLUMN_TYPE_INT64, &error));
+   mongoc_columns_clear(columns);
+   ASSERT(!mongoc_columns_add(columns, "a..b", MONGOC_COLUMN_TYPE_INT64, &error));
+   ASSERT_ERROR_CONTAINS(error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "invalid column path");
+   ASSERT(!mongoc_columns_add(columns, "a.", MONGOC_COLUMN_TYPE_INT64, &error));
+   ASSERT(!mongoc_columns_add(columns, "", MONGOC_COLUMN_TYPE_INT64, &error));
+
+   mongoc_columns_destroy(columns);
+}
+
+
+// Documents that change key order must not be confused by the layout learned from previous documents.
+static void
+test_columns_layout_change(void)
+{
+   mongoc_columns_t *columns = mongoc_columns_new();
+   bson_error_t error;
+
+   ASSERT_OR_PRINT(mongoc_columns_add(columns, "a", MONGOC_COLUMN_TYPE_INT64, &error), error);
+   ASSERT_OR_PRINT(mongoc_columns_add(columns, "b", MONGOC_COLUMN_TYPE_INT64, &error), error);
+
+   mongoc_columns_append_document(columns, tmp_bson("{'x': 0, 'a': 1, 'b': 2}"));
+   mongoc_columns_append_document(columns, tmp_bson("{'x': 0, 'a': 3, 'b': 4}"));
+   mongoc_columns_append_document(columns, tmp_bson("{'b': 6, 'x': 0, 'a': 5}"));
+   mongoc_columns_append_document(columns, tmp_bson("{'a': 7}"));
+   // Duplicate keys resolve to the first occurrence, like bson_iter_find.
+   mongoc_columns_append_document(columns, tmp_bson("{'x': 0, 'a': 8, 'a': 9, 'b': 10}"));
+
+   {
+      const int64_t *a = mongoc_columns_get_int64(columns, 0);
+      const int64_t *b = mongoc_columns_get_int64(columns, 1);
+      ASSERT_CMPINT64(a[0], ==, 1);
+      ASSERT_CMPINT64(b[0], ==, 2);
+      ASSERT_CMPINT64(a[1], ==, 3);
+      ASSERT_CMPINT64(b[1], ==, 4);
+      ASSERT_CMPINT64(a[2], ==, 5);
+      ASSERT_CMPINT64(b[2], ==, 6);
+      ASSERT_CMPINT64(a[3], ==, 7);
+      ASSERT(!_is_valid(columns, 1, 3));
+      ASSERT_CMPINT64(a[4], ==, 8);
+      ASSERT_CMPINT64(b[4], ==, 10);
+   }
+
+   mongoc_columns_destroy(columns);
+}
+
+
+static void
+test_columns_many_rows(void)
+{
+   mongoc_columns_t *columns = mongoc_columns_new();
+   bson_error_t error;
+
+   ASSERT_OR_PRINT(mongoc_columns_add(columns, "i", MONGOC_COLUMN_TYPE_INT64, &error), error);
+
+   for (int i = 0; i < 100; i++) {
+      // Every third row is missing the field.
+      mongoc_columns_append_document(columns, i % 3 == 0 ? tmp_bson("{}") : tmp_bson("{'i': %d}", i));
+   }
+
+   ASSERT_CMPSIZE_T(mongoc_columns_num_rows(columns), ==, 100);
+   for (size_t i = 0; i < 100; i++) {
+      ASSERT_CMPINT((int)_is_valid(columns, 0, i), ==, (int)(i % 3 != 0));
+      if (i % 3 != 0) {
+         ASSERT_CMPINT64(mongoc_columns_get_int64(columns, 0)[i], ==, (int64_t)i);
+      }
+   }
+
+   mongoc_columns_destroy(columns);
+}
+
+
+void
+test_columns_install(TestSuite *suite)
+{
+   TestSuite_Add(suite, "/columns/basic", test_columns_basic);
+   TestSuite_Add(suite, "/columns/dotted_paths", test_columns_dotted_paths);
+   TestSuite_Add(suite, "/columns/layout_change", test_columns_layout_change);
+   TestSuite_Add(suite, "/columns/many_rows", test_columns_many_rows);
+}
@@ -3,12 +3,14 @@
 #include <mongoc/mongoc-collection-private.h>
 #include <mongoc/mongoc-cursor-private.h>
 #include <mongoc/mongoc-error-private.h>
+#include <mongoc/mongoc-find-cache-private.h>
 #include <mongoc/mongoc-read-concern-private.h>
 #include <mongoc/mongoc-write-concern-private.h>
 
 #include <mongoc/mongoc.h>
 
 #include <mlib/cmp.h>
+#include <mlib/time_point.h>
 
 #include <TestSuite.h>
 #include <mock_server/future-functions.h>
@@ -2627,6 +2629,385 @@ test_killCursors_fails_hello_single(void)
 }
 
 
+/* mongoc_cursor_next_columns consumes exactly one batch per call. */
+static void
+test_cursor_next_columns(void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   mongoc_columns_t *columns;
+   const bson_t *doc;
+   future_t *future;
+   request_t *request;
+   bson_error_t error;
+
+   server = mock_server_with_auto_hello(WIRE_VERSION_MIN);
+   mock_server_run(server);
+
+   client = test_framework_client_new_from_uri(mock_server_get_uri(server), NULL);
+   collection = mongoc_client_get_collection(client, "db", "coll");
+   cursor = mongoc_collection_find_with_opts(collection, tmp_bson("{}"), NULL, NULL);
+   columns = mongoc_columns_new();
+   ASSERT_OR_PRINT(mongoc_columns_add(columns, "a", MONGOC_COLUMN_TYPE_INT64, &error), error);
+
+   future = future_cursor_next(cursor, &doc);
+   request = mock_server_receives_msg(server, MONGOC_MSG_NONE, tmp_bson("{'find': 'coll'}"));
+   reply_to_op_msg_request(request,
+                           MONGOC_MSG_NONE,
+                           tmp_bson("{'ok': 1,"
+                                    " 'cursor': {"
+                                    "    'id': {'$numberLong': '1234'},"
+                                    "    'ns': 'db.coll',"
+                                    "    'firstBatch': [{'a': 1}, {'a': 2}, {'a': 3}]}}"));
+   ASSERT(future_get_bool(future));
+   future_destroy(future);
+   request_destroy(request);
+
+   /* the rest of the first batch is read without a getMore. */
+   ASSERT(mongoc_cursor_next_columns(cursor, columns));
+   ASSERT_CMPSIZE_T(mongoc_columns_num_rows(columns), ==, 2);
+   ASSERT_CMPINT64(mongoc_columns_get_int64(columns, 0)[0], ==, 2);
+   ASSERT_CMPINT64(mongoc_columns_get_int64(columns, 0)[1], ==, 3);
+
+   mongoc_columns_clear(columns);
+
+   future = future_cursor_next(cursor, &doc);
+   request = mock_server_receives_msg(server, MONGOC_MSG_NONE, tmp_bson("{'getMore': {'$numberLong': '1234'}}"));
+   reply_to_op_msg_request(request,
+                           MONGOC_MSG_NONE,
+                           tmp_bson("{'ok': 1,"
+                                    " 'cursor': {"
+                                    "    'id': {'$numberLong': '0'},"
+                                    "    'ns': 'db.coll',"
+                                    "    'nextBatch': [{'a': 4}, {'b': 5}]}}"));
+   ASSERT(future_get_bool(future));
+   ASSERT_MATCH(doc, "{'a': 4}");
+   future_destroy(future);
+   request_destroy(request);
+
+   ASSERT(mongoc_cursor_next_columns(cursor, columns));
+   ASSERT_CMPSIZE_T(mongoc_columns_num_rows(columns), ==, 1);
+   ASSERT(!(mongoc_columns_get_validity(columns, 0)[0] & 1u));
+
+   ASSERT(!mongoc_cursor_next_columns(cursor, columns));
+   ASSERT_OR_PRINT(!mongoc_cursor_error(cursor, &error), error);
+   ASSERT_CMPSIZE_T(mongoc_columns_num_rows(columns), ==, 1);
+
+   mongoc_columns_destroy(columns);
+   mongoc_cursor_destroy(cursor);
+   mongoc_collection_destroy(collection);
+   mongoc_client_destroy(client);
+   mock_server_destroy(server);
+}
+
+
+static void
+test_cursor_next_columns_from_reply(void)
+{
+   mongoc_client_t *client;
+   mongoc_cursor_t *cursor;
+   mongoc_columns_t *columns;
+   bson_error_t error;
+   bson_t reply;
+
+   client = test_framework_client_new("mongodb://localhost", NULL);
+   bson_copy_to(tmp_bson("{'ok': 1, 'cursor': {'id': 0, 'ns': 'db.coll', 'firstBatch': [{'s': 'x'}, {'s': 'yz'}]}}"),
+                &reply);
+   cursor = mongoc_cursor_new_from_command_reply_with_opts(client, &reply, NULL);
+   ASSERT_OR_PRINT(!mongoc_cursor_error(cursor, &error), error);
+
+   columns = mongoc_columns_new();
+   ASSERT_OR_PRINT(mongoc_columns_add(columns, "s", MONGOC_COLUMN_TYPE_UTF8, &error), error);
+
+   ASSERT(mongoc_cursor_next_columns(cursor, columns));
+   ASSERT_CMPSIZE_T(mongoc_columns_num_rows(columns), ==, 2);
+   ASSERT_CMPUINT32(mongoc_columns_get_utf8_offsets(columns, 0)[2], ==, 3);
+   ASSERT(0 == memcmp(mongoc_columns_get_utf8_data(columns, 0), "xyz", 3));
+
+   ASSERT(!mongoc_cursor_next_columns(cursor, columns));
+   ASSERT_OR_PRINT(!mongoc_cursor_error(cursor, &error), error);
+   ASSERT(!mongoc_cursor_more(cursor));
+
+   mongoc_columns_destroy(columns);
+   mongoc_cursor_destroy(cursor);
+   mongoc_client_destroy(client);
+}
+
+
+/* getMore replies are received into a buffer owned by the cursor and reused
+ * across batches. the buffer shrinks after a run of much smaller replies. */
+static void
+test_cursor_reuse_reply_buffer(void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   mongoc_cursor_t *cursor;
+   const mongoc_cursor_response_t *response;
+   const bson_t *doc;
+   future_t *future;
+   request_t *request;
+   bson_error_t error;
+   bson_iter_t iter;
+   bson_t reply = BSON_INITIALIZER;
+   bson_t cursor_doc;
+   bson_t batch;
+   bson_t big_doc;
+   char *big_str;
+   uint32_t str_len;
+   const size_t big_len = 1024u * 1024u + 1u;
+
+   server = mock_server_with_auto_hello(WIRE_VERSION_MIN);
+   mock_server_run(server);
+
+   client = test_framework_client_new_from_uri(mock_server_get_uri(server), NULL);
+   collection = mongoc_client_get_collection(client, "db", "coll");
+   cursor = mongoc_collection_find_with_opts(collection, tmp_bson("{}"), NULL, NULL);
+   /* the response is the first member of the find cursor's private data. */
+   response = (const mongoc_cursor_response_t *)cursor->impl.data;
+
+   big_str = bson_malloc(big_len + 1u);
+   memset(big_str, 'x', big_len);
+   big_str[big_len] = '\0';
+
+   BSON_APPEND_INT32(&reply, "ok", 1);
+   BSON_APPEND_DOCUMENT_BEGIN(&reply, "cursor", &cursor_doc);
+   BSON_APPEND_INT64(&cursor_doc, "id", 123);
+   BSON_APPEND_UTF8(&cursor_doc, "ns", "db.coll");
+   BSON_APPEND_ARRAY_BEGIN(&cursor_doc, "firstBatch", &batch);
+   BSON_APPEND_DOCUMENT_BEGIN(&batch, "0", &big_doc);
+   BSON_APPEND_INT32(&big_doc, "_id", 0);
+   BSON_APPEND_UTF8(&big_doc, "s", big_str);
+   bson_append_document_end(&batch, &big_doc);
+   bson_append_array_end(&cursor_doc, &batch);
+   bson_append_document_end(&reply, &cursor_doc);
+
+   future = future_cursor_next(cursor, &doc);
+   request = mock_server_receives_msg(server, MONGOC_MSG_NONE, tmp_bson("{'find': 'coll'}"));
+   reply_to_op_msg_request(request, MONGOC_MSG_NONE, &reply);
+   ASSERT(future_get_bool(future));
+   ASSERT(bson_iter_init_find(&iter, doc, "s"));
+   bson_iter_utf8(&iter, &str_len);
+   ASSERT_CMPUINT32(str_len, ==, (uint32_t)big_len);
+   future_destroy(future);
+   request_destroy(request);
+
+   ASSERT_CMPSIZE_T(response->buffer.datalen, >, big_len);
+
+   for (int i = 1; i <= 5; i++) {
+      future = future_cursor_next(cursor, &doc);
+      request = mock_server_receives_msg(server, MONGOC_MSG_NONE, tmp_bson("{'getMore': {'$numberLong': '123'}}"));
+      reply_to_op_msg_request(request,
+                              MONGOC_MSG_NONE,
+                              tmp_bson("{'ok': 1,"
+                                       " 'cursor': {"
+                                       "    'id': {'$numberLong': '%d'},"
+                                       "    'ns': 'db.coll',"
+                                       "    'nextBatch': [{'_id': %d}, {'_id': %d}]}}",
+                                       i == 5 ? 0 : 123,
+                                       2 * i - 1,
+                                       2 * i));
+      ASSERT(future_get_bool(future));
+      ASSERT_MATCH(doc, "{'_id': %d}", 2 * i - 1);
+      future_destroy(future);
+      request_destroy(request);
+
+      ASSERT(mongoc_cursor_next(cursor, &doc));
+      ASSERT_MATCH(doc, "{'_id': %d}", 2 * i);
+   }
+
+   /* after a run of small replies the buffer gave back its memory. */
+   ASSERT_CMPSIZE_T(response->buffer.datalen, <, big_len);
+
+   ASSERT(!mongoc_cursor_next(cursor, &doc));
+   ASSERT_OR_PRINT(!mongoc_cursor_error(cursor, &error), error);
+
+   bson_free(big_str);
+   bson_destroy(&reply);
+   mongoc_cursor_destroy(cursor);
+   mongoc_collection_destroy(collection);
+   mongoc_client_destroy(client);
+   mock_server_destroy(server);
+}
+
+
+/* runs a find that returns {_id: id}. if `server` is not NULL, the find must
+ * reach it, otherwise it must be served from the client's find cache. */
+static void
+_find_cache_next(mongoc_collection_t *collection, mock_server_t *server, const char *filter, const bson_t *opts, int id)
+{
+   mongoc_cursor_t *cursor;
+   const bson_t *doc;
+   future_t *future;
+   request_t *request;
+   bson_error_t error;
+
+   cursor = mongoc_collection_find_with_opts(collection, tmp_bson(filter), opts, NULL);
+   future = future_cursor_next(cursor, &doc);
+   if (server) {
+      request = mock_server_receives_msg(server, MONGOC_MSG_NONE, tmp_bson("{'find': 'coll'}"));
+      reply_to_op_msg_request(
+         request,
+         MONGOC_MSG_NONE,
+         tmp_bson("{'ok': 1, 'cursor': {'id': 0, 'ns': 'db.coll', 'firstBatch': [{'_id': %d}]}}", id));
+      request_destroy(request);
+   }
+
+   ASSERT(future_get_bool(future));
+   ASSERT_MATCH(doc, "{'_id': %d}", id);
+   future_destroy(future);
+   ASSERT(!mongoc_cursor_next(cursor, &doc));
+   ASSERT_OR_PRINT(!mongoc_cursor_error(cursor, &error), error);
+   mongoc_cursor_destroy(cursor);
+}
+
+
+static void
+test_cursor_find_cache(void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   bson_error_t error;
+
+   server = mock_server_with_auto_hello(WIRE_VERSION_MIN);
+   mock_server_run(server);
+
+   client = test_framework_client_new_from_uri(mock_server_get_uri(server), NULL);
+   collection = mongoc_client_get_collection(client, "db", "coll");
+
+   ASSERT(!mongoc_client_set_find_cache(client, -1, 1024, &error));
+   ASSERT_ERROR_CONTAINS(error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Invalid find cache TTL");
+
+   /* disabled by default */
+   _find_cache_next(collection, server, "{'x': 1}", NULL, 1);
+   _find_cache_next(collection, server, "{'x': 1}", NULL, 2);
+
+   ASSERT_OR_PRINT(mongoc_client_set_find_cache(client, 60 * 1000, 1024 * 1024, &error), error);
+   _find_cache_next(collection, server, "{'x': 1}", NULL, 3);
+   _find_cache_next(collection, NULL, "{'x': 1}", NULL, 3);
+
+   /* the filter and options are part of the key */
+   _find_cache_next(collection, server, "{'x': 2}", NULL, 4);
+   _find_cache_next(collection, server, "{'x': 1}", tmp_bson("{'limit': 1}"), 5);
+   _find_cache_next(collection, NULL, "{'x': 1}", tmp_bson("{'limit': 1}"), 5);
+   _find_cache_next(collection, NULL, "{'x': 2}", NULL, 4);
+
+   mongoc_client_invalidate_find_cache(client, "db", "other");
+   mongoc_client_invalidate_find_cache(client, "d", NULL);
+   _find_cache_next(collection, NULL, "{'x': 1}", NULL, 3);
+
+   mongoc_client_invalidate_find_cache(client, "db", "coll");
+   _find_cache_next(collection, server, "{'x': 1}", NULL, 6);
+   _find_cache_next(collection, NULL, "{'x': 1}", NULL, 6);
+
+   /* entries expire */
+   ASSERT_OR_PRINT(mongoc_client_set_find_cache(client, 1, 1024 * 1024, &error), error);
+   _find_cache_next(collection, server, "{'x': 1}", NULL, 7);
+   mlib_sleep_for(10, ms);
+   _find_cache_next(collection, server, "{'x': 1}", NULL, 8);
+
+   /* replies larger than the cache are not cached */
+   ASSERT_OR_PRINT(mongoc_client_set_find_cache(client, 60 * 1000, 16, &error), error);
+   _find_cache_next(collection, server, "{'x': 1}", NULL, 9);
+   _find_cache_next(collection, server, "{'x': 1}", NULL, 10);
+
+   /* disable */
+   ASSERT_OR_PRINT(mongoc_client_set_find_cache(client, 0, 0, &error), error);
+   _find_cache_next(collection, server, "{'x': 1}", NULL, 11);
+   _find_cache_next(collection, server, "{'x': 1}", NULL, 12);
+
+   mongoc_collection_destroy(collection);
+   mongoc_client_destroy(client);
+   mock_server_destroy(server);
+}
+
+
+static void
+test_cursor_find_cache_eviction(void)
+{
+   mock_server_t *server;
+   mongoc_client_t *client;
+   mongoc_collection_t *collection;
+   bson_error_t error;
+
+   server = mock_server_with_auto_hello(WIRE_VERSION_MIN);
+   mock_server_run(server);
+
+   client = test_framework_client_new_from_uri(mock_server_get_uri(server), NULL);
+   collection = mongoc_client_get_collection(client, "db", "coll");
+
+   /* each entry takes a little over 200 bytes, room for two */
+   ASSERT_OR_PRINT(mongoc_client_set_find_cache(client, 60 * 1000, 500, &error), error);
+   _find_cache_next(collection, server, "{'x': 1}", NULL, 1);
+   _find_cache_next(collection, server, "{'x': 2}", NULL, 2);
+   _find_cache_next(collection, NULL, "{'x': 1}", NULL, 1);
+
+   /* evicts {'x': 2}, the least recently used */
+   _find_cache_next(collection, server, "{'x': 3}", NULL, 3);
+   _find_cache_next(collection, NULL, "{'x': 1}", NULL, 1);
+   _find_cache_next(collection, NULL, "{'x': 3}", NULL, 3);
+   _find_cache_next(collection, server, "{'x': 2}", NULL, 4);
+
+   mongoc_collection_destroy(collection);
+   mongoc_client_destroy(client);
+   mock_server_destroy(server);
+}
+
+
+/* Many entries, in least recently used order. */
+static void
+test_cursor_find_cache_many(void)
+{
+   mongoc_find_cache_t *cache;
+   bson_t *keys[1000];
+   bson_t *reply = tmp_bson("{'ok': 1}");
+   size_t entry_size;
+
+   for (int i = 0; i < 1000; i++) {
+      keys[i] = bson_copy(tmp_bson("{'x': %d}", i));
+   }
+
+   /* all entries fit, the hash table grows */
+   cache = _mongoc_find_cache_new(60 * 1000, 1024 * 1024);
+   for (int i = 0; i < 1000; i++) {
+      _mongoc_find_cache_put(cache, "db.coll", keys[i], reply);
+   }
+   for (int i = 0; i < 1000; i++) {
+      ASSERT(_mongoc_find_cache_get(cache, "db.coll", keys[i]));
+      ASSERT(!_mongoc_find_cache_get(cache, "db.other", keys[i]));
+   }
+
+   _mongoc_find_cache_invalidate(cache, "db", "coll");
+   ASSERT(!_mongoc_find_cache_get(cache, "db.coll", keys[0]));
+   _mongoc_find_cache_destroy(cache);
+
+   /* room for 10 entries */
+   entry_size = strlen("db.coll") + keys[0]->len + reply->len;
+   cache = _mongoc_find_cache_new(60 * 1000, 10u * entry_size);
+   for (int i = 0; i < 10; i++) {
+      _mongoc_find_cache_put(cache, "db.coll", keys[i], reply);
+   }
+
+   /* using the oldest entry makes the second oldest the least recently used */
+   ASSERT(_mongoc_find_cache_get(cache, "db.coll", keys[0]));
+   _mongoc_find_cache_put(cache, "db.coll", keys[10], reply);
+   ASSERT(_mongoc_find_cache_get(cache, "db.coll", keys[0]));
+   ASSERT(!_mongoc_find_cache_get(cache, "db.coll", keys[1]));
+   for (int i = 2; i <= 10; i++) {
+      ASSERT(_mongoc_find_cache_get(cache, "db.coll", keys[i]));
+   }
+
+   _mongoc_find_cache_destroy(cache);
+
+   for (int i = 0; i < 1000; i++) {
+      bson_destroy(keys[i]);
+   }
+}
+
+
 void
 test_cursor_install(TestSuite *suite)
 {
@@ -2688,4 +3069,10 @@ test_cursor_install(TestSuite *suite)
    TestSuite_AddLive(suite, "/Cursor/killCursors_failure_logs", test_killCursors_failure_logs);
    TestSuite_AddMockServerTest(suite, "/Cursor/killCursors_fails_hello/single", test_killCursors_fails_hello_single);
    TestSuite_AddMockServerTest(suite, "/Cursor/killCursors_fails_hello/pooled", test_killCursors_fails_hello_pooled);
+   TestSuite_AddMockServerTest(suite, "/Cursor/next_columns", test_cursor_next_columns);
+   TestSuite_Add(suite, "/Cursor/next_columns/from_reply", test_cursor_next_columns_from_reply);
+   TestSuite_AddMockServerTest(suite, "/Cursor/reuse_reply_buffer", test_cursor_reuse_reply_buffer);
+   TestSuite_AddMockServerTest(suite, "/Cursor/find_cache", test_cursor_find_cache);
+   TestSuite_AddMockServerTest(suite, "/Cursor/find_cache/eviction", test_cursor_find_cache_eviction);
+   TestSuite_Add(suite, "/Cursor/find_cache/many", test_cursor_find_cache_many);
 }
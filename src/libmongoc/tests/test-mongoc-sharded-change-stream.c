@@ -0,0 +1,134 @@
+#include <mongoc/mongoc.h>
+
+#include <mock_server/mock-server.h>
+#include <mock_server/request.h>
+
+#include <TestSuite.h>
+#include <test-conveniences.h>
+#include <test-libmongoc.h>
+
+
+static bool
+_json_responder(request_t *request, void *data)
+{
+   // `data` is a NULL-terminated list of command names, each followed by its reply.
+   const char *const *responses = data;
+
+   for (size_t i = 0; responses[i]; i += 2) {
+      if (!strcmp(request->command_name, responses[i])) {
+         reply_to_request_simple(request, responses[i + 1]);
+         request_destroy(request);
+         return true;
+      }
+   }
+
+   return false;
+}
+
+
+static void
+test_sharded_change_stream_low_watermark(void)
+{
+   mock_server_t *mongos = mock_mongos_new(WIRE_VERSION_MIN);
+   mock_server_t *shard_a = mock_mongos_new(WIRE_VERSION_MIN);
+   mock_server_t *shard_b = mock_server_new();
+   mongoc_client_t *client;
+   mongoc_sharded_change_stream_t *stream;
+   const bson_t *event;
+   bson_error_t error;
+   uint32_t t, i;
+   char *list_shards;
+   // The "_data" of each resume token begins with its cluster time, Timestamp(20, 1) and Timestamp(30, 1).
+   const char *aggregate_a = "{'ok': 1, 'operationTime': {'$timestamp': {'t': 10, 'i': 1}},"
+                             " 'cursor': {'id': 123, 'ns': 'admin.$cmd.aggregate', 'firstBatch': ["
+                             " {'_id': {'_data': '820000001400000001'},"
+                             "  'clusterTime': {'$timestamp': {'t': 20, 'i': 1}}}]}}";
+   const char *aggregate_b = "{'ok': 1, 'operationTime': {'$timestamp': {'t': 15, 'i': 1}},"
+                             " 'cursor': {'id': 123, 'ns': 'admin.$cmd.aggregate', 'firstBatch': [],"
+                             " 'postBatchResumeToken': {'_data': '820000001E00000001'}}}";
+
+   mock_server_run(mongos);
+   mock_server_run(shard_a);
+   mock_server_run(shard_b);
+
+   // shard_b is a single-member replica set, listed as "rsB/host".
+   mock_server_auto_hello(shard_b,
+                          "{'ok': 1, 'isWritablePrimary': true, 'setName': 'rsB', 'hosts': ['%s'],"
+                          " 'minWireVersion': %d, 'maxWireVersion': %d}",
+                          mock_server_get_host_and_port(shard_b),
+                          WIRE_VERSION_MIN,
+                          WIRE_VERSION_MIN);
+
+   list_shards = bson_strdup_printf("{'ok': 1, 'shards': [{'_id': 'shardA', 'host': '%s'},"
+                                    " {'_id': 'shardB', 'host': 'rsB/%s'}]}",
+                                    mock_server_get_host_and_port(shard_a),
+                                    mock_server_get_host_and_port(shard_b));
+
+   {
+      const char *mongos_responses[] = {"listShards", list_shards, "endSessions", "{'ok': 1}", NULL};
+      const char *a_responses[] = {
+         "aggregate", aggregate_a, "killCursors", "{'ok': 1}", "endSessions", "{'ok': 1}", NULL};
+      const char *b_responses[] = {
+         "aggregate", aggregate_b, "killCursors", "{'ok': 1}", "endSessions", "{'ok': 1}", NULL};
+
+      mock_server_autoresponds(mongos, _json_responder, (void *)mongos_responses, NULL);
+      mock_server_autoresponds(shard_a, _json_responder, (void *)a_responses, NULL);
+      mock_server_autoresponds(shard_b, _json_responder, (void *)b_responses, NULL);
+
+      client = test_framework_client_new_from_uri(mock_server_get_uri(mongos), NULL);
+
+      // Per-shard resume tokens cannot be used to start a stream on every shard.
+      stream = mongoc_client_watch_shards(client, tmp_bson("{}"), tmp_bson("{'resumeAfter': {'_data': 'x'}}"), &error);
+      ASSERT(!stream);
+      ASSERT_ERROR_CONTAINS(error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "startAtOperationTime");
+
+      stream = mongoc_client_watch_shards(client, tmp_bson("{}"), NULL, &error);
+      ASSERT_OR_PRINT(stream, error);
+
+      ASSERT_CMPSIZE_T(mongoc_sharded_change_stream_num_shards(stream), ==, 2);
+      ASSERT_CMPSTR(mongoc_sharded_change_stream_get_shard_name(stream, 0), "shardA");
+      ASSERT_CMPSTR(mongoc_sharded_change_stream_get_shard_name(stream, 1), "shardB");
+
+      // Each shard starts at the operationTime of its aggregate.
+      ASSERT(mongoc_sharded_change_stream_get_low_watermark(stream, &t, &i));
+      ASSERT_CMPUINT32(t, ==, 10);
+      ASSERT_CMPUINT32(i, ==, 1);
+
+      ASSERT(mongoc_change_stream_next(mongoc_sharded_change_stream_get_stream(stream, 0), &event));
+      ASSERT_OR_PRINT(mongoc_sharded_change_stream_ack(stream, 0, event, &error), error);
+      ASSERT(mongoc_sharded_change_stream_get_low_watermark(stream, &t, &i));
+      ASSERT_CMPUINT32(t, ==, 15);
+
+      // An idle shard advances to the cluster time of its post-batch resume token.
+      ASSERT_OR_PRINT(mongoc_sharded_change_stream_ack(stream, 1, NULL, &error), error);
+      ASSERT(mongoc_sharded_change_stream_get_low_watermark(stream, &t, &i));
+      ASSERT_CMPUINT32(t, ==, 20);
+      ASSERT_CMPUINT32(i, ==, 1);
+
+      // Watermarks never move backwards.
+      ASSERT_OR_PRINT(mongoc_sharded_change_stream_ack(
+                         stream, 0, tmp_bson("{'clusterTime': {'$timestamp': {'t': 5, 'i': 0}}}"), &error),
+                      error);
+      ASSERT(mongoc_sharded_change_stream_get_low_watermark(stream, &t, &i));
+      ASSERT_CMPUINT32(t, ==, 20);
+
+      ASSERT(!mongoc_sharded_change_stream_ack(stream, 0, tmp_bson("{}"), &error));
+      ASSERT_ERROR_CONTAINS(error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "clusterTime");
+
+      mongoc_sharded_change_stream_destroy(stream);
+      mongoc_client_destroy(client);
+   }
+
+   bson_free(list_shards);
+   mock_server_destroy(shard_b);
+   mock_server_destroy(shard_a);
+   mock_server_destroy(mongos);
+}
+
+
+void
+test_sharded_change_stream_install(TestSuite *suite)
+{
+   TestSuite_AddMockServerTest(
+      suite, "/sharded_change_stream/low_watermark", test_sharded_change_stream_low_watermark);
+}